@@ -79,6 +79,7 @@ private:
     PF_FileHandle pfFileHandle;
     AttrType attrType;
     int attrLength;
+    int pageSize;                                 // of the index file
 };
 
 //
@@ -143,7 +144,8 @@ public:
 
     // Create a new Index
     RC CreateIndex(const char *fileName, int indexNo,
-                   AttrType attrType, int attrLength);
+                   AttrType attrType, int attrLength,
+                   int pageSize = PF_PAGE_SIZE);
 
     // Destroy and Index
     RC DestroyIndex(const char *fileName, int indexNo);
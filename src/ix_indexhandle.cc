@@ -16,6 +16,7 @@ IX_IndexHandle::IX_IndexHandle()
    // Initialize member variables
    attrType = INT;
    attrLength = 0;
+   pageSize = PF_PAGE_SIZE;
 }
 
 //
@@ -184,7 +185,8 @@ RC IX_IndexHandle::InsertEntryToIntlNode(const PageNum nodeNum,
       goto err_return;
 
    // Just add new entry if possible
-   if (IX_PAGEHDR_SIZE + (numKeys + 2) * InternalEntrySize() <= PF_PAGE_SIZE) {
+   if ((int)(IX_PAGEHDR_SIZE + (numKeys + 2) * InternalEntrySize())
+         <= pageSize) {
       if (rc = InsertEntryToIntlNodeNoSplit(nodeNum, childNodeNum,
                                             splitKey, splitNodeNum))
          goto err_return;
@@ -402,8 +404,8 @@ RC IX_IndexHandle::InsertEntryToIntlNodeSplit(const PageNum nodeNum,
          goto err_return;
 
       // To assign page number 0 to root node
-      memcpy(pNew2Node, pNode, PF_PAGE_SIZE);
-      memset(pNode, 0, PF_PAGE_SIZE); 
+      memcpy(pNew2Node, pNode, pageSize);
+      memset(pNode, 0, pageSize); 
       ((IX_PageHdr *)pNode)->flags = IX_INTERNAL_NODE;
       ((IX_PageHdr *)pNode)->numKeys = 1;
       ((IX_PageHdr *)pNode)->prevNode = attrType;
@@ -533,7 +535,7 @@ do_unpin:
       goto err_return;
 do_insert:
    // Just add new entry if possible
-   if (IX_PAGEHDR_SIZE + (numKeys + 1) * LeafEntrySize() <= PF_PAGE_SIZE) {
+   if ((int)(IX_PAGEHDR_SIZE + (numKeys + 1) * LeafEntrySize()) <= pageSize) {
       if (rc = InsertEntryToLeafNodeNoSplit(nodeNum, pData, rid,
                                             splitKey, splitNodeNum))
          goto err_return;
@@ -727,8 +729,8 @@ RC IX_IndexHandle::InsertEntryToLeafNodeSplit(const PageNum nodeNum,
          goto err_return;
 
       // To assign page number 0 to root node
-      memcpy(pNew2Node, pNode, PF_PAGE_SIZE);
-      memset(pNode, 0, PF_PAGE_SIZE); 
+      memcpy(pNew2Node, pNode, pageSize);
+      memset(pNode, 0, pageSize); 
       ((IX_PageHdr *)pNode)->flags = IX_INTERNAL_NODE;
       ((IX_PageHdr *)pNode)->numKeys = 1;
       ((IX_PageHdr *)pNode)->prevNode = attrType;
@@ -1029,7 +1031,7 @@ RC IX_IndexHandle::DeleteEntryAtIntlNode(const PageNum nodeNum,
                goto err_return;
 
             // Move the new root node to page 0
-            memcpy(pNode, pRootNode, PF_PAGE_SIZE);
+            memcpy(pNode, pRootNode, pageSize);
             ((IX_PageHdr *)pNode)->prevNode = attrType;
             ((IX_PageHdr *)pNode)->nextNode = attrLength;
 
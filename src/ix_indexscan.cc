@@ -42,7 +42,8 @@ IX_IndexScan::~IX_IndexScan()
 //       _compOp     - EQ_OP|LT_OP|GT_OP|LE_OP|GE_OP|NO_OP (excludes NE_OP)
 //       _value      - points to the value which will be compared with
 //                     the index keys
-//       _pinHint    - not implemented yet
+//       _pinHint    - buffer pool hint for the leaf pages; a scan of the
+//                     whole index (NO_OP) with NO_HINT is SEQUENTIAL
 // Ret:  IX_SCANOPEN, IX_CLOSEDFILE, IX_NULLPOINTER, IX_INVALIDCOMPOP
 //
 RC IX_IndexScan::OpenScan(const IX_IndexHandle &indexHandle,
@@ -88,7 +89,8 @@ RC IX_IndexScan::OpenScan(const IX_IndexHandle &indexHandle,
    pIndexHandle = (IX_IndexHandle *)&indexHandle;
    compOp       = _compOp;
    value        =  _value;
-   pinHint      = _pinHint;
+   pinHint      = (_pinHint == NO_HINT && _compOp == NO_OP) ?
+                  SEQUENTIAL : _pinHint;
 
    // Set local state variables
    bScanOpen = TRUE;
@@ -125,7 +127,7 @@ RC IX_IndexScan::FindEntryAtNode(PageNum nodeNum)
    char *pNode;
    int numKeys;
 
-   // Pin
+   // Pin (inner nodes are shared by all scans: no scan hint here)
    if (rc = pIndexHandle->pfFileHandle.GetThisPage(nodeNum, pageHandle))
       goto err_return;
    if (rc = pageHandle.GetData(pNode))
@@ -305,7 +307,8 @@ RC IX_IndexScan::GetNextEntry(RID &rid)
 
    // Pin
 pin:
-   if (rc = pIndexHandle->pfFileHandle.GetThisPage(curNodeNum, pageHandle)) {
+   if (rc = pIndexHandle->pfFileHandle.GetThisPage(curNodeNum, pageHandle,
+         pinHint)) {
       // When the last leaf node become root node due to deletion,
       // curNodeNum must be invalid.
 #ifdef DEBUG_IX
@@ -346,6 +349,13 @@ pin:
       default:
          break;
       }
+
+      // A range scan goes on to the next leaf: start reading it now.
+      // This is only a hint to the buffer pool, so errors are ignored.
+      if (compOp != EQ_OP && pinHint != RANDOM && curNodeNum != 0 &&
+            ((IX_PageHdr *)pNode)->nextNode != IX_NO_MORE_NODE)
+         pIndexHandle->pfFileHandle.PrefetchPages(
+               ((IX_PageHdr *)pNode)->nextNode, 1, pinHint);
    }
 
    // Copy rid
@@ -36,10 +36,13 @@ IX_Manager::~IX_Manager()
 //       indexNo - 
 //       attrType - 
 //       attrLength -
+//       pageSize - size of the pages of the index (see
+//       PF_Manager::CreateFile); larger pages make for a lower tree
 // Ret:  IX_INVALIDINDEXNO or PF return code
 //
 RC IX_Manager::CreateIndex(const char *fileName, int indexNo,
-                           AttrType attrType, int attrLength)
+                           AttrType attrType, int attrLength,
+                           int pageSize)
 {
    RC rc;
    char *fileNameIndexNo;
@@ -85,7 +88,7 @@ RC IX_Manager::CreateIndex(const char *fileName, int indexNo,
    sprintf(fileNameIndexNo, "%s.%u", fileName, indexNo);
 
    // Call PF_Manager::CreateFile()
-   if (rc = pPfm->CreateFile(fileNameIndexNo))
+   if (rc = pPfm->CreateFile(fileNameIndexNo, pageSize))
       // Test: existing fileName, wrong permission
       goto err_return;
 
@@ -231,6 +234,11 @@ RC IX_Manager::OpenIndex(const char *fileName, int indexNo,
       // Test: non-existing fileName, opened indexHandle
       goto err_return;
 
+   // Nodes fill the pages of the file
+   if (rc = indexHandle.pfFileHandle.GetPageSize(indexHandle.pageSize))
+      // Should not happen
+      goto err_close;
+
    // Get the root node
    if (rc = indexHandle.pfFileHandle.GetFirstPage(pageHandle))
       // Test: invalid file
@@ -1,21 +1,22 @@
-/* A Bison parser, made by GNU Bison 2.5.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989-1990, 2000-2011 Free Software Foundation, Inc.
-   
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -26,13 +27,17 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -40,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "2.5"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -58,14 +63,10 @@
 /* Pull parsers.  */
 #define YYPULL 1
 
-/* Using locations.  */
-#define YYLSP_NEEDED 0
-
 
 
-/* Copy the first part of user declarations.  */
 
-/* Line 268 of yacc.c  */
+/* First part of user prologue.  */
 #line 1 "parse.y"
 
 /*
@@ -82,6 +83,8 @@
  * 1998: Added "reset buffer", "resize buffer [int]", "queryplans on",
  * and "queryplans off".
  * 2000: Added "const" to yyerror-header
+ * Added "print io buffer": the buffer use of each relation and index.
+ * Added "print buffer curve": the miss-ratio curve of the buffer pools.
  *
  */
 
@@ -136,76 +139,97 @@ SM_Manager *pSmm;          // SM component manager
 QL_Manager *pQlm;          // QL component manager
 
 
+#line 143 "y.tab.c"
 
-/* Line 268 of yacc.c  */
-#line 142 "y.tab.c"
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
 
-/* Enabling traces.  */
+/* Use api.header.include to #include this header
+   instead of duplicating it here.  */
+#ifndef YY_YY_Y_TAB_H_INCLUDED
+# define YY_YY_Y_TAB_H_INCLUDED
+/* Debug traces.  */
 #ifndef YYDEBUG
 # define YYDEBUG 0
 #endif
-
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* Enabling the token table.  */
-#ifndef YYTOKEN_TABLE
-# define YYTOKEN_TABLE 0
+#if YYDEBUG
+extern int yydebug;
 #endif
 
-
-/* Tokens.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     RW_CREATE = 258,
-     RW_DROP = 259,
-     RW_TABLE = 260,
-     RW_INDEX = 261,
-     RW_LOAD = 262,
-     RW_SET = 263,
-     RW_HELP = 264,
-     RW_PRINT = 265,
-     RW_EXIT = 266,
-     RW_SELECT = 267,
-     RW_FROM = 268,
-     RW_WHERE = 269,
-     RW_INSERT = 270,
-     RW_DELETE = 271,
-     RW_UPDATE = 272,
-     RW_AND = 273,
-     RW_INTO = 274,
-     RW_VALUES = 275,
-     T_EQ = 276,
-     T_LT = 277,
-     T_LE = 278,
-     T_GT = 279,
-     T_GE = 280,
-     T_NE = 281,
-     T_EOF = 282,
-     NOTOKEN = 283,
-     RW_RESET = 284,
-     RW_IO = 285,
-     RW_BUFFER = 286,
-     RW_RESIZE = 287,
-     RW_QUERY_PLAN = 288,
-     RW_ON = 289,
-     RW_OFF = 290,
-     T_INT = 291,
-     T_REAL = 292,
-     T_STRING = 293,
-     T_QSTRING = 294,
-     T_SHELL_CMD = 295
-   };
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    RW_CREATE = 258,               /* RW_CREATE  */
+    RW_DROP = 259,                 /* RW_DROP  */
+    RW_TABLE = 260,                /* RW_TABLE  */
+    RW_INDEX = 261,                /* RW_INDEX  */
+    RW_LOAD = 262,                 /* RW_LOAD  */
+    RW_SET = 263,                  /* RW_SET  */
+    RW_HELP = 264,                 /* RW_HELP  */
+    RW_PRINT = 265,                /* RW_PRINT  */
+    RW_EXIT = 266,                 /* RW_EXIT  */
+    RW_SELECT = 267,               /* RW_SELECT  */
+    RW_FROM = 268,                 /* RW_FROM  */
+    RW_WHERE = 269,                /* RW_WHERE  */
+    RW_INSERT = 270,               /* RW_INSERT  */
+    RW_DELETE = 271,               /* RW_DELETE  */
+    RW_UPDATE = 272,               /* RW_UPDATE  */
+    RW_AND = 273,                  /* RW_AND  */
+    RW_INTO = 274,                 /* RW_INTO  */
+    RW_VALUES = 275,               /* RW_VALUES  */
+    T_EQ = 276,                    /* T_EQ  */
+    T_LT = 277,                    /* T_LT  */
+    T_LE = 278,                    /* T_LE  */
+    T_GT = 279,                    /* T_GT  */
+    T_GE = 280,                    /* T_GE  */
+    T_NE = 281,                    /* T_NE  */
+    T_EOF = 282,                   /* T_EOF  */
+    NOTOKEN = 283,                 /* NOTOKEN  */
+    RW_RESET = 284,                /* RW_RESET  */
+    RW_IO = 285,                   /* RW_IO  */
+    RW_BUFFER = 286,               /* RW_BUFFER  */
+    RW_RESIZE = 287,               /* RW_RESIZE  */
+    RW_CURVE = 288,                /* RW_CURVE  */
+    RW_QUERY_PLAN = 289,           /* RW_QUERY_PLAN  */
+    RW_ON = 290,                   /* RW_ON  */
+    RW_OFF = 291,                  /* RW_OFF  */
+    T_INT = 292,                   /* T_INT  */
+    T_REAL = 293,                  /* T_REAL  */
+    T_STRING = 294,                /* T_STRING  */
+    T_QSTRING = 295,               /* T_QSTRING  */
+    T_SHELL_CMD = 296              /* T_SHELL_CMD  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
-/* Tokens.  */
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
 #define RW_CREATE 258
 #define RW_DROP 259
 #define RW_TABLE 260
@@ -236,24 +260,21 @@ QL_Manager *pQlm;          // QL component manager
 #define RW_IO 285
 #define RW_BUFFER 286
 #define RW_RESIZE 287
-#define RW_QUERY_PLAN 288
-#define RW_ON 289
-#define RW_OFF 290
-#define T_INT 291
-#define T_REAL 292
-#define T_STRING 293
-#define T_QSTRING 294
-#define T_SHELL_CMD 295
-
-
-
-
+#define RW_CURVE 288
+#define RW_QUERY_PLAN 289
+#define RW_ON 290
+#define RW_OFF 291
+#define T_INT 292
+#define T_REAL 293
+#define T_STRING 294
+#define T_QSTRING 295
+#define T_SHELL_CMD 296
+
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
+union YYSTYPE
 {
-
-/* Line 293 of yacc.c  */
-#line 71 "parse.y"
+#line 73 "parse.y"
 
     int ival;
     CompOp cval;
@@ -261,52 +282,203 @@ typedef union YYSTYPE
     char *sval;
     NODE *n;
 
+#line 286 "y.tab.c"
 
-
-/* Line 293 of yacc.c  */
-#line 268 "y.tab.c"
-} YYSTYPE;
+};
+typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
 # define YYSTYPE_IS_DECLARED 1
 #endif
 
 
-/* Copy the second part of user declarations.  */
+extern YYSTYPE yylval;
+
+
+int yyparse (void);
+
+
+#endif /* !YY_YY_Y_TAB_H_INCLUDED  */
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_RW_CREATE = 3,                  /* RW_CREATE  */
+  YYSYMBOL_RW_DROP = 4,                    /* RW_DROP  */
+  YYSYMBOL_RW_TABLE = 5,                   /* RW_TABLE  */
+  YYSYMBOL_RW_INDEX = 6,                   /* RW_INDEX  */
+  YYSYMBOL_RW_LOAD = 7,                    /* RW_LOAD  */
+  YYSYMBOL_RW_SET = 8,                     /* RW_SET  */
+  YYSYMBOL_RW_HELP = 9,                    /* RW_HELP  */
+  YYSYMBOL_RW_PRINT = 10,                  /* RW_PRINT  */
+  YYSYMBOL_RW_EXIT = 11,                   /* RW_EXIT  */
+  YYSYMBOL_RW_SELECT = 12,                 /* RW_SELECT  */
+  YYSYMBOL_RW_FROM = 13,                   /* RW_FROM  */
+  YYSYMBOL_RW_WHERE = 14,                  /* RW_WHERE  */
+  YYSYMBOL_RW_INSERT = 15,                 /* RW_INSERT  */
+  YYSYMBOL_RW_DELETE = 16,                 /* RW_DELETE  */
+  YYSYMBOL_RW_UPDATE = 17,                 /* RW_UPDATE  */
+  YYSYMBOL_RW_AND = 18,                    /* RW_AND  */
+  YYSYMBOL_RW_INTO = 19,                   /* RW_INTO  */
+  YYSYMBOL_RW_VALUES = 20,                 /* RW_VALUES  */
+  YYSYMBOL_T_EQ = 21,                      /* T_EQ  */
+  YYSYMBOL_T_LT = 22,                      /* T_LT  */
+  YYSYMBOL_T_LE = 23,                      /* T_LE  */
+  YYSYMBOL_T_GT = 24,                      /* T_GT  */
+  YYSYMBOL_T_GE = 25,                      /* T_GE  */
+  YYSYMBOL_T_NE = 26,                      /* T_NE  */
+  YYSYMBOL_T_EOF = 27,                     /* T_EOF  */
+  YYSYMBOL_NOTOKEN = 28,                   /* NOTOKEN  */
+  YYSYMBOL_RW_RESET = 29,                  /* RW_RESET  */
+  YYSYMBOL_RW_IO = 30,                     /* RW_IO  */
+  YYSYMBOL_RW_BUFFER = 31,                 /* RW_BUFFER  */
+  YYSYMBOL_RW_RESIZE = 32,                 /* RW_RESIZE  */
+  YYSYMBOL_RW_CURVE = 33,                  /* RW_CURVE  */
+  YYSYMBOL_RW_QUERY_PLAN = 34,             /* RW_QUERY_PLAN  */
+  YYSYMBOL_RW_ON = 35,                     /* RW_ON  */
+  YYSYMBOL_RW_OFF = 36,                    /* RW_OFF  */
+  YYSYMBOL_T_INT = 37,                     /* T_INT  */
+  YYSYMBOL_T_REAL = 38,                    /* T_REAL  */
+  YYSYMBOL_T_STRING = 39,                  /* T_STRING  */
+  YYSYMBOL_T_QSTRING = 40,                 /* T_QSTRING  */
+  YYSYMBOL_T_SHELL_CMD = 41,               /* T_SHELL_CMD  */
+  YYSYMBOL_42_ = 42,                       /* ';'  */
+  YYSYMBOL_43_ = 43,                       /* '('  */
+  YYSYMBOL_44_ = 44,                       /* ')'  */
+  YYSYMBOL_45_ = 45,                       /* ','  */
+  YYSYMBOL_46_ = 46,                       /* '*'  */
+  YYSYMBOL_47_ = 47,                       /* '.'  */
+  YYSYMBOL_YYACCEPT = 48,                  /* $accept  */
+  YYSYMBOL_start = 49,                     /* start  */
+  YYSYMBOL_command = 50,                   /* command  */
+  YYSYMBOL_ddl = 51,                       /* ddl  */
+  YYSYMBOL_dml = 52,                       /* dml  */
+  YYSYMBOL_utility = 53,                   /* utility  */
+  YYSYMBOL_queryplans = 54,                /* queryplans  */
+  YYSYMBOL_buffer = 55,                    /* buffer  */
+  YYSYMBOL_statistics = 56,                /* statistics  */
+  YYSYMBOL_createtable = 57,               /* createtable  */
+  YYSYMBOL_createindex = 58,               /* createindex  */
+  YYSYMBOL_droptable = 59,                 /* droptable  */
+  YYSYMBOL_dropindex = 60,                 /* dropindex  */
+  YYSYMBOL_load = 61,                      /* load  */
+  YYSYMBOL_set = 62,                       /* set  */
+  YYSYMBOL_help = 63,                      /* help  */
+  YYSYMBOL_print = 64,                     /* print  */
+  YYSYMBOL_exit = 65,                      /* exit  */
+  YYSYMBOL_query = 66,                     /* query  */
+  YYSYMBOL_insert = 67,                    /* insert  */
+  YYSYMBOL_delete = 68,                    /* delete  */
+  YYSYMBOL_update = 69,                    /* update  */
+  YYSYMBOL_non_mt_attrtype_list = 70,      /* non_mt_attrtype_list  */
+  YYSYMBOL_attrtype = 71,                  /* attrtype  */
+  YYSYMBOL_non_mt_select_clause = 72,      /* non_mt_select_clause  */
+  YYSYMBOL_non_mt_relattr_list = 73,       /* non_mt_relattr_list  */
+  YYSYMBOL_relattr = 74,                   /* relattr  */
+  YYSYMBOL_non_mt_relation_list = 75,      /* non_mt_relation_list  */
+  YYSYMBOL_relation = 76,                  /* relation  */
+  YYSYMBOL_opt_where_clause = 77,          /* opt_where_clause  */
+  YYSYMBOL_non_mt_cond_list = 78,          /* non_mt_cond_list  */
+  YYSYMBOL_condition = 79,                 /* condition  */
+  YYSYMBOL_relattr_or_value = 80,          /* relattr_or_value  */
+  YYSYMBOL_non_mt_value_list = 81,         /* non_mt_value_list  */
+  YYSYMBOL_value = 82,                     /* value  */
+  YYSYMBOL_opt_relname = 83,               /* opt_relname  */
+  YYSYMBOL_op = 84,                        /* op  */
+  YYSYMBOL_nothing = 85                    /* nothing  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
 
 
-/* Line 343 of yacc.c  */
-#line 280 "y.tab.c"
 
 #ifdef short
 # undef short
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
-#else
-typedef unsigned char yytype_uint8;
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#elif (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
 typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef short int yytype_int8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -314,55 +486,106 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
 #  if ENABLE_NLS
 #   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
-#   define YY_(msgid) dgettext ("bison-runtime", msgid)
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
 #  endif
 # endif
 # ifndef YY_
-#  define YY_(msgid) msgid
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(e) ((void) (e))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(e) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-/* Identity function, used to suppress warnings about constant conditions.  */
-#ifndef lint
-# define YYID(n) (n)
-#else
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static int
-YYID (int yyi)
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
 #else
-static int
-YYID (yyi)
-    int yyi;
+# define YY_INITIAL_VALUE(Value) Value
 #endif
-{
-  return yyi;
-}
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
 #endif
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -379,9 +602,9 @@ YYID (yyi)
 #    define alloca _alloca
 #   else
 #    define YYSTACK_ALLOC alloca
-#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
 #     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
 #     ifndef EXIT_SUCCESS
 #      define EXIT_SUCCESS 0
 #     endif
@@ -391,8 +614,8 @@ YYID (yyi)
 # endif
 
 # ifdef YYSTACK_ALLOC
-   /* Pacify GCC's `empty if-body' warning.  */
-#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (YYID (0))
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
     /* The OS might guarantee only one guard page at the bottom of the stack,
        and a page size can be as small as 4096 bytes.  So we cannot safely
@@ -408,7 +631,7 @@ YYID (yyi)
 #  endif
 #  if (defined __cplusplus && ! defined EXIT_SUCCESS \
        && ! ((defined YYMALLOC || defined malloc) \
-	     && (defined YYFREE || defined free)))
+             && (defined YYFREE || defined free)))
 #   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
 #   ifndef EXIT_SUCCESS
 #    define EXIT_SUCCESS 0
@@ -416,40 +639,37 @@ YYID (yyi)
 #  endif
 #  ifndef YYMALLOC
 #   define YYMALLOC malloc
-#   if ! defined malloc && ! defined EXIT_SUCCESS && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined malloc && ! defined EXIT_SUCCESS
 void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 #  ifndef YYFREE
 #   define YYFREE free
-#   if ! defined free && ! defined EXIT_SUCCESS && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined free && ! defined EXIT_SUCCESS
 void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-	 || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
@@ -459,35 +679,35 @@ union yyalloc
    elements in the stack, and YYPTR gives the new location of the
    stack.  Advance YYPTR to a properly aligned location for the next
    stack.  */
-# define YYSTACK_RELOCATE(Stack_alloc, Stack)				\
-    do									\
-      {									\
-	YYSIZE_T yynewbytes;						\
-	YYCOPY (&yyptr->Stack_alloc, Stack, yysize);			\
-	Stack = &yyptr->Stack_alloc;					\
-	yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-	yyptr += yynewbytes / sizeof (*yyptr);				\
-      }									\
-    while (YYID (0))
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
 
 #endif
 
 #if defined YYCOPY_NEEDED && YYCOPY_NEEDED
-/* Copy COUNT objects from FROM to TO.  The source and destination do
+/* Copy COUNT objects from SRC to DST.  The source and destination do
    not overlap.  */
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
-#   define YYCOPY(To, From, Count) \
-      __builtin_memcpy (To, From, (Count) * sizeof (*(From)))
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
-#   define YYCOPY(To, From, Count)		\
-      do					\
-	{					\
-	  YYSIZE_T yyi;				\
-	  for (yyi = 0; yyi < (Count); yyi++)	\
-	    (To)[yyi] = (From)[yyi];		\
-	}					\
-      while (YYID (0))
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
 #  endif
 # endif
 #endif /* !YYCOPY_NEEDED */
@@ -495,33 +715,38 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  65
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   110
+#define YYLAST   112
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  47
+#define YYNTOKENS  48
 /* YYNNTS -- Number of nonterminals.  */
 #define YYNNTS  38
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  78
-/* YYNRULES -- Number of states.  */
-#define YYNSTATES  137
+#define YYNRULES  80
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  139
 
-/* YYTRANSLATE(YYLEX) -- Bison symbol number corresponding to YYLEX.  */
-#define YYUNDEFTOK  2
-#define YYMAXUTOK   295
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   296
 
-#define YYTRANSLATE(YYX)						\
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
 
-/* YYTRANSLATE[YYLEX] -- Bison symbol number corresponding to YYLEX.  */
-static const yytype_uint8 yytranslate[] =
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-      42,    43,    45,     2,    44,     2,    46,     2,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,     2,     2,    41,
+      43,    44,    46,     2,    45,     2,    47,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,    42,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -545,338 +770,248 @@ static const yytype_uint8 yytranslate[] =
        5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
       15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
       25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
-      35,    36,    37,    38,    39,    40
+      35,    36,    37,    38,    39,    40,    41
 };
 
 #if YYDEBUG
-/* YYPRHS[YYN] -- Index of the first RHS symbol of rule number YYN in
-   YYRHS.  */
-static const yytype_uint8 yyprhs[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,     0,     3,     6,     8,    10,    12,    14,    16,    18,
-      20,    22,    24,    26,    28,    30,    32,    34,    36,    38,
-      40,    42,    44,    46,    48,    50,    52,    55,    58,    61,
-      64,    68,    71,    74,    81,    88,    92,    99,   105,   110,
-     113,   116,   118,   124,   132,   137,   145,   149,   151,   154,
-     156,   158,   162,   164,   168,   170,   174,   176,   178,   181,
-     183,   187,   189,   193,   195,   197,   201,   203,   205,   207,
-     209,   211,   213,   215,   217,   219,   221,   223,   225
+       0,   165,   165,   170,   180,   186,   195,   196,   197,   198,
+     205,   206,   207,   208,   212,   213,   214,   215,   219,   220,
+     221,   222,   223,   224,   225,   226,   230,   236,   247,   255,
+     260,   265,   273,   284,   298,   312,   319,   326,   333,   340,
+     348,   355,   362,   369,   377,   384,   391,   398,   405,   409,
+     416,   423,   424,   431,   435,   442,   446,   453,   457,   464,
+     471,   475,   482,   486,   493,   500,   504,   511,   515,   522,
+     526,   530,   537,   541,   548,   552,   556,   560,   564,   568,
+     575
 };
+#endif
 
-/* YYRHS -- A `-1'-separated list of the rules' RHS.  */
-static const yytype_int8 yyrhs[] =
-{
-      48,     0,    -1,    49,    41,    -1,    40,    -1,     1,    -1,
-      27,    -1,    50,    -1,    51,    -1,    52,    -1,    84,    -1,
-      56,    -1,    57,    -1,    58,    -1,    59,    -1,    65,    -1,
-      66,    -1,    67,    -1,    68,    -1,    60,    -1,    64,    -1,
-      61,    -1,    62,    -1,    63,    -1,    54,    -1,    55,    -1,
-      53,    -1,    33,    34,    -1,    33,    35,    -1,    29,    31,
-      -1,    10,    31,    -1,    32,    31,    36,    -1,    10,    30,
-      -1,    29,    30,    -1,     3,     5,    38,    42,    69,    43,
-      -1,     3,     6,    38,    42,    38,    43,    -1,     4,     5,
-      38,    -1,     4,     6,    38,    42,    38,    43,    -1,     7,
-      38,    42,    39,    43,    -1,     8,    38,    21,    39,    -1,
-       9,    82,    -1,    10,    38,    -1,    11,    -1,    12,    71,
-      13,    74,    76,    -1,    15,    19,    38,    20,    42,    80,
-      43,    -1,    16,    13,    38,    76,    -1,    17,    38,     8,
-      73,    21,    79,    76,    -1,    70,    44,    69,    -1,    70,
-      -1,    38,    38,    -1,    72,    -1,    45,    -1,    73,    44,
-      72,    -1,    73,    -1,    38,    46,    38,    -1,    38,    -1,
-      75,    44,    74,    -1,    75,    -1,    38,    -1,    14,    77,
-      -1,    84,    -1,    78,    18,    77,    -1,    78,    -1,    73,
-      83,    79,    -1,    73,    -1,    81,    -1,    81,    44,    80,
-      -1,    81,    -1,    39,    -1,    36,    -1,    37,    -1,    38,
-      -1,    84,    -1,    22,    -1,    23,    -1,    24,    -1,    25,
-      -1,    21,    -1,    26,    -1,    -1
-};
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
 
-/* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
-{
-       0,   162,   162,   167,   177,   183,   192,   193,   194,   195,
-     202,   203,   204,   205,   209,   210,   211,   212,   216,   217,
-     218,   219,   220,   221,   222,   223,   227,   233,   244,   252,
-     257,   265,   276,   289,   296,   303,   310,   317,   325,   332,
-     339,   346,   354,   361,   368,   375,   382,   386,   393,   400,
-     401,   408,   412,   419,   423,   430,   434,   441,   448,   452,
-     459,   463,   470,   477,   481,   488,   492,   499,   503,   507,
-     514,   518,   525,   529,   533,   537,   541,   545,   551
-};
-#endif
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
 
-#if YYDEBUG || YYERROR_VERBOSE || YYTOKEN_TABLE
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "RW_CREATE", "RW_DROP", "RW_TABLE",
-  "RW_INDEX", "RW_LOAD", "RW_SET", "RW_HELP", "RW_PRINT", "RW_EXIT",
-  "RW_SELECT", "RW_FROM", "RW_WHERE", "RW_INSERT", "RW_DELETE",
+  "\"end of file\"", "error", "\"invalid token\"", "RW_CREATE", "RW_DROP",
+  "RW_TABLE", "RW_INDEX", "RW_LOAD", "RW_SET", "RW_HELP", "RW_PRINT",
+  "RW_EXIT", "RW_SELECT", "RW_FROM", "RW_WHERE", "RW_INSERT", "RW_DELETE",
   "RW_UPDATE", "RW_AND", "RW_INTO", "RW_VALUES", "T_EQ", "T_LT", "T_LE",
   "T_GT", "T_GE", "T_NE", "T_EOF", "NOTOKEN", "RW_RESET", "RW_IO",
-  "RW_BUFFER", "RW_RESIZE", "RW_QUERY_PLAN", "RW_ON", "RW_OFF", "T_INT",
-  "T_REAL", "T_STRING", "T_QSTRING", "T_SHELL_CMD", "';'", "'('", "')'",
-  "','", "'*'", "'.'", "$accept", "start", "command", "ddl", "dml",
+  "RW_BUFFER", "RW_RESIZE", "RW_CURVE", "RW_QUERY_PLAN", "RW_ON", "RW_OFF",
+  "T_INT", "T_REAL", "T_STRING", "T_QSTRING", "T_SHELL_CMD", "';'", "'('",
+  "')'", "','", "'*'", "'.'", "$accept", "start", "command", "ddl", "dml",
   "utility", "queryplans", "buffer", "statistics", "createtable",
   "createindex", "droptable", "dropindex", "load", "set", "help", "print",
   "exit", "query", "insert", "delete", "update", "non_mt_attrtype_list",
   "attrtype", "non_mt_select_clause", "non_mt_relattr_list", "relattr",
   "non_mt_relation_list", "relation", "opt_where_clause",
   "non_mt_cond_list", "condition", "relattr_or_value", "non_mt_value_list",
-  "value", "opt_relname", "op", "nothing", 0
+  "value", "opt_relname", "op", "nothing", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[YYLEX-NUM] -- Internal token number corresponding to
-   token YYLEX-NUM.  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,   290,   291,   292,   293,   294,
-     295,    59,    40,    41,    44,    42,    46
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-/* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
-{
-       0,    47,    48,    48,    48,    48,    49,    49,    49,    49,
-      50,    50,    50,    50,    51,    51,    51,    51,    52,    52,
-      52,    52,    52,    52,    52,    52,    53,    53,    54,    54,
-      54,    55,    55,    56,    57,    58,    59,    60,    61,    62,
-      63,    64,    65,    66,    67,    68,    69,    69,    70,    71,
-      71,    72,    72,    73,    73,    74,    74,    75,    76,    76,
-      77,    77,    78,    79,    79,    80,    80,    81,    81,    81,
-      82,    82,    83,    83,    83,    83,    83,    83,    84
-};
+#define YYPACT_NINF (-107)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-81)
 
-/* YYR2[YYN] -- Number of symbols composing right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int8 yypact[] =
 {
-       0,     2,     2,     1,     1,     1,     1,     1,     1,     1,
-       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
-       1,     1,     1,     1,     1,     1,     2,     2,     2,     2,
-       3,     2,     2,     6,     6,     3,     6,     5,     4,     2,
-       2,     1,     5,     7,     4,     7,     3,     1,     2,     1,
-       1,     3,     1,     3,     1,     3,     1,     1,     2,     1,
-       3,     1,     3,     1,     1,     3,     1,     1,     1,     1,
-       1,     1,     1,     1,     1,     1,     1,     1,     0
+       8,  -107,    21,    39,   -32,   -17,   -11,   -25,  -107,   -38,
+      15,    23,     7,  -107,    27,    31,    24,  -107,    61,    22,
+    -107,  -107,  -107,  -107,  -107,  -107,  -107,  -107,  -107,  -107,
+    -107,  -107,  -107,  -107,  -107,  -107,  -107,  -107,  -107,  -107,
+      26,    28,    29,    32,    20,    45,  -107,  -107,  -107,    38,
+      37,  -107,    25,  -107,    60,  -107,    33,    35,    36,    68,
+    -107,  -107,    40,  -107,  -107,  -107,  -107,    41,    42,  -107,
+      43,    47,    48,  -107,  -107,    44,    50,    51,    59,    66,
+      51,  -107,    52,    53,    54,    55,  -107,  -107,  -107,    66,
+      49,  -107,    57,    51,  -107,  -107,    74,    58,    62,    56,
+      63,    64,  -107,  -107,    50,     1,    30,  -107,    78,    -7,
+    -107,  -107,    52,  -107,  -107,  -107,  -107,  -107,  -107,    65,
+      67,  -107,  -107,  -107,  -107,  -107,  -107,    -7,    51,  -107,
+      66,  -107,  -107,  -107,     1,  -107,  -107,  -107,  -107
 };
 
-/* YYDEFACT[STATE-NAME] -- Default reduction number in state STATE-NUM.
-   Performed when YYTABLE doesn't specify something else to do.  Zero
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
    means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+static const yytype_int8 yydefact[] =
 {
-       0,     4,     0,     0,     0,     0,    78,     0,    41,     0,
+       0,     4,     0,     0,     0,     0,    80,     0,    43,     0,
        0,     0,     0,     5,     0,     0,     0,     3,     0,     0,
        6,     7,     8,    25,    23,    24,    10,    11,    12,    13,
       18,    20,    21,    22,    19,    14,    15,    16,    17,     9,
-       0,     0,     0,     0,     0,     0,    70,    39,    71,    31,
-      29,    40,    54,    50,     0,    49,    52,     0,     0,     0,
-      32,    28,     0,    26,    27,     1,     2,     0,     0,    35,
-       0,     0,     0,     0,     0,     0,     0,    78,     0,    30,
-       0,     0,     0,     0,    38,    53,    57,    78,    56,    51,
-       0,     0,    44,    59,     0,     0,     0,    47,     0,     0,
-      37,    42,     0,     0,     0,    58,    61,     0,    48,    33,
-       0,    34,    36,    55,    68,    69,    67,     0,    66,    76,
-      72,    73,    74,    75,    77,     0,     0,    63,    78,    64,
-      46,    43,     0,    62,    60,    45,    65
-};
-
-/* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int16 yydefgoto[] =
-{
-      -1,    18,    19,    20,    21,    22,    23,    24,    25,    26,
-      27,    28,    29,    30,    31,    32,    33,    34,    35,    36,
-      37,    38,    96,    97,    54,    55,    56,    87,    88,    92,
-     105,   106,   128,   117,   118,    47,   125,    93
+       0,     0,     0,     0,     0,     0,    72,    41,    73,    32,
+      29,    42,    56,    52,     0,    51,    54,     0,     0,     0,
+      34,    28,     0,    26,    27,     1,     2,     0,     0,    37,
+       0,     0,     0,    33,    30,     0,     0,     0,     0,    80,
+       0,    31,     0,     0,     0,     0,    40,    55,    59,    80,
+      58,    53,     0,     0,    46,    61,     0,     0,     0,    49,
+       0,     0,    39,    44,     0,     0,     0,    60,    63,     0,
+      50,    35,     0,    36,    38,    57,    70,    71,    69,     0,
+      68,    78,    74,    75,    76,    77,    79,     0,     0,    65,
+      80,    66,    48,    45,     0,    64,    62,    47,    67
 };
 
-/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-   STATE-NUM.  */
-#define YYPACT_NINF -102
-static const yytype_int8 yypact[] =
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int8 yypgoto[] =
 {
-      11,  -102,     2,    40,   -33,   -29,    -8,   -28,  -102,   -34,
-      22,    46,    23,  -102,   -14,    29,    15,  -102,    62,    24,
-    -102,  -102,  -102,  -102,  -102,  -102,  -102,  -102,  -102,  -102,
-    -102,  -102,  -102,  -102,  -102,  -102,  -102,  -102,  -102,  -102,
-      26,    28,    30,    31,    21,    49,  -102,  -102,  -102,  -102,
-    -102,  -102,    27,  -102,    54,  -102,    33,    34,    36,    63,
-    -102,  -102,    39,  -102,  -102,  -102,  -102,    37,    38,  -102,
-      41,    42,    43,    47,    48,    50,    56,    64,    50,  -102,
-      51,    52,    53,    44,  -102,  -102,  -102,    64,    55,  -102,
-      58,    50,  -102,  -102,    71,    57,    59,    60,    65,    66,
-    -102,  -102,    48,     0,    32,  -102,    75,    -4,  -102,  -102,
-      51,  -102,  -102,  -102,  -102,  -102,  -102,    67,    61,  -102,
-    -102,  -102,  -102,  -102,  -102,    -4,    50,  -102,    64,  -102,
-    -102,  -102,     0,  -102,  -102,  -102,  -102
+    -107,  -107,  -107,  -107,  -107,  -107,  -107,  -107,  -107,  -107,
+    -107,  -107,  -107,  -107,  -107,  -107,  -107,  -107,  -107,  -107,
+    -107,  -107,   -31,  -107,  -107,     5,   -80,    -6,  -107,   -87,
+     -26,  -107,   -24,   -30,  -106,  -107,  -107,     4
 };
 
-/* YYPGOTO[NTERM-NUM].  */
-static const yytype_int8 yypgoto[] =
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
 {
-    -102,  -102,  -102,  -102,  -102,  -102,  -102,  -102,  -102,  -102,
-    -102,  -102,  -102,  -102,  -102,  -102,  -102,  -102,  -102,  -102,
-    -102,  -102,   -26,  -102,  -102,    19,   -78,    -6,  -102,   -86,
-     -25,  -102,   -27,   -35,  -101,  -102,  -102,    25
+       0,    18,    19,    20,    21,    22,    23,    24,    25,    26,
+      27,    28,    29,    30,    31,    32,    33,    34,    35,    36,
+      37,    38,    98,    99,    54,    55,    56,    89,    90,    94,
+     107,   108,   130,   119,   120,    47,   127,    95
 };
 
-/* YYTABLE[YYPACT[STATE-NUM]].  What to do in state STATE-NUM.  If
-   positive, shift that token.  If negative, reduce the rule which
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
-#define YYTABLE_NINF -79
 static const yytype_int16 yytable[] =
 {
-      94,   101,    49,    50,    52,    44,   129,    40,    41,    45,
-      51,    53,     1,   104,     2,     3,    60,    61,     4,     5,
-       6,     7,     8,     9,   129,    39,    10,    11,    12,   127,
-      46,    48,   114,   115,    52,   116,   114,   115,    13,   116,
-      14,    57,   135,    15,    16,    42,    43,   127,   104,    63,
-      64,    17,   -78,   119,   120,   121,   122,   123,   124,    58,
-      62,    59,    65,    71,    67,    66,    68,    74,    69,    70,
-      72,    78,    76,    73,    77,    79,    90,    75,    91,    80,
-      81,    83,    84,    82,   130,    85,    86,   100,    52,    95,
-      98,    99,   107,   126,    89,   108,   113,   136,   133,   102,
-     103,   134,   109,     0,   110,   132,     0,     0,   111,   112,
-     131
+      96,    52,   103,   131,    39,    49,    50,    44,    53,     1,
+      48,     2,     3,   106,    51,     4,     5,     6,     7,     8,
+       9,   131,    45,    10,    11,    12,    40,    41,    46,   129,
+     116,   117,    52,   118,    57,    13,    58,    14,   116,   117,
+      15,   118,    16,   137,    42,    43,    59,   129,   106,    17,
+     -80,   121,   122,   123,   124,   125,   126,    60,    61,    63,
+      64,    65,    62,    71,    66,    67,    72,    68,    69,    73,
+      74,    70,    75,    76,    78,    79,    80,    81,    77,    92,
+      93,   132,    91,    87,    82,    83,    84,    85,    86,    88,
+      52,    97,   100,   101,   104,   109,   128,   110,   115,   102,
+     105,   112,   136,   135,   138,     0,   111,   113,   114,   133,
+       0,     0,   134
 };
 
-#define yypact_value_is_default(yystate) \
-  ((yystate) == (-102))
-
-#define yytable_value_is_error(yytable_value) \
-  YYID (0)
-
 static const yytype_int16 yycheck[] =
 {
-      78,    87,    30,    31,    38,    38,   107,     5,     6,    38,
-      38,    45,     1,    91,     3,     4,    30,    31,     7,     8,
-       9,    10,    11,    12,   125,     0,    15,    16,    17,   107,
-      38,     6,    36,    37,    38,    39,    36,    37,    27,    39,
-      29,    19,   128,    32,    33,     5,     6,   125,   126,    34,
-      35,    40,    41,    21,    22,    23,    24,    25,    26,    13,
-      31,    38,     0,    42,    38,    41,    38,    13,    38,    38,
-      21,     8,    38,    46,    38,    36,    20,    44,    14,    42,
-      42,    39,    39,    42,   110,    38,    38,    43,    38,    38,
-      38,    38,    21,    18,    75,    38,   102,   132,   125,    44,
-      42,   126,    43,    -1,    44,    44,    -1,    -1,    43,    43,
-      43
+      80,    39,    89,   109,     0,    30,    31,    39,    46,     1,
+       6,     3,     4,    93,    39,     7,     8,     9,    10,    11,
+      12,   127,    39,    15,    16,    17,     5,     6,    39,   109,
+      37,    38,    39,    40,    19,    27,    13,    29,    37,    38,
+      32,    40,    34,   130,     5,     6,    39,   127,   128,    41,
+      42,    21,    22,    23,    24,    25,    26,    30,    31,    35,
+      36,     0,    31,    43,    42,    39,    21,    39,    39,    31,
+      33,    39,    47,    13,    39,    39,     8,    37,    45,    20,
+      14,   112,    77,    39,    43,    43,    43,    40,    40,    39,
+      39,    39,    39,    39,    45,    21,    18,    39,   104,    44,
+      43,    45,   128,   127,   134,    -1,    44,    44,    44,    44,
+      -1,    -1,    45
 };
 
-/* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-   symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
        0,     1,     3,     4,     7,     8,     9,    10,    11,    12,
-      15,    16,    17,    27,    29,    32,    33,    40,    48,    49,
-      50,    51,    52,    53,    54,    55,    56,    57,    58,    59,
-      60,    61,    62,    63,    64,    65,    66,    67,    68,    84,
-       5,     6,     5,     6,    38,    38,    38,    82,    84,    30,
-      31,    38,    38,    45,    71,    72,    73,    19,    13,    38,
-      30,    31,    31,    34,    35,     0,    41,    38,    38,    38,
-      38,    42,    21,    46,    13,    44,    38,    38,     8,    36,
-      42,    42,    42,    39,    39,    38,    38,    74,    75,    72,
-      20,    14,    76,    84,    73,    38,    69,    70,    38,    38,
-      43,    76,    44,    42,    73,    77,    78,    21,    38,    43,
-      44,    43,    43,    74,    36,    37,    39,    80,    81,    21,
-      22,    23,    24,    25,    26,    83,    18,    73,    79,    81,
-      69,    43,    44,    79,    77,    76,    80
+      15,    16,    17,    27,    29,    32,    34,    41,    49,    50,
+      51,    52,    53,    54,    55,    56,    57,    58,    59,    60,
+      61,    62,    63,    64,    65,    66,    67,    68,    69,    85,
+       5,     6,     5,     6,    39,    39,    39,    83,    85,    30,
+      31,    39,    39,    46,    72,    73,    74,    19,    13,    39,
+      30,    31,    31,    35,    36,     0,    42,    39,    39,    39,
+      39,    43,    21,    31,    33,    47,    13,    45,    39,    39,
+       8,    37,    43,    43,    43,    40,    40,    39,    39,    75,
+      76,    73,    20,    14,    77,    85,    74,    39,    70,    71,
+      39,    39,    44,    77,    45,    43,    74,    78,    79,    21,
+      39,    44,    45,    44,    44,    75,    37,    38,    40,    81,
+      82,    21,    22,    23,    24,    25,    26,    84,    18,    74,
+      80,    82,    70,    44,    45,    80,    78,    77,    81
 };
 
-#define yyerrok		(yyerrstatus = 0)
-#define yyclearin	(yychar = YYEMPTY)
-#define YYEMPTY		(-2)
-#define YYEOF		0
-
-#define YYACCEPT	goto yyacceptlab
-#define YYABORT		goto yyabortlab
-#define YYERROR		goto yyerrorlab
-
-
-/* Like YYERROR except do call yyerror.  This remains here temporarily
-   to ease the transition to the new meaning of YYERROR, for GCC.
-   Once GCC version 2 has supplanted version 1, this can go.  However,
-   YYFAIL appears to be in use.  Nevertheless, it is formally deprecated
-   in Bison 2.4.2's NEWS entry, where a plan to phase it out is
-   discussed.  */
-
-#define YYFAIL		goto yyerrlab
-#if defined YYFAIL
-  /* This is here to suppress warnings from the GCC cpp's
-     -Wunused-macros.  Normally we don't worry about that warning, but
-     some users do, and we want to make it easy for users to remove
-     YYFAIL uses, which will produce warnings from Bison 2.5.  */
-#endif
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    48,    49,    49,    49,    49,    50,    50,    50,    50,
+      51,    51,    51,    51,    52,    52,    52,    52,    53,    53,
+      53,    53,    53,    53,    53,    53,    54,    54,    55,    55,
+      55,    55,    56,    56,    56,    57,    58,    59,    60,    61,
+      62,    63,    64,    65,    66,    67,    68,    69,    70,    70,
+      71,    72,    72,    73,    73,    74,    74,    75,    75,    76,
+      77,    77,    78,    78,    79,    80,    80,    81,    81,    82,
+      82,    82,    83,    83,    84,    84,    84,    84,    84,    84,
+      85
+};
 
-#define YYRECOVERING()  (!!yyerrstatus)
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     2,     1,     1,     1,     1,     1,     1,     1,
+       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       1,     1,     1,     1,     1,     1,     2,     2,     2,     2,
+       3,     3,     2,     3,     2,     6,     6,     3,     6,     5,
+       4,     2,     2,     1,     5,     7,     4,     7,     3,     1,
+       2,     1,     1,     3,     1,     3,     1,     3,     1,     1,
+       2,     1,     3,     1,     3,     1,     1,     3,     1,     1,
+       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       0
+};
 
-#define YYBACKUP(Token, Value)					\
-do								\
-  if (yychar == YYEMPTY && yylen == 1)				\
-    {								\
-      yychar = (Token);						\
-      yylval = (Value);						\
-      YYPOPSTACK (1);						\
-      goto yybackup;						\
-    }								\
-  else								\
-    {								\
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;							\
-    }								\
-while (YYID (0))
-
-
-#define YYTERROR	1
-#define YYERRCODE	256
-
-
-/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
-   If N is 0, then set CURRENT to the empty location which ends
-   the previous symbol: RHS[0] (always defined).  */
-
-#define YYRHSLOC(Rhs, K) ((Rhs)[K])
-#ifndef YYLLOC_DEFAULT
-# define YYLLOC_DEFAULT(Current, Rhs, N)				\
-    do									\
-      if (YYID (N))                                                    \
-	{								\
-	  (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;	\
-	  (Current).first_column = YYRHSLOC (Rhs, 1).first_column;	\
-	  (Current).last_line    = YYRHSLOC (Rhs, N).last_line;		\
-	  (Current).last_column  = YYRHSLOC (Rhs, N).last_column;	\
-	}								\
-      else								\
-	{								\
-	  (Current).first_line   = (Current).last_line   =		\
-	    YYRHSLOC (Rhs, 0).last_line;				\
-	  (Current).first_column = (Current).last_column =		\
-	    YYRHSLOC (Rhs, 0).last_column;				\
-	}								\
-    while (YYID (0))
-#endif
 
+enum { YYENOMEM = -2 };
 
-/* This macro is provided for backward compatibility. */
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
 
-#ifndef YY_LOCATION_PRINT
-# define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-#endif
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
-/* YYLEX -- calling `yylex' with the right arguments.  */
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
-#ifdef YYLEX_PARAM
-# define YYLEX yylex (YYLEX_PARAM)
-#else
-# define YYLEX yylex ()
-#endif
 
 /* Enable debugging if requested.  */
 #if YYDEBUG
@@ -886,80 +1021,58 @@ while (YYID (0))
 #  define YYFPRINTF fprintf
 # endif
 
-# define YYDPRINTF(Args)			\
-do {						\
-  if (yydebug)					\
-    YYFPRINTF Args;				\
-} while (YYID (0))
-
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)			  \
-do {									  \
-  if (yydebug)								  \
-    {									  \
-      YYFPRINTF (stderr, "%s ", Title);					  \
-      yy_symbol_print (stderr,						  \
-		  Type, Value); \
-      YYFPRINTF (stderr, "\n");						  \
-    }									  \
-} while (YYID (0))
-
-
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
-
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
 static void
-yy_symbol_value_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# else
-  YYUSE (yyoutput);
-# endif
-  switch (yytype)
-    {
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
-static void
-yy_symbol_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
-  if (yytype < YYNTOKENS)
-    YYFPRINTF (yyoutput, "token %s (", yytname[yytype]);
-  else
-    YYFPRINTF (yyoutput, "nterm %s (", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -967,16 +1080,8 @@ yy_symbol_print (yyoutput, yytype, yyvaluep)
 | TOP (included).                                                   |
 `------------------------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
-#else
 static void
-yy_stack_print (yybottom, yytop)
-    yytype_int16 *yybottom;
-    yytype_int16 *yytop;
-#endif
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -987,63 +1092,56 @@ yy_stack_print (yybottom, yytop)
   YYFPRINTF (stderr, "\n");
 }
 
-# define YY_STACK_PRINT(Bottom, Top)				\
-do {								\
-  if (yydebug)							\
-    yy_stack_print ((Bottom), (Top));				\
-} while (YYID (0))
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
 
 
 /*------------------------------------------------.
 | Report that the YYRULE is going to be reduced.  |
 `------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_reduce_print (YYSTYPE *yyvsp, int yyrule)
-#else
 static void
-yy_reduce_print (yyvsp, yyrule)
-    YYSTYPE *yyvsp;
-    int yyrule;
-#endif
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
 {
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  unsigned long int yylno = yyrline[yyrule];
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
-	     yyrule - 1, yylno);
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
-      yy_symbol_print (stderr, yyrhs[yyprhs[yyrule] + yyi],
-		       &(yyvsp[(yyi + 1) - (yynrhs)])
-		       		       );
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
       YYFPRINTF (stderr, "\n");
     }
 }
 
-# define YY_REDUCE_PRINT(Rule)		\
-do {					\
-  if (yydebug)				\
-    yy_reduce_print (yyvsp, Rule); \
-} while (YYID (0))
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
 
 
 /* YYINITDEPTH -- initial size of the parser's stacks.  */
-#ifndef	YYINITDEPTH
+#ifndef YYINITDEPTH
 # define YYINITDEPTH 200
 #endif
 
@@ -1059,365 +1157,77 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
-
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static YYSIZE_T
-yystrlen (const char *yystr)
-#else
-static YYSIZE_T
-yystrlen (yystr)
-    const char *yystr;
-#endif
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
-
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-#else
-static char *
-yystpcpy (yydest, yysrc)
-    char *yydest;
-    const char *yysrc;
-#endif
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
-
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
 
-  return yyd - 1;
-}
-#  endif
-# endif
 
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-	switch (*++yyp)
-	  {
-	  case '\'':
-	  case ',':
-	    goto do_not_strip_quotes;
-
-	  case '\\':
-	    if (*++yyp != '\\')
-	      goto do_not_strip_quotes;
-	    /* Fall through.  */
-	  default:
-	    if (yyres)
-	      yyres[yyn] = *yyp;
-	    yyn++;
-	    break;
-
-	  case '"':
-	    if (yyres)
-	      yyres[yyn] = '\0';
-	    return yyn;
-	  }
-    do_not_strip_quotes: ;
-    }
 
-  if (! yyres)
-    return yystrlen (yystr);
-
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
-
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
-
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
-static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
-{
-  YYSIZE_T yysize0 = yytnamerr (0, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  YYSIZE_T yysize1;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = 0;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
-  int yycount = 0;
-
-  /* There are many possibilities here to consider:
-     - Assume YYFAIL is not used.  It's too flawed to consider.  See
-       <http://lists.gnu.org/archive/html/bison-patches/2009-12/msg00024.html>
-       for details.  YYERROR is fine as it does not invoke this
-       function.
-     - If this state is a consistent state with a default action, then
-       the only way this function was invoked is if the default action
-       is an error action.  In that case, don't check for expected
-       tokens because there are none.
-     - The only way there can be no lookahead present (in yychar) is if
-       this state is a consistent state with a default action.  Thus,
-       detecting the absence of a lookahead is sufficient to determine
-       that there is no unexpected or expected token to report.  In that
-       case, just report a simple "syntax error".
-     - Don't assume there isn't a lookahead just because this state is a
-       consistent state with a default action.  There might have been a
-       previous inconsistent state, consistent state with a non-default
-       action, or user semantic action that manipulated yychar.
-     - Of course, the expected token list depends on states to have
-       correct lookahead information, and it depends on the parser not
-       to perform extra reductions after fetching a lookahead from the
-       scanner and before detecting a syntax error.  Thus, state merging
-       (from LALR or IELR) and default reductions corrupt the expected
-       token list.  However, the list is correct for canonical LR with
-       one exception: it will still contain any token that will not be
-       accepted due to an error action in a later state.
-  */
-  if (yytoken != YYEMPTY)
-    {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                yysize1 = yysize + yytnamerr (0, yytname[yyx]);
-                if (! (yysize <= yysize1
-                       && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-                  return 2;
-                yysize = yysize1;
-              }
-        }
-    }
-
-  switch (yycount)
-    {
-# define YYCASE_(N, S)                      \
-      case N:                               \
-        yyformat = S;                       \
-      break
-      YYCASE_(0, YY_("syntax error"));
-      YYCASE_(1, YY_("syntax error, unexpected %s"));
-      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
-      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
-      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
-      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
-    }
-
-  yysize1 = yysize + yystrlen (yyformat);
-  if (! (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-    return 2;
-  yysize = yysize1;
-
-  if (*yymsg_alloc < yysize)
-    {
-      *yymsg_alloc = 2 * yysize;
-      if (! (yysize <= *yymsg_alloc
-             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
-        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
-    }
-
-  /* Avoid sprintf, as that infringes on the user's name space.
-     Don't have undefined behavior even if the translation
-     produced a string with the wrong number of "%s"s.  */
-  {
-    char *yyp = *yymsg;
-    int yyi = 0;
-    while ((*yyp = *yyformat) != '\0')
-      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
-        {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
-          yyformat += 2;
-        }
-      else
-        {
-          yyp++;
-          yyformat++;
-        }
-  }
-  return 0;
-}
-#endif /* YYERROR_VERBOSE */
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep)
-#else
-static void
-yydestruct (yymsg, yytype, yyvaluep)
-    const char *yymsg;
-    int yytype;
-    YYSTYPE *yyvaluep;
-#endif
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
 {
-  YYUSE (yyvaluep);
-
+  YY_USE (yyvaluep);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
-  switch (yytype)
-    {
-
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/* Prevent warnings from -Wmissing-prototypes.  */
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM);
-#else
-int yyparse ();
-#endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void);
-#else
-int yyparse ();
-#endif
-#endif /* ! YYPARSE_PARAM */
-
-
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 /* The semantic value of the lookahead symbol.  */
 YYSTYPE yylval;
-
 /* Number of syntax errors so far.  */
 int yynerrs;
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
 
-#ifdef YYPARSE_PARAM
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-int
-yyparse (void *YYPARSE_PARAM)
-#else
-int
-yyparse (YYPARSE_PARAM)
-    void *YYPARSE_PARAM;
-#endif
-#else /* ! YYPARSE_PARAM */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 int
 yyparse (void)
-#else
-int
-yyparse ()
-
-#endif
-#endif
 {
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
-
-    /* The stacks and their tools:
-       `yyss': related to states.
-       `yyvs': related to semantic values.
+    int yyerrstatus = 0;
 
-       Refer to the stacks thru separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-    /* The semantic value stack.  */
-    YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    YYSIZE_T yystacksize;
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
 
@@ -1425,111 +1235,107 @@ yyparse ()
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yytoken = 0;
-  yyss = yyssa;
-  yyvs = yyvsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
 
-  /* Initialize stack pointers.
-     Waste one element of value and location stack
-     so that they stay on the same level as the state stack.
-     The wasted elements are never initialized.  */
-  yyssp = yyss;
-  yyvsp = yyvs;
-
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
-	/* Give user a chance to reallocate the stack.  Use copies of
-	   these so that the &'s don't force the real ones into
-	   memory.  */
-	YYSTYPE *yyvs1 = yyvs;
-	yytype_int16 *yyss1 = yyss;
-
-	/* Each stack pointer address is followed by the size of the
-	   data in use in that stack, in bytes.  This used to be a
-	   conditional around just the two extra args, but that might
-	   be undefined if yyoverflow is a macro.  */
-	yyoverflow (YY_("memory exhausted"),
-		    &yyss1, yysize * sizeof (*yyssp),
-		    &yyvs1, yysize * sizeof (*yyvsp),
-		    &yystacksize);
-
-	yyss = yyss1;
-	yyvs = yyvs1;
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-	goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
-	yystacksize = YYMAXDEPTH;
+        yystacksize = YYMAXDEPTH;
 
       {
-	yytype_int16 *yyss1 = yyss;
-	union yyalloc *yyptr =
-	  (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
-	if (! yyptr)
-	  goto yyexhaustedlab;
-	YYSTACK_RELOCATE (yyss_alloc, yyss);
-	YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
-	if (yyss1 != yyssa)
-	  YYSTACK_FREE (yyss1);
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-		  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
-	YYABORT;
+        YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
@@ -1540,18 +1346,29 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = YYLEX;
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1579,13 +1396,13 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1600,14 +1417,14 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
   yylen = yyr2[yyn];
 
   /* If YYLEN is nonzero, implement the default value of the action:
-     `$$ = $1'.
+     '$$ = $1'.
 
      Otherwise, the following line sets YYVAL to garbage.
      This behavior is undocumented and Bison
@@ -1620,122 +1437,119 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-
-/* Line 1806 of yacc.c  */
-#line 163 "parse.y"
-    {
-      parse_tree = (yyvsp[(1) - (2)].n);
+  case 2: /* start: command ';'  */
+#line 166 "parse.y"
+   {
+      parse_tree = (yyvsp[-1].n);
       YYACCEPT;
    }
+#line 1447 "y.tab.c"
     break;
 
-  case 3:
-
-/* Line 1806 of yacc.c  */
-#line 168 "parse.y"
-    {
+  case 3: /* start: T_SHELL_CMD  */
+#line 171 "parse.y"
+   {
       if (!isatty(0)) {
-        cout << ((yyvsp[(1) - (1)].sval)) << "\n";
+        cout << ((yyvsp[0].sval)) << "\n";
         cout.flush();
       }
-      system((yyvsp[(1) - (1)].sval));
+      system((yyvsp[0].sval));
       parse_tree = NULL;
       YYACCEPT;
    }
+#line 1461 "y.tab.c"
     break;
 
-  case 4:
-
-/* Line 1806 of yacc.c  */
-#line 178 "parse.y"
-    {
+  case 4: /* start: error  */
+#line 181 "parse.y"
+   {
       reset_scanner();
       parse_tree = NULL;
       YYACCEPT;
    }
+#line 1471 "y.tab.c"
     break;
 
-  case 5:
-
-/* Line 1806 of yacc.c  */
-#line 184 "parse.y"
-    {
+  case 5: /* start: T_EOF  */
+#line 187 "parse.y"
+   {
       parse_tree = NULL;
       bExit = 1;
       YYACCEPT;
    }
+#line 1481 "y.tab.c"
     break;
 
-  case 9:
-
-/* Line 1806 of yacc.c  */
-#line 196 "parse.y"
-    {
+  case 9: /* command: nothing  */
+#line 199 "parse.y"
+   {
       (yyval.n) = NULL;
    }
+#line 1489 "y.tab.c"
     break;
 
-  case 26:
-
-/* Line 1806 of yacc.c  */
-#line 228 "parse.y"
-    {
+  case 26: /* queryplans: RW_QUERY_PLAN RW_ON  */
+#line 231 "parse.y"
+   {
       bQueryPlans = 1;
       cout << "Query plan display turned on.\n";
       (yyval.n) = NULL;
    }
+#line 1499 "y.tab.c"
     break;
 
-  case 27:
-
-/* Line 1806 of yacc.c  */
-#line 234 "parse.y"
-    { 
+  case 27: /* queryplans: RW_QUERY_PLAN RW_OFF  */
+#line 237 "parse.y"
+   { 
       bQueryPlans = 0;
       cout << "Query plan display turned off.\n";
       (yyval.n) = NULL;
    }
+#line 1509 "y.tab.c"
     break;
 
-  case 28:
-
-/* Line 1806 of yacc.c  */
-#line 245 "parse.y"
-    {
+  case 28: /* buffer: RW_RESET RW_BUFFER  */
+#line 248 "parse.y"
+   {
       if (pPfm->ClearBuffer())
          cout << "Trouble clearing buffer!  Things may be pinned.\n";
       else 
          cout << "Everything kicked out of Buffer!\n";
       (yyval.n) = NULL;
    }
+#line 1521 "y.tab.c"
     break;
 
-  case 29:
-
-/* Line 1806 of yacc.c  */
-#line 253 "parse.y"
-    {
+  case 29: /* buffer: RW_PRINT RW_BUFFER  */
+#line 256 "parse.y"
+   {
       pPfm->PrintBuffer();
       (yyval.n) = NULL;
    }
+#line 1530 "y.tab.c"
     break;
 
-  case 30:
-
-/* Line 1806 of yacc.c  */
-#line 258 "parse.y"
-    {
-      pPfm->ResizeBuffer((yyvsp[(3) - (3)].ival));
+  case 30: /* buffer: RW_PRINT RW_BUFFER RW_CURVE  */
+#line 261 "parse.y"
+   {
+      pPfm->PrintCurve();
       (yyval.n) = NULL;
    }
+#line 1539 "y.tab.c"
     break;
 
-  case 31:
-
-/* Line 1806 of yacc.c  */
+  case 31: /* buffer: RW_RESIZE RW_BUFFER T_INT  */
 #line 266 "parse.y"
-    {
+   {
+      pPfm->ResizeBuffer((yyvsp[0].ival));
+      (yyval.n) = NULL;
+   }
+#line 1548 "y.tab.c"
+    break;
+
+  case 32: /* statistics: RW_PRINT RW_IO  */
+#line 274 "parse.y"
+   {
       #ifdef PF_STATS
          cout << "Statistics\n";
          cout << "----------\n";
@@ -1745,424 +1559,398 @@ yyreduce:
       #endif
       (yyval.n) = NULL;
    }
+#line 1563 "y.tab.c"
     break;
 
-  case 32:
+  case 33: /* statistics: RW_PRINT RW_IO RW_BUFFER  */
+#line 285 "parse.y"
+   {
+      #ifdef PF_STATS
+         RC rc;
 
-/* Line 1806 of yacc.c  */
-#line 277 "parse.y"
-    {
+         cout << "Buffer use by relation and index\n";
+         cout << "--------------------------------\n";
+         if ((rc = pSmm->PrintIO(*pPfm)))
+            PrintError(rc);
+      #else
+         cout << "Statitisics not compiled.\n";
+      #endif
+      (yyval.n) = NULL;
+   }
+#line 1581 "y.tab.c"
+    break;
+
+  case 34: /* statistics: RW_RESET RW_IO  */
+#line 299 "parse.y"
+   {
       #ifdef PF_STATS
          cout << "Statistics reset.\n";
          pStatisticsMgr->Reset();
+         pPfm->ResetFileStats();
       #else
          cout << "Statitisics not compiled.\n";
       #endif
       (yyval.n) = NULL;
    }
+#line 1596 "y.tab.c"
     break;
 
-  case 33:
-
-/* Line 1806 of yacc.c  */
-#line 290 "parse.y"
-    {
-      (yyval.n) = create_table_node((yyvsp[(3) - (6)].sval), (yyvsp[(5) - (6)].n));
+  case 35: /* createtable: RW_CREATE RW_TABLE T_STRING '(' non_mt_attrtype_list ')'  */
+#line 313 "parse.y"
+   {
+      (yyval.n) = create_table_node((yyvsp[-3].sval), (yyvsp[-1].n));
    }
+#line 1604 "y.tab.c"
     break;
 
-  case 34:
-
-/* Line 1806 of yacc.c  */
-#line 297 "parse.y"
-    {
-      (yyval.n) = create_index_node((yyvsp[(3) - (6)].sval), (yyvsp[(5) - (6)].sval));
+  case 36: /* createindex: RW_CREATE RW_INDEX T_STRING '(' T_STRING ')'  */
+#line 320 "parse.y"
+   {
+      (yyval.n) = create_index_node((yyvsp[-3].sval), (yyvsp[-1].sval));
    }
+#line 1612 "y.tab.c"
     break;
 
-  case 35:
-
-/* Line 1806 of yacc.c  */
-#line 304 "parse.y"
-    {
-      (yyval.n) = drop_table_node((yyvsp[(3) - (3)].sval));
+  case 37: /* droptable: RW_DROP RW_TABLE T_STRING  */
+#line 327 "parse.y"
+   {
+      (yyval.n) = drop_table_node((yyvsp[0].sval));
    }
+#line 1620 "y.tab.c"
     break;
 
-  case 36:
-
-/* Line 1806 of yacc.c  */
-#line 311 "parse.y"
-    {
-      (yyval.n) = drop_index_node((yyvsp[(3) - (6)].sval), (yyvsp[(5) - (6)].sval));
+  case 38: /* dropindex: RW_DROP RW_INDEX T_STRING '(' T_STRING ')'  */
+#line 334 "parse.y"
+   {
+      (yyval.n) = drop_index_node((yyvsp[-3].sval), (yyvsp[-1].sval));
    }
+#line 1628 "y.tab.c"
     break;
 
-  case 37:
-
-/* Line 1806 of yacc.c  */
-#line 318 "parse.y"
-    {
-      (yyval.n) = load_node((yyvsp[(2) - (5)].sval), (yyvsp[(4) - (5)].sval));
+  case 39: /* load: RW_LOAD T_STRING '(' T_QSTRING ')'  */
+#line 341 "parse.y"
+   {
+      (yyval.n) = load_node((yyvsp[-3].sval), (yyvsp[-1].sval));
    }
+#line 1636 "y.tab.c"
     break;
 
-  case 38:
-
-/* Line 1806 of yacc.c  */
-#line 326 "parse.y"
-    {
-      (yyval.n) = set_node((yyvsp[(2) - (4)].sval), (yyvsp[(4) - (4)].sval));
+  case 40: /* set: RW_SET T_STRING T_EQ T_QSTRING  */
+#line 349 "parse.y"
+   {
+      (yyval.n) = set_node((yyvsp[-2].sval), (yyvsp[0].sval));
    }
+#line 1644 "y.tab.c"
     break;
 
-  case 39:
-
-/* Line 1806 of yacc.c  */
-#line 333 "parse.y"
-    {
-      (yyval.n) = help_node((yyvsp[(2) - (2)].sval));
+  case 41: /* help: RW_HELP opt_relname  */
+#line 356 "parse.y"
+   {
+      (yyval.n) = help_node((yyvsp[0].sval));
    }
+#line 1652 "y.tab.c"
     break;
 
-  case 40:
-
-/* Line 1806 of yacc.c  */
-#line 340 "parse.y"
-    {
-      (yyval.n) = print_node((yyvsp[(2) - (2)].sval));
+  case 42: /* print: RW_PRINT T_STRING  */
+#line 363 "parse.y"
+   {
+      (yyval.n) = print_node((yyvsp[0].sval));
    }
+#line 1660 "y.tab.c"
     break;
 
-  case 41:
-
-/* Line 1806 of yacc.c  */
-#line 347 "parse.y"
-    {
+  case 43: /* exit: RW_EXIT  */
+#line 370 "parse.y"
+   {
       (yyval.n) = NULL;
       bExit = 1;
    }
+#line 1669 "y.tab.c"
     break;
 
-  case 42:
-
-/* Line 1806 of yacc.c  */
-#line 355 "parse.y"
-    {
-      (yyval.n) = query_node((yyvsp[(2) - (5)].n), (yyvsp[(4) - (5)].n), (yyvsp[(5) - (5)].n));
+  case 44: /* query: RW_SELECT non_mt_select_clause RW_FROM non_mt_relation_list opt_where_clause  */
+#line 378 "parse.y"
+   {
+      (yyval.n) = query_node((yyvsp[-3].n), (yyvsp[-1].n), (yyvsp[0].n));
    }
+#line 1677 "y.tab.c"
     break;
 
-  case 43:
-
-/* Line 1806 of yacc.c  */
-#line 362 "parse.y"
-    {
-      (yyval.n) = insert_node((yyvsp[(3) - (7)].sval), (yyvsp[(6) - (7)].n));
+  case 45: /* insert: RW_INSERT RW_INTO T_STRING RW_VALUES '(' non_mt_value_list ')'  */
+#line 385 "parse.y"
+   {
+      (yyval.n) = insert_node((yyvsp[-4].sval), (yyvsp[-1].n));
    }
+#line 1685 "y.tab.c"
     break;
 
-  case 44:
-
-/* Line 1806 of yacc.c  */
-#line 369 "parse.y"
-    {
-      (yyval.n) = delete_node((yyvsp[(3) - (4)].sval), (yyvsp[(4) - (4)].n));
+  case 46: /* delete: RW_DELETE RW_FROM T_STRING opt_where_clause  */
+#line 392 "parse.y"
+   {
+      (yyval.n) = delete_node((yyvsp[-1].sval), (yyvsp[0].n));
    }
+#line 1693 "y.tab.c"
     break;
 
-  case 45:
-
-/* Line 1806 of yacc.c  */
-#line 376 "parse.y"
-    {
-      (yyval.n) = update_node((yyvsp[(2) - (7)].sval), (yyvsp[(4) - (7)].n), (yyvsp[(6) - (7)].n), (yyvsp[(7) - (7)].n));
+  case 47: /* update: RW_UPDATE T_STRING RW_SET relattr T_EQ relattr_or_value opt_where_clause  */
+#line 399 "parse.y"
+   {
+      (yyval.n) = update_node((yyvsp[-5].sval), (yyvsp[-3].n), (yyvsp[-1].n), (yyvsp[0].n));
    }
+#line 1701 "y.tab.c"
     break;
 
-  case 46:
-
-/* Line 1806 of yacc.c  */
-#line 383 "parse.y"
-    {
-      (yyval.n) = prepend((yyvsp[(1) - (3)].n), (yyvsp[(3) - (3)].n));
+  case 48: /* non_mt_attrtype_list: attrtype ',' non_mt_attrtype_list  */
+#line 406 "parse.y"
+   {
+      (yyval.n) = prepend((yyvsp[-2].n), (yyvsp[0].n));
    }
+#line 1709 "y.tab.c"
     break;
 
-  case 47:
-
-/* Line 1806 of yacc.c  */
-#line 387 "parse.y"
-    {
-      (yyval.n) = list_node((yyvsp[(1) - (1)].n));
+  case 49: /* non_mt_attrtype_list: attrtype  */
+#line 410 "parse.y"
+   {
+      (yyval.n) = list_node((yyvsp[0].n));
    }
+#line 1717 "y.tab.c"
     break;
 
-  case 48:
-
-/* Line 1806 of yacc.c  */
-#line 394 "parse.y"
+  case 50: /* attrtype: T_STRING T_STRING  */
+#line 417 "parse.y"
     {
-      (yyval.n) = attrtype_node((yyvsp[(1) - (2)].sval), (yyvsp[(2) - (2)].sval));
+      (yyval.n) = attrtype_node((yyvsp[-1].sval), (yyvsp[0].sval));
    }
+#line 1725 "y.tab.c"
     break;
 
-  case 50:
-
-/* Line 1806 of yacc.c  */
-#line 402 "parse.y"
-    {
+  case 52: /* non_mt_select_clause: '*'  */
+#line 425 "parse.y"
+   {
        (yyval.n) = list_node(relattr_node(NULL, (char*)"*"));
    }
+#line 1733 "y.tab.c"
     break;
 
-  case 51:
-
-/* Line 1806 of yacc.c  */
-#line 409 "parse.y"
-    {
-      (yyval.n) = prepend((yyvsp[(1) - (3)].n), (yyvsp[(3) - (3)].n));
+  case 53: /* non_mt_relattr_list: relattr ',' non_mt_relattr_list  */
+#line 432 "parse.y"
+   {
+      (yyval.n) = prepend((yyvsp[-2].n), (yyvsp[0].n));
    }
+#line 1741 "y.tab.c"
     break;
 
-  case 52:
-
-/* Line 1806 of yacc.c  */
-#line 413 "parse.y"
-    {
-      (yyval.n) = list_node((yyvsp[(1) - (1)].n));
+  case 54: /* non_mt_relattr_list: relattr  */
+#line 436 "parse.y"
+   {
+      (yyval.n) = list_node((yyvsp[0].n));
    }
+#line 1749 "y.tab.c"
     break;
 
-  case 53:
-
-/* Line 1806 of yacc.c  */
-#line 420 "parse.y"
-    {
-      (yyval.n) = relattr_node((yyvsp[(1) - (3)].sval), (yyvsp[(3) - (3)].sval));
+  case 55: /* relattr: T_STRING '.' T_STRING  */
+#line 443 "parse.y"
+   {
+      (yyval.n) = relattr_node((yyvsp[-2].sval), (yyvsp[0].sval));
    }
+#line 1757 "y.tab.c"
     break;
 
-  case 54:
-
-/* Line 1806 of yacc.c  */
-#line 424 "parse.y"
-    {
-      (yyval.n) = relattr_node(NULL, (yyvsp[(1) - (1)].sval));
+  case 56: /* relattr: T_STRING  */
+#line 447 "parse.y"
+   {
+      (yyval.n) = relattr_node(NULL, (yyvsp[0].sval));
    }
+#line 1765 "y.tab.c"
     break;
 
-  case 55:
-
-/* Line 1806 of yacc.c  */
-#line 431 "parse.y"
-    {
-      (yyval.n) = prepend((yyvsp[(1) - (3)].n), (yyvsp[(3) - (3)].n));
+  case 57: /* non_mt_relation_list: relation ',' non_mt_relation_list  */
+#line 454 "parse.y"
+   {
+      (yyval.n) = prepend((yyvsp[-2].n), (yyvsp[0].n));
    }
+#line 1773 "y.tab.c"
     break;
 
-  case 56:
-
-/* Line 1806 of yacc.c  */
-#line 435 "parse.y"
-    {
-      (yyval.n) = list_node((yyvsp[(1) - (1)].n));
+  case 58: /* non_mt_relation_list: relation  */
+#line 458 "parse.y"
+   {
+      (yyval.n) = list_node((yyvsp[0].n));
    }
+#line 1781 "y.tab.c"
     break;
 
-  case 57:
-
-/* Line 1806 of yacc.c  */
-#line 442 "parse.y"
-    {
-      (yyval.n) = relation_node((yyvsp[(1) - (1)].sval));
+  case 59: /* relation: T_STRING  */
+#line 465 "parse.y"
+   {
+      (yyval.n) = relation_node((yyvsp[0].sval));
    }
+#line 1789 "y.tab.c"
     break;
 
-  case 58:
-
-/* Line 1806 of yacc.c  */
-#line 449 "parse.y"
-    {
-      (yyval.n) = (yyvsp[(2) - (2)].n);
+  case 60: /* opt_where_clause: RW_WHERE non_mt_cond_list  */
+#line 472 "parse.y"
+   {
+      (yyval.n) = (yyvsp[0].n);
    }
+#line 1797 "y.tab.c"
     break;
 
-  case 59:
-
-/* Line 1806 of yacc.c  */
-#line 453 "parse.y"
-    {
+  case 61: /* opt_where_clause: nothing  */
+#line 476 "parse.y"
+   {
       (yyval.n) = NULL;
    }
+#line 1805 "y.tab.c"
     break;
 
-  case 60:
-
-/* Line 1806 of yacc.c  */
-#line 460 "parse.y"
-    {
-      (yyval.n) = prepend((yyvsp[(1) - (3)].n), (yyvsp[(3) - (3)].n));
+  case 62: /* non_mt_cond_list: condition RW_AND non_mt_cond_list  */
+#line 483 "parse.y"
+   {
+      (yyval.n) = prepend((yyvsp[-2].n), (yyvsp[0].n));
    }
+#line 1813 "y.tab.c"
     break;
 
-  case 61:
-
-/* Line 1806 of yacc.c  */
-#line 464 "parse.y"
-    {
-      (yyval.n) = list_node((yyvsp[(1) - (1)].n));
+  case 63: /* non_mt_cond_list: condition  */
+#line 487 "parse.y"
+   {
+      (yyval.n) = list_node((yyvsp[0].n));
    }
+#line 1821 "y.tab.c"
     break;
 
-  case 62:
-
-/* Line 1806 of yacc.c  */
-#line 471 "parse.y"
-    {
-      (yyval.n) = condition_node((yyvsp[(1) - (3)].n), (yyvsp[(2) - (3)].cval), (yyvsp[(3) - (3)].n));
+  case 64: /* condition: relattr op relattr_or_value  */
+#line 494 "parse.y"
+   {
+      (yyval.n) = condition_node((yyvsp[-2].n), (yyvsp[-1].cval), (yyvsp[0].n));
    }
+#line 1829 "y.tab.c"
     break;
 
-  case 63:
-
-/* Line 1806 of yacc.c  */
-#line 478 "parse.y"
-    {
-      (yyval.n) = relattr_or_value_node((yyvsp[(1) - (1)].n), NULL);
+  case 65: /* relattr_or_value: relattr  */
+#line 501 "parse.y"
+   {
+      (yyval.n) = relattr_or_value_node((yyvsp[0].n), NULL);
    }
+#line 1837 "y.tab.c"
     break;
 
-  case 64:
-
-/* Line 1806 of yacc.c  */
-#line 482 "parse.y"
-    {
-      (yyval.n) = relattr_or_value_node(NULL, (yyvsp[(1) - (1)].n));
+  case 66: /* relattr_or_value: value  */
+#line 505 "parse.y"
+   {
+      (yyval.n) = relattr_or_value_node(NULL, (yyvsp[0].n));
    }
+#line 1845 "y.tab.c"
     break;
 
-  case 65:
-
-/* Line 1806 of yacc.c  */
-#line 489 "parse.y"
-    {
-      (yyval.n) = prepend((yyvsp[(1) - (3)].n), (yyvsp[(3) - (3)].n));
+  case 67: /* non_mt_value_list: value ',' non_mt_value_list  */
+#line 512 "parse.y"
+   {
+      (yyval.n) = prepend((yyvsp[-2].n), (yyvsp[0].n));
    }
+#line 1853 "y.tab.c"
     break;
 
-  case 66:
-
-/* Line 1806 of yacc.c  */
-#line 493 "parse.y"
-    {
-      (yyval.n) = list_node((yyvsp[(1) - (1)].n));
+  case 68: /* non_mt_value_list: value  */
+#line 516 "parse.y"
+   {
+      (yyval.n) = list_node((yyvsp[0].n));
    }
+#line 1861 "y.tab.c"
     break;
 
-  case 67:
-
-/* Line 1806 of yacc.c  */
-#line 500 "parse.y"
-    {
-      (yyval.n) = value_node(STRING, (void *) (yyvsp[(1) - (1)].sval));
+  case 69: /* value: T_QSTRING  */
+#line 523 "parse.y"
+   {
+      (yyval.n) = value_node(STRING, (void *) (yyvsp[0].sval));
    }
+#line 1869 "y.tab.c"
     break;
 
-  case 68:
-
-/* Line 1806 of yacc.c  */
-#line 504 "parse.y"
-    {
-      (yyval.n) = value_node(INT, (void *)& (yyvsp[(1) - (1)].ival));
+  case 70: /* value: T_INT  */
+#line 527 "parse.y"
+   {
+      (yyval.n) = value_node(INT, (void *)& (yyvsp[0].ival));
    }
+#line 1877 "y.tab.c"
     break;
 
-  case 69:
-
-/* Line 1806 of yacc.c  */
-#line 508 "parse.y"
-    {
-      (yyval.n) = value_node(FLOAT, (void *)& (yyvsp[(1) - (1)].rval));
+  case 71: /* value: T_REAL  */
+#line 531 "parse.y"
+   {
+      (yyval.n) = value_node(FLOAT, (void *)& (yyvsp[0].rval));
    }
+#line 1885 "y.tab.c"
     break;
 
-  case 70:
-
-/* Line 1806 of yacc.c  */
-#line 515 "parse.y"
-    {
-      (yyval.sval) = (yyvsp[(1) - (1)].sval);
+  case 72: /* opt_relname: T_STRING  */
+#line 538 "parse.y"
+   {
+      (yyval.sval) = (yyvsp[0].sval);
    }
+#line 1893 "y.tab.c"
     break;
 
-  case 71:
-
-/* Line 1806 of yacc.c  */
-#line 519 "parse.y"
-    {
+  case 73: /* opt_relname: nothing  */
+#line 542 "parse.y"
+   {
       (yyval.sval) = NULL;
    }
+#line 1901 "y.tab.c"
     break;
 
-  case 72:
-
-/* Line 1806 of yacc.c  */
-#line 526 "parse.y"
-    {
+  case 74: /* op: T_LT  */
+#line 549 "parse.y"
+   {
       (yyval.cval) = LT_OP;
    }
+#line 1909 "y.tab.c"
     break;
 
-  case 73:
-
-/* Line 1806 of yacc.c  */
-#line 530 "parse.y"
-    {
+  case 75: /* op: T_LE  */
+#line 553 "parse.y"
+   {
       (yyval.cval) = LE_OP;
    }
+#line 1917 "y.tab.c"
     break;
 
-  case 74:
-
-/* Line 1806 of yacc.c  */
-#line 534 "parse.y"
-    {
+  case 76: /* op: T_GT  */
+#line 557 "parse.y"
+   {
       (yyval.cval) = GT_OP;
    }
+#line 1925 "y.tab.c"
     break;
 
-  case 75:
-
-/* Line 1806 of yacc.c  */
-#line 538 "parse.y"
-    {
+  case 77: /* op: T_GE  */
+#line 561 "parse.y"
+   {
       (yyval.cval) = GE_OP;
    }
+#line 1933 "y.tab.c"
     break;
 
-  case 76:
-
-/* Line 1806 of yacc.c  */
-#line 542 "parse.y"
-    {
+  case 78: /* op: T_EQ  */
+#line 565 "parse.y"
+   {
       (yyval.cval) = EQ_OP;
    }
+#line 1941 "y.tab.c"
     break;
 
-  case 77:
-
-/* Line 1806 of yacc.c  */
-#line 546 "parse.y"
-    {
+  case 79: /* op: T_NE  */
+#line 569 "parse.y"
+   {
       (yyval.cval) = NE_OP;
    }
+#line 1949 "y.tab.c"
     break;
 
 
+#line 1953 "y.tab.c"
 
-/* Line 1806 of yacc.c  */
-#line 2166 "y.tab.c"
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -2176,96 +1964,58 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
-  /* Now `shift' the result of the reduction.  Determine what state
+  /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
 
-/*------------------------------------.
-| yyerrlab -- here on detecting error |
-`------------------------------------*/
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
       yyerror (YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
-      {
-        char const *yymsgp = YY_("syntax error");
-        int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
-        if (yysyntax_error_status == 0)
-          yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
-          {
-            if (yymsg != yymsgbuf)
-              YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
-              {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
-              }
-            else
-              {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
-              }
-          }
-        yyerror (yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
-      }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
-
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
-	 error, discard it.  */
+         error, discard it.  */
 
       if (yychar <= YYEOF)
-	{
-	  /* Return failure if at end of input.  */
-	  if (yychar == YYEOF)
-	    YYABORT;
-	}
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
       else
-	{
-	  yydestruct ("Error: discarding",
-		      yytoken, &yylval);
-	  yychar = YYEMPTY;
-	}
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
     }
 
   /* Else will try to reuse lookahead token after shifting the error
@@ -2277,14 +2027,13 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
   yylen = 0;
@@ -2297,39 +2046,42 @@ yyerrorlab:
 | yyerrlab1 -- common code for both syntax error and YYERROR.  |
 `-------------------------------------------------------------*/
 yyerrlab1:
-  yyerrstatus = 3;	/* Each real token shifted decrements this.  */
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
-	{
-	  yyn += YYTERROR;
-	  if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
-	    {
-	      yyn = yytable[yyn];
-	      if (0 < yyn)
-		break;
-	    }
-	}
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
 
       /* Pop the current state because it cannot handle the error token.  */
       if (yyssp == yyss)
-	YYABORT;
+        YYABORT;
 
 
       yydestruct ("Error: popping",
-		  yystos[yystate], yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
     }
 
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2340,26 +2092,30 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
-#if !defined(yyoverflow) || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
 
-yyreturn:
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -2368,32 +2124,25 @@ yyreturn:
       yydestruct ("Cleanup: discarding lookahead",
                   yytoken, &yylval);
     }
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
   YYPOPSTACK (yylen);
   YY_STACK_PRINT (yyss, yyssp);
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-		  yystos[*yyssp], yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
-  /* Make sure YYID is used.  */
-  return YYID (yyresult);
-}
-
 
+  return yyresult;
+}
 
-/* Line 2067 of yacc.c  */
-#line 555 "parse.y"
+#line 578 "parse.y"
 
 
 //
@@ -2565,4 +2314,3 @@ int yywrap(void)
    return 1;
 }
 #endif
-
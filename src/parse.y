@@ -13,6 +13,8 @@
  * 1998: Added "reset buffer", "resize buffer [int]", "queryplans on",
  * and "queryplans off".
  * 2000: Added "const" to yyerror-header
+ * Added "print io buffer": the buffer use of each relation and index.
+ * Added "print buffer curve": the miss-ratio curve of the buffer pools.
  *
  */
 
@@ -107,6 +109,7 @@ QL_Manager *pQlm;          // QL component manager
       RW_IO
       RW_BUFFER
       RW_RESIZE
+      RW_CURVE
       RW_QUERY_PLAN
       RW_ON
       RW_OFF
@@ -254,6 +257,11 @@ buffer
       pPfm->PrintBuffer();
       $$ = NULL;
    }
+   | RW_PRINT RW_BUFFER RW_CURVE
+   {
+      pPfm->PrintCurve();
+      $$ = NULL;
+   }
    | RW_RESIZE RW_BUFFER T_INT
    {
       pPfm->ResizeBuffer($3);
@@ -273,11 +281,26 @@ statistics
       #endif
       $$ = NULL;
    }
+   | RW_PRINT RW_IO RW_BUFFER
+   {
+      #ifdef PF_STATS
+         RC rc;
+
+         cout << "Buffer use by relation and index\n";
+         cout << "--------------------------------\n";
+         if ((rc = pSmm->PrintIO(*pPfm)))
+            PrintError(rc);
+      #else
+         cout << "Statitisics not compiled.\n";
+      #endif
+      $$ = NULL;
+   }
    | RW_RESET RW_IO
    {
       #ifdef PF_STATS
          cout << "Statistics reset.\n";
          pStatisticsMgr->Reset();
+         pPfm->ResetFileStats();
       #else
          cout << "Statitisics not compiled.\n";
       #endif
@@ -12,10 +12,31 @@
 //       a particular file.  Allows students to use main memory chunks
 //       that are associated with (and limited by) the buffer.
 // 2005: Added GetLastPage and GetPrevPage for rocking
+// Pluggable page replacement policies, selectable per PF_Manager.
+// Page requests carry a ClientHint; scans recycle a small ring of pages.
+// Files are opened in buffered (pread/pwrite) or direct (O_DIRECT) mode.
+// Scans are read ahead; PrefetchPages lets clients ask for pages early.
+// Dirty pages are written back in file order, consecutive pages at once.
+// A background page cleaner writes dirty pages before they are replaced.
+// Files may be opened read-only with their pages mapped (PF_IO_MMAP).
+// The buffer may be shared by threads; LatchPage orders their accesses.
+// The file header maps the pages in use; scans skip free pages unread.
+// Files grow in preallocated extents, whose size is kept in the header.
+// Files may have pages of 8K to 64K; each page size has a buffer pool.
+// The pages of a file may be compressed on disk.
+// The buffer keeps statistics for each file (PF_FileStats).
+// Files may be bound by name to named buffer pools (PF_Pool).
+// The pages in the buffer may be saved to a manifest and read back on
+// the next run (SaveWarmSet, LoadWarmSet).
+// The buffer keeps a miss-ratio curve; pools may be sized by it.
+// Changes may be logged in a write-ahead log (OpenLog, LogPage); the log
+// is committed instead of forcing pages, and replayed by OpenLog.
+// Fuzzy checkpoints bound the log replayed; files are replayed in parallel.
 
 #ifndef PF_H
 #define PF_H
 
+#include <pthread.h>
 #include "redbase.h"
 
 //
@@ -32,6 +53,38 @@ typedef int PageNum;
 //
 const int PF_PAGE_SIZE = 4096 - sizeof(int);
 
+// A file may be created with larger pages instead: of 8K, 16K, 32K or
+// 64K, page header included.  PF_PageSize gives the data size of a page
+// of kBytes K.
+const int PF_PAGE_CLASSES = 5;                    // 4K, 8K, ..., 64K
+inline int PF_PageSize(int kBytes)
+{
+   return (kBytes * 1024 - (int)sizeof(int));
+}
+const int PF_MAX_PAGE_SIZE = 64 * 1024 - sizeof(int);
+
+//
+// PF_ReplacePolicy: page replacement policy of the buffer pool
+//
+enum PF_ReplacePolicy {
+   PF_REPLACE_LRU,                                // least recently used
+   PF_REPLACE_CLOCK,                              // second chance
+   PF_REPLACE_2Q,                                 // 2Q (A1in/A1out/Am)
+   PF_REPLACE_LRUK,                               // LRU-K
+   PF_REPLACE_ARC                                 // adaptive replacement
+};
+
+//
+// PF_IOMode: how the pages of a file are transferred
+//
+enum PF_IOMode {
+   PF_IO_BUFFERED,                                // through the OS cache
+   PF_IO_DIRECT,                                  // bypass the OS cache
+   PF_IO_MMAP                                     // read-only, the pages are
+                                                  //   used in place in a
+                                                  //   mapping of the file
+};
+
 //
 // PF_PageHandle: PF page interface
 //
@@ -57,15 +110,47 @@ private:
 //
 // PF_FileHdr: Header structure for files
 //
+// The rest of the header page is a map of the pages in use, so that
+// scans skip free pages without reading them.  It covers the first
+// mapPages pages of the file, which are allocated lowest first; free
+// pages after them are kept on the free list.  Files created without
+// the map have mapPages 0 and keep all of their free pages on the list.
+//
+// pageSize is the data size of the pages of the file (0 in files created
+// before page sizes could be chosen: PF_PAGE_SIZE).
+//
+// The pages of a file created with bCompress are compressed on disk
+// (see PF_CompressedIO), packed in groups, so that pages of any size take
+// the room of their compressed images.
+//
+// A file grows extentPages pages at a time: the space for them is
+// allocated on the disk at once, and new pages are handed out from it
+// until it is used up.  With extentPages 0 or 1 the file grows a page at
+// a time, when the page is first written.
+//
+const int PF_USED_MAP_SIZE = PF_PAGE_SIZE - 7 * sizeof(int);
+const int PF_MAP_PAGES = PF_USED_MAP_SIZE * 8;
+
+// Default extent: 1 MB
+const int PF_EXTENT_PAGES = 256;
+
 struct PF_FileHdr {
    int firstFree;     // first free page in the linked list
    int numPages;      // # of pages in the file
+   int pageSize;      // # of bytes of data in a page
+   int bCompressed;   // pages are compressed on disk
+   int extentPages;   // # of pages the file grows by
+   int allocPages;    // # of pages allocated on the disk so far
+   int mapPages;      // # of pages covered by usedMap
+   unsigned char usedMap[PF_USED_MAP_SIZE];   // bit set: page in use
 };
 
 //
 // PF_FileHandle: PF File interface
 //
 class PF_BufferMgr;
+class PF_LogMgr;
+struct PF_WarmSet;
 
 class PF_FileHandle {
    friend class PF_Manager;
@@ -79,27 +164,50 @@ public:
    // Overload =
    PF_FileHandle& operator=(const PF_FileHandle &fileHandle);
 
+   // The optional hint tells the buffer manager how the page is used
+
    // Get the first page
-   RC GetFirstPage(PF_PageHandle &pageHandle) const;
+   RC GetFirstPage(PF_PageHandle &pageHandle,
+                   ClientHint hint = NO_HINT) const;
    // Get the next page after current
-   RC GetNextPage (PageNum current, PF_PageHandle &pageHandle) const;
+   RC GetNextPage (PageNum current, PF_PageHandle &pageHandle,
+                   ClientHint hint = NO_HINT) const;
    // Get a specific page
-   RC GetThisPage (PageNum pageNum, PF_PageHandle &pageHandle) const;
+   RC GetThisPage (PageNum pageNum, PF_PageHandle &pageHandle,
+                   ClientHint hint = NO_HINT) const;
    // Get the last page
-   RC GetLastPage(PF_PageHandle &pageHandle) const;
+   RC GetLastPage(PF_PageHandle &pageHandle,
+                  ClientHint hint = NO_HINT) const;
    // Get the prev page after current
-   RC GetPrevPage (PageNum current, PF_PageHandle &pageHandle) const;
+   RC GetPrevPage (PageNum current, PF_PageHandle &pageHandle,
+                   ClientHint hint = NO_HINT) const;
+   // Start reading pages that will be needed soon; nothing is pinned
+   RC PrefetchPages(PageNum pageNum, int numPages = 1,
+                    ClientHint hint = NO_HINT) const;
 
    RC AllocatePage(PF_PageHandle &pageHandle);    // Allocate a new page
    RC DisposePage (PageNum pageNum);              // Dispose of a page
    RC MarkDirty   (PageNum pageNum) const;        // Mark page as dirty
+   // Mark a page dirty, and log that its length bytes of data at offset
+   // were changed.  Pages of logged files that are only marked dirty are
+   // logged whole, once per dirtying.
+   RC LogPage     (PageNum pageNum, int offset, int length) const;
    RC UnpinPage   (PageNum pageNum) const;        // Unpin the page
 
+   // Latch a pinned page shared (to read it) or exclusive (to change it)
+   // when several threads use it, and release the latch
+   RC LatchPage   (PageNum pageNum, int bExclusive = FALSE) const;
+   RC UnlatchPage (PageNum pageNum) const;
+
    // Flush pages from buffer pool.  Will write dirty pages to disk.
-   RC FlushPages  () const;
+   // With bSync, fdatasync the file afterwards.
+   RC FlushPages  (int bSync = FALSE) const;
 
    // Force a page or pages to disk (but do not remove from the buffer pool)
-   RC ForcePages  (PageNum pageNum=ALL_PAGES) const;
+   RC ForcePages  (PageNum pageNum=ALL_PAGES, int bSync = FALSE) const;
+
+   // # of bytes of data in a page of the file
+   RC GetPageSize (int &pageSize) const;
 
 private:
 
@@ -107,11 +215,61 @@ private:
    // otherwise
    int IsValidPageNum (PageNum pageNum) const;
 
+   // Used-page map of the header: mark a page, find the next page from
+   // pageNum on (step 1) or back (step -1) that is not known to be free,
+   // and find the lowest free page
+   void    SetUsed  (PageNum pageNum, int bUsed);
+   PageNum SkipFree (PageNum pageNum, int step) const;
+   PageNum FirstFree();
+   // Log the changes to the header made for pageNum
+   RC      LogHdr   (PageNum pageNum);
+
    PF_BufferMgr *pBufferMgr;                      // pointer to buffer manager
    PF_FileHdr hdr;                                // file header
    int bFileOpen;                                 // file open flag
    int bHdrChanged;                               // dirty flag for file hdr
+   int bReadOnly;                                 // opened with PF_IO_MMAP
+   PageNum firstClear;                            // no free page in the map
+                                                  //   before this one
    int unixfd;                                    // OS file descriptor
+   int fileNo;                                    // # of the file in the
+                                                  //   PF_Manager
+};
+
+//
+// PF_FileStats: what the buffer did for a file, from when it was first
+// opened on (or the counts were last reset).  The counts other than
+// residentPages are only kept with PF_STATS.
+//
+struct PF_FileStats {
+   char *fileName;      // as given to OpenFile
+   int  hits;           // pages asked for that were in the buffer
+   int  misses;         // pages asked for that had to be read
+   int  evictions;      // pages thrown out of the buffer to make room
+   int  writeBacks;     // dirty pages written to disk
+   int  residentPages;  // pages in the buffer now
+};
+
+//
+// PF_Pool: a named buffer pool, with a buffer manager for each page size
+// (created when first needed) of its own size and replacement policy.
+// The pool named PF_DEFAULT_POOL is always there; files go to it unless
+// they are bound to another (PF_Manager::BindFile).
+//
+const int PF_MAX_POOLS = 8;                       // most pools
+#define PF_DEFAULT_POOL    "default"
+
+struct PF_Pool {
+   char             name[MAXNAME + 1];            // "" if unused
+   PF_BufferMgr     *pBufferMgrs[PF_PAGE_CLASSES];// its buffer managers,
+                                                  //   by page size
+   PF_ReplacePolicy policy;                       // their settings
+   int              bufferPages;
+   int              tunePages;                    // most pages tuning may
+                                                  //   give it (0: no tuning)
+   int              bCurve;                       // its miss-ratio curve is
+                                                  //   kept (tuning keeps it
+                                                  //   too)
 };
 
 //
@@ -119,21 +277,99 @@ private:
 //
 class PF_Manager {
 public:
-   PF_Manager    ();                              // Constructor
+   PF_Manager    (PF_ReplacePolicy policy = PF_REPLACE_LRU); // Constructor
    ~PF_Manager   ();                              // Destructor
-   RC CreateFile    (const char *fileName);       // Create a new file
+   RC CreateFile    (const char *fileName,        // Create a new file
+                     int pageSize = PF_PAGE_SIZE, //   with pages of pageSize
+                     int extentPages = PF_EXTENT_PAGES,    // growing by
+                                                  //   extentPages pages
+                     int bCompress = FALSE);      //   compressed on disk
    RC DestroyFile   (const char *fileName);       // Delete a file
 
    // Open and close file methods
-   RC OpenFile      (const char *fileName, PF_FileHandle &fileHandle);
+   RC OpenFile      (const char *fileName, PF_FileHandle &fileHandle,
+                     PF_IOMode ioMode = PF_IO_BUFFERED);
    RC CloseFile     (PF_FileHandle &fileHandle);
 
    // Three methods that manipulate the buffer manager.  The calls are
-   // forwarded to the PF_BufferMgr instance and are called by parse.y
-   // when the user types in a system command.
+   // forwarded to the PF_BufferMgr instances and are called by parse.y
+   // when the user types in a system command.  The pools of larger pages
+   // hold about as many bytes as that of PF_PAGE_SIZE pages, whose size
+   // iNewSize is.
    RC ClearBuffer   ();
    RC PrintBuffer   ();
    RC ResizeBuffer  (int iNewSize);
+   // Display the miss-ratio curve of each pool: the hit ratio it would
+   // have had with other sizes
+   RC PrintCurve    ();
+
+   // Statistics of each file opened so far: pStats is a new array of
+   // numFiles (the caller deletes it), whose file names are those of the
+   // PF_Manager
+   RC GetFileStats  (PF_FileStats *&pStats, int &numFiles);
+   // Set the counts back to 0
+   void ResetFileStats();
+
+   // Change the page replacement policy of the buffer pool
+   RC SetReplacePolicy(PF_ReplacePolicy policy);
+   // Percentage of the buffer pools the page cleaner keeps clean
+   RC SetCleanTarget(int percent);
+
+   // The methods above work on the default pool (ClearBuffer, PrintBuffer
+   // and SetCleanTarget on all).  These ones work on named pools: set
+   // the size of poolName (creating the pool if there is none) or its
+   // policy, and bind the file fileName to it, or back to the default
+   // pool.  A file uses the pool it is bound to from when it is next
+   // opened.
+   RC SetPoolSize   (const char *poolName, int numPages);
+   RC SetPoolPolicy (const char *poolName, PF_ReplacePolicy policy);
+   RC BindFile      (const char *fileName, const char *poolName);
+   // Let the size of poolName follow its miss-ratio curve, up to
+   // maxPages pages (0: leave it as it is).  The pool is resized when
+   // files are opened and closed, once enough pages were asked for;
+   // other threads may go on using the pool meanwhile.
+   RC SetAutoTune   (const char *poolName, int maxPages);
+   // Keep the miss-ratio curve of poolName (bKeep), or stop.  It is not
+   // kept unless asked for, or the pool is tuned, as it costs every
+   // request; GetCurve and PrintCurve show what was kept.
+   RC SetCurve      (const char *poolName, int bKeep);
+   // Size of poolName, and the # of pages asked for of it since its
+   // curve was last reset (numRequests), of which it would have found
+   // hits in the buffer with numPages pages
+   RC GetPoolSize   (const char *poolName, int &numPages);
+   RC GetCurve      (const char *poolName, int numPages, int &hits,
+                     int &numRequests);
+
+   // Warm-up of the buffer across runs.  SaveWarmSet writes to the
+   // manifest manifestName which pages of each file were in the buffer
+   // when it was last closed; LoadWarmSet reads them back.  It has the OS
+   // read them ahead, and the pages of a file are brought back into the
+   // buffer when it is first opened.  As many pages of each pool are kept
+   // as it holds, the most recently used ones.  They are read in the
+   // background; WaitWarmUp waits until those of an open file are in.
+   RC SaveWarmSet   (const char *manifestName);
+   RC LoadWarmSet   (const char *manifestName);
+   RC WaitWarmUp    (const PF_FileHandle &fileHandle);
+
+   // Write-ahead log.  OpenLog brings the files changed in the log
+   // logName up to date (after a crash, the changes that had not been
+   // written are lost otherwise), then logs the changes to the files
+   // opened from then on.  It must be called before they are opened.
+   // Pages may then be written at any time, or not at all: Commit makes
+   // the changes logged so far durable, with one write of the log for
+   // all of the threads that commit at the same time.  CloseLog (once
+   // the files are closed) closes it; GetLogStats counts the records
+   // appended and the writes of the log.
+   RC OpenLog       (const char *logName);
+   RC CloseLog      ();
+   RC Commit        ();
+   RC GetLogStats   (int &numRecords, int &numWrites);
+   // Take a checkpoint, while the buffer is in use: write the pages that
+   // were dirty at the previous one, and log which ones are dirty now.
+   // Restart then only replays the log from the oldest change to a page
+   // still dirty.  One is taken by Commit and CloseFile once
+   // PF_CKPT_BYTES were logged since the last one.
+   RC Checkpoint    ();
 
    // Three Methods for manipulating raw memory buffers.  These memory
    // locations are handled by the buffer manager, but are not
@@ -155,7 +391,52 @@ public:
    RC DisposeBlock  (char *buffer);
 
 private:
-   PF_BufferMgr *pBufferMgr;                      // page-buffer manager
+   // Buffer manager of pool of pages of pageSize, created when first
+   // needed
+   PF_BufferMgr *BufferMgr(PF_Pool &pool, int pageSize);
+   // Pool named poolName, NULL if there is none
+   PF_Pool *Pool(const char *poolName);
+   // Pool fileName is bound to
+   PF_Pool &FilePool(const char *fileName);
+   // # of fileName in ppFileStats and pWarmSets, which are created when
+   // it is first opened
+   int FileNo(const char *fileName);
+   // Start bringing the pages of the warm set of an open file into the
+   // buffer, in a thread of its own (WarmUpPages); stop it, or wait for
+   // it to be done
+   void WarmUp(PF_FileHandle &fileHandle);
+   static void *WarmUpPages(void *pWarmUp);
+   void StopWarmUp(int fileNo, int bWait = FALSE);
+   // Resize the pools set to be tuned that have a better size; # of the
+   // pages asked for of a pool that a size would have found in it
+   void TunePools();
+   int PoolHits(PF_Pool &pool, int numPages);
+   // Log that fileName was created or destroyed (type), and wait for it
+   RC LogFile(int type, const char *fileName);
+   // Apply the changes in the log to the files, from its last checkpoint
+   // on; RedoFiles applies those of a PF_RedoQueue in a thread of its own
+   RC Redo(PF_LogMgr &log);
+   static void *RedoFiles(void *pQueue);
+   // Checkpoint, with ckptLatch held; AutoCheckpoint takes one if enough
+   // was logged since the last one and no other is being taken
+   RC TakeCheckpoint();
+   void AutoCheckpoint();
+
+   PF_Pool pools[PF_MAX_POOLS];                   // pools[0]: the default
+   int cleanTarget;                               // setting of all pools
+   char **ppBoundFiles;                           // files bound to pools
+   int *pBoundPools;                              //   other than the
+   int numBound;                                  //   default, and their
+   int maxBound;                                  //   pools
+   PF_FileStats **ppFileStats;                    // statistics of the files
+   int numFileStats;                              //   opened so far, which
+   int maxFileStats;                              //   stay where they are
+   PF_WarmSet *pWarmSets;                         // warm set of each file
+   int numCloses;                                 // files closed so far
+   int numOpen;                                   // files open now
+   PF_LogMgr *pLog;                               // write-ahead log, NULL
+                                                  //   if none is open
+   pthread_mutex_t ckptLatch;                     // one checkpoint at once
 };
 
 //
@@ -172,7 +453,16 @@ void PF_PrintError(RC rc);
 #define PF_PAGEUNPINNED    (START_PF_WARN + 6) // page already unpinned
 #define PF_EOF             (START_PF_WARN + 7) // end of file
 #define PF_TOOSMALL        (START_PF_WARN + 8) // Resize buffer too small
-#define PF_LASTWARN        PF_TOOSMALL
+#define PF_BADPOLICY       (START_PF_WARN + 9) // unknown replace policy
+#define PF_NODIRECTIO      (START_PF_WARN + 10) // no direct I/O for file
+#define PF_READONLY        (START_PF_WARN + 11) // file opened read-only
+#define PF_BADPAGESIZE     (START_PF_WARN + 12) // page size not supported
+#define PF_NOPOOL          (START_PF_WARN + 13) // no such buffer pool
+#define PF_TOOMANYPOOLS    (START_PF_WARN + 14) // no room for another pool
+#define PF_BADRANGE        (START_PF_WARN + 15) // bytes not within the page
+#define PF_NOLOG           (START_PF_WARN + 16) // no log is open
+#define PF_PAGELATCHED     (START_PF_WARN + 17) // page latched, no resize
+#define PF_LASTWARN        PF_PAGELATCHED
 
 #define PF_NOMEM           (START_PF_ERR - 0)  // no memory
 #define PF_NOBUF           (START_PF_ERR - 1)  // no buffer space
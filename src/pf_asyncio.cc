@@ -0,0 +1,179 @@
+//
+// File:        pf_asyncio.cc
+// Description: PF_AsyncIO class implementation
+//
+// A thread pool stands in for an asynchronous I/O interface; the
+// transfers themselves are plain PF_IO reads and writes.  A request is
+// forgotten as soon as its transfer is over, before the completion
+// function is called.
+//
+
+#include "pf_asyncio.h"
+
+//
+// PF_AsyncIO
+//
+// Desc: Constructor
+// In:   numThreads - # of I/O threads
+//       maxRequests - # of transfers that may be outstanding
+//       pDone, pArg - called as pDone(pArg, slot, bWrite, rc) when the
+//                     transfer for slot is over
+//
+PF_AsyncIO::PF_AsyncIO(int _numThreads, int _maxRequests,
+      PF_IODone _pDone, void *_pArg)
+{
+   numThreads = (_numThreads > 0) ? _numThreads : 1;
+   numStarted = 0;
+   threads = new pthread_t[numThreads];
+
+   maxRequests = (_maxRequests > 0) ? _maxRequests : 1;
+   requests = new Request[maxRequests];
+   for (int i = 0; i < maxRequests; i++)
+      requests[i].state = FREE;
+   numUsed = 0;
+   queueHead = queueTail = -1;
+   bStop = FALSE;
+   pDone = _pDone;
+   pArg = _pArg;
+
+   pthread_mutex_init(&mutex, NULL);
+   pthread_cond_init(&work, NULL);
+}
+
+//
+// ~PF_AsyncIO
+//
+// Desc: Destructor.  Lets the threads finish the queued transfers (their
+//       completion functions are called as usual), then stops them.
+//
+PF_AsyncIO::~PF_AsyncIO()
+{
+   pthread_mutex_lock(&mutex);
+   bStop = TRUE;
+   pthread_cond_broadcast(&work);
+   pthread_mutex_unlock(&mutex);
+
+   for (int i = 0; i < numStarted; i++)
+      pthread_join(threads[i], NULL);
+
+   pthread_cond_destroy(&work);
+   pthread_mutex_destroy(&mutex);
+   delete [] requests;
+   delete [] threads;
+}
+
+//
+// Submit
+//
+// Desc: Queue a transfer for an I/O thread
+// In:   slot - buffer slot the transfer is for (one transfer per slot)
+//       bWrite - TRUE to write buf, FALSE to read into it
+//       pIO, offset, buf, length - the transfer
+// Ret:  PF_NOBUF if the request table is full
+//
+RC PF_AsyncIO::Submit(int slot, int bWrite, PF_IO *pIO, off_t offset,
+      char *buf, int length)
+{
+   int i;
+
+   pthread_mutex_lock(&mutex);
+
+   for (i = 0; i < maxRequests && requests[i].state != FREE; i++)
+      ;
+   if (i == maxRequests) {
+      pthread_mutex_unlock(&mutex);
+      return (PF_NOBUF);
+   }
+
+   requests[i].state = QUEUED;
+   requests[i].slot = slot;
+   requests[i].bWrite = bWrite;
+   requests[i].pIO = pIO;
+   requests[i].offset = offset;
+   requests[i].buf = buf;
+   requests[i].length = length;
+   requests[i].next = -1;
+   if (queueTail == -1)
+      queueHead = i;
+   else
+      requests[queueTail].next = i;
+   queueTail = i;
+   numUsed++;
+
+   // Start another thread if all of them might be busy
+   if (numStarted < numThreads && numStarted < numUsed &&
+         pthread_create(&threads[numStarted], NULL, Worker, this) == 0)
+      numStarted++;
+
+   pthread_cond_signal(&work);
+   pthread_mutex_unlock(&mutex);
+
+   // Return ok
+   return (0);
+}
+
+//
+// Full
+//
+// Desc: TRUE if maxRequests transfers are going on
+//
+int PF_AsyncIO::Full()
+{
+   pthread_mutex_lock(&mutex);
+   int bFull = (numUsed == maxRequests);
+   pthread_mutex_unlock(&mutex);
+   return (bFull);
+}
+
+//
+// Worker
+//
+// Desc: Internal.  Body of the I/O threads.
+//
+void *PF_AsyncIO::Worker(void *pAsyncIO)
+{
+   ((PF_AsyncIO *)pAsyncIO)->Run();
+   return (NULL);
+}
+
+void PF_AsyncIO::Run()
+{
+   pthread_mutex_lock(&mutex);
+
+   for (;;) {
+      while (queueHead == -1 && !bStop)
+         pthread_cond_wait(&work, &mutex);
+      if (queueHead == -1)
+         break;
+
+      // Take the oldest queued request
+      int i = queueHead;
+      queueHead = requests[i].next;
+      if (queueHead == -1)
+         queueTail = -1;
+      requests[i].state = RUNNING;
+      Request req = requests[i];
+
+      // Do the transfer without holding the mutex
+      pthread_mutex_unlock(&mutex);
+      RC rc;
+      if (req.bWrite)
+         rc = req.pIO->Write(req.offset, req.buf, req.length,
+               PF_INCOMPLETEWRITE);
+      else
+         rc = req.pIO->Read(req.offset, req.buf, req.length,
+               PF_INCOMPLETEREAD);
+      pthread_mutex_lock(&mutex);
+
+      requests[i].state = FREE;
+      numUsed--;
+
+      // Report the transfer, again without the mutex: the completion
+      // function takes the buffer manager's latches
+      pthread_mutex_unlock(&mutex);
+      pDone(pArg, req.slot, req.bWrite, rc);
+      pthread_mutex_lock(&mutex);
+   }
+
+   pthread_mutex_unlock(&mutex);
+}
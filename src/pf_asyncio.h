@@ -0,0 +1,77 @@
+//
+// File:        pf_asyncio.h
+// Description: PF_AsyncIO - asynchronous page transfers for PF_BufferMgr
+//
+// A PF_AsyncIO is a small pool of threads doing page reads and writes in
+// the background.  The buffer manager has two: one reads pages ahead of
+// scans, the other (the page cleaner) writes dirty pages before they are
+// replaced.  The buffer manager marks the frame of the page as being read
+// or written and hands the transfer over.  When a transfer is over, the
+// thread that did it calls the completion function given to the
+// constructor, which settles the frame under the buffer manager's own
+// latches.  The threads never touch anything else of the buffer manager.
+//
+// The threads are started by the first Submit.
+//
+
+#ifndef PF_ASYNCIO_H
+#define PF_ASYNCIO_H
+
+#include <pthread.h>
+#include "pf_internal.h"
+#include "pf_io.h"
+
+//
+// PF_IODone - completion function: the transfer for slot is over with
+// result rc.  Called by the I/O thread, without any lock of PF_AsyncIO.
+//
+typedef void (*PF_IODone)(void *pArg, int slot, int bWrite, RC rc);
+
+class PF_AsyncIO {
+public:
+    PF_AsyncIO     (int numThreads, int maxRequests,
+                    PF_IODone pDone, void *pArg);
+    ~PF_AsyncIO    ();                      // Waits for all transfers
+
+    // Queue a read (or, if bWrite, a write) of length bytes at offset
+    // into (from) buf for buffer slot.
+    // Ret: PF_NOBUF if maxRequests transfers are outstanding already
+    RC   Submit    (int slot, int bWrite, PF_IO *pIO, off_t offset,
+                    char *buf, int length);
+
+    // TRUE if a Submit would fail for lack of room right now
+    int  Full      ();
+
+private:
+    enum { FREE, QUEUED, RUNNING };
+
+    struct Request {
+        int    state;
+        int    slot;
+        int    bWrite;
+        PF_IO  *pIO;
+        off_t  offset;
+        char   *buf;
+        int    length;
+        int    next;             // next queued request
+    };
+
+    static void *Worker (void *pAsyncIO);
+    void Run           ();
+
+    int             numThreads;
+    int             numStarted;            // threads started so far
+    pthread_t       *threads;
+    int             maxRequests;
+    Request         *requests;
+    int             numUsed;               // requests not FREE
+    int             queueHead;             // oldest QUEUED request
+    int             queueTail;             // newest QUEUED request
+    int             bStop;                 // threads must exit
+    PF_IODone       pDone;                 // completion function
+    void            *pArg;                 //   and its argument
+    pthread_mutex_t mutex;
+    pthread_cond_t  work;                  // a request was queued
+};
+
+#endif
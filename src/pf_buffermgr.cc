@@ -13,15 +13,160 @@
 //       pf_test2.cc for a demo.
 // 1998: The statistics manager is now instantiated in this file and is
 //       created and destroyed by the buffer manager.
+//       The replacement policy is now pluggable (see pf_replacement.h).
+//       The buffer manager only keeps a free list; the order in which
+//       resident pages are replaced belongs to the PF_Replacer.
+//       GetPage takes a ClientHint.  Pages read by scans go into a small
+//       ring of buffer pages that the scans recycle, so that a scan of a
+//       large file does not push everything else out of the buffer.
+//       The buffer pages are no longer allocated one by one: they are
+//       frames of a single anonymous mapping, backed by huge pages when
+//       the system allows it.
+//       Scans are read ahead: the reads are done by a PF_AsyncIO while
+//       the client works on the pages it already has.
+//       FlushPages and ForcePages sort the dirty pages of the file and
+//       write runs of consecutive pages with one call, optionally followed
+//       by an fdatasync.
+//       A page cleaner (another PF_AsyncIO) writes the dirty pages at the
+//       replacement end of the buffer whenever a page is replaced, so that
+//       the victims are mostly clean by the time they are chosen.
+//       The buffer is split into shards with a latch each, and pages are
+//       read and written outside of the latches, so that several threads
+//       may use the buffer at once.
+//       Files opened with PF_IO_MMAP are read in place in a mapping of
+//       the file: their pages only have their pins counted.
+//       The page size is a constructor argument.  There is a buffer
+//       manager for each page size, and they share the statistics manager.
+//       The pages of a compressed file are compressed and decompressed by
+//       its I/O backend (see PF_CompressedIO), out of sight of the buffer.
+//       Statistics are counted by number (StatisticsMgr::Add), and reads,
+//       writes and evictions are timed.
+//       Hits, misses, evictions and writes are also counted in the
+//       PF_FileStats of their file.
+//       ResizeBuffer keeps the pages that fit in the new buffer, throwing
+//       out the coldest ones only.
+//       ResidentPages lists the pages of a file in replacement order, so
+//       that PF_Manager can remember them for the next run.
+//       Each shard puts its page requests down in a miss-ratio curve
+//       (PF_MissCurve), which predicts the hits at other buffer sizes.
+//       With a write-ahead log (PF_LogMgr), the LSNs of the changes to a
+//       page are kept with it, and the log is flushed up to its last one
+//       before the page is written.  Pages changed without a log record
+//       are logged whole once they are changed: when their last pin is
+//       released, at a commit, or before they are written while pinned.
+//       Checkpoints go through the buffer a shard at a time: the dirty
+//       pages are listed, and those dirty since before the previous
+//       checkpoint written.
 //
 
 #include <cstdio>
+#include <cstring>
 #include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
 #include <iostream>
 #include "pf_buffermgr.h"
+#include "pf_replacement.h"
+#include "pf_io.h"
+#include "pf_asyncio.h"
+#include "pf_misscurve.h"
+#include "pf_logmgr.h"
 
 using namespace std;
 
+//
+// PF_MapArena
+//
+// Desc: Map an anonymous, zero filled arena of at least size bytes.
+//       With -DPF_HUGETLB explicit huge pages (MAP_HUGETLB) are tried
+//       first; they must have been reserved by the administrator.
+//       Otherwise transparent huge pages are requested for big arenas.
+// In:   size - bytes needed
+// Out:  arena - base and size of the mapping
+// Ret:  PF_NOMEM
+//
+static RC PF_MapArena(size_t size, PF_Arena &arena)
+{
+   void *base;
+
+   arena.numUsed = 0;
+   arena.next = NULL;
+
+#if defined(PF_HUGETLB) && defined(MAP_HUGETLB)
+   arena.size = (size + PF_HUGE_PAGE_SIZE - 1) / PF_HUGE_PAGE_SIZE *
+      PF_HUGE_PAGE_SIZE;
+   base = mmap(NULL, arena.size, PROT_READ | PROT_WRITE,
+         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+   if (base != MAP_FAILED) {
+      arena.base = (char *)base;
+      return (0);
+   }
+#endif
+
+   size_t sysPage = (size_t)getpagesize();
+   arena.size = (size + sysPage - 1) / sysPage * sysPage;
+   base = mmap(NULL, arena.size, PROT_READ | PROT_WRITE,
+         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   if (base == MAP_FAILED)
+      return (PF_NOMEM);
+   arena.base = (char *)base;
+
+#ifdef MADV_HUGEPAGE
+   // Only a hint: failure just means small pages
+   if (arena.size >= (size_t)PF_HUGE_PAGE_SIZE)
+      madvise(arena.base, arena.size, MADV_HUGEPAGE);
+#endif
+
+   return (0);
+}
+
+//
+// PF_ResidentEntry - a page of a file lined up by its shard, sorted by how
+// far into the line of its shard it is
+//
+struct PF_ResidentEntry {
+   PageNum pageNum;
+   int     rank;                  // place in the line of its shard, from 1
+   int     numRanked;             // # of pages in that line
+};
+
+static int PF_CompareResidentEntry(const void *p1, const void *p2)
+{
+   const PF_ResidentEntry *e1 = (const PF_ResidentEntry *)p1;
+   const PF_ResidentEntry *e2 = (const PF_ResidentEntry *)p2;
+   long long f1 = (long long)e1->rank * e2->numRanked;
+   long long f2 = (long long)e2->rank * e1->numRanked;
+   return ((f1 > f2) - (f1 < f2));
+}
+
+//
+// PF_WriteEntry - a dirty page to write back, sorted by page number
+//
+struct PF_WriteEntry {
+   PageNum pageNum;
+   int     slot;
+};
+
+static int PF_CompareWriteEntry(const void *p1, const void *p2)
+{
+   PageNum n1 = ((const PF_WriteEntry *)p1)->pageNum;
+   PageNum n2 = ((const PF_WriteEntry *)p2)->pageNum;
+   return ((n1 > n2) - (n1 < n2));
+}
+
+//
+// PF_UnmapArena
+//
+// Desc: Give an arena back to the system
+//
+static void PF_UnmapArena(PF_Arena &arena)
+{
+   if (arena.base != NULL)
+      munmap(arena.base, arena.size);
+   arena.base = NULL;
+}
+
 // The switch PF_STATS indicates that the user wishes to have statistics
 // tracked for the PF layer
 #ifdef PF_STATS
@@ -29,6 +174,9 @@ using namespace std;
 
 // Global variable for the statistics manager
 StatisticsMgr *pStatisticsMgr;
+
+// # of buffer managers sharing it
+static int numStatisticsUsers;
 #endif
 
 #ifdef PF_LOG
@@ -76,6 +224,48 @@ void WriteLog(const char *psMessage)
 #endif
 
 
+//
+// PF_ShardIndex
+//
+// Desc: Shard of page (fd, pageNum) among numShards shards.  Consecutive
+//       pages of a file go to consecutive shards.
+//
+static int PF_ShardIndex(int fd, PageNum pageNum, int numShards)
+{
+   unsigned int h = (unsigned int)fd * 2654435761u + (unsigned int)pageNum;
+   return ((int)(h % (unsigned int)numShards));
+}
+
+//
+// PF_NumShards
+//
+// Desc: # of shards for a buffer of numPages pages
+// In:   setting - # of shards asked for, 0 to go by the size of the
+//                 buffer: one shard per PF_SHARD_PAGES pages, at most
+//                 PF_MAX_SHARDS
+//
+static int PF_NumShards(int numPages, int setting)
+{
+   int n = (setting > 0) ? setting : numPages / PF_SHARD_PAGES;
+
+   if (setting <= 0 && n > PF_MAX_SHARDS)
+      n = PF_MAX_SHARDS;
+   if (n > numPages)
+      n = numPages;
+   return ((n < 1) ? 1 : n);
+}
+
+//
+// PF_ShardLatch - holds the latch of a shard for as long as it is in scope
+//
+class PF_ShardLatch {
+public:
+   PF_ShardLatch(PF_BufShard &_sh) : sh(_sh) { pthread_mutex_lock(&sh.latch); }
+   ~PF_ShardLatch() { pthread_mutex_unlock(&sh.latch); }
+private:
+   PF_BufShard &sh;
+};
+
 //
 // PF_BufferMgr
 //
@@ -84,53 +274,94 @@ void WriteLog(const char *psMessage)
 //       it checks if it is in the buffer.  If so, it pins the page (pages
 //       can be pinned multiple times).  If not, it reads it from the file
 //       and pins it.  If the buffer is full and a new page needs to be
-//       inserted, an unpinned page is replaced according to an LRU
+//       inserted, an unpinned page is replaced according to the
+//       replacement policy (LRU unless told otherwise)
 // In:   numPages - the number of pages in the buffer
+//       policy - the page replacement policy
+//       numShards - # of independently latched parts of the buffer; 0 to
+//                   choose by the size of the buffer (see PF_NumShards)
+//       _pageSize - # of bytes of data of the pages of the buffer
 //
-// Note: The constructor will initialize the global pStatisticsMgr.  We
-//       make it global so that other components may use it and to allow
-//       easy access.
+// Note: The first constructor will initialize the global pStatisticsMgr.
+//       We make it global so that other components may use it and to
+//       allow easy access.  The buffer managers of all page sizes share it.
 //
 // Aut2003
 // numPages changed to _numPages for to eliminate CC warnings
 
-PF_BufferMgr::PF_BufferMgr(int _numPages) : hashTable(PF_HASH_TBL_SIZE)
+PF_BufferMgr::PF_BufferMgr(int _numPages, PF_ReplacePolicy _policy,
+      int _numShards, int _pageSize)
 {
    // Initialize local variables
    this->numPages = _numPages;
-   pageSize = PF_PAGE_SIZE + sizeof(PF_PageHdr);
+   pageSize = _pageSize + sizeof(PF_PageHdr);
 
 #ifdef PF_STATS
    // Initialize the global variable for the statistics manager
-   pStatisticsMgr = new StatisticsMgr();
+   if (numStatisticsUsers++ == 0)
+      pStatisticsMgr = new StatisticsMgr();
 #endif
 
 #ifdef PF_LOG
    char psMessage[100];
    sprintf (psMessage, "Creating buffer manager. %d pages of size %d.\n",
-         numPages, PF_PAGE_SIZE+sizeof(PF_PageHdr));
+         numPages, pageSize);
    WriteLog(psMessage);
 #endif
 
-   // Allocate memory for buffer page description table
+   // Allocate memory for buffer page description table and page latches
    bufTable = new PF_BufPageDesc[numPages];
-
-   // Initialize the buffer table and allocate memory for buffer pages.
-   // Initially, the free list contains all pages
+   latches = new pthread_rwlock_t[numPages];
+   for (int i = 0; i < numPages; i++)
+      pthread_rwlock_init(&latches[i], NULL);
+
+   // No file is attached yet
+   for (int i = 0; i < PF_FILE_CHUNKS; i++)
+      fileChunks[i] = NULL;
+   pthread_mutex_init(&filesLatch, NULL);
+   pLog = NULL;
+
+   // Map the memory for all the buffer pages at once (already zeroed)
+   frameSize = (pageSize + PF_FRAME_ALIGN - 1) / PF_FRAME_ALIGN *
+      PF_FRAME_ALIGN;
+   pRetired = NULL;
+   pthread_mutex_init(&retiredLatch, NULL);
+   if (PF_MapArena((size_t)numPages * frameSize, arena)) {
+      cerr << "Not enough memory for buffer\n";
+      exit(1);
+   }
    for (int i = 0; i < numPages; i++) {
-      if ((bufTable[i].pData = new char[pageSize]) == NULL) {
-         cerr << "Not enough memory for buffer\n";
-         exit(1);
-      }
-
-      memset ((void *)bufTable[i].pData, 0, pageSize);
+      bufTable[i].pData = arena.base + (size_t)i * frameSize;
+      bufTable[i].bValid = FALSE;
+   }
 
-      bufTable[i].prev = i - 1;
-      bufTable[i].next = i + 1;
+   // Fall back to LRU for an unknown policy
+   PF_Replacer *pReplacer = PF_NewReplacer(_policy, 1);
+   if (pReplacer == NULL)
+      _policy = PF_REPLACE_LRU;
+   delete pReplacer;
+   policy = _policy;
+
+   // Split the buffer into shards.  Initially, the free lists contain all
+   // pages.
+   // The number of shards is kept when the buffer is resized, so that
+   // a page stays in its shard.
+   bCurve = FALSE;
+   numShards = PF_NumShards(numPages, _numShards);
+   shards = new PF_BufShard[numShards];
+   for (int i = 0; i < numShards; i++) {
+      pthread_mutex_init(&shards[i].latch, NULL);
+      pthread_cond_init(&shards[i].ioDone, NULL);
    }
-   bufTable[0].prev = bufTable[numPages - 1].next = INVALID_SLOT;
-   free = 0;
-   first = last = INVALID_SLOT;
+   InitShards(shards, bufTable, numPages);
+   nextBlockShard = 0;
+
+   // The read-ahead and cleaner threads are only started when first
+   // needed
+   pReader = new PF_AsyncIO(PF_PREFETCH_THREADS, 2 * PF_READAHEAD_PAGES,
+         IODone, this);
+   pCleaner = new PF_AsyncIO(1, PF_CLEANER_QUEUE, IODone, this);
+   cleanTarget = PF_CLEAN_TARGET;
 
 #ifdef PF_LOG
    WriteLog("Succesfully created the buffer manager.\n");
@@ -144,15 +375,52 @@ PF_BufferMgr::PF_BufferMgr(int _numPages) : hashTable(PF_HASH_TBL_SIZE)
 //
 PF_BufferMgr::~PF_BufferMgr()
 {
+   // Wait for the transfers going on from and into the buffer pages
+   // (they are settled in the shards, so these go first)
+   delete pReader;
+   delete pCleaner;
+
+   FreeShards(shards);
+   for (int i = 0; i < numShards; i++) {
+      pthread_cond_destroy(&shards[i].ioDone);
+      pthread_mutex_destroy(&shards[i].latch);
+   }
+   delete [] shards;
+
    // Free up buffer pages and tables
-   for (int i = 0; i < this->numPages; i++)
-      delete [] bufTable[i].pData;
+   PF_UnmapArena(arena);
+   while (pRetired != NULL) {
+      PF_Arena *pNext = pRetired->next;
+      PF_UnmapArena(*pRetired);
+      delete pRetired;
+      pRetired = pNext;
+   }
+   pthread_mutex_destroy(&retiredLatch);
 
+   for (int i = 0; i < numPages; i++)
+      pthread_rwlock_destroy(&latches[i]);
+   delete [] latches;
    delete [] bufTable;
 
+   for (int i = 0; i < PF_FILE_CHUNKS; i++) {
+      if (fileChunks[i] == NULL)
+         continue;
+      for (int j = 0; j < PF_FILE_CHUNK; j++) {
+         delete fileChunks[i][j].pIO;
+         delete [] fileChunks[i][j].mapPins;
+         delete fileChunks[i][j].pHdr;
+         pthread_mutex_destroy(&fileChunks[i][j].latch);
+      }
+      delete [] fileChunks[i];
+   }
+   pthread_mutex_destroy(&filesLatch);
+
 #ifdef PF_STATS
-   // Destroy the global statistics manager
-   delete pStatisticsMgr;
+   // Destroy the global statistics manager with the last buffer manager
+   if (--numStatisticsUsers == 0) {
+      delete pStatisticsMgr;
+      pStatisticsMgr = NULL;
+   }
 #endif
 
 #ifdef PF_LOG
@@ -160,6 +428,190 @@ PF_BufferMgr::~PF_BufferMgr()
 #endif
 }
 
+//
+// InitShards
+//
+// Desc: Internal.  Split a buffer table of numPages slots into numShards
+//       shards of (about) the same size.  All their slots are free.  The
+//       latches of the shards are left alone: they live as long as the
+//       buffer manager.
+// In:   pShards - the numShards shards
+//       pTable - the buffer table
+//       _numPages - # of slots of pTable
+//
+void PF_BufferMgr::InitShards(PF_BufShard *pShards, PF_BufPageDesc *pTable,
+      int _numPages)
+{
+   int first = 0;
+
+   for (int i = 0; i < numShards; i++) {
+      PF_BufShard &sh = pShards[i];
+
+      sh.numPages = _numPages / numShards + (i < _numPages % numShards);
+      sh.first = first;
+      sh.bufTable = pTable + first;
+      first += sh.numPages;
+
+      for (int slot = 0; slot < sh.numPages; slot++)
+         sh.bufTable[slot].next = slot + 1;
+      sh.bufTable[sh.numPages - 1].next = INVALID_SLOT;
+      sh.free = 0;
+
+      sh.pHashTable = new PF_HashTable(sh.numPages);
+      sh.pReplacer = PF_NewReplacer(policy, sh.numPages);
+
+      // The scan ring starts out empty.  The shards share PF_RING_SIZE
+      // entries according to their size.
+      for (int j = 0; j < PF_RING_SIZE; j++)
+         sh.ring[j] = INVALID_SLOT;
+      sh.ringSize = PF_RING_SIZE * sh.numPages / _numPages;
+      if (sh.ringSize < 1)
+         sh.ringSize = 1;
+      sh.ringPos = 0;
+
+      sh.numIO = 0;
+      sh.numWriting = 0;
+      sh.numWaiting = 0;
+      sh.numLatched = 0;
+      sh.cleanSlots = new int[sh.numPages];
+      sh.pCurve = bCurve ? new PF_MissCurve(sh.numPages) : NULL;
+   }
+}
+
+//
+// FreeShards
+//
+// Desc: Internal.  Take down what InitShards built (not the pages in the
+//       shards, nor their latches)
+// In:   pShards - the numShards shards
+//
+void PF_BufferMgr::FreeShards(PF_BufShard *pShards)
+{
+   for (int i = 0; i < numShards; i++) {
+      delete [] pShards[i].cleanSlots;
+      delete pShards[i].pCurve;
+      delete pShards[i].pReplacer;
+      delete pShards[i].pHashTable;
+   }
+}
+
+//
+// PF_MoveShard
+//
+// Desc: Hand what InitShards built for shard from over to shard sh,
+//       whose latch and ioDone stay as they are
+//
+static void PF_MoveShard(PF_BufShard &sh, const PF_BufShard &from)
+{
+   sh.bufTable = from.bufTable;
+   sh.first = from.first;
+   sh.numPages = from.numPages;
+   sh.free = from.free;
+   sh.pHashTable = from.pHashTable;
+   sh.pReplacer = from.pReplacer;
+   memcpy(sh.ring, from.ring, sizeof(sh.ring));
+   sh.ringSize = from.ringSize;
+   sh.ringPos = from.ringPos;
+   sh.numIO = from.numIO;
+   sh.numWriting = from.numWriting;
+   sh.numWaiting = from.numWaiting;
+   sh.numLatched = from.numLatched;
+   sh.cleanSlots = from.cleanSlots;
+   sh.pCurve = from.pCurve;
+}
+
+//
+// Shard, SlotShard
+//
+// Desc: Internal.  The shard of a page and the shard of a buffer slot.
+//       Blocks (MEMORY_FD) are in the shard of the slot they were
+//       allocated in.
+//
+PF_BufShard &PF_BufferMgr::Shard(int fd, PageNum pageNum) const
+{
+   if (numShards == 1)
+      return (shards[0]);
+   if (fd == MEMORY_FD)
+      return (SlotShard(pageNum));
+   return (shards[PF_ShardIndex(fd, pageNum, numShards)]);
+}
+
+PF_BufShard &PF_BufferMgr::SlotShard(int slot) const
+{
+   int i;
+   for (i = numShards - 1; i > 0 && slot < shards[i].first; i--)
+      ;
+   return (shards[i]);
+}
+
+//
+// LatchAll, UnlatchAll
+//
+// Desc: Internal.  Latch every shard, in order, for the calls that work
+//       on the whole buffer.  LatchAll only returns once no page is read
+//       or written and no thread waits in a shard (see WaitShard): if a
+//       shard has transfers going on, it lets go of the shards latched so
+//       far, waits for them and starts over.  Threads that were woken up
+//       but have not got their latch back yet are let through first.
+//
+void PF_BufferMgr::LatchAll()
+{
+   for (;;) {
+      int i;
+      for (i = 0; i < numShards; i++) {
+         pthread_mutex_lock(&shards[i].latch);
+         if (shards[i].numIO > 0 || shards[i].numWaiting > 0)
+            break;
+      }
+      if (i == numShards)
+         return;
+
+      // Wait for the transfers of shard i holding no other latch: they
+      // are settled under the latch of that shard alone
+      int bIO = (shards[i].numIO > 0);
+      for (int j = 0; j < i; j++)
+         pthread_mutex_unlock(&shards[j].latch);
+      if (bIO)
+         WaitIO(shards[i]);
+      pthread_mutex_unlock(&shards[i].latch);
+      if (!bIO)
+         sched_yield();
+   }
+}
+
+void PF_BufferMgr::UnlatchAll()
+{
+   for (int i = numShards - 1; i >= 0; i--)
+      pthread_mutex_unlock(&shards[i].latch);
+}
+
+//
+// WaitIO
+//
+// Desc: Internal.  Wait until no page of the shard is being read or
+//       written.  The latch of the shard is let go while waiting.
+//
+void PF_BufferMgr::WaitIO(PF_BufShard &sh)
+{
+   while (sh.numIO > 0)
+      pthread_cond_wait(&sh.ioDone, &sh.latch);
+}
+
+//
+// WaitShard
+//
+// Desc: Internal.  Wait for a transfer of the shard to be over, in the
+//       middle of a request.  The latch of the shard is let go while
+//       waiting, but the buffer is not resized meanwhile (LatchAll waits
+//       for the thread): the slots it has found stay where they are.
+//
+void PF_BufferMgr::WaitShard(PF_BufShard &sh)
+{
+   sh.numWaiting++;
+   pthread_cond_wait(&sh.ioDone, &sh.latch);
+   sh.numWaiting--;
+}
+
 //
 // GetPage
 //
@@ -172,11 +624,26 @@ PF_BufferMgr::~PF_BufferMgr()
 //       pageNum - number of the page to read
 //       bMultiplePins - if FALSE, it is an error to ask for a page that is
 //                       already pinned in the buffer.
+//       hint - how the client uses the page:
+//              SEQUENTIAL - a page read from disk goes into the scan ring,
+//                           re-reading a ring page is not a reference
+//              ONE_SHOT   - as SEQUENTIAL, and a page already in the
+//                           buffer is not referenced either
+//              KEEP_HOT   - a page read from disk counts as referenced
+//                           twice, so that it starts out as a hot page
+//              NO_HINT, RANDOM - plain reference
+//       If the page is being read (ahead, or for another thread) or
+//       written by the cleaner, wait for the transfer.  The first request
+//       for a page that was read ahead is not a reference: the page was
+//       handed to the replacement policy when it was read.
+//       The page is read without holding the latch of its shard.
+//       The pages of a file opened with PF_IO_MMAP are not read: they are
+//       pinned where they are in the mapping.
 // Out:  ppBuffer - set *ppBuffer to point to the page in the buffer
 // Ret:  PF return code
 //
 RC PF_BufferMgr::GetPage(int fd, PageNum pageNum, char **ppBuffer,
-      int bMultiplePins)
+      int bMultiplePins, ClientHint hint)
 {
    RC  rc;     // return code
    int slot;   // buffer slot where page is located
@@ -189,63 +656,144 @@ RC PF_BufferMgr::GetPage(int fd, PageNum pageNum, char **ppBuffer,
 
 
 #ifdef PF_STATS
-   pStatisticsMgr->Register(PF_GETPAGE, STAT_ADDONE);
+   pStatisticsMgr->Add(PF_STAT_GETPAGE);
 #endif
 
-   // Search for page in buffer
-   if ((rc = hashTable.Find(fd, pageNum, slot)) &&
-         (rc != PF_HASHNOTFOUND))
-      return (rc);                // unexpected error
-
-   // If page not in buffer...
-   if (rc == PF_HASHNOTFOUND) {
-
+   // The pages of a mapped file are used where they are.  (Mapped pages
+   // may always be pinned again: bMultiplePins is only FALSE for changes
+   // to the file, which are not allowed.)
+   if (MapPin(fd, pageNum, 1, ppBuffer, rc)) {
 #ifdef PF_STATS
-   pStatisticsMgr->Register(PF_PAGENOTFOUND, STAT_ADDONE);
+      if (!rc) {
+         pStatisticsMgr->Add(PF_STAT_PAGEFOUND);
+         CountFile(fd, &PF_FileStats::hits);
+      }
 #endif
+      return (rc);
+   }
+
+   PF_BufShard &sh = Shard(fd, pageNum);
+   PF_ShardLatch latch(sh);
+   PF_BufPageDesc *bufTable = sh.bufTable;
+
+   for (;;) {
+      // Search for page in buffer
+      if ((rc = sh.pHashTable->Find(fd, pageNum, slot)) &&
+            (rc != PF_HASHNOTFOUND))
+         return (rc);             // unexpected error
+
+      // Wait for a transfer of the page and look again: a read that
+      // failed leaves no page behind
+      if (rc == 0 && (bufTable[slot].bReading || bufTable[slot].bWriting)) {
+         WaitShard(sh);
+         continue;
+      }
+      if (rc == 0)
+         break;
+
+      // Count the miss before a page is thrown out for it
+      if (sh.pCurve != NULL)
+         sh.pCurve->Miss(fd, pageNum);
 
-      // Allocate an empty page, this will also promote the newly allocated
-      // page to the MRU slot
-      if ((rc = InternalAlloc(slot)))
+      // Allocate an empty page, scans take one from the ring
+      if (hint == SEQUENTIAL || hint == ONE_SHOT)
+         rc = RingAlloc(sh, slot, fd, pageNum);
+      else
+         rc = InternalAlloc(sh, slot, fd, pageNum);
+      if (rc)
          return (rc);
 
-      // read the page, insert it into the hash table,
-      // and initialize the page description entry
-      if ((rc = ReadPage(fd, pageNum, bufTable[slot].pData)) ||
-            (rc = hashTable.Insert(fd, pageNum, slot)) ||
-            (rc = InitPageDesc(fd, pageNum, slot))) {
+      // Another thread may have read the page while the latch was let go
+      // to wait for a slot
+      int other;
+      if (sh.pHashTable->Find(fd, pageNum, other) == 0) {
+         InsertFree(sh, slot);
+         continue;
+      }
+
+#ifdef PF_STATS
+      pStatisticsMgr->Add(PF_STAT_PAGENOTFOUND);
+      CountFile(fd, &PF_FileStats::misses);
+#endif
+
+      // Insert the page into the hash table, initialize the page
+      // description entry and hand the page over to the replacement policy
+      if ((rc = sh.pHashTable->Insert(fd, pageNum, slot)) ||
+            (rc = InitPageDesc(sh, fd, pageNum, slot))) {
 
          // Put the slot back on the free list before returning the error
-         Unlink(slot);
-         InsertFree(slot);
+         InsertFree(sh, slot);
+         return (rc);
+      }
+      bufTable[slot].bRing = (hint == SEQUENTIAL || hint == ONE_SHOT);
+      sh.pReplacer->Admit(slot, fd, pageNum);
+      if (hint == KEEP_HOT)
+         sh.pReplacer->Access(slot);
+
+      // Read the page.  Meanwhile, whoever asks for it waits.
+      bufTable[slot].bReading = TRUE;
+      sh.numIO++;
+      pthread_mutex_unlock(&sh.latch);
+      rc = ReadPage(fd, pageNum, bufTable[slot].pData);
+      pthread_mutex_lock(&sh.latch);
+      bufTable[slot].bReading = FALSE;
+      sh.numIO--;
+      pthread_cond_broadcast(&sh.ioDone);
+
+      if (rc) {
+         sh.pHashTable->Delete(fd, pageNum);
+         sh.pReplacer->Remove(slot);
+         InsertFree(sh, slot);
          return (rc);
       }
+
 #ifdef PF_LOG
    WriteLog("Page not found in buffer. Loaded.\n");
 #endif
+
+      // Point ppBuffer to page
+      *ppBuffer = bufTable[slot].pData;
+      return (0);
    }
-   else {   // Page is in the buffer...
+
+   // Page is in the buffer...
 
 #ifdef PF_STATS
-   pStatisticsMgr->Register(PF_PAGEFOUND, STAT_ADDONE);
+   pStatisticsMgr->Add(PF_STAT_PAGEFOUND);
+   CountFile(fd, &PF_FileStats::hits);
 #endif
 
-      // Error if we don't want to get a pinned page
-      if (!bMultiplePins && bufTable[slot].pinCount > 0)
-         return (PF_PAGEPINNED);
+   // Error if we don't want to get a pinned page
+   if (!bMultiplePins && bufTable[slot].pinCount > 0)
+      return (PF_PAGEPINNED);
 
-      // Page is alredy in memory, just increment pin count
-      bufTable[slot].pinCount++;
+   // Page is alredy in memory, just increment pin count
+   bufTable[slot].pinCount++;
 #ifdef PF_LOG
-      sprintf (psMessage, "Page found in buffer.  %d pin count.\n",
-            bufTable[slot].pinCount);
-      WriteLog(psMessage);
+   sprintf (psMessage, "Page found in buffer.  %d pin count.\n",
+         bufTable[slot].pinCount);
+   WriteLog(psMessage);
 #endif
 
-      // Make this page the most recently used page
-      if ((rc = Unlink(slot)) ||
-            (rc = LinkHead (slot)))
-         return (rc);
+   // Tell the replacement policy about the reference, unless it is
+   // a scan coming back to a page of the ring or a one shot access.
+   // Any other access takes the page out of the ring.
+   if (bufTable[slot].bPrefetched) {
+      // First request for a page read ahead: it is in the same place
+      // as a page just read from disk
+      bufTable[slot].bPrefetched = FALSE;
+      if (hint != SEQUENTIAL && hint != ONE_SHOT)
+         bufTable[slot].bRing = FALSE;
+      if (hint == KEEP_HOT)
+         sh.pReplacer->Access(slot);
+   }
+   else if (hint == ONE_SHOT ||
+         (hint == SEQUENTIAL && bufTable[slot].bRing))
+      CountHit(sh, slot);
+   else {
+      bufTable[slot].bRing = FALSE;
+      sh.pReplacer->Access(slot);
+      CountHit(sh, slot);
    }
 
    // Point ppBuffer to page
@@ -255,6 +803,169 @@ RC PF_BufferMgr::GetPage(int fd, PageNum pageNum, char **ppBuffer,
    return (0);
 }
 
+//
+// Prefetch
+//
+// Desc: Start reading a page into the buffer and return at once.  The
+//       page takes a slot (of the scan ring for SEQUENTIAL and ONE_SHOT)
+//       but is not pinned; GetPage waits for the read if it has to.
+//       Nothing is done if the page is in the buffer already.  For a
+//       mapped file, the OS is asked to read the page in.
+// In:   fd - OS file descriptor of the file to read
+//       pageNum - number of the page to read
+//       hint - how the client will use the page, see GetPage
+// Ret:  PF_NOBUF if no slot is free for the page, or too many reads are
+//       going on; other PF return code
+//
+RC PF_BufferMgr::Prefetch(int fd, PageNum pageNum, ClientHint hint)
+{
+   RC  rc;     // return code
+   int slot;   // buffer slot for the page
+   PF_IO *pIO;
+
+   if ((pIO = FileIO(fd)) == NULL)
+      return (PF_CLOSEDFILE);
+
+   // For a mapped file, let the OS know the page is wanted
+   if (pIO->Mode() == PF_IO_MMAP) {
+      char *pPage = pIO->Map(pageNum * (off_t)pageSize + PF_FILE_HDR_SIZE,
+            pageSize);
+      if (pPage == NULL)
+         return (PF_INVALIDPAGE);
+      long osPageSize = sysconf(_SC_PAGESIZE);
+      char *pStart = pPage - (size_t)pPage % osPageSize;
+      madvise(pStart, pPage + pageSize - pStart, MADV_WILLNEED);
+      return (0);
+   }
+
+   PF_BufShard &sh = Shard(fd, pageNum);
+   PF_ShardLatch latch(sh);
+   PF_BufPageDesc *bufTable = sh.bufTable;
+
+   // Nothing to do if the page is in the buffer
+   if ((rc = sh.pHashTable->Find(fd, pageNum, slot)) != PF_HASHNOTFOUND)
+      return (rc);
+
+   // Do not take a slot for a read that cannot be started
+   if (pReader->Full())
+      return (PF_NOBUF);
+   if (sh.pCurve != NULL)
+      sh.pCurve->Miss(fd, pageNum);
+
+   // Allocate an empty page, scans take one from the ring
+   if (hint == SEQUENTIAL || hint == ONE_SHOT)
+      rc = RingAlloc(sh, slot, fd, pageNum);
+   else
+      rc = InternalAlloc(sh, slot, fd, pageNum);
+   if (rc)
+      return (rc);
+
+   // Another thread may have got the page meanwhile
+   int other;
+   if (sh.pHashTable->Find(fd, pageNum, other) == 0) {
+      InsertFree(sh, slot);
+      return (0);
+   }
+
+   // Insert the page into the hash table and describe it as unpinned
+   // and being read
+   if ((rc = sh.pHashTable->Insert(fd, pageNum, slot)) ||
+         (rc = InitPageDesc(sh, fd, pageNum, slot))) {
+      InsertFree(sh, slot);
+      return (rc);
+   }
+   bufTable[slot].pinCount = 0;
+   bufTable[slot].bReading = TRUE;
+   bufTable[slot].bPrefetched = TRUE;
+   bufTable[slot].bRing = (hint == SEQUENTIAL || hint == ONE_SHOT);
+
+   // Start the read.  It is settled (IODone) under the latch we hold.
+   off_t offset = pageNum * (off_t)pageSize + PF_FILE_HDR_SIZE;
+   if ((rc = pReader->Submit(sh.first + slot, FALSE, pIO, offset,
+         bufTable[slot].pData, pageSize))) {
+      sh.pHashTable->Delete(fd, pageNum);
+      InsertFree(sh, slot);
+      return (rc);
+   }
+   sh.numIO++;
+
+#ifdef PF_STATS
+   pStatisticsMgr->Add(PF_STAT_READPAGE);
+   pStatisticsMgr->Add(PF_STAT_PREFETCHPAGE);
+#endif
+
+   // Hand the new page over to the replacement policy
+   sh.pReplacer->Admit(slot, fd, pageNum);
+
+   // Return ok
+   return (0);
+}
+
+//
+// ReadAhead
+//
+// Desc: Called by a scan about to get pageNum.  The scan's direction is
+//       the direction of the last steps it took (+1 or -1 page).  Pages
+//       up to PF_READAHEAD_PAGES in front of pageNum are prefetched.
+//       Scans with the SEQUENTIAL or ONE_SHOT hint are read ahead from
+//       their first sequential step on (an index scan hopping between
+//       leaves is not), other scans after PF_READAHEAD_TRIGGER steps;
+//       RANDOM and KEEP_HOT pages never are.  Read-ahead is advisory:
+//       when it cannot be done, the scan simply reads its pages itself.
+//       (Several threads scanning the same file at once confuse each
+//       other's runs: they then read ahead less, if at all.)
+// In:   fd - OS file descriptor of the file scanned
+//       pageNum - page the scan is at
+//       numFilePages - # of pages in the file
+//       hint - client hint of the scan
+//
+void PF_BufferMgr::ReadAhead(int fd, PageNum pageNum, PageNum numFilePages,
+      ClientHint hint)
+{
+   PageNum p, end;
+   int dir;
+
+   // (The OS reads mapped files ahead by itself)
+   PF_BufFile *pFile = File(fd);
+   if (pFile == NULL || pFile->mapPins != NULL)
+      return;
+   PF_BufFile &file = *pFile;
+   pthread_mutex_lock(&file.latch);
+
+   // Follow the run of sequential steps
+   if (pageNum == file.lastPage + 1)
+      file.run = (file.run > 0) ? file.run + 1 : 1;
+   else if (pageNum == file.lastPage - 1)
+      file.run = (file.run < 0) ? file.run - 1 : -1;
+   else if (pageNum != file.lastPage) {
+      file.run = 0;
+      file.raEnd = pageNum;
+   }
+   file.lastPage = pageNum;
+   dir = (file.run < 0) ? -1 : 1;
+
+   if (hint == RANDOM || hint == KEEP_HOT || file.run == 0 ||
+         (hint == NO_HINT && file.run * dir < PF_READAHEAD_TRIGGER)) {
+      pthread_mutex_unlock(&file.latch);
+      return;
+   }
+
+   // Pick up where the last read-ahead of this run stopped
+   p = pageNum + dir;
+   if ((file.raEnd - p) * dir > 0)
+      p = file.raEnd;
+   end = pageNum + dir * (PF_READAHEAD_PAGES + 1);
+   pthread_mutex_unlock(&file.latch);
+
+   for (; p != end && p >= 0 && p < numFilePages; p += dir)
+      if (Prefetch(fd, p, hint))
+         break;
+
+   pthread_mutex_lock(&file.latch);
+   file.raEnd = p;
+   pthread_mutex_unlock(&file.latch);
+}
+
 //
 // AllocatePage
 //
@@ -275,33 +986,49 @@ RC PF_BufferMgr::AllocatePage(int fd, PageNum pageNum, char **ppBuffer)
    WriteLog(psMessage);
 #endif
 
+   // Mapped files cannot grow
+   if (MapPin(fd, pageNum, 0, NULL, rc))
+      return (PF_READONLY);
+
+   PF_BufShard &sh = Shard(fd, pageNum);
+   PF_ShardLatch latch(sh);
+
    // If page is already in buffer, return an error
-   if (!(rc = hashTable.Find(fd, pageNum, slot)))
+   if (!(rc = sh.pHashTable->Find(fd, pageNum, slot)))
       return (PF_PAGEINBUF);
    else if (rc != PF_HASHNOTFOUND)
       return (rc);              // unexpected error
 
    // Allocate an empty page
-   if ((rc = InternalAlloc(slot)))
+   if ((rc = InternalAlloc(sh, slot, fd, pageNum)))
       return (rc);
 
+   // The page may have come in while the latch was let go
+   int other;
+   if (sh.pHashTable->Find(fd, pageNum, other) == 0) {
+      InsertFree(sh, slot);
+      return (PF_PAGEINBUF);
+   }
+
    // Insert the page into the hash table,
    // and initialize the page description entry
-   if ((rc = hashTable.Insert(fd, pageNum, slot)) ||
-         (rc = InitPageDesc(fd, pageNum, slot))) {
+   if ((rc = sh.pHashTable->Insert(fd, pageNum, slot)) ||
+         (rc = InitPageDesc(sh, fd, pageNum, slot))) {
 
       // Put the slot back on the free list before returning the error
-      Unlink(slot);
-      InsertFree(slot);
+      InsertFree(sh, slot);
       return (rc);
    }
 
+   // Hand the new page over to the replacement policy
+   sh.pReplacer->Admit(slot, fd, pageNum);
+
 #ifdef PF_LOG
    WriteLog("Succesfully allocated page.\n");
 #endif
 
    // Point ppBuffer to page
-   *ppBuffer = bufTable[slot].pData;
+   *ppBuffer = sh.bufTable[slot].pData;
 
    // Return ok
    return (0);
@@ -312,6 +1039,9 @@ RC PF_BufferMgr::AllocatePage(int fd, PageNum pageNum, char **ppBuffer)
 //
 // Desc: Mark a page dirty so that when it is discarded from the buffer
 //       it will be written back to the file.
+//       If the file is logged, the change has no log record (see
+//       LogChange): the whole page is logged once, when its last pin is
+//       released (see LogImage).
 // In:   fd - OS file descriptor of the file associated with the page
 //       pageNum - number of the page to mark dirty
 // Ret:  PF return code
@@ -327,23 +1057,29 @@ RC PF_BufferMgr::MarkDirty(int fd, PageNum pageNum)
    WriteLog(psMessage);
 #endif
 
+   // Mapped files cannot be changed
+   if (MapPin(fd, pageNum, 0, NULL, rc))
+      return (rc ? rc : PF_READONLY);
+
+   PF_BufShard &sh = Shard(fd, pageNum);
+   PF_ShardLatch latch(sh);
+
    // The page must be found and pinned in the buffer
-   if ((rc = hashTable.Find(fd, pageNum, slot)))
+   if ((rc = sh.pHashTable->Find(fd, pageNum, slot))) {
       if ((rc == PF_HASHNOTFOUND))
          return (PF_PAGENOTINBUF);
       else
          return (rc);              // unexpected error
+   }
 
-   if (bufTable[slot].pinCount == 0)
+   if (sh.bufTable[slot].pinCount == 0)
       return (PF_PAGEUNPINNED);
 
-   // Mark this page dirty
-   bufTable[slot].bDirty = TRUE;
-
-   // Make this page the most recently used page
-   if ((rc = Unlink(slot)) ||
-         (rc = LinkHead (slot)))
-      return (rc);
+   // Mark this page dirty.  This is not a reference as far as the
+   // replacement policy is concerned: the page is pinned anyway.
+   sh.bufTable[slot].bDirty = TRUE;
+   if (pLog != NULL && LogNo(fd) >= 0)
+      sh.bufTable[slot].bUnlogged = TRUE;
 
    // Return ok
    return (0);
@@ -362,34 +1098,139 @@ RC PF_BufferMgr::UnpinPage(int fd, PageNum pageNum)
    RC  rc;       // return code
    int slot;     // buffer slot where page is located
 
+   if (MapPin(fd, pageNum, -1, NULL, rc))
+      return (rc);
+
+   PF_BufShard &sh = Shard(fd, pageNum);
+   PF_ShardLatch latch(sh);
+
    // The page must be found and pinned in the buffer
-   if ((rc = hashTable.Find(fd, pageNum, slot)))
+   if ((rc = sh.pHashTable->Find(fd, pageNum, slot))) {
       if ((rc == PF_HASHNOTFOUND))
          return (PF_PAGENOTINBUF);
       else
          return (rc);              // unexpected error
+   }
+
+   return (UnpinSlot(sh, slot));
+}
+
+//
+// UnpinSlot
+//
+// Desc: Internal.  Unpin the page of a slot of a shard (latched)
+// In:   sh - the shard
+//       slot - slot of the page in the shard
+// Ret:  PF_PAGEUNPINNED, or error logging the page
+//
+RC PF_BufferMgr::UnpinSlot(PF_BufShard &sh, int slot)
+{
+   RC  rc;       // return code
+   PF_BufPageDesc *bufTable = sh.bufTable;
 
    if (bufTable[slot].pinCount == 0)
       return (PF_PAGEUNPINNED);
 
+   // Log the page if it was changed without a log record, once all of
+   // its changes are made
+   if (bufTable[slot].pinCount == 1 && (rc = LogImage(bufTable[slot])))
+      return (rc);
+
 #ifdef PF_LOG
    char psMessage[100];
    sprintf (psMessage, "Unpinning (%d,%d). %d Pin count\n",
-         fd, pageNum, bufTable[slot].pinCount-1);
+         bufTable[slot].fd, bufTable[slot].pageNum,
+         bufTable[slot].pinCount-1);
    WriteLog(psMessage);
 #endif
 
-   // If unpinning the last pin, make it the most recently used page
-   if (--(bufTable[slot].pinCount) == 0) {
-      if ((rc = Unlink(slot)) ||
-            (rc = LinkHead (slot)))
-         return (rc);
-   }
+   // If unpinning the last pin, let the replacement policy know that
+   // the page may now be replaced
+   // (pages of the scan ring do not count as used again)
+   if (--(bufTable[slot].pinCount) == 0 && !bufTable[slot].bRing)
+      sh.pReplacer->Unpin(slot);
 
    // Return ok
    return (0);
 }
 
+//
+// LatchPage
+//
+// Desc: Latch a page pinned in the buffer, shared or exclusive, for the
+//       threads that share it.  Waits until the latch is granted.  The
+//       buffer manager itself never takes these latches: they only order
+//       the clients' accesses to the contents of the page.  The buffer
+//       is not resized while a page is latched (or waited for).
+// In:   fd - OS file descriptor of the file associated with the page
+//       pageNum - number of the page
+//       bExclusive - TRUE to write the page, FALSE to read it
+// Ret:  PF_PAGENOTINBUF, PF_PAGEUNPINNED, PF_UNIX
+//
+RC PF_BufferMgr::LatchPage(int fd, PageNum pageNum, int bExclusive)
+{
+   RC  rc;       // return code
+   int slot;     // buffer slot where page is located
+
+   // Nobody changes the pages of a mapped file
+   if (MapPin(fd, pageNum, 0, NULL, rc))
+      return (rc);
+
+   PF_BufShard &sh = Shard(fd, pageNum);
+   pthread_mutex_lock(&sh.latch);
+   if ((rc = sh.pHashTable->Find(fd, pageNum, slot)) == 0) {
+      if (sh.bufTable[slot].pinCount == 0)
+         rc = PF_PAGEUNPINNED;
+      else
+         sh.numLatched++;
+      slot += sh.first;
+   }
+   pthread_mutex_unlock(&sh.latch);
+   if (rc)
+      return ((rc == PF_HASHNOTFOUND) ? PF_PAGENOTINBUF : rc);
+
+   // The page is pinned, and the buffer is not resized while it is
+   // latched (numLatched): it keeps its slot while we wait
+   if (bExclusive)
+      rc = pthread_rwlock_wrlock(&latches[slot]);
+   else
+      rc = pthread_rwlock_rdlock(&latches[slot]);
+   if (rc) {
+      pthread_mutex_lock(&sh.latch);
+      sh.numLatched--;
+      pthread_mutex_unlock(&sh.latch);
+      return (PF_UNIX);
+   }
+   return (0);
+}
+
+//
+// UnlatchPage
+//
+// Desc: Release the latch taken by LatchPage
+// In:   fd - OS file descriptor of the file associated with the page
+//       pageNum - number of the page
+// Ret:  PF_PAGENOTINBUF, PF_UNIX
+//
+RC PF_BufferMgr::UnlatchPage(int fd, PageNum pageNum)
+{
+   RC  rc;       // return code
+   int slot;     // buffer slot where page is located
+
+   if (MapPin(fd, pageNum, 0, NULL, rc))
+      return (rc);
+
+   PF_BufShard &sh = Shard(fd, pageNum);
+   PF_ShardLatch latch(sh);
+   if ((rc = sh.pHashTable->Find(fd, pageNum, slot)))
+      return ((rc == PF_HASHNOTFOUND) ? PF_PAGENOTINBUF : rc);
+
+   if (pthread_rwlock_unlock(&latches[sh.first + slot]))
+      return (PF_UNIX);
+   sh.numLatched--;
+   return (0);
+}
+
 //
 // FlushPages
 //
@@ -397,10 +1238,13 @@ RC PF_BufferMgr::UnpinPage(int fd, PageNum pageNum)
 //       Returns a warning if any of the file's pages are pinned.
 //       A linear search of the buffer is performed.
 //       A better method is not needed because # of buffers are small.
+//       The dirty pages are written first, in file order (see
+//       WriteDirty).
 // In:   fd - file descriptor
+//       bSync - fdatasync the file once the pages are written
 // Ret:  PF_PAGEPINNED or other PF return code
 //
-RC PF_BufferMgr::FlushPages(int fd)
+RC PF_BufferMgr::FlushPages(int fd, int bSync)
 {
    RC rc, rcWarn = 0;  // return codes
 
@@ -411,48 +1255,67 @@ RC PF_BufferMgr::FlushPages(int fd)
 #endif
 
 #ifdef PF_STATS
-   pStatisticsMgr->Register(PF_FLUSHPAGES, STAT_ADDONE);
+   pStatisticsMgr->Add(PF_STAT_FLUSHPAGES);
 #endif
 
+   // Mapped files have no pages in the buffer
+   if (MapPin(fd, ALL_PAGES, 0, NULL, rc))
+      return (rc);
+
+   // Let the read-aheads and the cleaner writes finish
+   LatchAll();
+
+   // Write the dirty pages that are not pinned
+   if ((rc = WriteDirty(fd, ALL_PAGES, FALSE))) {
+      UnlatchAll();
+      return (rc);
+   }
+
    // Do a linear scan of the buffer to find pages belonging to the file
-   int slot = first;
-   while (slot != INVALID_SLOT) {
+   for (int i = 0; i < numShards && !rc; i++) {
+      PF_BufShard &sh = shards[i];
+      PF_BufPageDesc *bufTable = sh.bufTable;
+      int bPinned = FALSE;
 
-      int next = bufTable[slot].next;
+      for (int slot = 0; slot < sh.numPages; slot++) {
 
-      // If the page belongs to the passed-in file descriptor
-      if (bufTable[slot].fd == fd) {
+         // If the page belongs to the passed-in file descriptor
+         if (bufTable[slot].bValid && bufTable[slot].fd == fd) {
 
 #ifdef PF_LOG
  sprintf (psMessage, "Page (%d) is in buffer manager.\n", bufTable[slot].pageNum);
  WriteLog(psMessage);
 #endif
-         // Ensure the page is not pinned
-         if (bufTable[slot].pinCount) {
-            rcWarn = PF_PAGEPINNED;
-         }
-         else {
-            // Write the page if dirty
-            if (bufTable[slot].bDirty) {
-#ifdef PF_LOG
- sprintf (psMessage, "Page (%d) is dirty\n",bufTable[slot].pageNum);
- WriteLog(psMessage);
-#endif
-               if ((rc = WritePage(fd, bufTable[slot].pageNum, bufTable[slot].pData)))
-                  return (rc);
-               bufTable[slot].bDirty = FALSE;
+            // Ensure the page is not pinned
+            if (bufTable[slot].pinCount) {
+               bPinned = TRUE;
+            }
+            else {
+               // Remove page from the hash table and add the slot to the
+               // free list
+               if ((rc = sh.pHashTable->Delete(fd, bufTable[slot].pageNum)))
+                  break;
+               sh.pReplacer->Remove(slot);
+               if ((rc = InsertFree(sh, slot)))
+                  break;
             }
-
-            // Remove page from the hash table and add the slot to the free list
-            if ((rc = hashTable.Delete(fd, bufTable[slot].pageNum)) ||
-                  (rc = Unlink(slot)) ||
-                  (rc = InsertFree(slot)))
-               return (rc);
          }
       }
-      slot = next;
+
+      // The descriptor may be reused by another file: drop any history
+      if (bPinned)
+         rcWarn = PF_PAGEPINNED;
+      else {
+         sh.pReplacer->Forget(fd);
+         if (sh.pCurve != NULL)
+            sh.pCurve->Forget(fd);
+      }
    }
 
+   UnlatchAll();
+   if (rc || (bSync && (rc = SyncFile(fd))))
+      return (rc);
+
 #ifdef PF_LOG
    WriteLog("All necessary pages flushed.\n");
 #endif
@@ -468,10 +1331,11 @@ RC PF_BufferMgr::FlushPages(int fd)
 //       onto disk.  The page will not be forced out of the buffer pool.
 // In:   The page number, a default value of ALL_PAGES will be used if
 //       the client doesn't provide a value.  This will force all pages.
+//       bSync - fdatasync the file once the pages are written
 // Ret:  Standard PF errors
 //
 //
-RC PF_BufferMgr::ForcePages(int fd, PageNum pageNum)
+RC PF_BufferMgr::ForcePages(int fd, PageNum pageNum, int bSync)
 {
    RC rc;  // return codes
 
@@ -481,34 +1345,26 @@ RC PF_BufferMgr::ForcePages(int fd, PageNum pageNum)
    WriteLog(psMessage);
 #endif
 
-   // Do a linear scan of the buffer to find the page for the file
-   int slot = first;
-   while (slot != INVALID_SLOT) {
-
-      int next = bufTable[slot].next;
-
-      // If the page belongs to the passed-in file descriptor
-      if (bufTable[slot].fd == fd &&
-            (pageNum==ALL_PAGES || bufTable[slot].pageNum == pageNum)) {
-
-#ifdef PF_LOG
- sprintf (psMessage, "Page (%d) is in buffer pool.\n", bufTable[slot].pageNum);
- WriteLog(psMessage);
-#endif
-         // I don't care if the page is pinned or not, just write it if
-         // it is dirty.
-         if (bufTable[slot].bDirty) {
-#ifdef PF_LOG
-sprintf (psMessage, "Page (%d) is dirty\n",bufTable[slot].pageNum);
-WriteLog(psMessage);
-#endif
-            if ((rc = WritePage(fd, bufTable[slot].pageNum, bufTable[slot].pData)))
-               return (rc);
-            bufTable[slot].bDirty = FALSE;
-         }
-      }
-      slot = next;
+   // I don't care if the page is pinned or not, just write it if
+   // it is dirty.  A page the cleaner writes is not written twice.
+   if (pageNum == ALL_PAGES) {
+      LatchAll();
+      rc = WriteDirty(fd, ALL_PAGES, TRUE);
+      UnlatchAll();
    }
+   else {
+      PF_BufShard &sh = Shard(fd, pageNum);
+      PF_ShardLatch latch(sh);
+      int slot;
+
+      while (sh.pHashTable->Find(fd, pageNum, slot) == 0 &&
+            (sh.bufTable[slot].bReading || sh.bufTable[slot].bWriting))
+         WaitShard(sh);
+      rc = WriteDirty(fd, pageNum, TRUE);
+   }
+
+   if (rc || (bSync && (rc = SyncFile(fd))))
+      return (rc);
 
    return 0;
 }
@@ -525,32 +1381,177 @@ WriteLog(psMessage);
 //
 RC PF_BufferMgr::PrintBuffer()
 {
+   int bEmpty = TRUE;
+
+   LatchAll();
+
    cout << "Buffer contains " << numPages << " pages of size "
       << pageSize <<".\n";
-   cout << "Contents in order from most recently used to "
-      << "least recently used.\n";
-
-   int slot, next;
-   slot = first;
-   while (slot != INVALID_SLOT) {
-      next = bufTable[slot].next;
+   if (numShards > 1)
+      cout << "Buffer is split into " << numShards << " shards.\n";
+   cout << "Replacement policy is " << shards[0].pReplacer->Name() << ".\n";
+   cout << "Page cleaner keeps " << cleanTarget << "% of the pages clean.\n";
+   cout << "Contents in slot order.\n";
+
+   for (int slot = 0; slot < numPages; slot++) {
+      if (!bufTable[slot].bValid)
+         continue;
+      bEmpty = FALSE;
       cout << slot << " :: \n";
       cout << "  fd = " << bufTable[slot].fd << "\n";
       cout << "  pageNum = " << bufTable[slot].pageNum << "\n";
       cout << "  bDirty = " << bufTable[slot].bDirty << "\n";
       cout << "  pinCount = " << bufTable[slot].pinCount << "\n";
-      slot = next;
    }
 
-   if (first==INVALID_SLOT)
+   if (bEmpty)
       cout << "Buffer is empty!\n";
    else
       cout << "All remaining slots are free.\n";
 
+   UnlatchAll();
    return 0;
 }
 
 
+//
+// CountResident
+//
+// Desc: Add the # of pages of each attached file in the buffer to the
+//       residentPages of its PF_FileStats.  Blocks and the pages of
+//       mapped files are not in the buffer.
+//
+void PF_BufferMgr::CountResident()
+{
+   LatchAll();
+
+   for (int slot = 0; slot < numPages; slot++) {
+      PF_FileStats *pStats;
+      if (bufTable[slot].bValid && bufTable[slot].fd != MEMORY_FD &&
+            (pStats = FileStats(bufTable[slot].fd)) != NULL)
+         pStats->residentPages++;
+   }
+
+   UnlatchAll();
+}
+
+//
+// KeepCurve
+//
+// Desc: Start or stop keeping the miss-ratio curve.  It is not kept at
+//       first, so that requests do not pay for it.  A curve started anew
+//       knows nothing of the pages in the buffer, which count as used
+//       before all others.
+// In:   bKeep - keep the curve
+//
+void PF_BufferMgr::KeepCurve(int bKeep)
+{
+   LatchAll();
+   if (bKeep != bCurve)
+      for (int i = 0; i < numShards; i++) {
+         PF_BufShard &sh = shards[i];
+
+         delete sh.pCurve;
+         sh.pCurve = bKeep ? new PF_MissCurve(sh.numPages) : NULL;
+      }
+   bCurve = bKeep;
+   UnlatchAll();
+}
+
+//
+// CurveRequests
+//
+// Desc: # of pages asked for since the miss-ratio curve was reset
+//
+int PF_BufferMgr::CurveRequests()
+{
+   int numRequests = 0;
+
+   for (int i = 0; i < numShards; i++) {
+      PF_ShardLatch latch(shards[i]);
+      if (shards[i].pCurve != NULL)
+         numRequests += shards[i].pCurve->Requests();
+   }
+   return (numRequests);
+}
+
+//
+// CurveHits
+//
+// Desc: # of the pages asked for since the miss-ratio curve was reset
+//       that a buffer of size pages would have found in it.  Each shard
+//       would have its share of them.
+// In:   size - # of pages of the buffer
+//
+int PF_BufferMgr::CurveHits(int size)
+{
+   int hits = 0;
+
+   for (int i = 0; i < numShards; i++) {
+      PF_BufShard &sh = shards[i];
+      PF_ShardLatch latch(sh);
+      if (sh.pCurve != NULL)
+         hits += sh.pCurve->Hits((int)(((long long)size * sh.numPages +
+               numPages / 2) / numPages));
+   }
+   return (hits);
+}
+
+//
+// ResetCurve
+//
+// Desc: Start the miss-ratio curve afresh
+//
+void PF_BufferMgr::ResetCurve()
+{
+   for (int i = 0; i < numShards; i++) {
+      PF_ShardLatch latch(shards[i]);
+      if (shards[i].pCurve != NULL)
+         shards[i].pCurve->Reset();
+   }
+}
+
+//
+// PrintCurve
+//
+// Desc: Display the miss-ratio curve: the hit ratio the pages asked for
+//       would have had with a quarter of the buffer up to PF_CURVE_FACTOR
+//       times the buffer.
+//       This routine will be called via the system command.
+// Ret:  Always returns 0
+//
+RC PF_BufferMgr::PrintCurve()
+{
+   int numRequests = CurveRequests();
+   int size, prevSize = 0;
+   char line[80];
+
+   if (!bCurve) {
+      cout << "The miss-ratio curve of the buffer of " << numPages
+         << " pages is not kept.\n";
+      return (0);
+   }
+   cout << "Miss-ratio curve of the buffer of " << numPages << " pages, from "
+      << numRequests << " pages asked for.\n";
+   if (numRequests == 0) {
+      cout << "No pages asked for yet.\n";
+      return (0);
+   }
+
+   cout << "   pages   hit %  miss %\n";
+   for (int k = 1; k <= 4 * PF_CURVE_FACTOR; k++) {
+      if ((size = numPages * k / 4) <= prevSize)
+         continue;
+      prevSize = size;
+      double hitRatio = 100.0 * CurveHits(size) / numRequests;
+      sprintf(line, "%8d %6.1f%% %6.1f%%%s\n", size, hitRatio,
+            100.0 - hitRatio, size == numPages ? "  (now)" : "");
+      cout << line;
+   }
+
+   return (0);
+}
+
 //
 // ClearBuffer
 //
@@ -563,20 +1564,146 @@ RC PF_BufferMgr::PrintBuffer()
 // Ret:  Will return an error if a page is pinned and the Clear routine
 //       is called.
 RC PF_BufferMgr::ClearBuffer()
+{
+   RC rc = 0;
+
+   LatchAll();
+   for (int i = 0; i < numShards && !rc; i++)
+      rc = ClearShard(shards[i]);
+   UnlatchAll();
+
+   return (rc);
+}
+
+//
+// LineUp
+//
+// Desc: Internal.  Line up the unpinned pages of all the shards (latched,
+//       with no transfer going on) coldest first.  Each shard lines up
+//       its own in the order its replacement policy would replace them
+//       (NextVictims); the next page of the shard that is least far into
+//       its own order comes next.
+// Out:  pOrder - the buffer slots of the pages (room for numPages)
+// Ret:  # of pages lined up
+//
+int PF_BufferMgr::LineUp(int *pOrder)
+{
+   int i, s, num;
+   int **ppVictims = new int*[numShards];
+   int *pNumVictims = new int[numShards];
+   int *pNext = new int[numShards];
+
+   for (num = 0, s = 0; s < numShards; s++) {
+      ppVictims[s] = new int[shards[s].numPages];
+      pNumVictims[s] = shards[s].pReplacer->NextVictims(shards[s].bufTable,
+            ppVictims[s], shards[s].numPages);
+      pNext[s] = 0;
+      num += pNumVictims[s];
+   }
+   for (i = 0; i < num; i++) {
+      int best = -1;
+      for (s = 0; s < numShards; s++)
+         if (pNext[s] < pNumVictims[s] && (best < 0 ||
+               (long long)(pNext[s] + 1) * pNumVictims[best] <
+               (long long)(pNext[best] + 1) * pNumVictims[s]))
+            best = s;
+      pOrder[i] = shards[best].first + ppVictims[best][pNext[best]++];
+   }
+
+   for (s = 0; s < numShards; s++)
+      delete [] ppVictims[s];
+   delete [] ppVictims;
+   delete [] pNumVictims;
+   delete [] pNext;
+   return (num);
+}
+
+//
+// ResidentPages
+//
+// Desc: The pages of a file in the buffer that are not pinned, in the
+//       order in which they would be replaced (coldest first).  The
+//       shards are latched one at a time, and only those with pages of
+//       the file line up theirs (NextVictims).  The pages of the shards
+//       are merged as in LineUp.
+// In:   fd - file descriptor
+// Out:  pPages - new array of their page numbers, which the caller
+//       deletes
+//       numPages - # of pages in it
+// Ret:  0
+//
+RC PF_BufferMgr::ResidentPages(int fd, PageNum *&pPages, int &_numPages)
+{
+   PF_ResidentEntry *pEntries = new PF_ResidentEntry[1];
+   int i, slot, num = 0, size = 1;
+
+   for (i = 0; i < numShards; i++) {
+      PF_BufShard &sh = shards[i];
+      PF_ShardLatch latch(sh);
+      int numVictims;
+
+      for (slot = 0; slot < sh.numPages; slot++)
+         if (sh.bufTable[slot].bValid && sh.bufTable[slot].fd == fd &&
+               PF_Unpinned(sh.bufTable[slot]))
+            break;
+      if (slot == sh.numPages)
+         continue;                 // no page of fd to line up
+
+      // Make room for the whole shard (its size is only known under its
+      // latch: the buffer may be resized in between)
+      if (num + sh.numPages > size) {
+         PF_ResidentEntry *pMore;
+         size = 2 * size > num + sh.numPages ? 2 * size : num + sh.numPages;
+         pMore = new PF_ResidentEntry[size];
+         memcpy(pMore, pEntries, num * sizeof(PF_ResidentEntry));
+         delete [] pEntries;
+         pEntries = pMore;
+      }
+
+      int *pVictims = new int[sh.numPages];
+      numVictims = sh.pReplacer->NextVictims(sh.bufTable, pVictims,
+            sh.numPages);
+      for (int j = 0; j < numVictims; j++)
+         if (sh.bufTable[pVictims[j]].fd == fd) {
+            pEntries[num].pageNum = sh.bufTable[pVictims[j]].pageNum;
+            pEntries[num].rank = j + 1;
+            pEntries[num].numRanked = numVictims;
+            num++;
+         }
+      delete [] pVictims;
+   }
+   qsort(pEntries, num, sizeof(PF_ResidentEntry), PF_CompareResidentEntry);
+
+   pPages = new PageNum[num > 0 ? num : 1];
+   for (i = 0; i < num; i++)
+      pPages[i] = pEntries[i].pageNum;
+   _numPages = num;
+   delete [] pEntries;
+
+   return (0);
+}
+
+//
+// ClearShard
+//
+// Desc: Internal.  Remove the unpinned pages of a shard (latched, with no
+//       transfer going on)
+// Ret:  PF return code
+//
+RC PF_BufferMgr::ClearShard(PF_BufShard &sh)
 {
    RC rc;
+   PF_BufPageDesc *bufTable = sh.bufTable;
 
-   int slot, next;
-   slot = first;
-   while (slot != INVALID_SLOT) {
-      next = bufTable[slot].next;
-      if (bufTable[slot].pinCount == 0)
-         if ((rc = hashTable.Delete(bufTable[slot].fd,
-               bufTable[slot].pageNum)) ||
-            (rc = Unlink(slot)) ||
-            (rc = InsertFree(slot)))
-         return (rc);
-      slot = next;
+   for (int slot = 0; slot < sh.numPages; slot++) {
+      if (bufTable[slot].bValid && bufTable[slot].pinCount == 0) {
+         if ((rc = sh.pHashTable->Delete(bufTable[slot].fd,
+               bufTable[slot].pageNum)))
+            return (rc);
+         sh.pReplacer->Remove(slot);
+         if ((rc = InsertFree(sh, slot)))
+            return (rc);
+      }
    }
 
    return 0;
@@ -587,337 +1714,1598 @@ RC PF_BufferMgr::ClearBuffer()
 //
 // Desc: Resizes the buffer manager to the size passed in.
 //       This routine will be called via the system command.
+//       Other threads may go on using the buffer: every shard is latched
+//       (LatchAll) from before the pages are lined up until the new
+//       buffer is in place, so they find the pages either where they were
+//       or where they are now.  The buffer keeps its number of shards.
 // In:   The new buffer size
 // Out:  Nothing
 // Ret:  0 for success or,
-//       Some other PF error (probably PF_NOBUF)
-//
-// Notes: This method attempts to copy all the old pages which I am
-// unable to kick out of the old buffer manager into the new buffer
-// manager.  This obviously cannot always be successfull!
+//       PF_TOOSMALL if the pinned pages would not fit in the new buffer,
+//       or it would have fewer pages than shards
+//       PF_PAGELATCHED if a client holds or waits for the latch of a
+//       page (LatchPage): its slot cannot change meanwhile
+//
+// Notes: The pages in the buffer stay in it as far as they fit.  The
+// unpinned pages are lined up coldest first, merging the order in which
+// the replacement policy of each shard would replace them, and only the
+// coldest of them are thrown out (written first if dirty) when their
+// shard has no room for them in the new buffer.  The others are copied
+// into frames of the new arena, keeping their dirty bit, and admitted
+// into the new replacement policies coldest first, so that the hottest
+// pages are again the last in line.
+// The pages which cannot be moved (the pinned ones) keep their frame in
+// the old arena so that pointers held by clients remain valid (see
+// PF_Arena).  A page stays in its shard, so every shard of the new
+// buffer must have room for its own pinned pages and blocks; disposed
+// blocks are dropped.
+// The new shards are built aside and only take the place of the old ones
+// once every page is in, so that the old buffer is left as it is if
+// something fails.
 //
 RC PF_BufferMgr::ResizeBuffer(int iNewSize)
 {
-   int i;
+   int i, s, slot, numUnpinned;
    RC rc;
 
-   // First try and clear out the old buffer!
-   ClearBuffer();
+   if (iNewSize < numShards)
+      return (PF_TOOSMALL);
 
-   // Allocate memory for a new buffer table
-   PF_BufPageDesc *pNewBufTable = new PF_BufPageDesc[iNewSize];
+   LatchAll();
 
-   // Initialize the new buffer table and allocate memory for buffer
-   // pages.  Initially, the free list contains all pages
-   for (i = 0; i < iNewSize; i++) {
-      if ((pNewBufTable[i].pData = new char[pageSize]) == NULL) {
-         cerr << "Not enough memory for buffer\n";
-         exit(1);
+   // A latched page must keep its slot
+   for (s = 0; s < numShards; s++)
+      if (shards[s].numLatched > 0) {
+         UnlatchAll();
+         return (PF_PAGELATCHED);
       }
 
-      memset ((void *)pNewBufTable[i].pData, 0, pageSize);
-
-      pNewBufTable[i].prev = i - 1;
-      pNewBufTable[i].next = i + 1;
+   // Line up the unpinned pages of all the shards, coldest first
+   int *pOrder = new int[numPages];
+   numUnpinned = LineUp(pOrder);
+
+   // Whatever is not in line cannot be moved and must fit in its shard
+   char *pMovable = new char[numPages];
+   memset(pMovable, FALSE, numPages);
+   for (i = 0; i < numUnpinned; i++)
+      pMovable[pOrder[i]] = TRUE;
+
+   int *pRoom = new int[numShards];
+   for (rc = 0, s = 0; s < numShards; s++) {
+      PF_BufShard &sh = shards[s];
+      pRoom[s] = iNewSize / numShards + (s < iNewSize % numShards);
+      for (slot = 0; slot < sh.numPages; slot++)
+         if (sh.bufTable[slot].bValid && !pMovable[sh.first + slot] &&
+               --pRoom[s] < 0)
+            rc = PF_TOOSMALL;
    }
-   pNewBufTable[0].prev = pNewBufTable[iNewSize - 1].next = INVALID_SLOT;
 
-   // Now we must remember the old first and last slots and (of course)
-   // the buffer table itself.  Then we use insert methods to insert
-   // each of the entries into the new buffertable
-   int oldFirst = first;
-   PF_BufPageDesc *pOldBufTable = bufTable;
+   // Keep the hottest unpinned pages that their shards have room for
+   char *pKeep = new char[numUnpinned];
+   for (i = numUnpinned - 1; i >= 0; i--) {
+      PF_BufPageDesc &desc = bufTable[pOrder[i]];
+      int *piRoom = &pRoom[&SlotShard(pOrder[i]) - shards];
+      pKeep[i] = FALSE;
+      if (rc || desc.fd == MEMORY_FD)
+         continue;
+      if (*piRoom > 0) {
+         (*piRoom)--;
+         pKeep[i] = TRUE;
+      }
+   }
+   delete [] pRoom;
+
+   // Map the memory for the new buffer pages
+   PF_Arena newArena;
+   if (rc == 0)
+      rc = PF_MapArena((size_t)iNewSize * frameSize, newArena);
+
+   // Write the dirty pages that go.  Nothing has changed yet if this
+   // fails, only these pages are clean.
+   for (i = 0; rc == 0 && i < numUnpinned; i++) {
+      PF_BufPageDesc &desc = bufTable[pOrder[i]];
+      if (pKeep[i] || !desc.bDirty)
+         continue;
+      if ((rc = LogAhead(desc.pageLSN)) ||
+            (rc = WritePage(desc.fd, desc.pageNum, desc.pData))) {
+         PF_UnmapArena(newArena);
+         break;
+      }
+      PF_Cleaned(desc);
+#ifdef PF_STATS
+      pStatisticsMgr->Add(PF_STAT_DIRTYVICTIM);
+#endif
+   }
+   if (rc) {
+      delete [] pOrder;
+      delete [] pMovable;
+      delete [] pKeep;
+      UnlatchAll();
+      return (rc);
+   }
 
-   // Setup the new number of pages,  first, last and free
-   numPages = iNewSize;
-   first = last = INVALID_SLOT;
-   free = 0;
+   // Allocate memory for a new buffer table, page latches and shards
+   PF_BufPageDesc *pNewBufTable = new PF_BufPageDesc[iNewSize];
+   for (i = 0; i < iNewSize; i++) {
+      pNewBufTable[i].pData = newArena.base + (size_t)i * frameSize;
+      pNewBufTable[i].bValid = FALSE;
+   }
+   pthread_rwlock_t *pNewLatches = new pthread_rwlock_t[iNewSize];
+   for (i = 0; i < iNewSize; i++)
+      pthread_rwlock_init(&pNewLatches[i], NULL);
+   PF_BufShard *pNewShards = new PF_BufShard[numShards];
+   InitShards(pNewShards, pNewBufTable, iNewSize);
+
+   // Move the pages which cannot be moved first (they keep their frame),
+   // then the pages kept, coldest first (they are copied into the frame
+   // of their new slot)
+   for (int pass = 0; rc == 0 && pass < 2; pass++)
+      for (i = 0; i < (pass == 0 ? numPages : numUnpinned); i++) {
+         int newSlot;
+
+         if (pass == 0)
+            slot = i;
+         else if (pKeep[i])
+            slot = pOrder[i];
+         else
+            continue;
+         PF_BufPageDesc &desc = bufTable[slot];
+         if (!desc.bValid || (pass == 0 && pMovable[slot]))
+            continue;
+
+         // Take a slot from the free list of the same shard for the old
+         // page.  A pinned page keeps its frame; the slot gets its own
+         // back when the page leaves.
+         int fd = desc.fd;
+         PF_BufShard &sh = pNewShards[&SlotShard(slot) - shards];
+         newSlot = sh.free;
+         sh.free = sh.bufTable[newSlot].next;
+         char *pHome = sh.bufTable[newSlot].pData;
+         sh.bufTable[newSlot] = desc;
+         sh.bufTable[newSlot].bRing = FALSE;
+         if (pass == 1) {
+            memcpy(pHome, desc.pData, pageSize);
+            sh.bufTable[newSlot].pData = pHome;
+         }
+         if (fd == MEMORY_FD)
+            sh.bufTable[newSlot].pageNum = sh.first + newSlot;
 
-   // Setup the new buffer table
-   bufTable = pNewBufTable;
+         if ((rc = sh.pHashTable->Insert(fd, sh.bufTable[newSlot].pageNum,
+               newSlot)))
+            break;
 
-   // We must first remove from the hashtable any possible entries
-   int slot, next, newSlot;
-   slot = oldFirst;
-   while (slot != INVALID_SLOT) {
-      next = pOldBufTable[slot].next;
+         sh.pReplacer->Admit(newSlot, fd, sh.bufTable[newSlot].pageNum);
+         if (sh.pCurve != NULL && fd != MEMORY_FD)
+            sh.pCurve->Used(newSlot);
+      }
 
-      // Must remove the entry from the hashtable from the
-      if ((rc=hashTable.Delete(pOldBufTable[slot].fd, pOldBufTable[slot].pageNum)))
-         return (rc);
-      slot = next;
+   // Stay with the old buffer if a page could not be moved: the pages
+   // copied are still in their old frames
+   if (rc) {
+      FreeShards(pNewShards);
+      delete [] pNewShards;
+      for (i = 0; i < iNewSize; i++)
+         pthread_rwlock_destroy(&pNewLatches[i]);
+      delete [] pNewLatches;
+      delete [] pNewBufTable;
+      PF_UnmapArena(newArena);
+
+      delete [] pOrder;
+      delete [] pMovable;
+      delete [] pKeep;
+      UnlatchAll();
+      return (rc);
    }
 
-   // Now we traverse through the old buffer table and copy any old
-   // entries into the new one
-   slot = oldFirst;
-   while (slot != INVALID_SLOT) {
-
-      next = pOldBufTable[slot].next;
-      // Allocate a new slot for the old page
-      if ((rc = InternalAlloc(newSlot)))
-         return (rc);
+   // Put the new buffer in place of the old one, which we remember to
+   // take it down
+   PF_BufPageDesc *pOldBufTable = bufTable;
+   int oldNumPages = numPages;
+   PF_Arena *pOldArena = new PF_Arena(arena);
+   pthread_rwlock_t *pOldLatches = latches;
+
+   FreeShards(shards);
+   for (s = 0; s < numShards; s++)
+      PF_MoveShard(shards[s], pNewShards[s]);
+   delete [] pNewShards;
+   latches = pNewLatches;
+   bufTable = pNewBufTable;
+   arena = newArena;
+   numPages = iNewSize;
 
-      // Insert the page into the hash table,
-      // and initialize the page description entry
-      if ((rc = hashTable.Insert(pOldBufTable[slot].fd,
-            pOldBufTable[slot].pageNum, newSlot)) ||
-            (rc = InitPageDesc(pOldBufTable[slot].fd,
-            pOldBufTable[slot].pageNum, newSlot)))
-         return (rc);
+   // No page latch is held, nor waited for
+   for (i = 0; i < oldNumPages; i++)
+      pthread_rwlock_destroy(&pOldLatches[i]);
+   delete [] pOldLatches;
 
-      // Put the slot back on the free list before returning the error
-      Unlink(newSlot);
-      InsertFree(newSlot);
+#ifdef PF_STATS
+   for (i = 0; i < numUnpinned; i++)
+      if (!pKeep[i] && pOldBufTable[pOrder[i]].fd != MEMORY_FD)
+         CountFile(pOldBufTable[pOrder[i]].fd, &PF_FileStats::evictions);
+#endif
 
-      slot = next;
+   // The frames of the pages moved or thrown out are free.  Retire the
+   // old arena if pinned pages still live in it, unmap it otherwise.
+   for (i = 0; i < numUnpinned; i++)
+      ReleaseFrame(pOldBufTable[pOrder[i]].pData);
+   for (slot = 0; slot < oldNumPages; slot++)
+      if (pOldBufTable[slot].bValid && !pMovable[slot] &&
+            pOldBufTable[slot].pData >= pOldArena->base &&
+            pOldBufTable[slot].pData < pOldArena->base + pOldArena->size)
+         pOldArena->numUsed++;
+   if (pOldArena->numUsed == 0) {
+      PF_UnmapArena(*pOldArena);
+      delete pOldArena;
+   }
+   else {
+      pthread_mutex_lock(&retiredLatch);
+      pOldArena->next = pRetired;
+      pRetired = pOldArena;
+      pthread_mutex_unlock(&retiredLatch);
    }
 
    // Finally, delete the old buffer table
    delete [] pOldBufTable;
+   delete [] pOrder;
+   delete [] pMovable;
+   delete [] pKeep;
+   UnlatchAll();
 
    return 0;
 }
 
-
 //
-// InsertFree
+// NumShards
 //
-// Desc: Internal.  Insert a slot at the head of the free list
-// In:   slot - slot number to insert
-// Ret:  PF return code
+// Desc: # of shards of the buffer.  It does not change.
 //
-RC PF_BufferMgr::InsertFree(int slot)
+int PF_BufferMgr::NumShards() const
 {
-   bufTable[slot].next = free;
-   free = slot;
-
-   // Return ok
-   return (0);
+   return (numShards);
 }
 
 //
-// LinkHead
+// SetReplacePolicy
 //
-// Desc: Internal.  Insert a slot at the head of the used list, making
-//       it the most-recently used slot.
-// In:   slot - slot number to insert
-// Ret:  PF return code
+// Desc: Switch the buffer to another page replacement policy.  Resident
+//       pages are handed over to the new policy in slot order; whatever
+//       history the old policy had gathered is lost.
+// In:   _policy - new page replacement policy
+// Ret:  PF_BADPOLICY for an unknown policy
 //
-RC PF_BufferMgr::LinkHead(int slot)
+RC PF_BufferMgr::SetReplacePolicy(PF_ReplacePolicy _policy)
 {
-   // Set next and prev pointers of slot entry
-   bufTable[slot].next = first;
-   bufTable[slot].prev = INVALID_SLOT;
-
-   // If list isn't empty, point old first back to slot
-   if (first != INVALID_SLOT)
-      bufTable[first].prev = slot;
-
-   first = slot;
-
-   // if list was empty, set last to slot
-   if (last == INVALID_SLOT)
-      last = first;
+   PF_Replacer *pNewReplacer;
+
+   if ((pNewReplacer = PF_NewReplacer(_policy, 1)) == NULL)
+      return (PF_BADPOLICY);
+   delete pNewReplacer;
+
+   LatchAll();
+   policy = _policy;
+   for (int i = 0; i < numShards; i++) {
+      PF_BufShard &sh = shards[i];
+
+      delete sh.pReplacer;
+      sh.pReplacer = PF_NewReplacer(policy, sh.numPages);
+      for (int slot = 0; slot < sh.numPages; slot++)
+         if (sh.bufTable[slot].bValid)
+            sh.pReplacer->Admit(slot, sh.bufTable[slot].fd,
+                  sh.bufTable[slot].pageNum);
+   }
+   UnlatchAll();
 
-   // Return ok
    return (0);
 }
 
 //
-// Unlink
+// SetCleanTarget
 //
-// Desc: Internal.  Unlink the slot from the used list.  Assume that
-//       slot is valid.  Set prev and next pointers to INVALID_SLOT.
-//       The caller is responsible to either place the unlinked page into
-//       the free list or the used list.
-// In:   slot - slot number to unlink
-// Ret:  PF return code
+// Desc: Set how much of the buffer the page cleaner keeps clean: every
+//       time a page is replaced, the dirty pages among the next percent %
+//       of the shard in line for replacement are written in the
+//       background.  0 turns the cleaner off: dirty pages are then only
+//       written when they are replaced or flushed.
+// In:   percent - 0 to 100 (other values are brought into that range)
+// Ret:  0
 //
-RC PF_BufferMgr::Unlink(int slot)
+RC PF_BufferMgr::SetCleanTarget(int percent)
 {
-   // If slot is at head of list, set first to next element
-   if (first == slot)
-      first = bufTable[slot].next;
-
-   // If slot is at end of list, set last to previous element
-   if (last == slot)
-      last = bufTable[slot].prev;
+   if (percent < 0)
+      percent = 0;
+   if (percent > 100)
+      percent = 100;
 
-   // If slot not at end of list, point next back to previous
-   if (bufTable[slot].next != INVALID_SLOT)
-      bufTable[bufTable[slot].next].prev = bufTable[slot].prev;
+   LatchAll();
+   cleanTarget = percent;
+   UnlatchAll();
 
-   // If slot not at head of list, point prev forward to next
-   if (bufTable[slot].prev != INVALID_SLOT)
-      bufTable[bufTable[slot].prev].next = bufTable[slot].next;
-
-   // Set next and prev pointers of slot entry
-   bufTable[slot].prev = bufTable[slot].next = INVALID_SLOT;
-
-   // Return ok
    return (0);
 }
 
 //
-// InternalAlloc
+// SetLog
 //
-// Desc: Internal.  Allocate a buffer slot.  The slot is inserted at the
-//       head of the used list.  Here's how it chooses which slot to use:
-//       If there is something on the free list, then use it.
-//       Otherwise, choose a victim to replace.  If a victim cannot be
-//       chosen (because all the pages are pinned), then return an error.
-// Out:  slot - set to newly-allocated slot
-// Ret:  PF_NOBUF if all pages are pinned, other PF return code otherwise
+// Desc: Attach a write-ahead log, or detach it.  From then on, a dirty
+//       page is only written once the log is on the disk up to the last
+//       record of its changes.  Must not be called while other threads
+//       use the buffer.
+// In:   _pLog - the log, NULL for none
 //
-RC PF_BufferMgr::InternalAlloc(int &slot)
+void PF_BufferMgr::SetLog(PF_LogMgr *_pLog)
 {
-   RC  rc;       // return code
-
-   // If the free list is not empty, choose a slot from the free list
-   if (free != INVALID_SLOT) {
-      slot = free;
-      free = bufTable[slot].next;
-   }
-   else {
+   pLog = _pLog;
+}
 
-      // Choose the least-recently used page that is unpinned
-      for (slot = last; slot != INVALID_SLOT; slot = bufTable[slot].prev) {
-         if (bufTable[slot].pinCount == 0)
-            break;
+//
+// DirtyPages
+//
+// Desc: List the dirty pages of the logged files, with the LSN of their
+//       first change since they were last written.  The shards are
+//       latched one at a time.  Pages that were changed without a log
+//       record yet are left out: their record comes later.
+// Out:  pPages - new array of the pages (the caller deletes it)
+//       numPages - # of pages in it
+// Ret:  0
+//
+RC PF_BufferMgr::DirtyPages(PF_DirtyPage *&pPages, int &_numPages)
+{
+   int size = 1;
+
+   pPages = new PF_DirtyPage[size];
+   _numPages = 0;
+
+   for (int i = 0; i < numShards; i++) {
+      PF_BufShard &sh = shards[i];
+      PF_ShardLatch latch(sh);
+
+      // Make room for the whole shard (the buffer may have been resized
+      // since the last one was latched)
+      if (_numPages + sh.numPages > size) {
+         PF_DirtyPage *pMore;
+         size = 2 * size > _numPages + sh.numPages ? 2 * size :
+            _numPages + sh.numPages;
+         pMore = new PF_DirtyPage[size];
+         memcpy(pMore, pPages, _numPages * sizeof(PF_DirtyPage));
+         delete [] pPages;
+         pPages = pMore;
       }
 
-      // Return error if all buffers were pinned
-      if (slot == INVALID_SLOT)
-         return (PF_NOBUF);
-
-      // Write out the page if it is dirty
-      if (bufTable[slot].bDirty) {
-         if ((rc = WritePage(bufTable[slot].fd, bufTable[slot].pageNum,
-               bufTable[slot].pData)))
-            return (rc);
-
-         bufTable[slot].bDirty = FALSE;
+      for (int slot = 0; slot < sh.numPages; slot++) {
+         PF_BufPageDesc &desc = sh.bufTable[slot];
+         int logNo;
+
+         if (!desc.bValid || !desc.bDirty || desc.recLSN == 0 ||
+               (logNo = LogNo(desc.fd)) < 0)
+            continue;
+         pPages[_numPages].fileNo = logNo;
+         pPages[_numPages].pageNum = desc.pageNum;
+         pPages[_numPages].recLSN = desc.recLSN;
+         _numPages++;
       }
-
-      // Remove page from the hash table and slot from the used buffer list
-      if ((rc = hashTable.Delete(bufTable[slot].fd, bufTable[slot].pageNum)) ||
-            (rc = Unlink(slot)))
-         return (rc);
    }
-
-   // Link slot at the head of the used list
-   if ((rc = LinkHead(slot)))
-      return (rc);
-
    // Return ok
    return (0);
 }
 
 //
-// ReadPage
-//
-// Desc: Read a page from disk
+// LogFileHdrs
 //
-// In:   fd - OS file descriptor
-//       pageNum - number of page to read
-//       dest - pointer to buffer in which to read page
-// Out:  dest - buffer contains page contents
-// Ret:  PF return code
+// Desc: Log the header of each logged file whose header was logged
+//       before as a whole, so that the records before are not needed
+// Ret:  error writing the log
 //
-RC PF_BufferMgr::ReadPage(int fd, PageNum pageNum, char *dest)
+RC PF_BufferMgr::LogFileHdrs()
 {
+   RC rc = 0;
+   PF_LSN lsn;
 
-#ifdef PF_LOG
-   char psMessage[100];
-   sprintf (psMessage, "Reading (%d,%d).\n", fd, pageNum);
-   WriteLog(psMessage);
-#endif
-
-#ifdef PF_STATS
-   pStatisticsMgr->Register(PF_READPAGE, STAT_ADDONE);
-#endif
+   if (pLog == NULL)
+      return (0);
 
-   // seek to the appropriate place (cast to long for PC's)
-   long offset = pageNum * (long)pageSize + PF_FILE_HDR_SIZE;
-   if (lseek(fd, offset, L_SET) < 0)
-      return (PF_UNIX);
+   for (int fd = 0; fd < PF_FILE_CHUNK * PF_FILE_CHUNKS && !rc; fd++) {
+      PF_BufFile *pFile = File(fd);
+      if (pFile == NULL && FileEntry(fd) == NULL)
+         fd += PF_FILE_CHUNK - 1 - fd % PF_FILE_CHUNK;   // no such chunk
+      if (pFile == NULL || pFile->logNo < 0)
+         continue;
+
+      pthread_mutex_lock(&pFile->latch);
+      if (pFile->pHdr != NULL &&
+            !(rc = pLog->Append(PF_LOGREC_HDR, pFile->logNo, -1, 0,
+            (const char *)pFile->pHdr, sizeof(PF_FileHdr), lsn)))
+         pFile->hdrLSN = lsn;
+      pthread_mutex_unlock(&pFile->latch);
+   }
 
-   // Read the data
-   int numBytes = read(fd, dest, pageSize);
-   if (numBytes < 0)
-      return (PF_UNIX);
-   else if (numBytes != pageSize)
-      return (PF_INCOMPLETEREAD);
-   else
-      return (0);
+   return (rc);
 }
 
 //
-// WritePage
-//
-// Desc: Write a page to disk
+// CleanOld
 //
-// In:   fd - OS file descriptor
-//       pageNum - number of page to write
-//       dest - pointer to buffer containing page contents
+// Desc: Write the pages that are not pinned (nor being transferred) and
+//       were first changed before lsn, after their log records.  The
+//       shards are latched one at a time.
+// In:   lsn - LSN of the oldest change that may stay in the buffer
 // Ret:  PF return code
 //
-RC PF_BufferMgr::WritePage(int fd, PageNum pageNum, char *source)
+RC PF_BufferMgr::CleanOld(PF_LSN lsn)
 {
+   RC rc = 0;
 
-#ifdef PF_LOG
-   char psMessage[100];
-   sprintf (psMessage, "Writing (%d,%d).\n", fd, pageNum);
-   WriteLog(psMessage);
-#endif
+   for (int i = 0; i < numShards && !rc; i++) {
+      PF_BufShard &sh = shards[i];
+      PF_ShardLatch latch(sh);
 
-#ifdef PF_STATS
-   pStatisticsMgr->Register(PF_WRITEPAGE, STAT_ADDONE);
-#endif
+      for (int slot = 0; slot < sh.numPages && !rc; slot++) {
+         PF_BufPageDesc &desc = sh.bufTable[slot];
 
-   // seek to the appropriate place (cast to long for PC's)
-   long offset = pageNum * (long)pageSize + PF_FILE_HDR_SIZE;
-   if (lseek(fd, offset, L_SET) < 0)
-      return (PF_UNIX);
+         if (!desc.bValid || !desc.bDirty || !PF_Evictable(desc) ||
+               desc.recLSN == 0 || desc.recLSN >= lsn)
+            continue;
+         if (!(rc = LogAhead(desc.pageLSN)) &&
+               !(rc = WritePage(desc.fd, desc.pageNum, desc.pData)))
+            PF_Cleaned(desc);
+      }
+   }
+   return (rc);
+}
 
-   // Read the data
-   int numBytes = write(fd, source, pageSize);
-   if (numBytes < 0)
-      return (PF_UNIX);
-   else if (numBytes != pageSize)
-      return (PF_INCOMPLETEWRITE);
-   else
-      return (0);
+//
+// SyncFiles
+//
+// Desc: fdatasync the logged files, so that the pages written so far are
+//       on the disk
+// Ret:  PF_UNIX
+//
+RC PF_BufferMgr::SyncFiles()
+{
+   RC rc = 0;
+
+   for (int fd = 0; fd < PF_FILE_CHUNK * PF_FILE_CHUNKS && !rc; fd++) {
+      PF_BufFile *pFile = File(fd);
+      if (pFile == NULL && FileEntry(fd) == NULL)
+         fd += PF_FILE_CHUNK - 1 - fd % PF_FILE_CHUNK;   // no such chunk
+      else if (pFile != NULL && pFile->logNo >= 0)
+         rc = pFile->pIO->Sync();
+   }
+
+   return (rc);
 }
 
 //
-// InitPageDesc
+// InsertFree
 //
-// Desc: Internal.  Initialize PF_BufPageDesc to a newly-pinned page
-//       for a newly pinned page
-// In:   fd - file descriptor
-//       pageNum - page number
+// Desc: Internal.  Insert a slot at the head of the free list of a shard
+// In:   sh - shard of the slot
+//       slot - slot number to insert
 // Ret:  PF return code
 //
-RC PF_BufferMgr::InitPageDesc(int fd, PageNum pageNum, int slot)
+RC PF_BufferMgr::InsertFree(PF_BufShard &sh, int slot)
 {
-   // set the slot to refer to a newly-pinned page
-   bufTable[slot].fd       = fd;
-   bufTable[slot].pageNum  = pageNum;
-   bufTable[slot].bDirty   = FALSE;
-   bufTable[slot].pinCount = 1;
+   HomeFrame(sh, slot);
+   if (sh.pCurve != NULL)
+      sh.pCurve->Freed(slot);
+   sh.bufTable[slot].bValid = FALSE;
+   sh.bufTable[slot].next = sh.free;
+   sh.free = slot;
 
    // Return ok
    return (0);
 }
 
-//------------------------------------------------------------------------------
+//
+// HomeFrame
+//
+// Desc: Internal.  Called when the page in slot leaves the buffer.  If
+//       the page was still using a frame of a retired arena (it was
+//       pinned when the buffer was resized), point the slot back to its
+//       own frame and let go of the other (see ReleaseFrame).
+// In:   sh - shard of the slot
+//       slot - slot whose page is gone
+//
+void PF_BufferMgr::HomeFrame(PF_BufShard &sh, int slot)
+{
+   char *pHome = arena.base + (size_t)(sh.first + slot) * frameSize;
+   char *pData = sh.bufTable[slot].pData;
+
+   if (pData == pHome)
+      return;
+
+   ReleaseFrame(pData);
+   sh.bufTable[slot].pData = pHome;
+}
+
+//
+// ReleaseFrame
+//
+// Desc: Internal.  A page no longer uses the frame at pData.  If the frame
+//       belongs to a retired arena, unmap the arena once none of its
+//       frames is used.
+// In:   pData - the frame
+//
+void PF_BufferMgr::ReleaseFrame(char *pData)
+{
+   // The retired arenas are shared by all shards
+   pthread_mutex_lock(&retiredLatch);
+   for (PF_Arena **ppArena = &pRetired; *ppArena != NULL;
+         ppArena = &(*ppArena)->next) {
+      PF_Arena *pArena = *ppArena;
+      if (pData >= pArena->base && pData < pArena->base + pArena->size) {
+         if (--pArena->numUsed == 0) {
+            *ppArena = pArena->next;
+            PF_UnmapArena(*pArena);
+            delete pArena;
+         }
+         break;
+      }
+   }
+   pthread_mutex_unlock(&retiredLatch);
+}
+
+//
+// InternalAlloc
+//
+// Desc: Internal.  Allocate a buffer slot of a shard.  Here's how it
+//       chooses which slot to use:
+//       If there is something on the free list, then use it.
+//       Otherwise, ask the replacement policy for a victim.  If a victim
+//       cannot be chosen (because all the pages are pinned), then return
+//       an error.
+//       Pages being read or written cannot be chosen: if they are all
+//       that is left, or if the victim is dirty while the cleaner is
+//       writing pages, wait for a transfer to be over and look again (the
+//       pages the cleaner wrote are the next in line and are clean then).
+//       Waiting lets go of the latch of the shard.
+//       A dirty victim is written first, without the latch (see
+//       WriteVictim); then the choice is made again, since the shard may
+//       have changed meanwhile.
+//       Once a page was replaced, the cleaner is set to work.
+//       The caller hands the slot to the replacement policy once the
+//       new page is in place.
+// In:   sh - shard (latched) the page belongs to
+//       fd, pageNum - page the slot is needed for
+// Out:  slot - set to newly-allocated slot
+// Ret:  PF_NOBUF if all pages are pinned, other PF return code otherwise
+//
+RC PF_BufferMgr::InternalAlloc(PF_BufShard &sh, int &slot, int fd,
+      PageNum pageNum)
+{
+   RC  rc;       // return code
+   PF_BufPageDesc *bufTable = sh.bufTable;
+
+   for (;;) {
+      // If the free list is not empty, choose a slot from the free list
+      if (sh.free != INVALID_SLOT) {
+         slot = sh.free;
+         sh.free = bufTable[slot].next;
+         return (0);
+      }
+
+      // Let the replacement policy choose an unpinned page
+      rc = sh.pReplacer->Victim(bufTable, fd, pageNum, slot);
+      if ((rc == PF_NOBUF ||
+            (rc == 0 && bufTable[slot].bDirty && sh.numWriting > 0)) &&
+            sh.numIO > 0) {
+         WaitShard(sh);
+         continue;
+      }
+      if (rc)
+         return (rc);
+
+      // Write out the page if it is dirty, and choose again
+      if (bufTable[slot].bDirty) {
+         if ((rc = WriteVictim(sh, slot)))
+            return (rc);
+         continue;
+      }
+      break;
+   }
+
+#ifdef PF_STATS
+   long long start = StatNow();
+#endif
+
+   // Remove page from the hash table and from the replacement policy
+   if ((rc = sh.pHashTable->Delete(bufTable[slot].fd,
+         bufTable[slot].pageNum)))
+      return (rc);
+   sh.pReplacer->Evict(slot, bufTable[slot].fd, bufTable[slot].pageNum);
+   if (sh.pCurve != NULL)
+      sh.pCurve->Evicted(bufTable[slot].fd, bufTable[slot].pageNum);
+   bufTable[slot].bValid = FALSE;
+   HomeFrame(sh, slot);
+#ifdef PF_STATS
+   pStatisticsMgr->Time(PF_TIME_EVICT, start);
+   CountFile(bufTable[slot].fd, &PF_FileStats::evictions);
+#endif
+
+   // Get the next victims written while the new page is used
+   CleanTail(sh);
+
+   // Return ok
+   return (0);
+}
+
+//
+// RingAlloc
+//
+// Desc: Internal.  Allocate a buffer slot for a page read by a scan.
+//       The scan ring of the shard holds the last ringSize slots handed
+//       out this way.  If the oldest of them still holds an
+//       unpinned scan page, that page is thrown out and its slot reused;
+//       otherwise a slot is allocated as usual (InternalAlloc) and takes
+//       its place in the ring.  A scan thus keeps replacing its own pages
+//       instead of the rest of the buffer.  Pages read ahead that the
+//       scan has not got to yet are not recycled.  A dirty ring page is
+//       written first, without the latch, as in InternalAlloc.
+// In:   sh - shard (latched) the page belongs to
+//       fd, pageNum - page the slot is needed for
+// Out:  slot - set to newly-allocated slot
+// Ret:  PF_NOBUF if all pages are pinned, other PF return code otherwise
+//
+RC PF_BufferMgr::RingAlloc(PF_BufShard &sh, int &slot, int fd,
+      PageNum pageNum)
+{
+   RC  rc;       // return code
+   PF_BufPageDesc *bufTable = sh.bufTable;
+   int ringSlot;
+
+   for (;;) {
+      ringSlot = sh.ring[sh.ringPos];
+      if (ringSlot == INVALID_SLOT || !bufTable[ringSlot].bValid ||
+            !bufTable[ringSlot].bRing || !PF_Evictable(bufTable[ringSlot]) ||
+            bufTable[ringSlot].bPrefetched) {
+         ringSlot = INVALID_SLOT;
+         break;
+      }
+
+      // Write out the page if it is dirty, and look again
+      if (!bufTable[ringSlot].bDirty)
+         break;
+      if ((rc = WriteVictim(sh, ringSlot)))
+         return (rc);
+   }
+
+   if (ringSlot != INVALID_SLOT) {
+#ifdef PF_STATS
+      long long start = StatNow();
+#endif
+
+      // Scan pages leave no history behind
+      if ((rc = sh.pHashTable->Delete(bufTable[ringSlot].fd,
+            bufTable[ringSlot].pageNum)))
+         return (rc);
+      sh.pReplacer->Remove(ringSlot);
+      bufTable[ringSlot].bValid = FALSE;
+      HomeFrame(sh, ringSlot);
+#ifdef PF_STATS
+      pStatisticsMgr->Time(PF_TIME_EVICT, start);
+      CountFile(bufTable[ringSlot].fd, &PF_FileStats::evictions);
+#endif
+      slot = ringSlot;
+   }
+   else {
+      if ((rc = InternalAlloc(sh, slot, fd, pageNum)))
+         return (rc);
+
+      // The slot may have been in the ring before (freed by a flush)
+      for (int i = 0; i < sh.ringSize; i++)
+         if (sh.ring[i] == slot)
+            sh.ring[i] = INVALID_SLOT;
+   }
+
+   sh.ring[sh.ringPos] = slot;
+   sh.ringPos = (sh.ringPos + 1) % sh.ringSize;
+
+   // Return ok
+   return (0);
+}
+
+//
+// WriteVictim
+//
+// Desc: Internal.  Write a dirty page chosen for replacement, once the
+//       log records of its changes are on the disk.  Neither the wait for
+//       the log nor the write holds the latch of the shard: meanwhile the
+//       page is marked bWriting, so that it is neither replaced nor
+//       pinned (GetPage waits for the write), and the rest of the shard
+//       stays in use.  The page is left in the buffer, clean if the write
+//       went well.
+// In:   sh - shard (latched) of the page
+//       slot - slot of the page (unpinned, dirty, not being transferred)
+// Ret:  error writing the log or the page
+//
+RC PF_BufferMgr::WriteVictim(PF_BufShard &sh, int slot)
+{
+   PF_BufPageDesc &desc = sh.bufTable[slot];
+   RC rc;
+
+   desc.bWriting = TRUE;
+   sh.numIO++;
+   pthread_mutex_unlock(&sh.latch);
+
+   if (!(rc = LogAhead(desc.pageLSN)))
+      rc = WritePage(desc.fd, desc.pageNum, desc.pData);
+
+   pthread_mutex_lock(&sh.latch);
+   desc.bWriting = FALSE;
+   sh.numIO--;
+   pthread_cond_broadcast(&sh.ioDone);
+
+   if (rc)
+      return (rc);
+   PF_Cleaned(desc);
+#ifdef PF_STATS
+   pStatisticsMgr->Add(PF_STAT_DIRTYVICTIM);
+#endif
+   return (0);
+}
+
+//
+// AttachFile
+//
+// Desc: Called when a file is opened.  From now on the pages of fd are
+//       read and written through an I/O backend of the given mode.
+// In:   fd - OS file descriptor of the open file
+//       ioMode - PF_IO_BUFFERED, PF_IO_DIRECT or PF_IO_MMAP
+//       bCompressed - the pages of the file are compressed on disk (not
+//       with PF_IO_MMAP)
+//       pStats - where to count the work done for the file (NULL:
+//       nowhere); it must stay there until the file is detached
+//       logNo - # of the file in the write-ahead log, -1 if its changes
+//       are not logged
+// Ret:  PF_FILEOPEN if fd is attached already, PF_NODIRECTIO, PF_UNIX
+//
+RC PF_BufferMgr::AttachFile(int fd, PF_IOMode ioMode, int bCompressed,
+      PF_FileStats *pStats, int logNo)
+{
+   RC rc = 0;
+   PF_IO *pIO;
+
+   if (fd < 0 || fd >= PF_FILE_CHUNK * PF_FILE_CHUNKS)
+      return (PF_CLOSEDFILE);
+
+   pthread_mutex_lock(&filesLatch);
+
+   // Extend the file table to cover fd.  Chunks never move, so that
+   // entries can be read without a latch.
+   PF_BufFile *&pChunk = fileChunks[fd / PF_FILE_CHUNK];
+   if (pChunk == NULL) {
+      PF_BufFile *pNewChunk = new PF_BufFile[PF_FILE_CHUNK];
+      for (int i = 0; i < PF_FILE_CHUNK; i++) {
+         pNewChunk[i].pIO = NULL;
+         pNewChunk[i].mapPins = NULL;
+         pNewChunk[i].pStats = NULL;
+         pNewChunk[i].logNo = -1;
+         pNewChunk[i].pHdr = NULL;
+         pthread_mutex_init(&pNewChunk[i].latch, NULL);
+      }
+      __atomic_store_n(&pChunk, pNewChunk, __ATOMIC_RELEASE);
+   }
+   PF_BufFile &file = pChunk[fd % PF_FILE_CHUNK];
+
+   if (file.pIO != NULL)
+      rc = PF_FILEOPEN;
+   else if (!(rc = PF_NewIO(fd, ioMode, pIO))) {
+      if (bCompressed && ioMode != PF_IO_MMAP)
+         pIO = PF_NewCompressedIO(pIO, pageSize);
+      file.pStats = pStats;
+      file.logNo = (ioMode == PF_IO_MMAP) ? -1 : logNo;
+      file.hdrLSN = 0;
+      file.lastPage = -1;
+      file.run = 0;
+      file.raEnd = -1;
+
+      // Pages of a mapped file are only pinned
+      file.mapPins = NULL;
+      file.numMapped = 0;
+      if (ioMode == PF_IO_MMAP) {
+         if (pIO->MapLength() > PF_FILE_HDR_SIZE)
+            file.numMapped =
+               (PageNum)((pIO->MapLength() - PF_FILE_HDR_SIZE) / pageSize);
+         file.mapPins = new short int[file.numMapped + 1];
+         memset(file.mapPins, 0, (file.numMapped + 1) * sizeof(short int));
+      }
+
+      // The entry is complete once pIO is set
+      __atomic_store_n(&file.pIO, pIO, __ATOMIC_RELEASE);
+   }
+
+   pthread_mutex_unlock(&filesLatch);
+   return (rc);
+}
+
+//
+// DetachFile
+//
+// Desc: Called when a file is closed, after its pages were flushed
+// In:   fd - OS file descriptor
+// Ret:  PF_CLOSEDFILE if fd was not attached
+//
+RC PF_BufferMgr::DetachFile(int fd)
+{
+   PF_BufFile *pFile = File(fd);
+   if (pFile == NULL)
+      return (PF_CLOSEDFILE);
+
+   // No read or write may be going on through the backend
+   LatchAll();
+   UnlatchAll();
+
+   pthread_mutex_lock(&filesLatch);
+   PF_IO *pIO = pFile->pIO;
+   __atomic_store_n(&pFile->pIO, (PF_IO *)NULL, __ATOMIC_RELEASE);
+   delete pIO;
+   delete [] pFile->mapPins;
+   pFile->mapPins = NULL;
+   pFile->pStats = NULL;
+   pthread_mutex_unlock(&filesLatch);
+
+   // A checkpoint may be logging the header
+   pthread_mutex_lock(&pFile->latch);
+   delete pFile->pHdr;
+   pFile->pHdr = NULL;
+   pthread_mutex_unlock(&pFile->latch);
+
+   // Return ok
+   return (0);
+}
+
+//
+// FileEntry, File
+//
+// Desc: Internal.  Entry of fd in the file table, without a latch
+// Ret:  FileEntry: NULL if the table has no entry for fd yet
+//       File: NULL as well if fd is not attached
+//
+PF_BufFile *PF_BufferMgr::FileEntry(int fd) const
+{
+   if (fd < 0 || fd >= PF_FILE_CHUNK * PF_FILE_CHUNKS)
+      return (NULL);
+   PF_BufFile *pChunk = __atomic_load_n(&fileChunks[fd / PF_FILE_CHUNK],
+         __ATOMIC_ACQUIRE);
+   return (pChunk == NULL ? NULL : &pChunk[fd % PF_FILE_CHUNK]);
+}
+
+PF_BufFile *PF_BufferMgr::File(int fd) const
+{
+   PF_BufFile *pFile = FileEntry(fd);
+   if (pFile == NULL || __atomic_load_n(&pFile->pIO, __ATOMIC_ACQUIRE) == NULL)
+      return (NULL);
+   return (pFile);
+}
+
+//
+// FileIO
+//
+// Desc: Internal.  I/O backend of fd
+// Ret:  NULL if fd is not attached
+//
+PF_IO *PF_BufferMgr::FileIO(int fd)
+{
+   PF_BufFile *pFile = File(fd);
+   return (pFile == NULL ? NULL : pFile->pIO);
+}
+
+//
+// LogNo
+//
+// Desc: Internal.  # of fd in the log
+// Ret:  -1 if fd is not attached or its changes are not logged
+//
+int PF_BufferMgr::LogNo(int fd)
+{
+   PF_BufFile *pFile = File(fd);
+   return (pFile == NULL ? -1 : pFile->logNo);
+}
+
+//
+// LogAhead
+//
+// Desc: Internal.  Wait until the log is on the disk up to the record at
+//       lsn, before a page whose last change it logs is written
+// In:   lsn - LSN of the record, 0 for none
+// Ret:  error writing the log
+//
+RC PF_BufferMgr::LogAhead(PF_LSN lsn)
+{
+   if (pLog == NULL || lsn == 0)
+      return (0);
+   return (pLog->Flush(lsn));
+}
+
+//
+// FileStats
+//
+// Desc: Internal.  Statistics of fd
+// Ret:  NULL if fd is not attached or its work is not counted
+//
+PF_FileStats *PF_BufferMgr::FileStats(int fd)
+{
+   PF_BufFile *pFile = File(fd);
+   return (pFile == NULL ? NULL : pFile->pStats);
+}
+
+//
+// CountFile
+//
+// Desc: Internal.  Add n to a count of the statistics of fd, if it has
+//       any.  The file may be used by other threads: the add is atomic.
+// In:   fd - OS file descriptor
+//       pCount - the count: &PF_FileStats::hits, ...
+//       n - what to add
+//
+void PF_BufferMgr::CountFile(int fd, int PF_FileStats::*pCount, int n)
+{
+   PF_FileStats *pStats = FileStats(fd);
+
+   if (pStats != NULL)
+      __sync_fetch_and_add(&(pStats->*pCount), n);
+}
+
+//
+// MapPin
+//
+// Desc: Internal.  If fd was opened with PF_IO_MMAP, keep track of the
+//       pins of one of its pages: pin it (delta 1), unpin it (delta -1)
+//       or only check that it is pinned (delta 0).  With ALL_PAGES (and
+//       delta 0), check that no page of the file is pinned.
+// In:   fd - OS file descriptor
+//       pageNum - page of the file, or ALL_PAGES
+//       delta - 1, -1 or 0
+// Out:  ppBuffer - if not NULL, set *ppBuffer to point to the page
+//       rc - PF_INVALIDPAGE, PF_PAGEUNPINNED, PF_PAGEPINNED (ALL_PAGES)
+//            or 0
+// Ret:  TRUE if fd is mapped, FALSE if the page is up to the buffer
+//
+int PF_BufferMgr::MapPin(int fd, PageNum pageNum, int delta,
+      char **ppBuffer, RC &rc)
+{
+   PF_BufFile *pFile = File(fd);
+   if (pFile == NULL || pFile->mapPins == NULL)
+      return (FALSE);
+   PF_BufFile &file = *pFile;
+
+   // The pins are counted atomically: the page may be shared by threads
+   rc = 0;
+   if (pageNum == ALL_PAGES) {
+      for (PageNum i = 0; i < file.numMapped; i++)
+         if (__atomic_load_n(&file.mapPins[i], __ATOMIC_RELAXED) > 0)
+            rc = PF_PAGEPINNED;
+   }
+   else if (pageNum < 0 || pageNum >= file.numMapped)
+      rc = PF_INVALIDPAGE;
+   else if (delta > 0)
+      __sync_fetch_and_add(&file.mapPins[pageNum], 1);
+   else {
+      short int pins;
+      do {
+         pins = __atomic_load_n(&file.mapPins[pageNum], __ATOMIC_RELAXED);
+         if (pins == 0) {
+            rc = PF_PAGEUNPINNED;
+            break;
+         }
+      } while (delta < 0 && !__sync_bool_compare_and_swap(
+            &file.mapPins[pageNum], pins, (short int)(pins - 1)));
+   }
+
+   if (!rc && ppBuffer != NULL)
+      *ppBuffer = file.pIO->Map(pageNum * (off_t)pageSize +
+            PF_FILE_HDR_SIZE, pageSize);
+
+   return (TRUE);
+}
+
+//
+// WriteFileHdr
+//
+// Desc: Write the header page of a file, once the log records of its
+//       changes are on the disk.  The page is written whole from an
+//       aligned copy (the rest of it zeroed), as direct I/O wants.
+// In:   fd - OS file descriptor
+//       source - the header
+//       length - # of bytes of it (at most PF_FILE_HDR_SIZE)
+// Ret:  PF_HDRWRITE, PF_NOMEM, PF_UNIX
+//
+RC PF_BufferMgr::WriteFileHdr(int fd, const char *source, int length)
+{
+   PF_LSN hdrLSN = 0;
+   void *pPage;
+   RC rc;
+
+   PF_BufFile *pFile = File(fd);
+   if (pFile == NULL)
+      return (PF_CLOSEDFILE);
+   PF_IO *pIO = pFile->pIO;
+
+   pthread_mutex_lock(&pFile->latch);
+   hdrLSN = pFile->hdrLSN;
+   pthread_mutex_unlock(&pFile->latch);
+   if ((rc = LogAhead(hdrLSN)))
+      return (rc);
+
+   if (posix_memalign(&pPage, PF_DIRECT_ALIGN, PF_FILE_HDR_SIZE))
+      return (PF_NOMEM);
+   memcpy(pPage, source, length);
+   memset((char *)pPage + length, 0, PF_FILE_HDR_SIZE - length);
+   rc = pIO->Write(0, (char *)pPage, PF_FILE_HDR_SIZE, PF_HDRWRITE);
+   free(pPage);
+   return (rc);
+}
+
+//
+// LogChange
+//
+// Desc: Log a change to a page pinned in the buffer, and mark it dirty.
+//       The page is written once the record is on the disk.  If the file
+//       is not logged, the page is only marked dirty.
+// In:   fd - OS file descriptor of the file of the page
+//       pageNum - number of the page
+//       type - PF_LOGREC_PAGE: the bytes changed are logged,
+//              PF_LOGREC_ALLOC: the page was allocated (and zeroed)
+//       offset, length - the bytes changed, from the start of the page
+//       header
+// Ret:  PF_PAGENOTINBUF, PF_PAGEUNPINNED, error writing the log
+//
+RC PF_BufferMgr::LogChange(int fd, PageNum pageNum, int type, int offset,
+      int length)
+{
+   RC  rc;       // return code
+   int slot;     // buffer slot where page is located
+   int logNo = LogNo(fd);
+   PF_LSN lsn;
+
+   if (pLog == NULL || logNo < 0)
+      return (MarkDirty(fd, pageNum));
+
+   PF_BufShard &sh = Shard(fd, pageNum);
+   PF_ShardLatch latch(sh);
+
+   // The page must be found and pinned in the buffer
+   if ((rc = sh.pHashTable->Find(fd, pageNum, slot))) {
+      if ((rc == PF_HASHNOTFOUND))
+         return (PF_PAGENOTINBUF);
+      else
+         return (rc);              // unexpected error
+   }
+
+   if (sh.bufTable[slot].pinCount == 0)
+      return (PF_PAGEUNPINNED);
+
+   if ((rc = pLog->Append(type, logNo, pageNum, offset,
+         sh.bufTable[slot].pData + offset,
+         (type == PF_LOGREC_PAGE) ? length : 0, lsn)))
+      return (rc);
+   sh.bufTable[slot].bDirty = TRUE;
+   Logged(sh.bufTable[slot], lsn);
+
+   // Return ok
+   return (0);
+}
+
+//
+// LogFileHdr
+//
+// Desc: Log a change to the header of a file.  The header is written once
+//       the record is on the disk.  Nothing is logged if the file is not.
+// In:   fd - OS file descriptor of the file
+//       pHdr - the header (a copy is logged whole again at checkpoints)
+//       offset, length - the bytes changed
+// Ret:  error writing the log
+//
+// Note: The record is appended and the header copied under the latch of
+// the file, so that a checkpoint logs the header either before the record
+// or with the change in it.
+//
+RC PF_BufferMgr::LogFileHdr(int fd, const char *pHdr, int offset,
+      int length)
+{
+   int logNo = LogNo(fd);
+   PF_LSN lsn;
+   RC rc;
+
+   if (pLog == NULL || logNo < 0)
+      return (0);
+
+   PF_BufFile *pFile = File(fd);
+   pthread_mutex_lock(&pFile->latch);
+   if (!(rc = pLog->Append(PF_LOGREC_HDR, logNo, -1, offset, pHdr + offset,
+         length, lsn))) {
+      pFile->hdrLSN = lsn;
+      if (pFile->pHdr == NULL)
+         pFile->pHdr = new PF_FileHdr;
+      memcpy(pFile->pHdr, pHdr, sizeof(PF_FileHdr));
+   }
+   pthread_mutex_unlock(&pFile->latch);
+
+   return (rc);
+}
+
+//
+// LogImage
+//
+// Desc: Internal.  Log a page changed without a log record whole, once
+//       per dirtying: the page is logged again only if it is marked
+//       dirty again
+// In:   desc - descriptor of the page (its shard latched)
+// Ret:  error writing the log
+//
+RC PF_BufferMgr::LogImage(PF_BufPageDesc &desc)
+{
+   PF_LSN lsn;
+   RC rc;
+
+   if (!desc.bUnlogged)
+      return (0);
+
+   if (pLog != NULL) {
+      if ((rc = pLog->Append(PF_LOGREC_PAGE, LogNo(desc.fd), desc.pageNum,
+            0, desc.pData, pageSize, lsn)))
+         return (rc);
+      Logged(desc, lsn);
+   }
+   desc.bUnlogged = FALSE;
+
+   // Return ok
+   return (0);
+}
+
+//
+// LogPinned
+//
+// Desc: Log the pages changed without a log record that are still
+//       pinned, so that a commit covers them too (the others were logged
+//       when they were unpinned).  The shards are latched one at a time.
+// Ret:  error writing the log
+//
+RC PF_BufferMgr::LogPinned()
+{
+   RC rc = 0;
+
+   for (int i = 0; i < numShards && !rc; i++) {
+      PF_BufShard &sh = shards[i];
+      PF_ShardLatch latch(sh);
+
+      for (int slot = 0; slot < sh.numPages && !rc; slot++)
+         if (sh.bufTable[slot].bValid)
+            rc = LogImage(sh.bufTable[slot]);
+   }
+   return (rc);
+}
+
+//
+// Logged
+//
+// Desc: Internal.  Note that a change to a page was logged
+// In:   desc - descriptor of the page (its shard latched)
+//       lsn - LSN of the record
+//
+void PF_BufferMgr::Logged(PF_BufPageDesc &desc, PF_LSN lsn)
+{
+   desc.pageLSN = lsn;
+   if (desc.recLSN == 0)
+      desc.recLSN = lsn;
+}
+
+//
+// AllocateExtent
+//
+// Desc: Allocate the space for a run of pages of a file on the disk, so
+//       that the file does not have to grow as they are written.  The
+//       pages read as zeros until then.
+// In:   fd - OS file descriptor
+//       pageNum - first page of the run
+//       numPages - # of pages
+// Ret:  PF_READONLY, PF_UNIX
+//
+RC PF_BufferMgr::AllocateExtent(int fd, PageNum pageNum, int numPages)
+{
+   PF_IO *pIO = FileIO(fd);
+   if (pIO == NULL)
+      return (PF_CLOSEDFILE);
+
+   return (pIO->Allocate(pageNum * (off_t)pageSize + PF_FILE_HDR_SIZE,
+         numPages * (off_t)pageSize));
+}
+
+//
+// ReadPage
+//
+// Desc: Read a page from disk
+//
+// In:   fd - OS file descriptor
+//       pageNum - number of page to read
+//       dest - pointer to buffer in which to read page
+// Out:  dest - buffer contains page contents
+// Ret:  PF return code
+//
+RC PF_BufferMgr::ReadPage(int fd, PageNum pageNum, char *dest)
+{
+
+#ifdef PF_LOG
+   char psMessage[100];
+   sprintf (psMessage, "Reading (%d,%d).\n", fd, pageNum);
+   WriteLog(psMessage);
+#endif
+
+#ifdef PF_STATS
+   pStatisticsMgr->Add(PF_STAT_READPAGE);
+   long long start = StatNow();
+#endif
+
+   PF_IO *pIO = FileIO(fd);
+   if (pIO == NULL)
+      return (PF_CLOSEDFILE);
+
+   // Read the data at the page's place in the file
+   off_t offset = pageNum * (off_t)pageSize + PF_FILE_HDR_SIZE;
+   RC rc = pIO->Read(offset, dest, pageSize, PF_INCOMPLETEREAD);
+
+#ifdef PF_STATS
+   pStatisticsMgr->Time(PF_TIME_READ, start);
+#endif
+   return (rc);
+}
+
+//
+// WritePage
+//
+// Desc: Write a page to disk
+//
+// In:   fd - OS file descriptor
+//       pageNum - number of page to write
+//       dest - pointer to buffer containing page contents
+// Ret:  PF return code
+//
+RC PF_BufferMgr::WritePage(int fd, PageNum pageNum, char *source)
+{
+
+#ifdef PF_LOG
+   char psMessage[100];
+   sprintf (psMessage, "Writing (%d,%d).\n", fd, pageNum);
+   WriteLog(psMessage);
+#endif
+
+#ifdef PF_STATS
+   pStatisticsMgr->Add(PF_STAT_WRITEPAGE);
+   pStatisticsMgr->Add(PF_STAT_WRITERUN);
+   CountFile(fd, &PF_FileStats::writeBacks);
+   long long start = StatNow();
+#endif
+
+   PF_IO *pIO = FileIO(fd);
+   if (pIO == NULL)
+      return (PF_CLOSEDFILE);
+
+   // Write the data at the page's place in the file
+   off_t offset = pageNum * (off_t)pageSize + PF_FILE_HDR_SIZE;
+   RC rc = pIO->Write(offset, source, pageSize, PF_INCOMPLETEWRITE);
+
+#ifdef PF_STATS
+   pStatisticsMgr->Time(PF_TIME_WRITE, start);
+#endif
+   return (rc);
+}
+
+//
+// WriteRun
+//
+// Desc: Write consecutive pages to disk with one call
+//
+// In:   fd - OS file descriptor
+//       pageNum - number of the first page to write
+//       iov - the contents of the pages, one buffer per page
+//       numPages - # of pages to write (at most PF_WRITEBACK_RUN)
+// Ret:  PF return code
+//
+RC PF_BufferMgr::WriteRun(int fd, PageNum pageNum, const struct iovec *iov,
+      int numPages)
+{
+
+#ifdef PF_LOG
+   char psMessage[100];
+   sprintf (psMessage, "Writing (%d,%d) to (%d,%d).\n", fd, pageNum,
+         fd, pageNum + numPages - 1);
+   WriteLog(psMessage);
+#endif
+
+#ifdef PF_STATS
+   pStatisticsMgr->Add(PF_STAT_WRITEPAGE, numPages);
+   pStatisticsMgr->Add(PF_STAT_WRITERUN);
+   CountFile(fd, &PF_FileStats::writeBacks, numPages);
+   long long start = StatNow();
+#endif
+
+   PF_IO *pIO = FileIO(fd);
+   if (pIO == NULL)
+      return (PF_CLOSEDFILE);
+
+   // Write the data at the place of the first page in the file
+   off_t offset = pageNum * (off_t)pageSize + PF_FILE_HDR_SIZE;
+   RC rc = pIO->WriteV(offset, iov, numPages, PF_INCOMPLETEWRITE);
+
+#ifdef PF_STATS
+   pStatisticsMgr->Time(PF_TIME_WRITE, start);
+#endif
+   return (rc);
+}
+
+
+//
+// WriteDirty
+//
+// Desc: Internal.  Write back the dirty pages of a file.  The pages are
+//       sorted by page number, and every run of consecutive pages (up to
+//       PF_WRITEBACK_RUN of them) is written with one call.  The pages
+//       written are clean afterwards.
+//       For ALL_PAGES every shard must be latched, otherwise the shard of
+//       the page.
+// In:   fd - OS file descriptor
+//       pageNum - the page to write, or ALL_PAGES
+//       bPinned - write pinned pages too
+// Ret:  PF return code
+//
+RC PF_BufferMgr::WriteDirty(int fd, PageNum pageNum, int bPinned)
+{
+   RC rc = 0;
+   PF_WriteEntry *pEntries;
+   struct iovec iov[PF_WRITEBACK_RUN];
+   int numEntries = 0;
+   int i, j, n;
+   int first = 0, last = numPages;   // range of slots to look at
+   PF_LSN lastLSN = 0;               // last log record of their changes
+
+   if (pageNum != ALL_PAGES) {
+      PF_BufShard &sh = Shard(fd, pageNum);
+      first = sh.first;
+      last = sh.first + sh.numPages;
+   }
+
+   // Collect the pages to write and sort them (pinned pages changed
+   // without a log record are logged first)
+   pEntries = new PF_WriteEntry[last - first];
+   for (int slot = first; slot < last && !rc; slot++)
+      if (bufTable[slot].bValid && bufTable[slot].fd == fd &&
+            bufTable[slot].bDirty &&
+            (bPinned || bufTable[slot].pinCount == 0) &&
+            (pageNum == ALL_PAGES || bufTable[slot].pageNum == pageNum) &&
+            !(rc = LogImage(bufTable[slot]))) {
+         pEntries[numEntries].pageNum = bufTable[slot].pageNum;
+         pEntries[numEntries].slot = slot;
+         numEntries++;
+         if (bufTable[slot].pageLSN > lastLSN)
+            lastLSN = bufTable[slot].pageLSN;
+      }
+   qsort(pEntries, numEntries, sizeof(PF_WriteEntry), PF_CompareWriteEntry);
+
+   // One flush of the log covers all of them
+   if (rc || (rc = LogAhead(lastLSN))) {
+      delete [] pEntries;
+      return (rc);
+   }
+
+   // Write them a run at a time
+   for (i = 0; i < numEntries && !rc; i += n) {
+      for (n = 0; i + n < numEntries && n < PF_WRITEBACK_RUN &&
+            pEntries[i + n].pageNum == pEntries[i].pageNum + n; n++) {
+         iov[n].iov_base = bufTable[pEntries[i + n].slot].pData;
+         iov[n].iov_len = pageSize;
+      }
+
+      if (!(rc = WriteRun(fd, pEntries[i].pageNum, iov, n)))
+         for (j = i; j < i + n; j++)
+            PF_Cleaned(bufTable[pEntries[j].slot]);
+   }
+
+   delete [] pEntries;
+   return (rc);
+}
+
+
+//
+// SyncFile
+//
+// Desc: Internal.  Make sure what was written to a file is on the disk
+// In:   fd - OS file descriptor
+// Ret:  PF_UNIX
+//
+RC PF_BufferMgr::SyncFile(int fd)
+{
+   PF_IO *pIO = FileIO(fd);
+   if (pIO == NULL)
+      return (PF_CLOSEDFILE);
+
+   return (pIO->Sync());
+}
+
+
+//
+// InitPageDesc
+//
+// Desc: Internal.  Initialize PF_BufPageDesc to a newly-pinned page
+//       for a newly pinned page
+// In:   sh - shard of the slot
+//       fd - file descriptor
+//       pageNum - page number
+// Ret:  PF return code
+//
+RC PF_BufferMgr::InitPageDesc(PF_BufShard &sh, int fd, PageNum pageNum,
+      int slot)
+{
+   PF_BufPageDesc *bufTable = sh.bufTable;
+
+   // set the slot to refer to a newly-pinned page
+   bufTable[slot].fd       = fd;
+   bufTable[slot].pageNum  = pageNum;
+   bufTable[slot].bDirty   = FALSE;
+   bufTable[slot].pinCount = 1;
+   bufTable[slot].bValid   = TRUE;
+   bufTable[slot].bRing    = FALSE;
+   bufTable[slot].bReading = FALSE;
+   bufTable[slot].bPrefetched = FALSE;
+   bufTable[slot].bWriting = FALSE;
+   bufTable[slot].pageLSN  = 0;
+   bufTable[slot].recLSN   = 0;
+   bufTable[slot].bUnlogged = FALSE;
+   if (sh.pCurve != NULL && fd != MEMORY_FD)
+      sh.pCurve->Used(slot);
+
+   // Return ok
+   return (0);
+}
+
+//
+// CountHit
+//
+// Desc: Internal.  Count a request for the page in slot, which was in the
+//       buffer, in the miss-ratio curve of the shard, if it is kept: at the
+//       # of pages of the shard used since it was last used.  (Misses are
+//       counted by PF_MissCurve::Miss before a slot is found for the page.)
+// In:   sh - shard (latched) of the slot
+//       slot - slot of the page
+//
+void PF_BufferMgr::CountHit(PF_BufShard &sh, int slot)
+{
+   if (sh.pCurve != NULL)
+      sh.pCurve->Hit(slot);
+}
+
+//
+// CompleteRead
+//
+// Desc: Internal.  The read-ahead of the page in slot is over.  If it
+//       failed, the page leaves the buffer.
+// In:   sh - shard (latched) of the slot
+//       slot - slot of the page
+//       rc - result of the read
+// Ret:  rc
+//
+RC PF_BufferMgr::CompleteRead(PF_BufShard &sh, int slot, RC rc)
+{
+   sh.bufTable[slot].bReading = FALSE;
+   if (rc) {
+      sh.pHashTable->Delete(sh.bufTable[slot].fd, sh.bufTable[slot].pageNum);
+      sh.pReplacer->Remove(slot);
+      InsertFree(sh, slot);
+   }
+   return (rc);
+}
+
+//
+// CleanTail
+//
+// Desc: Internal.  The page cleaner.  Looks at the cleanTarget % of the
+//       pages of the shard that the replacement policy would replace next
+//       (counting those it writes already), and starts writing those that
+//       are dirty.  They stay in the buffer; while they are written they
+//       cannot be replaced, and GetPage waits for the write.  Pages of
+//       files not attached (blocks) are left alone.
+// In:   sh - shard (latched) to clean
+//
+void PF_BufferMgr::CleanTail(PF_BufShard &sh)
+{
+   PF_BufPageDesc *bufTable = sh.bufTable;
+   int numClean = sh.numPages * cleanTarget / 100;
+   int num, i, slot;
+   PF_IO *pIO;
+
+   if (cleanTarget > 0 && numClean == 0)
+      numClean = 1;
+   if (numClean == 0)
+      return;
+
+   num = sh.pReplacer->NextVictims(bufTable, sh.cleanSlots, numClean);
+   for (i = 0; i < num && !pCleaner->Full(); i++) {
+      slot = sh.cleanSlots[i];
+      if (!bufTable[slot].bDirty || bufTable[slot].bWriting ||
+            (pIO = FileIO(bufTable[slot].fd)) == NULL)
+         continue;
+
+      // Not before the log is on the disk: the log writer is asked for
+      // it, and the page is written the next time round
+      if (pLog && !pLog->OnDisk(bufTable[slot].pageLSN))
+         continue;
+
+      // The write is settled (IODone) under the latch we hold
+      off_t offset = bufTable[slot].pageNum * (off_t)pageSize +
+         PF_FILE_HDR_SIZE;
+      if (pCleaner->Submit(sh.first + slot, TRUE, pIO, offset,
+            bufTable[slot].pData, pageSize))
+         break;
+      bufTable[slot].bWriting = TRUE;
+      sh.numIO++;
+      sh.numWriting++;
+
+#ifdef PF_LOG
+      char psMessage[100];
+      sprintf (psMessage, "Cleaning (%d,%d).\n", bufTable[slot].fd,
+            bufTable[slot].pageNum);
+      WriteLog(psMessage);
+#endif
+
+#ifdef PF_STATS
+      pStatisticsMgr->Add(PF_STAT_WRITEPAGE);
+      pStatisticsMgr->Add(PF_STAT_WRITERUN);
+      pStatisticsMgr->Add(PF_STAT_CLEANPAGE);
+      CountFile(bufTable[slot].fd, &PF_FileStats::writeBacks);
+#endif
+   }
+}
+
+//
+// CompleteWrite
+//
+// Desc: Internal.  The cleaner is done writing the page in slot.  If the
+//       write failed, the page is still dirty: it is written again when
+//       it is replaced or flushed, and the error shows up then.
+// In:   sh - shard (latched) of the slot
+//       slot - slot of the page
+//       rc - result of the write
+// Ret:  rc
+//
+RC PF_BufferMgr::CompleteWrite(PF_BufShard &sh, int slot, RC rc)
+{
+   sh.bufTable[slot].bWriting = FALSE;
+   if (!rc)
+      PF_Cleaned(sh.bufTable[slot]);
+   return (rc);
+}
+
+//
+// IODone
+//
+// Desc: Internal.  Completion function of the read-ahead and cleaner
+//       threads: settle the transfer under the latch of its shard and
+//       wake up whoever waits for it.
+// In:   pBufferMgr - the buffer manager
+//       slot - buffer slot of the page transferred
+//       bWrite - TRUE for a cleaner write, FALSE for a read-ahead
+//       rc - result of the transfer
+//
+void PF_BufferMgr::IODone(void *pBufferMgr, int slot, int bWrite, RC rc)
+{
+   PF_BufferMgr *pBufMgr = (PF_BufferMgr *)pBufferMgr;
+
+   // The shards cannot change while a transfer is going on
+   PF_BufShard &sh = pBufMgr->SlotShard(slot);
+   PF_ShardLatch latch(sh);
+
+   if (bWrite) {
+      pBufMgr->CompleteWrite(sh, slot - sh.first, rc);
+      sh.numWriting--;
+   }
+   else
+      pBufMgr->CompleteRead(sh, slot - sh.first, rc);
+   sh.numIO--;
+   pthread_cond_broadcast(&sh.ioDone);
+}
+
+//------------------------------------------------------------------------------
 // Methods for manipulating raw memory buffers
 //------------------------------------------------------------------------------
 
-#define MEMORY_FD -1
-
 //
 // GetBlockSize
 //
@@ -937,34 +3325,49 @@ RC PF_BufferMgr::GetBlockSize(int &length) const
 //
 // Allocates a page in the buffer pool that is not associated with a
 // particular file and returns the pointer to the data area back to the
-// user.
+// user.  The shards are tried in turn, starting with the one after the
+// shard the last block came from.
 //
 RC PF_BufferMgr::AllocateBlock(char *&buffer)
 {
    RC rc = OK_RC;
+   int start = (int)((unsigned int)__sync_fetch_and_add(&nextBlockShard, 1)
+         % (unsigned int)numShards);
+
+   for (int i = 0; i < numShards; i++) {
+      PF_BufShard &sh = shards[(start + i) % numShards];
+      PF_ShardLatch latch(sh);
+
+      // Get an empty slot from the buffer pool
+      int slot;
+      if ((rc = InternalAlloc(sh, slot, MEMORY_FD, 0)) == PF_NOBUF)
+         continue;
+      if (rc != OK_RC)
+         return rc;
+
+      // Create artificial page number (just needs to be unique for hash
+      // table): the buffer slot number
+      PageNum pageNum = sh.first + slot;
+
+      // Insert the page into the hash table, and initialize the page description entry
+      if ((rc = sh.pHashTable->Insert(MEMORY_FD, pageNum, slot) != OK_RC) ||
+            (rc = InitPageDesc(sh, MEMORY_FD, pageNum, slot)) != OK_RC) {
+         // Put the slot back on the free list before returning the error
+         InsertFree(sh, slot);
+         return rc;
+      }
 
-   // Get an empty slot from the buffer pool
-   int slot;
-   if ((rc = InternalAlloc(slot)) != OK_RC)
-      return rc;
+      // Blocks are replaced like any other page once disposed of
+      sh.pReplacer->Admit(slot, MEMORY_FD, pageNum);
 
-   // Create artificial page number (just needs to be unique for hash table)
-   PageNum pageNum = PageNum(bufTable[slot].pData);
+      // Return pointer to buffer
+      buffer = sh.bufTable[slot].pData;
 
-   // Insert the page into the hash table, and initialize the page description entry
-   if ((rc = hashTable.Insert(MEMORY_FD, pageNum, slot) != OK_RC) ||
-         (rc = InitPageDesc(MEMORY_FD, pageNum, slot)) != OK_RC) {
-      // Put the slot back on the free list before returning the error
-      Unlink(slot);
-      InsertFree(slot);
-      return rc;
+      // Return success code
+      return OK_RC;
    }
 
-   // Return pointer to buffer
-   buffer = bufTable[slot].pData;
-
-   // Return success code
-   return OK_RC;
+   return PF_NOBUF;
 }
 
 //
@@ -974,5 +3377,35 @@ RC PF_BufferMgr::AllocateBlock(char *&buffer)
 //
 RC PF_BufferMgr::DisposeBlock(char* buffer)
 {
-   return UnpinPage(MEMORY_FD, PageNum(buffer));
+   int slot;
+
+   // Blocks normally sit in their own frame of the arena; after a resize
+   // they may still be in a frame of a retired arena.  The arena and the
+   // slots of the shards only change with every shard latched.
+   for (int pass = 0; pass < 2; pass++)
+      for (int i = 0; i < numShards; i++) {
+         PF_BufShard &sh = shards[i];
+         PF_ShardLatch latch(sh);
+         int first = 0, last = sh.numPages;
+
+         if (pass == 0) {
+            if (buffer < arena.base || buffer >= arena.base + arena.size ||
+                  (buffer - arena.base) % frameSize != 0)
+               break;
+            slot = (int)((buffer - arena.base) / frameSize) - sh.first;
+            if (slot < 0 || slot >= sh.numPages)
+               continue;
+            first = slot;
+            last = slot + 1;
+         }
+         for (slot = first; slot < last; slot++)
+            if (sh.bufTable[slot].pData == buffer &&
+                  sh.bufTable[slot].bValid &&
+                  sh.bufTable[slot].fd == MEMORY_FD)
+               return (UnpinSlot(sh, slot));
+         if (pass == 0)
+            break;
+      }
+
+   return (PF_PAGENOTINBUF);
 }
@@ -10,11 +10,34 @@
 // 1998: Allow chunks from the buffer manager to not be associated with
 // a particular file.  Allows students to use main memory chunks that
 // are associated with (and limited by) the buffer.
+// The choice of the page to replace is delegated to a PF_Replacer (see
+// pf_replacement.h).  The MRU/LRU list is now private to the LRU policy.
+// The buffer pages are carved out of one mmap'ed arena (see PF_Arena).
+// Pages of a scan are read ahead asynchronously (see pf_asyncio.h).
+// Flushes write the dirty pages of a file sorted, runs of consecutive
+// pages at once.
+// A page cleaner writes the dirty pages next in line for replacement in
+// the background, so that a page fault rarely has to write one first.
+// The buffer is split into shards, each with its own latch, so that
+// several threads may use it at once (see PF_BufShard).
+// Files are extended on disk an extent at a time (AllocateExtent).
+// The size of the pages is a parameter: PF_Manager has a buffer manager
+// for each page size.
+// AttachFile stacks a compressing backend on those of compressed files.
+// Hits, misses, evictions and writes are counted for each file too.
+// A resize keeps the pages that fit in the new buffer.
+// ResidentPages lists the pages of a file coldest first (for warm-up).
+// Each shard keeps a miss-ratio curve of its page requests.
+// With a write-ahead log (SetLog), a page is written only once the log
+// records of its changes are on the disk.
+// Checkpoints list the dirty pages a shard at a time, and write those
+// dirty for long.
 //
 
 #ifndef PF_BUFFERMGR_H
 #define PF_BUFFERMGR_H
 
+#include <pthread.h>
 #include "pf_internal.h"
 #include "pf_hashtable.h"
 
@@ -22,23 +45,160 @@
 // Defines
 //
 
-// INVALID_SLOT is used within the PF_BufferMgr class which tracks a list
-// of PF_BufPageDesc.  Inside the PF_BufPageDesc are integer "pointers" to
+// INVALID_SLOT is used within the PF_BufferMgr class which tracks lists
+// of PF_BufPageDesc.  Lists are threaded through integer "pointers" to
 // next and prev items.  INVALID_SLOT is used to indicate no previous or
 // next.
 #define INVALID_SLOT  (-1)
 
+// MEMORY_FD is the file descriptor of the blocks handed out by
+// AllocateBlock.  Their page number is the (buffer wide) slot they were
+// allocated in.
+#define MEMORY_FD     (-1)
+
 //
 // PF_BufPageDesc - struct containing data about a page in the buffer
 //
 struct PF_BufPageDesc {
     char       *pData;      // page contents
-    int        next;        // next in the linked list of buffer pages
-    int        prev;        // prev in the linked list of buffer pages
+    int        next;        // next in the free list of buffer pages
+    int        bValid;      // TRUE if the slot holds a page
     int        bDirty;      // TRUE if page is dirty
     short int  pinCount;    // pin count
     PageNum    pageNum;     // page number for this page
     int        fd;          // OS file descriptor of this page
+    int        bRing;       // TRUE if loaded by a scan into the ring
+    int        bReading;    // TRUE while the page is read from disk
+    int        bPrefetched; // TRUE if read ahead and not asked for yet
+    int        bWriting;    // TRUE while the cleaner writes the page
+    PF_LSN     pageLSN;     // last log record of a change of the page
+    PF_LSN     recLSN;      // first one since the page was last clean
+    int        bUnlogged;   // changed without a log record: the whole
+                            //   page is logged once (see LogImage)
+};
+
+//
+// PF_Unpinned - TRUE if the page is in line for replacement: not pinned
+// and not being read (it may be being written by the cleaner)
+//
+inline int PF_Unpinned(const PF_BufPageDesc &desc)
+{
+    return (desc.pinCount == 0 && !desc.bReading);
+}
+
+//
+// PF_Evictable - TRUE if the replacer may choose this page as a victim
+//
+inline int PF_Evictable(const PF_BufPageDesc &desc)
+{
+    return (PF_Unpinned(desc) && !desc.bWriting);
+}
+
+//
+// PF_Cleaned - the page was written: it is clean, and no log record has
+// to be written before it is written again
+//
+inline void PF_Cleaned(PF_BufPageDesc &desc)
+{
+    desc.bDirty = FALSE;
+    desc.pageLSN = desc.recLSN = 0;
+}
+
+class PF_Replacer;
+class PF_IO;
+struct iovec;
+class PF_AsyncIO;
+class PF_MissCurve;
+class PF_LogMgr;
+struct PF_DirtyPage;
+
+//
+// PF_BufFile - what the buffer manager knows about an open file
+//
+// The buffer manager keeps one entry per OS file descriptor, from
+// AttachFile to DetachFile.  It also follows the pages a scan of the file
+// goes through, to see whether it is worth reading ahead.
+// The pages of a file opened with PF_IO_MMAP never enter the buffer: they
+// are used in place in the mapping, and only their pins are counted here.
+//
+// The entries are looked up on every pin, so they are read without a
+// latch: what describes the file is only written by AttachFile and
+// DetachFile (pIO last and first), the pins of mapped pages are counted
+// atomically, and what changes while the file is in use has a latch of
+// its own.
+//
+struct PF_BufFile {
+    PF_IO      *pIO;        // I/O backend, NULL if the fd is not attached
+    short int  *mapPins;    // mapped file: pin count of each page, else NULL
+    PageNum    numMapped;   // mapped file: # of pages in the mapping
+    PF_FileStats *pStats;   // where the buffer counts its work for the
+                            //   file, NULL if nowhere
+    int        logNo;       // # of the file in the log, -1 if its changes
+                            //   are not logged
+    pthread_mutex_t latch;  // protects the rest
+    PageNum    lastPage;    // last page seen by ReadAhead
+    int        run;         // # of steps of +1 (> 0) or -1 (< 0) ending
+                            //   at lastPage
+    PageNum    raEnd;       // read-ahead was issued up to (excluding)
+                            //   raEnd, in the direction of run
+    PF_LSN     hdrLSN;      // last log record of a change of its header
+    PF_FileHdr *pHdr;       // copy of the header as last logged (NULL:
+                            //   not yet)
+};
+
+//
+// PF_BufShard - one independently latched part of the buffer
+//
+// A page belongs to the shard its (fd, pageNum) hashes to.  Each shard
+// owns a range of the buffer slots and is in effect a small buffer of
+// its own: hash table, free list, replacement policy and scan ring only
+// ever see the slots of the shard, numbered from 0 (slot i of the shard
+// is slot first + i of the buffer).  The latch of the shard protects all
+// of these and the page descriptors of its slots.
+//
+// Pages are read and written without the latch.  While that happens the
+// page is marked bReading or bWriting; whoever wants the page waits on
+// ioDone for the transfer to be over.  The calls that work on the whole
+// buffer wait for these transfers and waiting threads to be over first.
+// A buffer keeps its shards (and their latches) when it is resized.
+//
+struct PF_BufShard {
+    pthread_mutex_t latch;                      // latch of the shard
+    pthread_cond_t  ioDone;                     // a transfer is over
+    PF_BufPageDesc  *bufTable;                  // its part of the buffer
+    int             first;                      // buffer slot of slot 0
+    int             numPages;                   // # of slots of the shard
+    int             free;                       // head of free list
+    PF_HashTable    *pHashTable;                // (fd, pageNum) -> slot
+    PF_Replacer     *pReplacer;                 // replacement policy
+    int             ring[PF_RING_SIZE];         // slots recycled by scans
+    int             ringSize;                   // # of ring entries used
+    int             ringPos;                    // next ring entry to reuse
+    int             numIO;                      // pages being transferred
+    int             numWriting;                 //   of which cleaner writes
+    int             numWaiting;                 // threads waiting on ioDone
+    int             numLatched;                 // page latches held or
+                                                //   waited for (LatchPage)
+    int             *cleanSlots;                // candidates of CleanTail
+    PF_MissCurve    *pCurve;                    // miss-ratio curve, NULL
+                                                //   if it is not kept
+};
+
+//
+// PF_Arena - one contiguous mapping holding the buffer pages
+//
+// Page i of the buffer lives at base + i * frameSize.  frameSize is the
+// page size rounded up to PF_FRAME_ALIGN, so that every frame is aligned
+// for direct I/O.  When the buffer is resized, pages that are pinned keep
+// their frame in the old arena (their address is in use); the old arena
+// is then kept on a list of retired arenas until the last of these pages
+// leaves the buffer.
+//
+struct PF_Arena {
+    char       *base;       // start of the mapping
+    size_t     size;        // length of the mapping
+    int        numUsed;     // retired arenas: # of frames still in use
+    PF_Arena   *next;       // next retired arena
 };
 
 //
@@ -47,31 +207,113 @@ struct PF_BufPageDesc {
 class PF_BufferMgr {
 public:
 
-    PF_BufferMgr     (int numPages);             // Constructor - allocate
-                                                  // numPages buffer pages
+    PF_BufferMgr     (int numPages,              // Constructor - allocate
+                      PF_ReplacePolicy policy = PF_REPLACE_LRU,
+                      int numShards = 0,         // numPages buffer pages
+                                                  // (0 shards: by size)
+                      int pageSize = PF_PAGE_SIZE);   // of pageSize bytes
     ~PF_BufferMgr    ();                         // Destructor
 
     // Read pageNum into buffer, point *ppBuffer to location
     RC  GetPage      (int fd, PageNum pageNum, char **ppBuffer,
-                      int bMultiplePins = TRUE);
+                      int bMultiplePins = TRUE,
+                      ClientHint hint = NO_HINT);
     // Allocate a new page in the buffer, point *ppBuffer to its location
     RC  AllocatePage (int fd, PageNum pageNum, char **ppBuffer);
 
     RC  MarkDirty    (int fd, PageNum pageNum);  // Mark page dirty
     RC  UnpinPage    (int fd, PageNum pageNum);  // Unpin page from the buffer
-    RC  FlushPages   (int fd);                   // Flush pages for file
+    RC  FlushPages   (int fd,                    // Flush pages for file,
+                      int bSync = FALSE);        //   bSync: fdatasync too
+
+    // Start reading a page into the buffer without waiting for it
+    RC  Prefetch     (int fd, PageNum pageNum, ClientHint hint = NO_HINT);
+    // A scan is at pageNum (of numFilePages): read ahead if it pays
+    void ReadAhead   (int fd, PageNum pageNum, PageNum numFilePages,
+                      ClientHint hint);
+
+    // Latch a pinned page for reading (shared) or writing (exclusive);
+    // the latches are only taken by clients, never by the buffer manager
+    RC  LatchPage    (int fd, PageNum pageNum, int bExclusive);
+    RC  UnlatchPage  (int fd, PageNum pageNum);
+
+    // Start and stop doing I/O for an open file
+    RC  AttachFile   (int fd, PF_IOMode ioMode,  // (bCompressed: its pages
+                      int bCompressed = FALSE,   //   are compressed; count
+                      PF_FileStats *pStats = NULL,   //   in pStats; log
+                      int logNo = -1);           //   its changes as logNo)
+    RC  DetachFile   (int fd);
+    // Write the file header through the file's I/O backend
+    RC  WriteFileHdr (int fd, const char *source, int length);
+
+    // Log a change to length bytes at offset of a pinned page (its header
+    // included) as a record of type: PF_LOGREC_PAGE with the bytes,
+    // PF_LOGREC_ALLOC without; and mark the page dirty.  Log a change to
+    // length bytes at offset of the file header (pHdr).  Changes to files
+    // that are not logged are only marked dirty, or nothing.
+    RC  LogChange    (int fd, PageNum pageNum, int type, int offset,
+                      int length);
+    RC  LogFileHdr   (int fd, const char *pHdr, int offset, int length);
+    // Allocate disk space for numPages pages from pageNum on
+    RC  AllocateExtent(int fd, PageNum pageNum, int numPages);
 
     // Force a page to the disk, but do not remove from the buffer pool
-    RC ForcePages    (int fd, PageNum pageNum);
+    // (bSync: and make sure it is on the disk with fdatasync)
+    RC ForcePages    (int fd, PageNum pageNum, int bSync = FALSE);
+
 
+    // The following calls work on the whole buffer.  They wait for the
+    // other threads to leave the shards.
 
     // Remove all entries from the Buffer Manager.
     RC  ClearBuffer  ();
     // Display all entries in the buffer
     RC PrintBuffer   ();
+    // Add the pages of each file in the buffer to the residentPages of
+    // its PF_FileStats
+    void CountResident();
+    // Unpinned pages of fd in the buffer, coldest first (the shards are
+    // latched one at a time)
+    RC ResidentPages (int fd, PageNum *&pPages, int &numPages);
+
+    // Miss-ratio curve (see PF_MissCurve), only kept once KeepCurve turns
+    // it on: # of pages asked for since it was reset, and how many of
+    // them a buffer of size pages would have found in it.  PrintCurve
+    // displays it.
+    void KeepCurve   (int bKeep);
+    int CurveRequests();
+    int CurveHits    (int size);
+    void ResetCurve  ();
+    RC PrintCurve    ();
 
-    // Attempts to resize the buffer to the new size
+    // Attempts to resize the buffer to the new size (refused while a
+    // page is latched)
     RC ResizeBuffer  (int iNewSize);
+    // # of shards, kept by resizes: the buffer has at least as many pages
+    int NumShards    () const;
+
+    // Switch to another page replacement policy
+    RC SetReplacePolicy(PF_ReplacePolicy policy);
+
+    // Percentage of the buffer the page cleaner keeps clean (0: none)
+    RC SetCleanTarget(int percent);
+
+    // Write-ahead log of the changes to the pages (NULL: none).  Pages
+    // of files attached with a logNo that are marked dirty without a log
+    // record are logged whole once per dirtying: when their last pin is
+    // released, or by LogPinned if they are still pinned at a commit.
+    void SetLog      (PF_LogMgr *pLog);
+    RC LogPinned     ();
+
+    // For a checkpoint, while the buffer is in use: list the dirty pages
+    // of logged files (pPages is a new array of numPages, the caller
+    // deletes it), log the headers of logged files whole, write the
+    // unpinned pages that were first changed before lsn, and fdatasync
+    // the logged files
+    RC DirtyPages    (PF_DirtyPage *&pPages, int &numPages);
+    RC LogFileHdrs   ();
+    RC CleanOld      (PF_LSN lsn);
+    RC SyncFiles     ();
 
     // Three Methods for manipulating raw memory buffers.  These memory
     // locations are handled by the buffer manager, but are not
@@ -87,27 +329,115 @@ public:
     RC DisposeBlock  (char *buffer);
 
 private:
-    RC  InsertFree   (int slot);                 // Insert slot at head of free
-    RC  LinkHead     (int slot);                 // Insert slot at head of used
-    RC  Unlink       (int slot);                 // Unlink slot
-    RC  InternalAlloc(int &slot);                // Get a slot to use
+    // Shard of page (fd, pageNum), shard of buffer slot slot
+    PF_BufShard &Shard     (int fd, PageNum pageNum) const;
+    PF_BufShard &SlotShard (int slot) const;
+    // Latch every shard once it has no transfer going on, and unlatch
+    void LatchAll    ();
+    void UnlatchAll  ();
+    // Build and take down the contents of the shards over a buffer table
+    // of numPages slots (not their latches)
+    void InitShards  (PF_BufShard *pShards, PF_BufPageDesc *pTable,
+                      int numPages);
+    void FreeShards  (PF_BufShard *pShards);
+
+    RC  InsertFree   (PF_BufShard &sh,           // Insert slot at head of
+                      int slot);                 //   free
+    RC  InternalAlloc(PF_BufShard &sh,           // Get a slot to use for
+                      int &slot,                 //   page (fd, pageNum)
+                      int fd, PageNum pageNum);
+    RC  RingAlloc    (PF_BufShard &sh,           // Same, for a scan: reuse
+                      int &slot,                 //   the scan ring if we can
+                      int fd, PageNum pageNum);
+    RC  WriteVictim  (PF_BufShard &sh,           // Write the dirty page of
+                      int slot);                 //   slot without the latch
+    void HomeFrame   (PF_BufShard &sh,           // Give slot back its own
+                      int slot);                 //   frame in the arena
+    void ReleaseFrame(char *pData);              // Frame pData is unused
+    // Remove the unpinned pages of a shard
+    RC  ClearShard   (PF_BufShard &sh);
+    // Line up the unpinned pages of the buffer, coldest first
+    int LineUp       (int *pOrder);
+    // Wait for the transfers of the shard to be over, and for one of them
+    // in the middle of a request
+    void WaitIO      (PF_BufShard &sh);
+    void WaitShard   (PF_BufShard &sh);
+    // Unpin the page of slot of a shard
+    RC  UnpinSlot    (PF_BufShard &sh, int slot);
 
     // Read a page
     RC  ReadPage     (int fd, PageNum pageNum, char *dest);
 
     // Write a page
     RC  WritePage    (int fd, PageNum pageNum, char *source);
+    // Write numPages consecutive pages, from pageNum on, from iov
+    RC  WriteRun     (int fd, PageNum pageNum, const struct iovec *iov,
+                      int numPages);
+    // Write the dirty pages of fd (pageNum or ALL_PAGES) in file order
+    // (all shards latched)
+    RC  WriteDirty   (int fd, PageNum pageNum, int bPinned);
+    // fdatasync fd
+    RC  SyncFile     (int fd);
+
+    // Entry of fd in the file table (NULL if it has none yet), and the
+    // same if fd is attached (else NULL); no latch is taken
+    PF_BufFile *FileEntry(int fd) const;
+    PF_BufFile *File (int fd) const;
+    // I/O backend of fd, or NULL if fd is not attached
+    PF_IO *FileIO    (int fd);
+    // # of fd in the log, -1 if it is not attached or not logged
+    int LogNo        (int fd);
+    // Get the log records of changes to a page on the disk before the page
+    // is written
+    RC  LogAhead     (PF_LSN lsn);
+    // Log a page changed without a log record whole
+    RC  LogImage     (PF_BufPageDesc &desc);
+    // The change to a page of slot was logged at lsn
+    void Logged      (PF_BufPageDesc &desc, PF_LSN lsn);
+    // Statistics of fd, or NULL if fd is not attached or has none
+    PF_FileStats *FileStats(int fd);
+    // Add n to one of the counts (hits, ...) of the statistics of fd
+    void CountFile   (int fd, int PF_FileStats::*pCount, int n = 1);
+    // If fd is mapped, pin, unpin or check a page of it
+    int MapPin       (int fd, PageNum pageNum, int delta, char **ppBuffer,
+                      RC &rc);
 
     // Init the page desc entry
-    RC  InitPageDesc (int fd, PageNum pageNum, int slot);
+    RC  InitPageDesc (PF_BufShard &sh, int fd, PageNum pageNum, int slot);
+    // Count a request for the page in slot, found in the buffer, in the
+    // miss-ratio curve
+    void CountHit    (PF_BufShard &sh, int slot);
+
+    // Read-ahead of slot is over with result rc: settle the page
+    RC  CompleteRead (PF_BufShard &sh, int slot, RC rc);
+    // Start writing the dirty pages next in line for replacement
+    void CleanTail   (PF_BufShard &sh);
+    // Cleaner write of slot is over with result rc: settle the page
+    RC  CompleteWrite(PF_BufShard &sh, int slot, RC rc);
+    // Completion function of the I/O threads
+    static void IODone (void *pBufferMgr, int slot, int bWrite, RC rc);
 
     PF_BufPageDesc *bufTable;                     // info on buffer pages
-    PF_HashTable   hashTable;                     // Hash table object
+    pthread_rwlock_t *latches;                    // page latches, by slot
+    PF_BufShard    *shards;                       // the shards
+    int            numShards;                     // # of shards
+    int            bCurve;                        // miss-ratio curve kept
+    PF_Arena       arena;                         // memory of buffer pages
+    PF_Arena       *pRetired;                     // arenas left by resizes
+    pthread_mutex_t retiredLatch;                 // protects pRetired
+    PF_BufFile     *fileChunks[PF_FILE_CHUNKS];   // open files, by fd, in
+                                                  //   chunks of PF_FILE_CHUNK
+    pthread_mutex_t filesLatch;                   // serializes AttachFile
+                                                  //   and DetachFile
+    int            frameSize;                     // distance between frames
+    PF_ReplacePolicy policy;                      // which policy
     int            numPages;                      // # of pages in the buffer
     int            pageSize;                      // Size of pages in the buffer
-    int            first;                         // MRU page slot
-    int            last;                          // LRU page slot
-    int            free;                          // head of free list
+    PF_AsyncIO     *pReader;                      // does the read-ahead
+    PF_AsyncIO     *pCleaner;                     // writes pages to replace
+    int            cleanTarget;                   // % of pages kept clean
+    PF_LogMgr      *pLog;                         // write-ahead log
+    int            nextBlockShard;                // where to try AllocateBlock
 };
 
 #endif
@@ -0,0 +1,211 @@
+//
+// File:        pf_compress.cc
+// Description: Block codec for compressed PF pages
+//
+
+#include <cstring>
+#include "redbase.h"
+#include "pf_compress.h"
+
+//
+// Defines
+//
+#define PF_MIN_MATCH     4            // shortest match
+#define PF_MAX_DISTANCE  65535        // farthest match
+#define PF_HASH_BITS     12           // size of the match finder's table
+
+typedef unsigned char uchar;
+
+//
+// Read4, Hash4
+//
+// Desc: The 4 bytes at p, and their slot in the match finder's table
+//
+static inline unsigned int Read4(const uchar *p)
+{
+   unsigned int v;
+   memcpy(&v, p, sizeof(v));
+   return (v);
+}
+
+static inline unsigned int Hash4(const uchar *p)
+{
+   return ((Read4(p) * 2654435761U) >> (32 - PF_HASH_BITS));
+}
+
+//
+// PutLength
+//
+// Desc: Write the part of a length that did not fit in its 4 bits of the
+//       token (length >= 15)
+// Ret:  TRUE, or FALSE if there is no room before end
+//
+static int PutLength(uchar *&op, const uchar *end, int length)
+{
+   for (length -= 15; length >= 255; length -= 255) {
+      if (op >= end)
+         return (FALSE);
+      *op++ = 255;
+   }
+   if (op >= end)
+      return (FALSE);
+   *op++ = (uchar)length;
+   return (TRUE);
+}
+
+//
+// PutSequence
+//
+// Desc: Write a sequence: numLiterals literals from pLiterals, then a
+//       match of matchLength bytes distance back (no match if
+//       matchLength is 0)
+// Ret:  TRUE, or FALSE if there is no room before end
+//
+static int PutSequence(uchar *&op, const uchar *end, const uchar *pLiterals,
+      int numLiterals, int distance, int matchLength)
+{
+   int matchCode = matchLength ? matchLength - PF_MIN_MATCH : 0;
+
+   if (op >= end)
+      return (FALSE);
+   *op++ = (uchar)(((numLiterals < 15 ? numLiterals : 15) << 4) |
+         (matchCode < 15 ? matchCode : 15));
+   if (numLiterals >= 15 && !PutLength(op, end, numLiterals))
+      return (FALSE);
+
+   if (end - op < numLiterals)
+      return (FALSE);
+   memcpy(op, pLiterals, numLiterals);
+   op += numLiterals;
+
+   if (matchLength) {
+      if (end - op < 2)
+         return (FALSE);
+      *op++ = (uchar)(distance & 0xFF);
+      *op++ = (uchar)(distance >> 8);
+      if (matchCode >= 15 && !PutLength(op, end, matchCode))
+         return (FALSE);
+   }
+   return (TRUE);
+}
+
+//
+// PF_Compress
+//
+// Desc: Compress a block.  Matches are found through a table of the last
+//       position of each hash of 4 bytes, and extended as far as they go.
+// In:   src, srcLen - the block (srcLen at most 64K)
+//       destCap - room in dest
+// Out:  dest - the compressed block
+// Ret:  length of the compressed block, 0 if it does not fit in destCap
+//
+int PF_Compress(const char *src, int srcLen, char *dest, int destCap)
+{
+   const uchar *base = (const uchar *)src;
+   const uchar *ip = base, *anchor = base, *end = base + srcLen;
+   uchar *op = (uchar *)dest, *opEnd = (uchar *)dest + destCap;
+   int table[1 << PF_HASH_BITS];
+
+   memset(table, 0xFF, sizeof(table));
+
+   while (end - ip >= PF_MIN_MATCH) {
+      unsigned int h = Hash4(ip);
+      int ref = table[h];
+      table[h] = (int)(ip - base);
+
+      if (ref < 0 || ip - base - ref > PF_MAX_DISTANCE ||
+            Read4(base + ref) != Read4(ip)) {
+         ip++;
+         continue;
+      }
+
+      // Extend the match
+      const uchar *p = ip + PF_MIN_MATCH, *m = base + ref + PF_MIN_MATCH;
+      while (p < end && *p == *m) {
+         p++;
+         m++;
+      }
+
+      if (!PutSequence(op, opEnd, anchor, (int)(ip - anchor),
+            (int)(ip - base - ref), (int)(p - ip)))
+         return (0);
+      ip = anchor = p;
+   }
+
+   // The rest are literals
+   if (!PutSequence(op, opEnd, anchor, (int)(end - anchor), 0, 0))
+      return (0);
+
+   return ((int)(op - (uchar *)dest));
+}
+
+//
+// GetLength
+//
+// Desc: Read the rest of a length whose 4 bits in the token were 15
+// Ret:  TRUE, or FALSE if the block ends first
+//
+static int GetLength(const uchar *&ip, const uchar *end, int &length)
+{
+   uchar b;
+
+   do {
+      if (ip >= end)
+         return (FALSE);
+      b = *ip++;
+      length += b;
+   } while (b == 255);
+   return (TRUE);
+}
+
+//
+// PF_Decompress
+//
+// Desc: Decompress a block.  Every length and distance is checked against
+//       the bounds of src and dest, so that a damaged block is reported
+//       rather than overrunning either.
+// In:   src, srcLen - the compressed block
+//       destLen - length of the block when decompressed
+// Out:  dest - the block
+// Ret:  TRUE if ok, FALSE if the block is damaged
+//
+int PF_Decompress(const char *src, int srcLen, char *dest, int destLen)
+{
+   const uchar *ip = (const uchar *)src, *end = ip + srcLen;
+   uchar *op = (uchar *)dest, *opEnd = (uchar *)dest + destLen;
+
+   while (ip < end) {
+      int token = *ip++;
+
+      // Literals
+      int numLiterals = token >> 4;
+      if (numLiterals == 15 && !GetLength(ip, end, numLiterals))
+         return (FALSE);
+      if (end - ip < numLiterals || opEnd - op < numLiterals)
+         return (FALSE);
+      memcpy(op, ip, numLiterals);
+      ip += numLiterals;
+      op += numLiterals;
+
+      // The last sequence has no match
+      if (ip == end)
+         break;
+
+      // Match, which may overlap what it produces
+      if (end - ip < 2)
+         return (FALSE);
+      int distance = ip[0] | (ip[1] << 8);
+      ip += 2;
+      int matchLength = token & 15;
+      if (matchLength == 15 && !GetLength(ip, end, matchLength))
+         return (FALSE);
+      matchLength += PF_MIN_MATCH;
+      if (distance == 0 || distance > op - (uchar *)dest ||
+            opEnd - op < matchLength)
+         return (FALSE);
+      for (const uchar *m = op - distance; matchLength > 0; matchLength--)
+         *op++ = *m++;
+   }
+
+   return (op == opEnd);
+}
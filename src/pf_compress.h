@@ -0,0 +1,30 @@
+//
+// File:        pf_compress.h
+// Description: Block codec for compressed PF pages
+//
+// A small LZ77 codec in the manner of LZ4: fast rather than tight, and
+// good at what PF pages are mostly made of, runs of '\0' padding and
+// repeated bytes.  The compressed block is a list of sequences, each a
+// token byte (# of literals in the high 4 bits, match length - 4 in the
+// low 4 bits; 15 means more length bytes follow, each adding up to 255),
+// the literals, and a match: a 2-byte little-endian distance back into
+// the output.  The last sequence has literals only.
+//
+
+#ifndef PF_COMPRESS_H
+#define PF_COMPRESS_H
+
+//
+// PF_Compress - compress srcLen bytes of src (at most 64K) into dest
+// Ret: length of the compressed block, or 0 if it is longer than destCap
+//
+int PF_Compress(const char *src, int srcLen, char *dest, int destCap);
+
+//
+// PF_Decompress - decompress the block of srcLen bytes in src into dest
+// Ret: TRUE if it decompresses into exactly destLen bytes, FALSE if the
+//      block is damaged (dest is not written past destLen)
+//
+int PF_Decompress(const char *src, int srcLen, char *dest, int destLen);
+
+#endif
@@ -25,6 +25,15 @@ static char *PF_WarnMsg[] = {
   (char*)"page already unpinned",
   (char*)"end of file",
   (char*)"attempting to resize the buffer too small",
+  (char*)"unknown page replacement policy",
+  (char*)"direct I/O is not supported for this file",
+  (char*)"file is open read-only",
+  (char*)"page size not supported",
+  (char*)"no such buffer pool (or invalid pool name)",
+  (char*)"too many buffer pools",
+  (char*)"bytes not within the page",
+  (char*)"no log is open",
+  (char*)"a page of the buffer is latched",
   (char*)"invalid filename"
 };
 
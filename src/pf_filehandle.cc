@@ -5,10 +5,12 @@
 //              Dallan Quass (quass@cs.stanford.edu)
 //
 
+#include <cstddef>
 #include <unistd.h>
 #include <sys/types.h>
 #include "pf_internal.h"
 #include "pf_buffermgr.h"
+#include "pf_logmgr.h"
 
 //
 // PF_FileHandle
@@ -27,7 +29,10 @@ PF_FileHandle::PF_FileHandle()
 {
    // Initialize local variables
    bFileOpen = FALSE;
+   bReadOnly = FALSE;
+   firstClear = 0;
    pBufferMgr = NULL;
+   fileNo = -1;
 }
 
 //
@@ -55,7 +60,10 @@ PF_FileHandle::PF_FileHandle(const PF_FileHandle &fileHandle)
    this->hdr         = fileHandle.hdr;
    this->bFileOpen   = fileHandle.bFileOpen;
    this->bHdrChanged = fileHandle.bHdrChanged;
+   this->bReadOnly   = fileHandle.bReadOnly;
+   this->firstClear  = fileHandle.firstClear;
    this->unixfd      = fileHandle.unixfd;
+   this->fileNo      = fileHandle.fileNo;
 }
 
 //
@@ -77,7 +85,10 @@ PF_FileHandle& PF_FileHandle::operator= (const PF_FileHandle &fileHandle)
       this->hdr         = fileHandle.hdr;
       this->bFileOpen   = fileHandle.bFileOpen;
       this->bHdrChanged = fileHandle.bHdrChanged;
+      this->bReadOnly   = fileHandle.bReadOnly;
+      this->firstClear  = fileHandle.firstClear;
       this->unixfd      = fileHandle.unixfd;
+      this->fileNo      = fileHandle.fileNo;
    }
 
    // Return a reference to this
@@ -89,13 +100,15 @@ PF_FileHandle& PF_FileHandle::operator= (const PF_FileHandle &fileHandle)
 //
 // Desc: Get the first page in a file
 //       The file handle must refer to an open file
+// In:   hint - passed on to the buffer manager
 // Out:  pageHandle - becomes a handle to the first page of the file
 //       The referenced page is pinned in the buffer pool.
 // Ret:  PF return code
 //
-RC PF_FileHandle::GetFirstPage(PF_PageHandle &pageHandle) const
+RC PF_FileHandle::GetFirstPage(PF_PageHandle &pageHandle,
+      ClientHint hint) const
 {
-   return (GetNextPage((PageNum)-1, pageHandle));
+   return (GetNextPage((PageNum)-1, pageHandle, hint));
 }
 
 //
@@ -103,13 +116,15 @@ RC PF_FileHandle::GetFirstPage(PF_PageHandle &pageHandle) const
 //
 // Desc: Get the last page in a file
 //       The file handle must refer to an open file
+// In:   hint - passed on to the buffer manager
 // Out:  pageHandle - becomes a handle to the last page of the file
 //       The referenced page is pinned in the buffer pool.
 // Ret:  PF return code
 //
-RC PF_FileHandle::GetLastPage(PF_PageHandle &pageHandle) const
+RC PF_FileHandle::GetLastPage(PF_PageHandle &pageHandle,
+      ClientHint hint) const
 {
-   return (GetPrevPage((PageNum)hdr.numPages, pageHandle));
+   return (GetPrevPage((PageNum)hdr.numPages, pageHandle, hint));
 }
 
 //
@@ -117,13 +132,18 @@ RC PF_FileHandle::GetLastPage(PF_PageHandle &pageHandle) const
 //
 // Desc: Get the next (valid) page after current
 //       The file handle must refer to an open file
+//       Pages the used-page map knows to be free are not read.
+//       Without a hint, the buffer manager reads ahead once it sees a
+//       few calls step through the file.
 // In:   current - get the next valid page after this page number
 //       current can refer to a page that has been disposed
+//       hint - passed on to the buffer manager
 // Out:  pageHandle - becomes a handle to the next page of the file
 //       The referenced page is pinned in the buffer pool.
 // Ret:  PF_EOF, or another PF return code
 //
-RC PF_FileHandle::GetNextPage(PageNum current, PF_PageHandle &pageHandle) const
+RC PF_FileHandle::GetNextPage(PageNum current, PF_PageHandle &pageHandle,
+      ClientHint hint) const
 {
    int rc;               // return code
 
@@ -135,11 +155,16 @@ RC PF_FileHandle::GetNextPage(PageNum current, PF_PageHandle &pageHandle) const
    if (current != -1 &&  !IsValidPageNum(current))
       return (PF_INVALIDPAGE);
 
-   // Scan the file until a valid used page is found
-   for (current++; current < hdr.numPages; current++) {
+   // Scan the file until a valid used page is found, skipping the pages
+   // the map knows to be free
+   for (current = SkipFree(current + 1, 1); current < hdr.numPages;
+         current = SkipFree(current + 1, 1)) {
+
+      if (hint == NO_HINT)
+         pBufferMgr->ReadAhead(unixfd, current, hdr.numPages, hint);
 
       // If this is a valid (used) page, we're done
-      if (!(rc = GetThisPage(current, pageHandle)))
+      if (!(rc = GetThisPage(current, pageHandle, hint)))
          return (0);
 
       // If unexpected error, return it
@@ -156,13 +181,17 @@ RC PF_FileHandle::GetNextPage(PageNum current, PF_PageHandle &pageHandle) const
 //
 // Desc: Get the prev (valid) page after current
 //       The file handle must refer to an open file
+//       Read-ahead is done as for GetNextPage, towards the beginning
+//       of the file.
 // In:   current - get the prev valid page before this page number
 //       current can refer to a page that has been disposed
+//       hint - passed on to the buffer manager
 // Out:  pageHandle - becomes a handle to the prev page of the file
 //       The referenced page is pinned in the buffer pool.
 // Ret:  PF_EOF, or another PF return code
 //
-RC PF_FileHandle::GetPrevPage(PageNum current, PF_PageHandle &pageHandle) const
+RC PF_FileHandle::GetPrevPage(PageNum current, PF_PageHandle &pageHandle,
+      ClientHint hint) const
 {
    int rc;               // return code
 
@@ -174,11 +203,16 @@ RC PF_FileHandle::GetPrevPage(PageNum current, PF_PageHandle &pageHandle) const
    if (current != hdr.numPages &&  !IsValidPageNum(current))
       return (PF_INVALIDPAGE);
 
-   // Scan the file until a valid used page is found
-   for (current--; current >= 0; current--) {
+   // Scan the file until a valid used page is found, skipping the pages
+   // the map knows to be free
+   for (current = SkipFree(current - 1, -1); current >= 0;
+         current = SkipFree(current - 1, -1)) {
+
+      if (hint == NO_HINT)
+         pBufferMgr->ReadAhead(unixfd, current, hdr.numPages, hint);
 
       // If this is a valid (used) page, we're done
-      if (!(rc = GetThisPage(current, pageHandle)))
+      if (!(rc = GetThisPage(current, pageHandle, hint)))
          return (0);
 
       // If unexpected error, return it
@@ -195,13 +229,18 @@ RC PF_FileHandle::GetPrevPage(PageNum current, PF_PageHandle &pageHandle) const
 //
 // Desc: Get a specific page in a file
 //       The file handle must refer to an open file
+//       With the SEQUENTIAL and ONE_SHOT hints, calls that step through
+//       the file get the pages after pageNum (before it, if the calls go
+//       backwards) read ahead.
 // In:   pageNum - the number of the page to get
+//       hint - how the page will be used, see PF_BufferMgr::GetPage
 // Out:  pageHandle - becomes a handle to the this page of the file
 //                    this function modifies local var's in pageHandle
 //       The referenced page is pinned in the buffer pool.
 // Ret:  PF return code
 //
-RC PF_FileHandle::GetThisPage(PageNum pageNum, PF_PageHandle &pageHandle) const
+RC PF_FileHandle::GetThisPage(PageNum pageNum, PF_PageHandle &pageHandle,
+      ClientHint hint) const
 {
    int  rc;               // return code
    char *pPageBuf;        // address of page in buffer pool
@@ -214,8 +253,12 @@ RC PF_FileHandle::GetThisPage(PageNum pageNum, PF_PageHandle &pageHandle) const
    if (!IsValidPageNum(pageNum))
       return (PF_INVALIDPAGE);
 
+   // Start reading the pages the scan will want next
+   if (hint == SEQUENTIAL || hint == ONE_SHOT)
+      pBufferMgr->ReadAhead(unixfd, pageNum, hdr.numPages, hint);
+
    // Get this page from the buffer manager
-   if ((rc = pBufferMgr->GetPage(unixfd, pageNum, &pPageBuf)))
+   if ((rc = pBufferMgr->GetPage(unixfd, pageNum, &pPageBuf, TRUE, hint)))
       return (rc);
 
    // If the page is valid, then set pageHandle to this page and return ok
@@ -236,15 +279,51 @@ RC PF_FileHandle::GetThisPage(PageNum pageNum, PF_PageHandle &pageHandle) const
    return (PF_INVALIDPAGE);
 }
 
+//
+// PrefetchPages
+//
+// Desc: Start reading pages into the buffer pool without waiting for
+//       them, e.g. because they will be asked for soon.  Pages that are
+//       in the buffer pool already are left alone.  Nothing is pinned.
+//       The file handle must refer to an open file
+// In:   pageNum - first page to read
+//       numPages - # of pages to read, from pageNum on
+//       hint - how the pages will be used, see PF_BufferMgr::GetPage
+// Ret:  PF_INVALIDPAGE, PF_NOBUF if the pages cannot be read ahead now,
+//       or another PF return code
+//
+RC PF_FileHandle::PrefetchPages(PageNum pageNum, int numPages,
+      ClientHint hint) const
+{
+   RC rc;
+
+   // File must be open
+   if (!bFileOpen)
+      return (PF_CLOSEDFILE);
+
+   for (int i = 0; i < numPages; i++) {
+      if (!IsValidPageNum(pageNum + i))
+         return (PF_INVALIDPAGE);
+      if ((rc = pBufferMgr->Prefetch(unixfd, pageNum + i, hint)))
+         return (rc);
+   }
+
+   // Return ok
+   return (0);
+}
+
 //
 // AllocatePage
 //
 // Desc: Allocate a new page in the file (may get a page which was
 //       previously disposed)
-//       The file handle must refer to an open file
+//       The lowest free page in the used-page map is taken first, so
+//       that files stay dense; then a page from the free list.  New
+//       pages come from the extent allocated last.
+//       The file handle must refer to an open file, not opened read-only
 // Out:  pageHandle - becomes a handle to the newly-allocated page
 //                    this function modifies local var's in pageHandle
-// Ret:  PF return code
+// Ret:  PF_READONLY or other PF return code
 //
 RC PF_FileHandle::AllocatePage(PF_PageHandle &pageHandle)
 {
@@ -252,12 +331,24 @@ RC PF_FileHandle::AllocatePage(PF_PageHandle &pageHandle)
    int     pageNum;          // new-page number
    char    *pPageBuf;        // address of page in buffer pool
 
-   // File must be open
+   // File must be open for writing
    if (!bFileOpen)
       return (PF_CLOSEDFILE);
+   if (bReadOnly)
+      return (PF_READONLY);
+
+   // If there is a free page in the map...
+   if ((pageNum = FirstFree()) != PF_PAGE_LIST_END) {
+
+      // Get it into the buffer
+      if ((rc = pBufferMgr->GetPage(unixfd,
+            pageNum,
+            &pPageBuf)))
+         return (rc);
+   }
 
    // If the free list isn't empty...
-   if (hdr.firstFree != PF_PAGE_LIST_END) {
+   else if (hdr.firstFree != PF_PAGE_LIST_END) {
       pageNum = hdr.firstFree;
 
       // Get the first free page into the buffer
@@ -274,6 +365,14 @@ RC PF_FileHandle::AllocatePage(PF_PageHandle &pageHandle)
       // The free list is empty...
       pageNum = hdr.numPages;
 
+      // Once the last extent is used up, allocate the next one on disk
+      if (hdr.extentPages > 1 && pageNum >= hdr.allocPages) {
+         if ((rc = pBufferMgr->AllocateExtent(unixfd, pageNum,
+               hdr.extentPages)))
+            return (rc);
+         hdr.allocPages = pageNum + hdr.extentPages;
+      }
+
       // Allocate a new page in the file
       if ((rc = pBufferMgr->AllocatePage(unixfd,
             pageNum,
@@ -289,12 +388,16 @@ RC PF_FileHandle::AllocatePage(PF_PageHandle &pageHandle)
 
    // Mark this page as used
    ((PF_PageHdr *)pPageBuf)->nextFree = PF_PAGE_USED;
+   SetUsed(pageNum, TRUE);
 
    // Zero out the page data
-   memset(pPageBuf + sizeof(PF_PageHdr), 0, PF_PAGE_SIZE);
+   memset(pPageBuf + sizeof(PF_PageHdr), 0, hdr.pageSize);
 
-   // Mark the page dirty because we changed the next pointer
-   if ((rc = MarkDirty(pageNum)))
+   // Mark the page dirty because we changed the next pointer (if the
+   // file is logged, so is the allocation)
+   if ((rc = LogHdr(pageNum)) ||
+         (rc = pBufferMgr->LogChange(unixfd, pageNum, PF_LOGREC_ALLOC, 0,
+         0)))
       return (rc);
 
    // Set the pageHandle local variables
@@ -313,16 +416,18 @@ RC PF_FileHandle::AllocatePage(PF_PageHandle &pageHandle)
 //       PF_PageHandle objects referring to this page should not be used
 //       after making this call.
 // In:   pageNum - number of page to dispose
-// Ret:  PF return code
+// Ret:  PF_READONLY or other PF return code
 //
 RC PF_FileHandle::DisposePage(PageNum pageNum)
 {
    int     rc;               // return code
    char    *pPageBuf;        // address of page in buffer pool
 
-   // File must be open
+   // File must be open for writing
    if (!bFileOpen)
       return (PF_CLOSEDFILE);
+   if (bReadOnly)
+      return (PF_READONLY);
 
    // Validate page number
    if (!IsValidPageNum(pageNum))
@@ -346,13 +451,21 @@ RC PF_FileHandle::DisposePage(PageNum pageNum)
       return (PF_PAGEFREE);
    }
 
-   // Put this page onto the free list
-   ((PF_PageHdr *)pPageBuf)->nextFree = hdr.firstFree;
-   hdr.firstFree = pageNum;
+   // Free this page in the map, or put it onto the free list
+   if (pageNum < hdr.mapPages) {
+      ((PF_PageHdr *)pPageBuf)->nextFree = PF_PAGE_LIST_END;
+      SetUsed(pageNum, FALSE);
+   }
+   else {
+      ((PF_PageHdr *)pPageBuf)->nextFree = hdr.firstFree;
+      hdr.firstFree = pageNum;
+   }
    bHdrChanged = TRUE;
 
    // Mark the page dirty because we changed the next pointer
-   if ((rc = MarkDirty(pageNum)))
+   if ((rc = LogHdr(pageNum)) ||
+         (rc = pBufferMgr->LogChange(unixfd, pageNum, PF_LOGREC_PAGE, 0,
+         sizeof(PF_PageHdr))))
       return (rc);
 
    // Unpin the page
@@ -369,15 +482,17 @@ RC PF_FileHandle::DisposePage(PageNum pageNum)
 // Desc: Mark a page as being dirty
 //       The page will then be written back to disk when it is removed from
 //       the page buffer
-//       The file handle must refer to an open file
+//       The file handle must refer to an open file, not opened read-only
 // In:   pageNum - number of page to mark dirty
-// Ret:  PF return code
+// Ret:  PF_READONLY or other PF return code
 //
 RC PF_FileHandle::MarkDirty(PageNum pageNum) const
 {
-   // File must be open
+   // File must be open for writing
    if (!bFileOpen)
       return (PF_CLOSEDFILE);
+   if (bReadOnly)
+      return (PF_READONLY);
 
    // Validate page number
    if (!IsValidPageNum(pageNum))
@@ -387,6 +502,36 @@ RC PF_FileHandle::MarkDirty(PageNum pageNum) const
    return (pBufferMgr->MarkDirty(unixfd, pageNum));
 }
 
+//
+// LogPage
+//
+// Desc: Mark a page dirty, as MarkDirty, after some of its data were
+//       changed.  If the file is logged, the bytes changed are logged.
+//       That is what MarkDirty does too, but for the whole page.
+//       The file handle must refer to an open file, not opened read-only
+// In:   pageNum - number of the page (pinned)
+//       offset - # of the first byte changed in the data of the page
+//       length - # of bytes changed
+// Ret:  PF_BADRANGE, PF_READONLY or other PF return code
+//
+RC PF_FileHandle::LogPage(PageNum pageNum, int offset, int length) const
+{
+   // File must be open for writing
+   if (!bFileOpen)
+      return (PF_CLOSEDFILE);
+   if (bReadOnly)
+      return (PF_READONLY);
+
+   // Validate page number and bytes
+   if (!IsValidPageNum(pageNum))
+      return (PF_INVALIDPAGE);
+   if (offset < 0 || length < 0 || offset + length > hdr.pageSize)
+      return (PF_BADRANGE);
+
+   return (pBufferMgr->LogChange(unixfd, pageNum, PF_LOGREC_PAGE,
+         offset + sizeof(PF_PageHdr), length));
+}
+
 //
 // UnpinPage
 //
@@ -412,15 +557,61 @@ RC PF_FileHandle::UnpinPage(PageNum pageNum) const
    return (pBufferMgr->UnpinPage(unixfd, pageNum));
 }
 
+//
+// LatchPage
+//
+// Desc: Latch a pinned page so that threads sharing it do not read it
+//       while another one changes it.  Any number of threads may hold the
+//       latch shared, one thread exclusive.  Waits until it is granted.
+//       The file handle must refer to an open file.
+// In:   pageNum - number of the page (pinned)
+//       bExclusive - TRUE to change the page, FALSE to read it
+// Ret:  PF_PAGEUNPINNED, PF return code
+//
+RC PF_FileHandle::LatchPage(PageNum pageNum, int bExclusive) const
+{
+   // File must be open
+   if (!bFileOpen)
+      return (PF_CLOSEDFILE);
+
+   // Validate page number
+   if (!IsValidPageNum(pageNum))
+      return (PF_INVALIDPAGE);
+
+   return (pBufferMgr->LatchPage(unixfd, pageNum, bExclusive));
+}
+
+//
+// UnlatchPage
+//
+// Desc: Release a latch taken by LatchPage.  The page must still be
+//       pinned.  The file handle must refer to an open file.
+// In:   pageNum - number of the page
+// Ret:  PF return code
+//
+RC PF_FileHandle::UnlatchPage(PageNum pageNum) const
+{
+   // File must be open
+   if (!bFileOpen)
+      return (PF_CLOSEDFILE);
+
+   // Validate page number
+   if (!IsValidPageNum(pageNum))
+      return (PF_INVALIDPAGE);
+
+   return (pBufferMgr->UnlatchPage(unixfd, pageNum));
+}
+
 //
 // FlushPages
 //
 // Desc: Flush all dirty unpinned pages from the buffer manager for this file
-// In:   Nothing
+// In:   bSync - also make sure the header and pages are on the disk
+//       (one fdatasync once they are all written)
 // Ret:  PF_PAGEFIXED warning from buffer manager if pages are pinned or
 //       other PF error
 //
-RC PF_FileHandle::FlushPages() const
+RC PF_FileHandle::FlushPages(int bSync) const
 {
    // File must be open
    if (!bFileOpen)
@@ -429,18 +620,12 @@ RC PF_FileHandle::FlushPages() const
    // If the file header has changed, write it back to the file
    if (bHdrChanged) {
 
-      // First seek to the appropriate place
-      if (lseek(unixfd, 0, L_SET) < 0)
-         return (PF_UNIX);
+      RC rc;
 
       // Write header
-      int numBytes = write(unixfd,
-            (char *)&hdr,
-            sizeof(PF_FileHdr));
-      if (numBytes < 0)
-         return (PF_UNIX);
-      if (numBytes != sizeof(PF_FileHdr))
-         return (PF_HDRWRITE);
+      if ((rc = pBufferMgr->WriteFileHdr(unixfd, (char *)&hdr,
+            sizeof(PF_FileHdr))))
+         return (rc);
 
       // This function is declared const, but we need to change the
       // bHdrChanged variable.  Cast away the constness
@@ -449,7 +634,7 @@ RC PF_FileHandle::FlushPages() const
    }
 
    // Tell Buffer Manager to flush pages
-   return (pBufferMgr->FlushPages(unixfd));
+   return (pBufferMgr->FlushPages(unixfd, bSync));
 }
 
 //
@@ -459,10 +644,12 @@ RC PF_FileHandle::FlushPages() const
 //       onto disk.  The page will not be forced out of the buffer pool.
 // In:   The page number, a default value of ALL_PAGES will be used if
 //       the client doesn't provide a value.  This will force all pages.
+//       bSync - also make sure the header and pages are on the disk
+//       (one fdatasync once they are all written)
 // Ret:  Standard PF errors
 //
 //
-RC PF_FileHandle::ForcePages(PageNum pageNum) const
+RC PF_FileHandle::ForcePages(PageNum pageNum, int bSync) const
 {
    // File must be open
    if (!bFileOpen)
@@ -471,18 +658,12 @@ RC PF_FileHandle::ForcePages(PageNum pageNum) const
    // If the file header has changed, write it back to the file
    if (bHdrChanged) {
 
-      // First seek to the appropriate place
-      if (lseek(unixfd, 0, L_SET) < 0)
-         return (PF_UNIX);
+      RC rc;
 
       // Write header
-      int numBytes = write(unixfd,
-            (char *)&hdr,
-            sizeof(PF_FileHdr));
-      if (numBytes < 0)
-         return (PF_UNIX);
-      if (numBytes != sizeof(PF_FileHdr))
-         return (PF_HDRWRITE);
+      if ((rc = pBufferMgr->WriteFileHdr(unixfd, (char *)&hdr,
+            sizeof(PF_FileHdr))))
+         return (rc);
 
       // This function is declared const, but we need to change the
       // bHdrChanged variable.  Cast away the constness
@@ -491,9 +672,26 @@ RC PF_FileHandle::ForcePages(PageNum pageNum) const
    }
 
    // Tell Buffer Manager to Force the page
-   return (pBufferMgr->ForcePages(unixfd, pageNum));
+   return (pBufferMgr->ForcePages(unixfd, pageNum, bSync));
 }
 
+//
+// GetPageSize
+//
+// Desc: Get the size of the pages of the file, chosen when it was created
+//       The file handle must refer to an open file
+// Out:  pageSize - # of bytes of data of a page
+// Ret:  PF return code
+//
+RC PF_FileHandle::GetPageSize(int &pageSize) const
+{
+   // File must be open
+   if (!bFileOpen)
+      return (PF_CLOSEDFILE);
+
+   pageSize = hdr.pageSize;
+   return (0);
+}
 
 //
 // IsValidPageNum
@@ -510,3 +708,102 @@ int PF_FileHandle::IsValidPageNum(PageNum pageNum) const
          pageNum < hdr.numPages);
 }
 
+//
+// SetUsed
+//
+// Desc: Internal.  Mark a page used or free in the used-page map.  Pages
+//       the map does not cover are left alone.
+// In:   pageNum - page number
+//       bUsed - TRUE if the page is now used, FALSE if it is free
+//
+void PF_FileHandle::SetUsed(PageNum pageNum, int bUsed)
+{
+   if (pageNum >= hdr.mapPages)
+      return;
+
+   if (bUsed)
+      hdr.usedMap[pageNum / 8] |= (unsigned char)(1 << (pageNum % 8));
+   else {
+      hdr.usedMap[pageNum / 8] &= (unsigned char)~(1 << (pageNum % 8));
+      if (pageNum < firstClear)
+         firstClear = pageNum;
+   }
+}
+
+//
+// SkipFree
+//
+// Desc: Internal.  Find the first page from pageNum on, going in the
+//       direction of step, that the used-page map does not know to be
+//       free.  Pages the map does not cover may be used.
+// In:   pageNum - page to start from
+//       step - 1 to go towards the end of the file, -1 towards the
+//       beginning
+// Ret:  that page; a page number past either end of the file if there
+//       is none
+//
+PageNum PF_FileHandle::SkipFree(PageNum pageNum, int step) const
+{
+   while (pageNum >= 0 && pageNum < hdr.numPages &&
+         pageNum < hdr.mapPages &&
+         !(hdr.usedMap[pageNum / 8] & (1 << (pageNum % 8)))) {
+
+      // Eight free pages in a row are skipped at once
+      if (hdr.usedMap[pageNum / 8] == 0)
+         pageNum = (step > 0) ? (pageNum / 8 + 1) * 8 : pageNum / 8 * 8 - 1;
+      else
+         pageNum += step;
+   }
+   return (pageNum);
+}
+
+//
+// LogHdr
+//
+// Desc: Internal.  Log the changes to the header made when pageNum was
+//       allocated or disposed of: the fields before the used-page map,
+//       and the byte of the map of pageNum.  Nothing is logged if the
+//       file is not.
+// In:   pageNum - page number
+// Ret:  PF return code
+//
+RC PF_FileHandle::LogHdr(PageNum pageNum)
+{
+   const int mapOffset = offsetof(PF_FileHdr, usedMap);
+   RC rc;
+
+   if ((rc = pBufferMgr->LogFileHdr(unixfd, (char *)&hdr, 0, mapOffset)))
+      return (rc);
+   if (pageNum < hdr.mapPages)
+      return (pBufferMgr->LogFileHdr(unixfd, (char *)&hdr,
+            mapOffset + pageNum / 8, 1));
+   return (0);
+}
+
+//
+// FirstFree
+//
+// Desc: Internal.  Find the lowest free page of the file in the used-page
+//       map.  The search starts at firstClear, which moves up past the
+//       pages found to be used.
+// Ret:  the page number, or PF_PAGE_LIST_END if there is no such page
+//
+PageNum PF_FileHandle::FirstFree()
+{
+   PageNum last = (hdr.numPages < hdr.mapPages) ? hdr.numPages : hdr.mapPages;
+   PageNum pageNum;
+
+   for (pageNum = firstClear; pageNum < last; pageNum++) {
+
+      // Skip bytes of used pages
+      if (pageNum % 8 == 0 && hdr.usedMap[pageNum / 8] == 0xFF) {
+         pageNum += 7;
+         continue;
+      }
+      if (!(hdr.usedMap[pageNum / 8] & (1 << (pageNum % 8))))
+         break;
+   }
+
+   firstClear = pageNum;
+   return (pageNum < last ? pageNum : PF_PAGE_LIST_END);
+}
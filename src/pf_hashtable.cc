@@ -4,28 +4,33 @@
 // Authors:     Hugo Rivero (rivero@cs.stanford.edu)
 //              Dallan Quass (quass@cs.stanford.edu)
 //
+// The chained buckets (one new'd entry per insert) were replaced by an
+// open addressing table.  Deletion shifts the following entries of the
+// probe sequence back, so there are no tombstones and a Find never has
+// to look past the first free bucket.
+//
 
 #include "pf_internal.h"
 #include "pf_hashtable.h"
 
+#define PF_HASH_FREE  (-1)          // slot value of a free bucket
+
 //
 // PF_HashTable
 //
 // Desc: Constructor for PF_HashTable object, which allows search, insert,
 //       and delete of hash table entries.
-// In:   numBuckets - number of hash table buckets
+// In:   numEntries - expected number of entries; the table grows past it
+//       if needed
 //
-PF_HashTable::PF_HashTable(int _numBuckets)
+PF_HashTable::PF_HashTable(int _numEntries)
 {
-  // Initialize numBuckets local variable from parameter
-  this->numBuckets = _numBuckets;
+  numBuckets = 0;
+  numEntries = 0;
+  hashTable = NULL;
 
   // Allocate memory for hash table
-  hashTable = new PF_HashEntry* [numBuckets];
-
-  // Initialize all buckets to empty
-  for (int i = 0; i < numBuckets; i++)
-    hashTable[i] = NULL;
+  Resize(_numEntries);
 }
 
 //
@@ -35,20 +40,106 @@ PF_HashTable::PF_HashTable(int _numBuckets)
 //
 PF_HashTable::~PF_HashTable()
 {
-  // Clear out all buckets
-  for (int i = 0; i < numBuckets; i++) {
-
-    // Delete all entries in the bucket
-    PF_HashEntry *entry = hashTable[i];
-    while (entry != NULL) {
-      PF_HashEntry *next = entry->next;
-      delete entry;
-      entry = next;
-    }
+  delete[] hashTable;
+}
+
+//
+// Hash
+//
+// Desc: Mix fd and pageNum into a bucket number.  Both halves of the key
+//       go through a 64-bit finalizer, so that neighbouring pages and the
+//       same page of different files land far apart.
+//
+int PF_HashTable::Hash(int fd, PageNum pageNum) const
+{
+  unsigned long long h = ((unsigned long long)(unsigned int)fd << 32) |
+    (unsigned int)pageNum;
+
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+
+  return ((int)(h & (numBuckets - 1)));
+}
+
+//
+// Probe
+//
+// Desc: Follow the probe sequence of (fd, pageNum)
+// Ret:  the bucket holding the entry, or the free bucket where the
+//       search stopped
+//
+int PF_HashTable::Probe(int fd, PageNum pageNum) const
+{
+  int bucket = Hash(fd, pageNum);
+
+  while (hashTable[bucket].slot != PF_HASH_FREE &&
+         (hashTable[bucket].fd != fd || hashTable[bucket].pageNum != pageNum))
+    bucket = (bucket + 1) & (numBuckets - 1);
+
+  return (bucket);
+}
+
+//
+// Rehash
+//
+// Desc: Move all entries to a new array of newNumBuckets buckets
+// In:   newNumBuckets - a power of two, more than twice numEntries
+// Ret:  PF_NOMEM
+//
+RC PF_HashTable::Rehash(int newNumBuckets)
+{
+  PF_HashEntry *oldTable = hashTable;
+  int oldNumBuckets = numBuckets;
+  int i;
+
+  if ((hashTable = new PF_HashEntry[newNumBuckets]) == NULL) {
+    hashTable = oldTable;
+    return (PF_NOMEM);
   }
+  numBuckets = newNumBuckets;
 
-  // Finally delete the hash table
-  delete[] hashTable;
+  // Initialize all buckets to free
+  for (i = 0; i < numBuckets; i++)
+    hashTable[i].slot = PF_HASH_FREE;
+
+  // Reinsert the old entries
+  for (i = 0; i < oldNumBuckets; i++)
+    if (oldTable[i].slot != PF_HASH_FREE)
+      hashTable[Probe(oldTable[i].fd, oldTable[i].pageNum)] = oldTable[i];
+
+  delete[] oldTable;
+
+  // Return ok
+  return (0);
+}
+
+//
+// Resize
+//
+// Desc: Size the table for _numEntries entries (it never shrinks below
+//       the entries it holds).  Called by the buffer manager when the
+//       buffer is resized.
+// In:   _numEntries - number of entries to make room for
+// Ret:  PF_NOMEM
+//
+RC PF_HashTable::Resize(int _numEntries)
+{
+  int newNumBuckets = 4;
+
+  if (_numEntries < numEntries)
+    _numEntries = numEntries;
+
+  // Keep the table at most half full
+  while (newNumBuckets < 2 * _numEntries)
+    newNumBuckets <<= 1;
+
+  if (newNumBuckets == numBuckets)
+    return (0);
+
+  return (Rehash(newNumBuckets));
 }
 
 //
@@ -62,26 +153,15 @@ PF_HashTable::~PF_HashTable()
 //
 RC PF_HashTable::Find(int fd, PageNum pageNum, int &slot)
 {
-  // Get which bucket it should be in
-  int bucket = Hash(fd, pageNum);
-
-  if (bucket<0)
-     return (PF_HASHNOTFOUND);
-
-  // Go through the linked list of this bucket
-  for (PF_HashEntry *entry = hashTable[bucket];
-       entry != NULL;
-       entry = entry->next) {
-    if (entry->fd == fd && entry->pageNum == pageNum) {
-
-      // Found it
-      slot = entry->slot;
-      return (0);
-    }
-  }
+  int bucket = Probe(fd, pageNum);
 
   // Didn't find it
-  return (PF_HASHNOTFOUND);
+  if (hashTable[bucket].slot == PF_HASH_FREE)
+    return (PF_HASHNOTFOUND);
+
+  // Found it
+  slot = hashTable[bucket].slot;
+  return (0);
 }
 
 //
@@ -95,31 +175,25 @@ RC PF_HashTable::Find(int fd, PageNum pageNum, int &slot)
 //
 RC PF_HashTable::Insert(int fd, PageNum pageNum, int slot)
 {
-  // Get which bucket it should be in
-  int bucket = Hash(fd, pageNum);
-
-  // Check entry doesn't already exist in the bucket
-  PF_HashEntry *entry;
-  for (entry = hashTable[bucket];
-       entry != NULL;
-       entry = entry->next) {
-    if (entry->fd == fd && entry->pageNum == pageNum)
-      return (PF_HASHPAGEEXIST);
+  RC rc;
+
+  // Check entry doesn't already exist
+  int bucket = Probe(fd, pageNum);
+  if (hashTable[bucket].slot != PF_HASH_FREE)
+    return (PF_HASHPAGEEXIST);
+
+  // Grow if the table would be more than half full
+  if (2 * (numEntries + 1) > numBuckets) {
+    if ((rc = Rehash(2 * numBuckets)))
+      return (rc);
+    bucket = Probe(fd, pageNum);
   }
 
-  // Allocate memory for new hash entry
-  if ((entry = new PF_HashEntry) == NULL)
-    return (PF_NOMEM);
-
-  // Insert entry at head of list for this bucket
-  entry->fd = fd;
-  entry->pageNum = pageNum;
-  entry->slot = slot;
-  entry->next = hashTable[bucket];
-  entry->prev = NULL;
-  if (hashTable[bucket] != NULL)
-    hashTable[bucket]->prev = entry;
-  hashTable[bucket] = entry;
+  // Fill the free bucket that ended the probe
+  hashTable[bucket].fd = fd;
+  hashTable[bucket].pageNum = pageNum;
+  hashTable[bucket].slot = slot;
+  numEntries++;
 
   // Return ok
   return (0);
@@ -135,33 +209,28 @@ RC PF_HashTable::Insert(int fd, PageNum pageNum, int slot)
 //
 RC PF_HashTable::Delete(int fd, PageNum pageNum)
 {
-  // Get which bucket it should be in
-  int bucket = Hash(fd, pageNum);
-
-  // Find the entry is in this bucket
-  PF_HashEntry *entry;
-  for (entry = hashTable[bucket];
-       entry != NULL;
-       entry = entry->next) {
-    if (entry->fd == fd && entry->pageNum == pageNum)
-      break;
-  }
+  int mask = numBuckets - 1;
+  int hole, bucket, home;
 
   // Did we find hash entry?
-  if (entry == NULL)
+  hole = Probe(fd, pageNum);
+  if (hashTable[hole].slot == PF_HASH_FREE)
     return (PF_HASHNOTFOUND);
 
-  // Remove this entry
-  if (entry == hashTable[bucket])
-    hashTable[bucket] = entry->next;
-  if (entry->prev != NULL)
-    entry->prev->next = entry->next;
-  if (entry->next != NULL)
-    entry->next->prev = entry->prev;
-  delete entry;
+  // Remove this entry: move back every following entry of the cluster
+  // whose home bucket does not lie between the hole and itself
+  for (bucket = (hole + 1) & mask;
+       hashTable[bucket].slot != PF_HASH_FREE;
+       bucket = (bucket + 1) & mask) {
+    home = Hash(hashTable[bucket].fd, hashTable[bucket].pageNum);
+    if (((bucket - home) & mask) >= ((bucket - hole) & mask)) {
+      hashTable[hole] = hashTable[bucket];
+      hole = bucket;
+    }
+  }
+  hashTable[hole].slot = PF_HASH_FREE;
+  numEntries--;
 
-  // Return ook
+  // Return ok
   return (0);
 }
-
-
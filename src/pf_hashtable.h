@@ -4,6 +4,10 @@
 // Authors:     Hugo Rivero (rivero@cs.stanford.edu)
 //              Dallan Quass (quass@cs.stanford.edu)
 //
+// The table uses open addressing with linear probing.  Entries live in
+// one array whose size is a power of two, kept at most half full; it
+// grows by rehashing when needed.  Nothing is allocated per insert.
+//
 
 #ifndef PF_HASHTABLE_H
 #define PF_HASHTABLE_H
@@ -11,14 +15,12 @@
 #include "pf_internal.h"
 
 //
-// HashEntry - Hash table bucket entries
+// HashEntry - Hash table entries
 //
 struct PF_HashEntry {
-    PF_HashEntry *next;   // next hash table element or NULL
-    PF_HashEntry *prev;   // prev hash table element or NULL
     int          fd;      // file descriptor
     PageNum      pageNum; // page number
-    int          slot;    // slot of this page in the buffer
+    int          slot;    // slot of this page in the buffer, or -1 if free
 };
 
 //
@@ -26,7 +28,8 @@ struct PF_HashEntry {
 //
 class PF_HashTable {
 public:
-    PF_HashTable (int numBuckets);           // Constructor
+    PF_HashTable (int numEntries);           // Constructor, room for
+                                             // numEntries entries
     ~PF_HashTable();                         // Destructor
     RC  Find     (int fd, PageNum pageNum, int &slot);
                                              // Set slot to the hash table
@@ -34,12 +37,18 @@ public:
     RC  Insert   (int fd, PageNum pageNum, int slot);
                                              // Insert a hash table entry
     RC  Delete   (int fd, PageNum pageNum);  // Delete a hash table entry
+    RC  Resize   (int numEntries);           // Make room for numEntries
 
 private:
-    int Hash     (int fd, PageNum pageNum) const
-      { return ((fd + pageNum) % numBuckets); }   // Hash function
-    int numBuckets;                               // Number of hash table buckets
-    PF_HashEntry **hashTable;                     // Hash table
+    int Hash     (int fd, PageNum pageNum) const;  // Hash function
+    int Probe    (int fd, PageNum pageNum) const;  // Bucket of the entry
+                                                   // or of the free bucket
+                                                   // ending its probe
+    RC  Rehash   (int newNumBuckets);              // Move to a new array
+    int numBuckets;                                // Number of buckets
+                                                   // (a power of two)
+    int numEntries;                                // Number of entries
+    PF_HashEntry *hashTable;                       // Hash table
 };
 
 #endif
@@ -17,7 +17,38 @@
 // Constants and defines
 //
 const int PF_BUFFER_SIZE = 40;     // Number of pages in the buffer
-const int PF_HASH_TBL_SIZE = 20;   // Size of hash table
+const int PF_HASH_TBL_SIZE = 20;   // Initial # of entries of hash table
+const int PF_LRUK_K = 2;           // K of the LRU-K replacement policy
+const int PF_2Q_KIN = 25;          // 2Q: A1in target, % of the buffer
+const int PF_2Q_KOUT = 50;         // 2Q: A1out size, % of the buffer
+const int PF_RING_SIZE = 16;       // Buffer pages recycled by scans
+const int PF_DIRECT_ALIGN = 4096;  // Block size of direct I/O transfers
+const int PF_FRAME_ALIGN = PF_DIRECT_ALIGN;   // Alignment of buffer pages
+const int PF_HUGE_PAGE_SIZE = 2 * 1024 * 1024;   // Huge page size
+const int PF_READAHEAD_PAGES = 8;  // Pages read ahead of a scan
+const int PF_READAHEAD_TRIGGER = 3;// Sequential run that starts read-ahead
+const int PF_PREFETCH_THREADS = 2; // Threads doing read-ahead
+const int PF_WRITEBACK_RUN = 64;   // Most pages written by one call
+const int PF_CLEAN_TARGET = 10;    // % of the buffer the cleaner keeps clean
+const int PF_CLEANER_QUEUE = 16;   // Most writes the cleaner has going on
+const int PF_SHARD_PAGES = 64;     // Buffer pages per shard (by default)
+const int PF_MAX_SHARDS = 16;      // Most shards (by default)
+const int PF_MIN_CLASS_PAGES = 8;  // Fewest pages of a pool of larger pages
+const int PF_FILE_CHUNK = 256;     // File table entries allocated at once
+const int PF_FILE_CHUNKS = 1024;   // Most chunks: fds up to 256K
+const int PF_WARM_MAGIC = 0x5057524d;   // First word of a warm-set manifest
+const int PF_CURVE_FACTOR = 4;     // Miss-ratio curve: up to 4 x the buffer
+const int PF_TUNE_REQUESTS = 1000; // Requests before the buffer is tuned
+const int PF_TUNE_SLACK = 1;       // % of hits tuning may give up for room
+const int PF_TUNE_MIN_PAGES = 8;   // Fewest pages tuning shrinks the buffer to
+const int PF_LOG_MAGIC = 0x50574c47;    // First word of a log file
+const int PF_LOG_BUFFER = 256 * 1024;   // Bytes of each log buffer
+const int PF_CKPT_BYTES = 4 * 1024 * 1024;   // Log between checkpoints
+const int PF_REDO_THREADS = 4;     // Threads applying the log at restart
+const int PF_REDO_BATCH = 1024 * 1024;  // Bytes of records each takes at once
+const int PF_COMPRESS_GROUP = 64;  // Compressed pages packed together
+const int PF_COMPRESS_UNIT = 512;  // Compressed images are whole units
+const int PF_COMPRESS_STRIPES = 4; // Groups of a file transferred at once
 
 #define CREATION_MASK      0600    // r/w privileges to owner only
 #define PF_PAGE_LIST_END  -1       // end of list of free pages
@@ -40,7 +71,69 @@ struct PF_PageHdr {
                         //  - PF_PAGE_USED if the page is not free
 };
 
+//
+// PF_LSN - log sequence number: where a record starts in the log (see
+// PF_LogMgr).  0 is no record.
+//
+typedef long long PF_LSN;
+
 // Justify the file header to the length of one page
 const int PF_FILE_HDR_SIZE = PF_PAGE_SIZE + sizeof(PF_PageHdr);
 
+//
+// PF_WarmSet: the pages of a file that were in the buffer when it was
+// last closed, coldest first (see PF_Manager::SaveWarmSet), or those to
+// bring back into the buffer when it is next opened, in file order
+//
+struct PF_WarmUp;
+
+struct PF_WarmSet {
+    PageNum *pPages;    // page numbers (NULL if none)
+    int numPages;       // # of them
+    int lastClose;      // when the file was last closed (a count)
+    int bPending;       // TRUE: to be read when the file is next opened
+    PF_WarmUp *pWarmUp; // thread reading them since then (NULL if none)
+};
+
+//
+// PF_WarmUp: a thread bringing the pages of a warm set into the buffer,
+// once the file is open (see PF_Manager::WarmUp)
+//
+struct PF_WarmUp {
+    PF_BufferMgr *pBufferMgr; // buffer manager of the file
+    int fd;             // OS file descriptor of the file
+    PageNum *pPages;    // the pages, in file order
+    int numPages;       // # of them
+    int bStop;          // TRUE: stop reading them (atomic)
+    pthread_t thread;
+};
+
+//
+// PF_PageClass - size class of pages of pageSize bytes of data: 0 for
+// PF_PAGE_SIZE, 1 for 8K pages, ..., PF_PAGE_CLASSES - 1 for 64K pages;
+// -1 if there are no such pages
+//
+inline int PF_PageClass(int pageSize)
+{
+   for (int c = 0; c < PF_PAGE_CLASSES; c++)
+      if (pageSize == (int)((PF_PAGE_SIZE + sizeof(PF_PageHdr)) << c) -
+            (int)sizeof(PF_PageHdr))
+         return (c);
+   return (-1);
+}
+
+//
+// PF_ClassPages - # of pages of the buffer pool of size class c, when
+// that of PF_PAGE_SIZE pages has numPages: about as many bytes, but at
+// least PF_MIN_CLASS_PAGES pages (fewer only if numPages is)
+//
+inline int PF_ClassPages(int numPages, int c)
+{
+   int classPages = numPages >> c;
+   if (classPages < PF_MIN_CLASS_PAGES)
+      classPages = (numPages < PF_MIN_CLASS_PAGES) ?
+         numPages : PF_MIN_CLASS_PAGES;
+   return (classPages);
+}
+
 #endif
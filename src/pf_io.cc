@@ -0,0 +1,779 @@
+//
+// File:        pf_io.cc
+// Description: Positional and direct I/O backends for PF files
+//
+
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include "pf_io.h"
+#include "pf_compress.h"
+
+//
+// PF_PRead, PF_PWrite
+//
+// Desc: pread/pwrite that carry on after short transfers and EINTR
+// Ret:  # of bytes transferred (less than length only at end of file),
+//       or -1 on error
+//
+static ssize_t PF_PRead(int fd, char *dest, size_t length, off_t offset)
+{
+   size_t done = 0;
+
+   while (done < length) {
+      ssize_t n = pread(fd, dest + done, length - done, offset + done);
+      if (n < 0 && errno == EINTR)
+         continue;
+      if (n < 0)
+         return (-1);
+      if (n == 0)
+         break;
+      done += n;
+   }
+   return ((ssize_t)done);
+}
+
+static ssize_t PF_PWrite(int fd, const char *source, size_t length,
+      off_t offset)
+{
+   size_t done = 0;
+
+   while (done < length) {
+      ssize_t n = pwrite(fd, source + done, length - done, offset + done);
+      if (n < 0 && errno == EINTR)
+         continue;
+      if (n <= 0)
+         return (n < 0 ? -1 : (ssize_t)done);
+      done += n;
+   }
+   return ((ssize_t)done);
+}
+
+//
+// PF_PWriteV
+//
+// Desc: pwritev that carries on after short transfers and EINTR
+// In:   iov, iovcnt - buffers to write, iovcnt at most PF_WRITEBACK_RUN
+// Ret:  # of bytes written, or -1 on error
+//
+static ssize_t PF_PWriteV(int fd, const struct iovec *iov, int iovcnt,
+      off_t offset)
+{
+   struct iovec vec[PF_WRITEBACK_RUN];
+   int first = 0;
+   size_t done = 0;
+
+   memcpy(vec, iov, iovcnt * sizeof(struct iovec));
+   while (first < iovcnt) {
+      ssize_t n = pwritev(fd, vec + first, iovcnt - first, offset + done);
+      if (n < 0 && errno == EINTR)
+         continue;
+      if (n <= 0)
+         return (n < 0 ? -1 : (ssize_t)done);
+      done += n;
+
+      // Skip what was written
+      while (first < iovcnt && (size_t)n >= vec[first].iov_len)
+         n -= vec[first++].iov_len;
+      if (first < iovcnt) {
+         vec[first].iov_base = (char *)vec[first].iov_base + n;
+         vec[first].iov_len -= n;
+      }
+   }
+   return ((ssize_t)done);
+}
+
+//
+// PF_Fallocate
+//
+// Desc: fallocate the range: allocate it, extending the file, or with
+//       bPunch, punch a hole in it.  Where the file system (or OS) cannot,
+//       nothing is done: the file grows as it is written, and the range
+//       keeps its disk space.
+// Ret:  PF_UNIX
+//
+static RC PF_Fallocate(int fd, off_t offset, off_t length, int bPunch = FALSE)
+{
+#ifdef __linux__
+   int mode = bPunch ? FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE : 0;
+
+   while (fallocate(fd, mode, offset, length) < 0) {
+      if (errno == EINTR)
+         continue;
+      if (errno == EOPNOTSUPP || errno == ENOSYS)
+         break;
+      return (PF_UNIX);
+   }
+#endif
+   return (0);
+}
+
+//
+// PF_IOVLength
+//
+// Desc: Total length of the buffers of iov
+//
+static size_t PF_IOVLength(const struct iovec *iov, int iovcnt)
+{
+   size_t length = 0;
+
+   for (int i = 0; i < iovcnt; i++)
+      length += iov[i].iov_len;
+   return (length);
+}
+
+//
+// PF_BufferedIO - pread/pwrite through the OS page cache
+//
+class PF_BufferedIO : public PF_IO {
+public:
+   PF_BufferedIO(int _fd) : fd(_fd) {}
+
+   PF_IOMode Mode() const { return PF_IO_BUFFERED; }
+
+   RC Read(off_t offset, char *dest, int length, RC incompleteRC)
+   {
+      ssize_t n = PF_PRead(fd, dest, length, offset);
+      if (n < 0)
+         return (PF_UNIX);
+      return (n == length ? 0 : incompleteRC);
+   }
+
+   RC Write(off_t offset, const char *source, int length, RC incompleteRC)
+   {
+      ssize_t n = PF_PWrite(fd, source, length, offset);
+      if (n < 0)
+         return (PF_UNIX);
+      return (n == length ? 0 : incompleteRC);
+   }
+
+   RC WriteV(off_t offset, const struct iovec *iov, int iovcnt,
+         RC incompleteRC)
+   {
+      ssize_t n = PF_PWriteV(fd, iov, iovcnt, offset);
+      if (n < 0)
+         return (PF_UNIX);
+      return ((size_t)n == PF_IOVLength(iov, iovcnt) ? 0 : incompleteRC);
+   }
+
+   RC Sync()
+   {
+      return (fdatasync(fd) ? PF_UNIX : 0);
+   }
+
+   RC Allocate(off_t offset, off_t length)
+   {
+      return (PF_Fallocate(fd, offset, length));
+   }
+
+   RC Discard(off_t offset, off_t length)
+   {
+      return (PF_Fallocate(fd, offset, length, TRUE));
+   }
+
+private:
+   int fd;
+};
+
+#ifdef O_DIRECT
+
+//
+// PF_DirectIO - O_DIRECT transfers
+//
+// Pages are whole blocks at block aligned offsets (PF_FILE_HDR_SIZE and
+// the page sizes are multiples of PF_DIRECT_ALIGN), and the buffer frames
+// they are transferred from and into are aligned (PF_FRAME_ALIGN), so
+// transfers go straight between the frames and the file.  Callers must
+// keep to whole aligned blocks in aligned memory: O_DIRECT fails the
+// others (PF_UNIX).
+//
+class PF_DirectIO : public PF_BufferedIO {
+public:
+   PF_DirectIO(int _fd) : PF_BufferedIO(_fd) {}
+
+   PF_IOMode Mode() const { return PF_IO_DIRECT; }
+};
+
+#endif
+
+//
+// PF_MappedIO - a read-only mapping of the whole file
+//
+// The buffer manager hands out pointers into the mapping instead of
+// copying pages into the buffer (see Map).  The file is mapped as it is
+// when opened: it does not grow and cannot be written.
+//
+class PF_MappedIO : public PF_IO {
+public:
+   PF_MappedIO(char *_base, off_t _length) : base(_base), length(_length) {}
+   ~PF_MappedIO()
+   {
+      if (base != NULL)
+         munmap(base, length);
+   }
+
+   PF_IOMode Mode() const { return PF_IO_MMAP; }
+
+   RC Read(off_t offset, char *dest, int _length, RC incompleteRC)
+   {
+      char *pSource = Map(offset, _length);
+      if (pSource == NULL)
+         return (incompleteRC);
+      memcpy(dest, pSource, _length);
+      return (0);
+   }
+
+   RC Write(off_t offset, const char *source, int _length, RC incompleteRC)
+   {
+      return (PF_READONLY);
+   }
+
+   RC WriteV(off_t offset, const struct iovec *iov, int iovcnt,
+         RC incompleteRC)
+   {
+      return (PF_READONLY);
+   }
+
+   RC Sync()
+   {
+      return (0);
+   }
+
+   RC Allocate(off_t offset, off_t length)
+   {
+      return (PF_READONLY);
+   }
+
+   RC Discard(off_t offset, off_t length)
+   {
+      return (PF_READONLY);
+   }
+
+   char *Map(off_t offset, int _length)
+   {
+      if (offset < 0 || offset + _length > length)
+         return (NULL);
+      return (base + offset);
+   }
+
+   off_t MapLength() const { return length; }
+
+private:
+   char  *base;                 // start of the mapping
+   off_t length;                // file size when mapped
+};
+
+//
+// PF_BlockRound - length rounded up to whole PF_DIRECT_ALIGN blocks
+//
+static int PF_BlockRound(int length)
+{
+   return ((length + PF_DIRECT_ALIGN - 1) / PF_DIRECT_ALIGN * PF_DIRECT_ALIGN);
+}
+
+//
+// PF_CompressedIO - compresses the pages of a file on their way to disk
+//
+// The pages are packed: every PF_COMPRESS_GROUP pages of the file make a
+// group, which has a region of the file to itself, as large as its pages
+// would take uncompressed plus a block for its directory.  The directory
+// gives the place of the image of each page in the region, in units of
+// PF_COMPRESS_UNIT bytes after the directory, and its length; a page
+// that does not compress into fewer units than it has bytes is stored as
+// it is (length pageSize).  The images of a group are kept one after the
+// other from the start of its region, so that even small pages take
+// little more than their images, and the rest of the region is left
+// unwritten or given back (Discard).  An image that grows is moved to
+// the end of the others; when that would leave the region more than half
+// unused, the group is compacted first.  The file header is not
+// compressed.
+//
+// The directories are kept in memory once read.  Transfers may run on the
+// I/O threads: the groups are latched by stripes, and each stripe has the
+// buffers its transfers use.  As images do not start on block boundaries,
+// the blocks at the ends of an image are read and written back whole.
+//
+struct PF_CompressedSlot {
+   int start;                   // first unit of the image in the region
+   int length;                  // # of bytes of the image, 0 if none
+};
+
+struct PF_CompressedGroup {
+   int bLoaded;                 // slots were read from the file
+   int bInFile;                 // the directory is in the file
+   PF_CompressedSlot slots[PF_COMPRESS_GROUP];
+};
+
+struct PF_CompressedStripe {
+   pthread_mutex_t latch;       // latches the groups of the stripe
+   char *pBuffer;               // the buffers below, allocated on first use
+   char *pImage;                // compressed image
+   char *pIn;                   // blocks read, a page and a block
+   char *pOut;                  // blocks written, a page and a block
+};
+
+class PF_CompressedIO : public PF_IO {
+public:
+   PF_CompressedIO(PF_IO *_pIO, int _pageSize)
+      : pIO(_pIO), pageSize(_pageSize), groups(NULL), numGroups(0)
+   {
+      pthread_mutex_init(&groupsLatch, NULL);
+      for (int i = 0; i < PF_COMPRESS_STRIPES; i++) {
+         pthread_mutex_init(&stripes[i].latch, NULL);
+         stripes[i].pBuffer = NULL;
+      }
+   }
+
+   ~PF_CompressedIO()
+   {
+      for (int i = 0; i < PF_COMPRESS_STRIPES; i++) {
+         pthread_mutex_destroy(&stripes[i].latch);
+         ::free(stripes[i].pBuffer);
+      }
+      for (int g = 0; g < numGroups; g++)
+         delete groups[g];
+      delete [] groups;
+      pthread_mutex_destroy(&groupsLatch);
+      delete pIO;
+   }
+
+   PF_IOMode Mode() const { return pIO->Mode(); }
+
+   // Page transfers are of whole pages
+   RC Read(off_t offset, char *dest, int length, RC incompleteRC)
+   {
+      RC rc = 0;
+
+      if (offset < PF_FILE_HDR_SIZE)
+         return (pIO->Read(offset, dest, length, incompleteRC));
+      for (int done = 0; done < length && !rc; done += pageSize)
+         rc = ReadPage(PageOf(offset + done), dest + done, incompleteRC);
+      return (rc);
+   }
+
+   RC Write(off_t offset, const char *source, int length, RC incompleteRC)
+   {
+      RC rc = 0;
+
+      if (offset < PF_FILE_HDR_SIZE)
+         return (pIO->Write(offset, source, length, incompleteRC));
+      for (int done = 0; done < length && !rc; done += pageSize)
+         rc = WritePage(PageOf(offset + done), source + done, incompleteRC);
+      return (rc);
+   }
+
+   RC WriteV(off_t offset, const struct iovec *iov, int iovcnt,
+         RC incompleteRC)
+   {
+      RC rc = 0;
+
+      for (int i = 0; i < iovcnt && !rc; i++) {
+         rc = Write(offset, (const char *)iov[i].iov_base, iov[i].iov_len,
+               incompleteRC);
+         offset += iov[i].iov_len;
+      }
+      return (rc);
+   }
+
+   RC Sync() { return (pIO->Sync()); }
+
+   // The pages have no places of their own to allocate
+   RC Allocate(off_t offset, off_t length) { return (0); }
+
+   // The images of the pages are dropped (their room is taken back when
+   // the group is next compacted)
+   RC Discard(off_t offset, off_t length)
+   {
+      RC rc = 0;
+
+      for (off_t done = 0; done + pageSize <= length && !rc;
+            done += pageSize) {
+         PageNum pageNum = PageOf(offset + done);
+         PF_CompressedStripe &stripe = Stripe(pageNum);
+         PF_CompressedGroup *pGroup;
+
+         pthread_mutex_lock(&stripe.latch);
+         if (!(rc = Enter(pageNum, stripe, pGroup))) {
+            PF_CompressedSlot &slot =
+               pGroup->slots[pageNum % PF_COMPRESS_GROUP];
+            if (slot.length > 0) {
+               slot.length = 0;
+               rc = WriteDir(pageNum, pGroup, stripe.pOut, PF_INCOMPLETEWRITE);
+            }
+         }
+         pthread_mutex_unlock(&stripe.latch);
+      }
+      return (rc);
+   }
+
+private:
+   PageNum PageOf(off_t offset) const
+   {
+      return ((PageNum)((offset - PF_FILE_HDR_SIZE) / pageSize));
+   }
+
+   // Start of the region of the group of pageNum, and of its images
+   off_t Region(PageNum pageNum) const
+   {
+      return (PF_FILE_HDR_SIZE + (off_t)(pageNum / PF_COMPRESS_GROUP) *
+            (PF_DIRECT_ALIGN + (off_t)PF_COMPRESS_GROUP * pageSize));
+   }
+
+   off_t Unit(PageNum pageNum, int unit) const
+   {
+      return (Region(pageNum) + PF_DIRECT_ALIGN +
+            unit * (off_t)PF_COMPRESS_UNIT);
+   }
+
+   static int Units(int length)
+   {
+      return ((length + PF_COMPRESS_UNIT - 1) / PF_COMPRESS_UNIT);
+   }
+
+   // Unit after the last image of a group, and # of units in use
+   static int End(const PF_CompressedGroup *pGroup, int &live)
+   {
+      int end = 0;
+
+      live = 0;
+      for (int i = 0; i < PF_COMPRESS_GROUP; i++) {
+         const PF_CompressedSlot &slot = pGroup->slots[i];
+         if (slot.length > 0) {
+            live += Units(slot.length);
+            if (slot.start + Units(slot.length) > end)
+               end = slot.start + Units(slot.length);
+         }
+      }
+      return (end);
+   }
+
+   PF_CompressedStripe &Stripe(PageNum pageNum)
+   {
+      return (stripes[pageNum / PF_COMPRESS_GROUP % PF_COMPRESS_STRIPES]);
+   }
+
+   //
+   // Enter
+   //
+   // Desc: With the latch of its stripe held, get the group of pageNum,
+   //       reading its directory if it was not yet, and the buffers of the
+   //       stripe
+   // Ret:  PF_NOMEM, PF_UNIX
+   //
+   RC Enter(PageNum pageNum, PF_CompressedStripe &stripe,
+         PF_CompressedGroup *&pGroup)
+   {
+      int g = pageNum / PF_COMPRESS_GROUP;
+      RC rc;
+
+      if (stripe.pBuffer == NULL) {
+         void *p;
+         if (posix_memalign(&p, PF_DIRECT_ALIGN,
+               3 * pageSize + 2 * PF_DIRECT_ALIGN))
+            return (PF_NOMEM);
+         stripe.pBuffer = stripe.pImage = (char *)p;
+         stripe.pIn = stripe.pImage + pageSize;
+         stripe.pOut = stripe.pIn + pageSize + PF_DIRECT_ALIGN;
+      }
+
+      // The group table only grows; groups do not move
+      pthread_mutex_lock(&groupsLatch);
+      if (g >= numGroups) {
+         int newNumGroups = (numGroups > 0) ? numGroups : 16;
+         while (newNumGroups <= g)
+            newNumGroups *= 2;
+
+         PF_CompressedGroup **pNewGroups =
+            new PF_CompressedGroup *[newNumGroups];
+         for (int i = 0; i < newNumGroups; i++)
+            pNewGroups[i] = (i < numGroups) ? groups[i] : NULL;
+         delete [] groups;
+         groups = pNewGroups;
+         numGroups = newNumGroups;
+      }
+      if (groups[g] == NULL) {
+         groups[g] = new PF_CompressedGroup;
+         groups[g]->bLoaded = FALSE;
+      }
+      pGroup = groups[g];
+      pthread_mutex_unlock(&groupsLatch);
+
+      if (pGroup->bLoaded)
+         return (0);
+
+      // A directory past the end of the file was never written
+      memset(stripe.pIn, 0, PF_DIRECT_ALIGN);
+      rc = pIO->Read(Region(pageNum), stripe.pIn, PF_DIRECT_ALIGN,
+            PF_INCOMPLETEREAD);
+      if (rc && rc != PF_INCOMPLETEREAD)
+         return (rc);
+      memcpy(pGroup->slots, stripe.pIn, sizeof(pGroup->slots));
+      pGroup->bInFile = (rc == 0);
+      pGroup->bLoaded = TRUE;
+      return (0);
+   }
+
+   RC WriteDir(PageNum pageNum, PF_CompressedGroup *pGroup, char *pBlock,
+         RC incompleteRC)
+   {
+      memset(pBlock, 0, PF_DIRECT_ALIGN);
+      memcpy(pBlock, pGroup->slots, sizeof(pGroup->slots));
+      RC rc = pIO->Write(Region(pageNum), pBlock, PF_DIRECT_ALIGN,
+            incompleteRC);
+      if (!rc)
+         pGroup->bInFile = TRUE;
+      return (rc);
+   }
+
+   //
+   // ReadImage, WriteImage
+   //
+   // Desc: Transfer length bytes at offset through the whole blocks that
+   //       hold them in pBlocks (a page and a block long).  WriteImage
+   //       reads the blocks at the ends first, for what else they hold.
+   // Out:  pImage - ReadImage: where the bytes are in pBlocks
+   //
+   RC ReadImage(off_t offset, int length, char *pBlocks, char *&pImage,
+         RC incompleteRC)
+   {
+      off_t first = offset / PF_DIRECT_ALIGN * PF_DIRECT_ALIGN;
+
+      pImage = pBlocks + (offset - first);
+      return (pIO->Read(first, pBlocks,
+            PF_BlockRound((int)(offset - first) + length), incompleteRC));
+   }
+
+   RC WriteImage(off_t offset, const char *pImage, int length,
+         char *pBlocks, RC incompleteRC)
+   {
+      off_t first = offset / PF_DIRECT_ALIGN * PF_DIRECT_ALIGN;
+      int head = (int)(offset - first);
+      int span = PF_BlockRound(head + length);
+      RC rc = 0;
+
+      if (head > 0)
+         rc = ReadBlock(first, pBlocks);
+      if (!rc && (head + length) % PF_DIRECT_ALIGN != 0 &&
+            (head == 0 || span > PF_DIRECT_ALIGN))
+         rc = ReadBlock(first + span - PF_DIRECT_ALIGN,
+               pBlocks + span - PF_DIRECT_ALIGN);
+      if (rc)
+         return (rc);
+      memcpy(pBlocks + head, pImage, length);
+      return (pIO->Write(first, pBlocks, span, incompleteRC));
+   }
+
+   // A block past the end of the file reads as zeros
+   RC ReadBlock(off_t offset, char *pBlock)
+   {
+      memset(pBlock, 0, PF_DIRECT_ALIGN);
+      RC rc = pIO->Read(offset, pBlock, PF_DIRECT_ALIGN, PF_INCOMPLETEREAD);
+      return (rc == PF_INCOMPLETEREAD ? 0 : rc);
+   }
+
+   RC ReadPage(PageNum pageNum, char *dest, RC incompleteRC)
+   {
+      PF_CompressedStripe &stripe = Stripe(pageNum);
+      PF_CompressedGroup *pGroup;
+      char *pImage;
+      RC rc;
+
+      pthread_mutex_lock(&stripe.latch);
+      if ((rc = Enter(pageNum, stripe, pGroup))) {
+         pthread_mutex_unlock(&stripe.latch);
+         return (rc);
+      }
+
+      // A page never written reads as zeros, like one allocated (or as
+      // one past the end of the file)
+      PF_CompressedSlot slot = pGroup->slots[pageNum % PF_COMPRESS_GROUP];
+      off_t offset = Unit(pageNum, slot.start);
+      if (slot.length == 0) {
+         memset(dest, 0, pageSize);
+         rc = pGroup->bInFile ? 0 : incompleteRC;
+      }
+      else if (slot.length == pageSize && offset % PF_DIRECT_ALIGN == 0)
+         rc = pIO->Read(offset, dest, pageSize, incompleteRC);
+      else if (!(rc = ReadImage(offset, slot.length, stripe.pIn, pImage,
+            incompleteRC))) {
+         if (slot.length == pageSize)
+            memcpy(dest, pImage, pageSize);
+         else if (!PF_Decompress(pImage, slot.length, dest, pageSize))
+            rc = incompleteRC;
+      }
+
+      pthread_mutex_unlock(&stripe.latch);
+      return (rc);
+   }
+
+   RC WritePage(PageNum pageNum, const char *source, RC incompleteRC)
+   {
+      PF_CompressedStripe &stripe = Stripe(pageNum);
+      PF_CompressedGroup *pGroup;
+      RC rc;
+
+      pthread_mutex_lock(&stripe.latch);
+      if ((rc = Enter(pageNum, stripe, pGroup))) {
+         pthread_mutex_unlock(&stripe.latch);
+         return (rc);
+      }
+
+      // Compress, if the image takes fewer units than the page
+      const char *pImage = stripe.pImage;
+      int length = PF_Compress(source, pageSize, stripe.pImage,
+            pageSize - PF_COMPRESS_UNIT);
+      if (length == 0) {
+         pImage = source;
+         length = pageSize;
+      }
+
+      // An image that does not fit in the place of the last one goes
+      // after the others
+      PF_CompressedSlot &slot = pGroup->slots[pageNum % PF_COMPRESS_GROUP];
+      PF_CompressedSlot old = slot;
+      if (old.length == 0 || Units(length) > Units(old.length)) {
+         int live, oldEnd = End(pGroup, live), end;
+
+         slot.length = 0;
+         end = End(pGroup, live) + Units(length);
+         if (end > PF_COMPRESS_GROUP * pageSize / PF_COMPRESS_UNIT ||
+               end > 2 * (live + Units(length)))
+            rc = Compact(pageNum, pGroup, stripe, oldEnd, incompleteRC);
+         slot.start = End(pGroup, live);
+      }
+
+      off_t offset = Unit(pageNum, slot.start);
+      if (rc)
+         ;
+      else if (length == pageSize && offset % PF_DIRECT_ALIGN == 0)
+         rc = pIO->Write(offset, pImage, pageSize, incompleteRC);
+      else
+         rc = WriteImage(offset, pImage, length, stripe.pOut, incompleteRC);
+
+      // The directory follows the image
+      if (!rc) {
+         slot.length = length;
+         if (slot.start != old.start || slot.length != old.length)
+            rc = WriteDir(pageNum, pGroup, stripe.pOut, incompleteRC);
+      }
+
+      pthread_mutex_unlock(&stripe.latch);
+      return (rc);
+   }
+
+   //
+   // Compact
+   //
+   // Desc: Move the images of the group of pageNum down to the start of
+   //       its region, lowest first, and give back the room after them
+   // In:   end - unit after the last image before
+   //
+   RC Compact(PageNum pageNum, PF_CompressedGroup *pGroup,
+         PF_CompressedStripe &stripe, int end, RC incompleteRC)
+   {
+      PF_CompressedSlot *slots = pGroup->slots;
+      int next = 0;
+      char *pImage;
+      RC rc;
+
+      for (;;) {
+         // The images not moved yet are the ones from next on
+         int k = -1;
+         for (int i = 0; i < PF_COMPRESS_GROUP; i++)
+            if (slots[i].length > 0 && slots[i].start >= next &&
+                  (k < 0 || slots[i].start < slots[k].start))
+               k = i;
+         if (k < 0)
+            break;
+
+         // The directory is written after each image it places
+         if (slots[k].start != next) {
+            if ((rc = ReadImage(Unit(pageNum, slots[k].start),
+                  slots[k].length, stripe.pIn, pImage, incompleteRC)) ||
+                  (rc = WriteImage(Unit(pageNum, next), pImage,
+                  slots[k].length, stripe.pOut, incompleteRC)))
+               return (rc);
+            slots[k].start = next;
+            if ((rc = WriteDir(pageNum, pGroup, stripe.pOut, incompleteRC)))
+               return (rc);
+         }
+         next += Units(slots[k].length);
+      }
+
+      off_t from = Unit(pageNum, 0) + PF_BlockRound(next * PF_COMPRESS_UNIT);
+      off_t to = Unit(pageNum, 0) + PF_BlockRound(end * PF_COMPRESS_UNIT);
+      return (to > from ? pIO->Discard(from, to - from) : 0);
+   }
+
+   PF_IO *pIO;                  // backend doing the transfers
+   int   pageSize;              // size of a page, header included
+   PF_CompressedGroup **groups; // groups read so far, by group number
+   int   numGroups;             // # of entries of groups
+   pthread_mutex_t groupsLatch; // protects groups and numGroups
+   PF_CompressedStripe stripes[PF_COMPRESS_STRIPES];
+};
+
+//
+// PF_NewIO
+//
+// Desc: Build the I/O backend for an open file
+// In:   fd - OS file descriptor
+//       mode - PF_IO_BUFFERED, PF_IO_DIRECT or PF_IO_MMAP
+// Out:  pIO - new backend (caller deletes)
+// Ret:  PF_NODIRECTIO if direct I/O is not available for fd,
+//       PF_UNIX if the file cannot be mapped
+//
+RC PF_NewIO(int fd, PF_IOMode mode, PF_IO *&pIO)
+{
+   switch (mode) {
+   case PF_IO_BUFFERED:
+      pIO = new PF_BufferedIO(fd);
+      return (0);
+
+   case PF_IO_DIRECT:
+#ifdef O_DIRECT
+      {
+         int flags = fcntl(fd, F_GETFL);
+         if (flags < 0 || fcntl(fd, F_SETFL, flags | O_DIRECT) < 0)
+            return (PF_NODIRECTIO);
+         pIO = new PF_DirectIO(fd);
+         return (0);
+      }
+#else
+      return (PF_NODIRECTIO);
+#endif
+
+   case PF_IO_MMAP:
+      {
+         struct stat st;
+         char *base = NULL;
+
+         if (fstat(fd, &st) < 0)
+            return (PF_UNIX);
+         if (st.st_size > 0 &&
+               (base = (char *)mmap(NULL, st.st_size, PROT_READ, MAP_SHARED,
+               fd, 0)) == (char *)MAP_FAILED)
+            return (PF_UNIX);
+         pIO = new PF_MappedIO(base, st.st_size);
+         return (0);
+      }
+   }
+   return (PF_NODIRECTIO);
+}
+
+//
+// PF_NewCompressedIO
+//
+// Desc: Build the backend of a compressed file
+// In:   pIO - backend that does the transfers (deleted with the new one)
+//       pageSize - size of the pages of the file, header included
+// Ret:  the new backend (caller deletes)
+//
+PF_IO *PF_NewCompressedIO(PF_IO *pIO, int pageSize)
+{
+   return (new PF_CompressedIO(pIO, pageSize));
+}
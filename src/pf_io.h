@@ -0,0 +1,82 @@
+//
+// File:        pf_io.h
+// Description: I/O backends used by PF_BufferMgr to transfer pages
+//
+// Every open PF file has a PF_IO that knows how to move bytes between
+// the file and memory.  Transfers name their file offset, so that there
+// is no shared file position (no lseek) and the same descriptor can be
+// used for several transfers at once.  Runs of pages that follow each
+// other in the file are written with one gathering write (WriteV).
+//
+//    PF_IO_BUFFERED - pread/pwrite through the OS page cache
+//    PF_IO_DIRECT   - O_DIRECT, bypassing the OS page cache.  The header
+//                     and the pages of a PF file are whole blocks of
+//                     PF_DIRECT_ALIGN bytes at aligned offsets, and the
+//                     buffer frames are aligned, so transfers go straight
+//                     between the frames and the file.
+//    PF_IO_MMAP     - the file is mapped read-only; pages are used in place
+//                     (Map) rather than read, and cannot be written.
+//
+// The pages of a compressed file go through a PF_CompressedIO on top of
+// the buffered or direct backend (see PF_NewCompressedIO).
+//
+
+#ifndef PF_IO_H
+#define PF_IO_H
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include "pf_internal.h"
+
+//
+// PF_IO - interface of an I/O backend
+//
+class PF_IO {
+public:
+    virtual ~PF_IO() {};
+
+    virtual PF_IOMode Mode() const = 0;
+
+    // Read length bytes at offset into dest
+    // Ret: PF_UNIX, or incompleteRC if the file is too short
+    virtual RC Read  (off_t offset, char *dest, int length,
+                      RC incompleteRC) = 0;
+    // Write length bytes from source at offset
+    // Ret: PF_UNIX, or incompleteRC if the write fell short
+    virtual RC Write (off_t offset, const char *source, int length,
+                      RC incompleteRC) = 0;
+    // Write the iovcnt buffers of iov (at most PF_WRITEBACK_RUN) one after
+    // the other from offset on
+    // Ret: PF_UNIX, or incompleteRC if the write fell short
+    virtual RC WriteV(off_t offset, const struct iovec *iov, int iovcnt,
+                      RC incompleteRC) = 0;
+    // Get the data written so far to the disk (fdatasync)
+    // Ret: PF_UNIX
+    virtual RC Sync  () = 0;
+    // Allocate disk space for length bytes at offset, extending the file
+    // Ret: PF_READONLY, PF_UNIX
+    virtual RC Allocate(off_t offset, off_t length) = 0;
+    // Give back the disk space of length bytes at offset (they read as
+    // zeros afterwards, or keep their contents where the file system
+    // cannot do this)
+    // Ret: PF_READONLY, PF_UNIX
+    virtual RC Discard (off_t offset, off_t length) = 0;
+
+    // Address of length bytes at offset in a mapping of the file, NULL if
+    // the backend does not map the file or they are beyond its end
+    virtual char *Map(off_t offset, int length) { return (NULL); }
+    // # of bytes of the file mapped (0 if the backend does not map it)
+    virtual off_t MapLength() const { return (0); }
+};
+
+// Build the backend for the open file fd.  For PF_IO_DIRECT this turns
+// O_DIRECT on for fd, for PF_IO_MMAP it maps the file.
+// Ret: PF_NODIRECTIO if the file system (or OS) cannot do direct I/O,
+//      PF_UNIX
+RC PF_NewIO(int fd, PF_IOMode mode, PF_IO *&pIO);
+
+// Build the backend of a compressed file with pages of pageSize bytes
+// (header included) on top of pIO, which it takes over
+PF_IO *PF_NewCompressedIO(PF_IO *pIO, int pageSize);
+
+#endif
@@ -0,0 +1,796 @@
+//
+// File:        pf_logmgr.cc
+// Description: PF_LogMgr class implementation
+//
+// See pf_logmgr.h.  The log writer takes the buffer appended to and
+// hands the other one to the clients before writing it, so that records
+// keep being appended while it writes.  A client only waits if the
+// buffer it appends to fills up before the writer is done.
+//
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstddef>
+#include <sys/types.h>
+#include "pf_logmgr.h"
+
+//
+// PF_LogSum
+//
+// Desc: Checksum (FNV-1a) of numBytes bytes, going on from sum
+//
+static unsigned int PF_LogSum(unsigned int sum, const char *p, int numBytes)
+{
+   for (int i = 0; i < numBytes; i++)
+      sum = (sum ^ (unsigned char)p[i]) * 16777619u;
+   return (sum);
+}
+
+const unsigned int PF_LOG_SUM_START = 2166136261u;
+
+//
+// PF_LogMgr
+//
+// Desc: Constructor
+//
+PF_LogMgr::PF_LogMgr()
+{
+   fd = -1;
+   pBufs[0] = pBufs[1] = NULL;
+   ppNames = NULL;
+   pClosed = NULL;
+   maxNamed = 0;
+   ckptLSN = ckptBeginLSN = 0;
+   pScanBuf = NULL;
+   numRecords = numWrites = 0;
+
+   pthread_mutex_init(&mutex, NULL);
+   pthread_cond_init(&work, NULL);
+   pthread_cond_init(&done, NULL);
+}
+
+//
+// ~PF_LogMgr
+//
+// Desc: Destructor.  Closes the log if it is open.
+//
+PF_LogMgr::~PF_LogMgr()
+{
+   if (fd >= 0)
+      Close();
+
+   pthread_cond_destroy(&done);
+   pthread_cond_destroy(&work);
+   pthread_mutex_destroy(&mutex);
+}
+
+//
+// Open
+//
+// Desc: Open the log, or create it.  The records up to the first one that
+//       is not whole (or not there) are kept; the rest of the file is cut
+//       off.  The log writer is started.
+// In:   logName - name of the log file
+// Ret:  PF_FILEOPEN if the log is open already, PF_HDRREAD if logName is
+//       not a log, PF_UNIX
+//
+RC PF_LogMgr::Open(const char *logName)
+{
+   PF_LogHdr hdr;
+   PF_LogRec *pRec;
+   PF_LSN lsn, endLSN;
+   ssize_t numBytes;
+   RC rc;
+
+   if (fd >= 0)
+      return (PF_FILEOPEN);
+
+   if ((fd = open(logName, O_CREAT | O_RDWR, CREATION_MASK)) < 0)
+      return (PF_UNIX);
+
+   // A new log only has its header
+   if ((numBytes = pread(fd, &hdr, sizeof(hdr), 0)) == 0) {
+      hdr.magic = PF_LOG_MAGIC;
+      hdr.reserved = 0;
+      hdr.ckptLSN = 0;
+      if (pwrite(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+            fdatasync(fd) < 0) {
+         rc = PF_UNIX;
+         goto err;
+      }
+   }
+   else if (numBytes != sizeof(hdr) || hdr.magic != PF_LOG_MAGIC) {
+      rc = (numBytes < 0) ? PF_UNIX : PF_HDRREAD;
+      goto err;
+   }
+
+   // Find the end of the records, from the last checkpoint on (the
+   // records before may be gone)
+   ckptLSN = hdr.ckptLSN;
+   ckptBeginLSN = 0;
+   pScanBuf = new char[PF_LOG_BUFFER];
+   endLSN = sizeof(PF_LogHdr);
+   if ((rc = Scan(ckptLSN)))
+      goto err;
+   while ((rc = NextRec(lsn, pRec)) == 0)
+      endLSN = lsn + pRec->length;
+   if (rc != PF_EOF || ftruncate(fd, endLSN) < 0) {
+      rc = (rc != PF_EOF) ? rc : PF_UNIX;
+      goto err;
+   }
+
+   pBufs[0] = new char[PF_LOG_BUFFER];
+   pBufs[1] = new char[PF_LOG_BUFFER];
+   cur = 0;
+   numUsed = 0;
+   bufLSN = flushedLSN = wantLSN = endLSN;
+   writeRC = 0;
+   bStop = FALSE;
+   numRecords = numWrites = 0;
+
+   if (pthread_create(&writer, NULL, Writer, this)) {
+      rc = PF_UNIX;
+      goto err;
+   }
+
+   // Return ok
+   return (0);
+
+err:
+   delete [] pBufs[0];
+   delete [] pBufs[1];
+   pBufs[0] = pBufs[1] = NULL;
+   delete [] pScanBuf;
+   pScanBuf = NULL;
+   close(fd);
+   fd = -1;
+   return (rc);
+}
+
+//
+// Close
+//
+// Desc: Write out the records appended, stop the log writer and close the
+//       log
+// Ret:  PF_CLOSEDFILE, error of the last write of the log, PF_UNIX
+//
+RC PF_LogMgr::Close()
+{
+   RC rc;
+
+   if (fd < 0)
+      return (PF_CLOSEDFILE);
+
+   rc = FlushAll();
+
+   pthread_mutex_lock(&mutex);
+   bStop = TRUE;
+   pthread_cond_signal(&work);
+   pthread_mutex_unlock(&mutex);
+   pthread_join(writer, NULL);
+
+   if (close(fd) < 0 && rc == 0)
+      rc = PF_UNIX;
+   fd = -1;
+
+   delete [] pBufs[0];
+   delete [] pBufs[1];
+   pBufs[0] = pBufs[1] = NULL;
+   delete [] pScanBuf;
+   pScanBuf = NULL;
+   for (int i = 0; i < maxNamed; i++)
+      delete [] ppNames[i];
+   delete [] ppNames;
+   ppNames = NULL;
+   delete [] pClosed;
+   pClosed = NULL;
+   maxNamed = 0;
+
+   return (rc);
+}
+
+//
+// Append
+//
+// Desc: Append a record to the log.  It is written by the log writer
+//       when somebody waits for it, or when the buffer fills up.
+// In:   type - PF_LogRecType
+//       fileNo, pageNum, offset - the file, and where the data goes
+//       pData - dataLength bytes of data
+// Out:  lsn - LSN of the record
+// Ret:  PF_CLOSEDFILE, error of an earlier write of the log
+//
+RC PF_LogMgr::Append(int type, int fileNo, PageNum pageNum, int offset,
+      const char *pData, int dataLength, PF_LSN &lsn)
+{
+   PF_LogRec rec;
+   static const char zeros[8] = { 0 };
+   RC rc;
+
+   if (fd < 0)
+      return (PF_CLOSEDFILE);
+
+   // The checksum does not depend on where the record goes
+   rec.length = (sizeof(PF_LogRec) + dataLength + 7) / 8 * 8;
+   rec.type = type;
+   rec.fileNo = fileNo;
+   rec.pageNum = pageNum;
+   rec.offset = offset;
+   rec.dataLength = dataLength;
+   rec.checksum = 0;
+   rec.reserved = 0;
+   int padLength = rec.length - sizeof(PF_LogRec) - dataLength;
+   unsigned int sum = PF_LogSum(PF_LOG_SUM_START, (char *)&rec, sizeof(rec));
+   sum = PF_LogSum(sum, pData, dataLength);
+   rec.checksum = PF_LogSum(sum, zeros, padLength);
+
+   pthread_mutex_lock(&mutex);
+
+   // Wait for the writer to take the buffer if the record does not fit
+   while (!writeRC && numUsed + rec.length > PF_LOG_BUFFER) {
+      pthread_cond_signal(&work);
+      pthread_cond_wait(&done, &mutex);
+   }
+   if ((rc = writeRC)) {
+      pthread_mutex_unlock(&mutex);
+      return (rc);
+   }
+
+   char *p = pBufs[cur] + numUsed;
+   memcpy(p, &rec, sizeof(rec));
+   if (dataLength > 0)
+      memcpy(p + sizeof(rec), pData, dataLength);
+   memset(p + sizeof(rec) + dataLength, 0, padLength);
+   lsn = bufLSN + numUsed;
+   numUsed += rec.length;
+   numRecords++;
+
+   pthread_mutex_unlock(&mutex);
+
+   // Return ok
+   return (0);
+}
+
+//
+// Name
+//
+// Desc: Tell the log the name of fileNo (once)
+// In:   fileNo - # of the file
+//       fileName - its name
+// Ret:  as Append
+//
+RC PF_LogMgr::Name(int fileNo, const char *fileName)
+{
+   PF_LSN lsn;
+   RC rc;
+
+   pthread_mutex_lock(&mutex);
+   if (fileNo >= maxNamed) {
+      int newMaxNamed = (maxNamed > 0) ? maxNamed : 16;
+      while (newMaxNamed <= fileNo)
+         newMaxNamed *= 2;
+      char **ppNewNames = new char *[newMaxNamed];
+      char *pNewClosed = new char[newMaxNamed];
+      for (int i = 0; i < newMaxNamed; i++) {
+         ppNewNames[i] = (i < maxNamed) ? ppNames[i] : NULL;
+         pNewClosed[i] = (i < maxNamed) ? pClosed[i] : FALSE;
+      }
+      delete [] ppNames;
+      delete [] pClosed;
+      ppNames = ppNewNames;
+      pClosed = pNewClosed;
+      maxNamed = newMaxNamed;
+   }
+   int bNamed = (ppNames[fileNo] != NULL);
+   if (!bNamed) {
+      ppNames[fileNo] = new char[strlen(fileName) + 1];
+      strcpy(ppNames[fileNo], fileName);
+   }
+   pthread_mutex_unlock(&mutex);
+
+   if (bNamed)
+      return (0);
+   if ((rc = Append(PF_LOGREC_FILE, fileNo, -1, 0, fileName,
+         strlen(fileName) + 1, lsn))) {
+      pthread_mutex_lock(&mutex);
+      delete [] ppNames[fileNo];
+      ppNames[fileNo] = NULL;
+      pthread_mutex_unlock(&mutex);
+      return (rc);
+   }
+   return (0);
+}
+
+//
+// NameAll
+//
+// Desc: Append the PF_LOGREC_FILE record of each file named again (for a
+//       checkpoint: the records before it may be gone)
+// Ret:  as Append
+//
+RC PF_LogMgr::NameAll()
+{
+   PF_LSN lsn;
+   RC rc = 0;
+
+   for (int i = 0; !rc; i++) {
+      char *fileName = NULL;
+
+      pthread_mutex_lock(&mutex);
+      if (i >= maxNamed) {
+         pthread_mutex_unlock(&mutex);
+         break;
+      }
+      if (ppNames[i] != NULL) {
+         fileName = new char[strlen(ppNames[i]) + 1];
+         strcpy(fileName, ppNames[i]);
+      }
+      pthread_mutex_unlock(&mutex);
+
+      if (fileName != NULL)
+         rc = Append(PF_LOGREC_FILE, i, -1, 0, fileName,
+               strlen(fileName) + 1, lsn);
+      delete [] fileName;
+   }
+   return (rc);
+}
+
+//
+// Named
+//
+// Desc: Find out whether fileNo was named (its changes may be in the log)
+// Ret:  TRUE or FALSE
+//
+int PF_LogMgr::Named(int fileNo)
+{
+   pthread_mutex_lock(&mutex);
+   int bNamed = (fileNo >= 0 && fileNo < maxNamed && ppNames[fileNo]);
+   pthread_mutex_unlock(&mutex);
+   return (bNamed);
+}
+
+//
+// Closed
+//
+// Desc: Note that fileNo is being closed.  Its pages are written, but
+//       not synced: SyncClosed syncs them later, all at once.  This is
+//       noted before they are written, so that a checkpoint either finds
+//       the pages dirty or syncs them.  Nothing is noted for a file not
+//       named.
+// In:   fileNo - # of the file
+//
+void PF_LogMgr::Closed(int fileNo)
+{
+   pthread_mutex_lock(&mutex);
+   if (fileNo >= 0 && fileNo < maxNamed && ppNames[fileNo] != NULL)
+      pClosed[fileNo] = TRUE;
+   pthread_mutex_unlock(&mutex);
+}
+
+//
+// SyncClosed
+//
+// Desc: fdatasync the files closed since they were last synced, opening
+//       them by their names.  Files that cannot be opened any more (they
+//       were destroyed) need not be synced.  A file closed again
+//       meanwhile is synced next time.
+// Ret:  PF_UNIX
+//
+RC PF_LogMgr::SyncClosed()
+{
+   RC rc = 0;
+
+   for (int i = 0; !rc; i++) {
+      char *fileName = NULL;
+      int fileFd;
+
+      pthread_mutex_lock(&mutex);
+      if (i >= maxNamed) {
+         pthread_mutex_unlock(&mutex);
+         break;
+      }
+      if (pClosed[i] && ppNames[i] != NULL) {
+         fileName = new char[strlen(ppNames[i]) + 1];
+         strcpy(fileName, ppNames[i]);
+      }
+      pClosed[i] = FALSE;
+      pthread_mutex_unlock(&mutex);
+
+      if (fileName != NULL && (fileFd = open(fileName, O_RDONLY)) >= 0) {
+         if (fdatasync(fileFd) < 0) {
+            Closed(i);
+            rc = PF_UNIX;
+         }
+         close(fileFd);
+      }
+      delete [] fileName;
+   }
+   return (rc);
+}
+
+//
+// Flush
+//
+// Desc: Wait until the record at lsn is on the disk.  The clients that
+//       wait at the same time share the write and the fdatasync.
+// In:   lsn - LSN of the record, 0 for none
+// Ret:  error of the write of the log
+//
+RC PF_LogMgr::Flush(PF_LSN lsn)
+{
+   RC rc;
+
+   if (lsn == 0 || fd < 0)
+      return (0);
+
+   pthread_mutex_lock(&mutex);
+   while (!writeRC && flushedLSN <= lsn && lsn < bufLSN + numUsed) {
+      if (wantLSN <= lsn)
+         wantLSN = lsn + 1;
+      pthread_cond_signal(&work);
+      pthread_cond_wait(&done, &mutex);
+   }
+   rc = writeRC;
+   pthread_mutex_unlock(&mutex);
+
+   return (rc);
+}
+
+//
+// FlushAll
+//
+// Desc: Wait until all of the records appended are on the disk
+// Ret:  as Flush
+//
+RC PF_LogMgr::FlushAll()
+{
+   PF_LSN lsn;
+
+   if (fd < 0)
+      return (0);
+
+   pthread_mutex_lock(&mutex);
+   lsn = bufLSN + numUsed - 1;
+   pthread_mutex_unlock(&mutex);
+
+   return (Flush(lsn));
+}
+
+//
+// OnDisk
+//
+// Desc: Find out whether the record at lsn is on the disk.  If not, have
+//       the log writer write it without waiting.
+// In:   lsn - LSN of the record, 0 for none
+// Ret:  TRUE or FALSE
+//
+int PF_LogMgr::OnDisk(PF_LSN lsn)
+{
+   int bOnDisk;
+
+   if (lsn == 0 || fd < 0)
+      return (TRUE);
+
+   pthread_mutex_lock(&mutex);
+   if (!(bOnDisk = (flushedLSN > lsn))) {
+      if (wantLSN <= lsn)
+         wantLSN = lsn + 1;
+      pthread_cond_signal(&work);
+   }
+   pthread_mutex_unlock(&mutex);
+
+   return (bOnDisk);
+}
+
+//
+// EndLSN
+//
+// Desc: Where the log ends now
+// Ret:  the LSN of the next record appended
+//
+PF_LSN PF_LogMgr::EndLSN()
+{
+   pthread_mutex_lock(&mutex);
+   PF_LSN lsn = bufLSN + numUsed;
+   pthread_mutex_unlock(&mutex);
+   return (lsn);
+}
+
+//
+// Scan
+//
+// Desc: Start reading the records from the one at lsn on
+// In:   lsn - LSN of a record, 0 for the first
+// Ret:  PF_CLOSEDFILE
+//
+RC PF_LogMgr::Scan(PF_LSN lsn)
+{
+   if (fd < 0)
+      return (PF_CLOSEDFILE);
+
+   scanLen = scanPos = 0;
+   scanLSN = (lsn > 0) ? lsn : sizeof(PF_LogHdr);
+   return (0);
+}
+
+//
+// NextRec
+//
+// Desc: Get the next record.  The records end at the first one that is
+//       cut short or damaged.
+// Out:  lsn - its LSN
+//       pRec - the record, followed by its data
+// Ret:  PF_EOF if there are no more records, PF_UNIX
+//
+RC PF_LogMgr::NextRec(PF_LSN &lsn, PF_LogRec *&pRec)
+{
+   PF_LogRec *p;
+   RC rc;
+
+   if ((rc = ScanFill(sizeof(PF_LogRec))))
+      return (rc);
+   p = (PF_LogRec *)(pScanBuf + scanPos);
+   if (p->length < (int)sizeof(PF_LogRec) || p->length > PF_LOG_MAX_REC ||
+         p->length % 8 != 0 || p->dataLength < 0 ||
+         p->dataLength > p->length - (int)sizeof(PF_LogRec))
+      return (PF_EOF);
+   if ((rc = ScanFill(p->length)))
+      return (rc);
+
+   p = (PF_LogRec *)(pScanBuf + scanPos);
+   unsigned int checksum = p->checksum;
+   p->checksum = 0;
+   if (PF_LogSum(PF_LOG_SUM_START, (char *)p, p->length) != checksum)
+      return (PF_EOF);
+   p->checksum = checksum;
+
+   lsn = scanLSN + scanPos;
+   pRec = p;
+   scanPos += p->length;
+
+   // Return ok
+   return (0);
+}
+
+//
+// ScanFill
+//
+// Desc: Internal.  Read the log so that the numBytes bytes at scanPos
+//       are in the scan buffer
+// Ret:  PF_EOF if the log is shorter, PF_UNIX
+//
+RC PF_LogMgr::ScanFill(int numBytes)
+{
+   ssize_t n;
+
+   if (scanLen - scanPos >= numBytes)
+      return (0);
+
+   // Move what is left to the start of the buffer and read on
+   memmove(pScanBuf, pScanBuf + scanPos, scanLen - scanPos);
+   scanLSN += scanPos;
+   scanLen -= scanPos;
+   scanPos = 0;
+   while (scanLen < numBytes) {
+      if ((n = pread(fd, pScanBuf + scanLen, PF_LOG_BUFFER - scanLen,
+            scanLSN + scanLen)) < 0)
+         return (PF_UNIX);
+      if (n == 0)
+         return (PF_EOF);
+      scanLen += n;
+   }
+
+   // Return ok
+   return (0);
+}
+
+//
+// Truncate
+//
+// Desc: Drop all of the records.  The files named in the log are named
+//       again in new records.
+// Ret:  as Flush, PF_UNIX
+//
+RC PF_LogMgr::Truncate()
+{
+   RC rc;
+
+   if (fd < 0)
+      return (PF_CLOSEDFILE);
+   if ((rc = FlushAll()))
+      return (rc);
+
+   pthread_mutex_lock(&mutex);
+   ckptLSN = ckptBeginLSN = 0;
+   if ((rc = WriteHdr()) == 0 &&
+         (ftruncate(fd, sizeof(PF_LogHdr)) < 0 || fdatasync(fd) < 0))
+      rc = PF_UNIX;
+   if (!rc) {
+      bufLSN = flushedLSN = wantLSN = sizeof(PF_LogHdr);
+      numUsed = 0;
+      for (int i = 0; i < maxNamed; i++) {
+         delete [] ppNames[i];
+         ppNames[i] = NULL;
+         pClosed[i] = FALSE;
+      }
+   }
+   pthread_mutex_unlock(&mutex);
+
+   return (rc);
+}
+
+//
+// SetCheckpoint
+//
+// Desc: Make the checkpoint whose last record is at ckptLSN the one a
+//       restart starts from, once it is on the disk.  The space of the
+//       records before redoLSN is given back (where the file system can
+//       punch holes in a file); their offsets stay the LSNs of the
+//       records after them.
+// In:   ckptLSN - LSN of the last record of the checkpoint
+//       beginLSN - where the log ended when it began
+//       redoLSN - LSN of the first record a restart needs
+// Ret:  as Flush, PF_UNIX
+//
+RC PF_LogMgr::SetCheckpoint(PF_LSN _ckptLSN, PF_LSN beginLSN,
+      PF_LSN redoLSN)
+{
+   RC rc;
+
+   if (fd < 0)
+      return (PF_CLOSEDFILE);
+   if ((rc = Flush(_ckptLSN)))
+      return (rc);
+
+   pthread_mutex_lock(&mutex);
+   ckptLSN = _ckptLSN;
+   ckptBeginLSN = beginLSN;
+   if ((rc = WriteHdr()) == 0 && fdatasync(fd) < 0)
+      rc = PF_UNIX;
+   pthread_mutex_unlock(&mutex);
+   if (rc)
+      return (rc);
+
+#ifdef FALLOC_FL_PUNCH_HOLE
+   const PF_LSN block = 4096;
+   PF_LSN start = block, end = redoLSN / block * block;
+   if (end > start)
+      fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, start,
+            end - start);
+#endif
+
+   // Return ok
+   return (0);
+}
+
+//
+// CheckpointLSN
+//
+// Desc: Where the last checkpoint ends
+// Ret:  LSN of its last record, 0 if there is none
+//
+PF_LSN PF_LogMgr::CheckpointLSN()
+{
+   pthread_mutex_lock(&mutex);
+   PF_LSN lsn = ckptLSN;
+   pthread_mutex_unlock(&mutex);
+   return (lsn);
+}
+
+//
+// CheckpointBegin
+//
+// Desc: Where the log ended when the last checkpoint taken since the log
+//       was opened began
+// Ret:  the LSN, 0 if none was taken
+//
+PF_LSN PF_LogMgr::CheckpointBegin()
+{
+   pthread_mutex_lock(&mutex);
+   PF_LSN lsn = ckptBeginLSN;
+   pthread_mutex_unlock(&mutex);
+   return (lsn);
+}
+
+//
+// SinceCheckpoint
+//
+// Desc: # of bytes of records appended since the last checkpoint (or
+//       since the log starts)
+//
+PF_LSN PF_LogMgr::SinceCheckpoint()
+{
+   pthread_mutex_lock(&mutex);
+   PF_LSN since = bufLSN + numUsed -
+      (ckptLSN > 0 ? ckptLSN : (PF_LSN)sizeof(PF_LogHdr));
+   pthread_mutex_unlock(&mutex);
+   return (since);
+}
+
+//
+// WriteHdr
+//
+// Desc: Internal.  Write ckptLSN to the log header (without syncing it)
+// Ret:  PF_UNIX
+//
+RC PF_LogMgr::WriteHdr()
+{
+   if (pwrite(fd, &ckptLSN, sizeof(ckptLSN), offsetof(PF_LogHdr, ckptLSN))
+         != sizeof(ckptLSN))
+      return (PF_UNIX);
+   return (0);
+}
+
+//
+// GetStats
+//
+// Desc: # of records appended and of writes of the log since it was
+//       opened
+//
+void PF_LogMgr::GetStats(int &_numRecords, int &_numWrites)
+{
+   pthread_mutex_lock(&mutex);
+   _numRecords = numRecords;
+   _numWrites = numWrites;
+   pthread_mutex_unlock(&mutex);
+}
+
+//
+// Writer
+//
+// Desc: Internal.  Body of the log writer.  It writes the buffer appended
+//       to when a client waits for a record in it or when it is half
+//       full, and on exit.
+//
+void *PF_LogMgr::Writer(void *pLogMgr)
+{
+   ((PF_LogMgr *)pLogMgr)->Run();
+   return (NULL);
+}
+
+void PF_LogMgr::Run()
+{
+   pthread_mutex_lock(&mutex);
+
+   for (;;) {
+      while (!bStop && (numUsed == 0 ||
+            (wantLSN <= bufLSN && numUsed < PF_LOG_BUFFER / 2)))
+         pthread_cond_wait(&work, &mutex);
+      if (numUsed == 0)
+         break;
+
+      // Take the buffer; the clients go on with the other one
+      char *pBuf = pBufs[cur];
+      int numBytes = numUsed;
+      PF_LSN lsn = bufLSN;
+      cur = 1 - cur;
+      numUsed = 0;
+      bufLSN += numBytes;
+      pthread_cond_broadcast(&done);
+
+      // Write it without holding the mutex
+      pthread_mutex_unlock(&mutex);
+      RC rc = 0;
+      for (int n = 0; n < numBytes && !rc; ) {
+         ssize_t written = pwrite(fd, pBuf + n, numBytes - n, lsn + n);
+         if (written <= 0)
+            rc = PF_UNIX;
+         else
+            n += written;
+      }
+      if (!rc && fdatasync(fd) < 0)
+         rc = PF_UNIX;
+      pthread_mutex_lock(&mutex);
+
+      if (rc)
+         writeRC = rc;
+      else
+         flushedLSN = lsn + numBytes;
+      numWrites++;
+      pthread_cond_broadcast(&done);
+      if (rc)
+         break;
+   }
+
+   pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,202 @@
+//
+// File:        pf_logmgr.h
+// Description: PF_LogMgr - write-ahead log of the changes to PF files
+//
+// The log holds, in the order they were made, the changes to the pages
+// and headers of the files opened while it is open, as after images of
+// the bytes that changed (and a few records of their own for files and
+// pages that come and go).  Since a page may only be written once the
+// records of its changes are on the disk (the buffer manager sees to
+// that), the log alone is enough to bring the files up to date after a
+// crash: pages can be written whenever the buffer likes (or never), and
+// nothing needs to be forced to make a change durable but the log.
+//
+// The log sequence number (LSN) of a record is its offset in the log
+// file.  Records are appended to one of two buffers in memory; a log
+// writer thread writes the other one out, followed by an fdatasync.  A
+// client that wants its records on the disk (Flush) waits for the writer,
+// and the records of all clients that wait meanwhile are written and
+// synced at once (group commit).
+//
+// A record is a PF_LogRec followed by its data and padded to 8 bytes.
+// A checksum tells where the records written before a crash end.
+//
+// A checkpoint (see PF_Manager) lists the pages that were dirty in the
+// buffer, with the LSN of their first change that was not written
+// (recLSN).  Once it is on the disk the log header points to its last
+// record; the records before the oldest recLSN are not needed any more
+// and their space is given back to the file system.
+//
+
+#ifndef PF_LOGMGR_H
+#define PF_LOGMGR_H
+
+#include <pthread.h>
+#include "pf_internal.h"
+
+//
+// PF_LogRecType - what a record stands for
+//
+enum PF_LogRecType {
+   PF_LOGREC_FILE,          // fileNo is the file named by the data
+   PF_LOGREC_CREATE,        // fileNo was created
+   PF_LOGREC_DESTROY,       // fileNo was destroyed
+   PF_LOGREC_ALLOC,         // page allocated: zeroed, and marked used
+   PF_LOGREC_PAGE,          // bytes of a page (its header included) are
+                            //   now the data
+   PF_LOGREC_HDR,           // bytes of the file header are now the data
+   PF_LOGREC_CKPT           // part of a checkpoint: PF_CkptData followed
+                            //   by pageNum PF_DirtyPages; offset is TRUE
+                            //   in the last part
+};
+
+//
+// PF_LogHdr - first bytes of the log file
+//
+struct PF_LogHdr {
+   int    magic;            // PF_LOG_MAGIC
+   int    reserved;
+   PF_LSN ckptLSN;          // last record of the last checkpoint, 0 if
+                            //   there is none
+};
+
+//
+// PF_CkptData - start of the data of a checkpoint record
+//
+struct PF_CkptData {
+   PF_LSN beginLSN;         // the log ended here when the checkpoint began
+};
+
+//
+// PF_DirtyPage - a page that was dirty at a checkpoint
+//
+struct PF_DirtyPage {
+   int     fileNo;
+   PageNum pageNum;
+   PF_LSN  recLSN;          // first change to it that was not written
+};
+
+//
+// PF_LogRec - header of a log record
+//
+struct PF_LogRec {
+   int          length;     // # of bytes of the record, data and padding
+                            //   included
+   int          type;       // PF_LogRecType
+   int          fileNo;     // file, as numbered by PF_Manager::FileNo
+   PageNum      pageNum;    // page changed
+   int          offset;     // where the data goes in the page or header
+   int          dataLength; // # of bytes of data
+   unsigned int checksum;   // of the whole record, with checksum 0
+   int          reserved;
+};
+
+// Largest record: a whole page of the largest size; most dirty pages in
+// a checkpoint record
+const int PF_LOG_MAX_REC = (int)(sizeof(PF_LogRec) + sizeof(PF_PageHdr)) +
+   PF_MAX_PAGE_SIZE + 8;
+const int PF_CKPT_MAX_PAGES = (PF_LOG_MAX_REC - (int)sizeof(PF_LogRec) -
+   (int)sizeof(PF_CkptData)) / (int)sizeof(PF_DirtyPage);
+
+class PF_LogMgr {
+public:
+    PF_LogMgr      ();
+    ~PF_LogMgr     ();                  // Closes the log
+
+    // Open the log logName, creating it if need be.  The records found in
+    // it are kept (a torn end is cut off), and new ones go after them.
+    // Ret: PF_HDRREAD if logName is no log, PF_UNIX
+    RC   Open      (const char *logName);
+    // Write out all of the records and close the log
+    RC   Close     ();
+
+    // Append a record of dataLength bytes of data from pData; lsn is set
+    // to its LSN
+    RC   Append    (int type, int fileNo, PageNum pageNum, int offset,
+                    const char *pData, int dataLength, PF_LSN &lsn);
+    // Append a PF_LOGREC_FILE record the first time fileNo is used since
+    // the log was opened or truncated; NameAll appends one again for each
+    // file named
+    RC   Name      (int fileNo, const char *fileName);
+    RC   NameAll   ();
+    // TRUE if fileNo was named since the log was opened or truncated
+    int  Named     (int fileNo);
+    // fileNo, named, is being closed: its pages may not be on the disk
+    // when it is.  SyncClosed fdatasyncs the files closed since it was
+    // last called (by their names; those that are gone are left out).
+    void Closed    (int fileNo);
+    RC   SyncClosed();
+
+    // Wait until the record at lsn (0: none) is on the disk
+    RC   Flush     (PF_LSN lsn);
+    // Same, for all of the records appended so far
+    RC   FlushAll  ();
+    // TRUE if the record at lsn is on the disk; otherwise the log writer
+    // is asked to write it, without waiting
+    int  OnDisk    (PF_LSN lsn);
+
+    // LSN the next record appended gets
+    PF_LSN EndLSN  ();
+
+    // Read the records, from the one at lsn on (0: the first): Scan
+    // starts over, NextRec sets pRec to the next one (valid until the
+    // next call) and lsn to its LSN.  Not while records are appended.
+    // Ret: PF_EOF after the last record, PF_UNIX
+    RC   Scan      (PF_LSN lsn = 0);
+    RC   NextRec   (PF_LSN &lsn, PF_LogRec *&pRec);
+
+    // Drop all of the records: the files are up to date on the disk
+    RC   Truncate  ();
+
+    // Point the log header to the checkpoint that began at beginLSN and
+    // ends at ckptLSN, once it is on the disk, and give back the space of
+    // the records before redoLSN.  CheckpointLSN is where the last
+    // checkpoint ends (0: none), CheckpointBegin where the last one taken
+    // since the log was opened began (0: none), and SinceCheckpoint the
+    // # of bytes appended since the last one.
+    RC   SetCheckpoint(PF_LSN ckptLSN, PF_LSN beginLSN, PF_LSN redoLSN);
+    PF_LSN CheckpointLSN();
+    PF_LSN CheckpointBegin();
+    PF_LSN SinceCheckpoint();
+
+    // # of records appended and of writes of the log (each with an
+    // fdatasync) since it was opened
+    void GetStats  (int &numRecords, int &numWrites);
+
+private:
+    static void *Writer (void *pLogMgr);
+    void Run       ();
+    // Have numBytes bytes from scanPos on in the scan buffer
+    RC   ScanFill  (int numBytes);
+    // Write ckptLSN to the log header
+    RC   WriteHdr  ();
+
+    int             fd;                    // log file, -1 if not open
+    char            *pBufs[2];             // append buffers
+    int             cur;                   //   the one appended to
+    int             numUsed;               //   # of bytes in it
+    PF_LSN          bufLSN;                //   LSN of its first byte
+    PF_LSN          flushedLSN;            // the log is on the disk up to
+    PF_LSN          wantLSN;               // clients wait for it up to
+    PF_LSN          ckptLSN;               // as in the log header
+    PF_LSN          ckptBeginLSN;          // last checkpoint began at
+    RC              writeRC;               // error of the log writer
+    int             bStop;                 // the log writer must exit
+    pthread_t       writer;
+    char            **ppNames;             // names of the fileNos named in
+    int             maxNamed;              //   the log, NULL if not named
+    char            *pClosed;              //   and which were closed since
+                                           //   they were last synced
+    int             numRecords;            // statistics
+    int             numWrites;
+    pthread_mutex_t mutex;
+    pthread_cond_t  work;                  // the writer has work to do
+    pthread_cond_t  done;                  // it took a buffer or wrote one
+
+    char            *pScanBuf;             // records read by NextRec
+    int             scanLen;               //   # of bytes in pScanBuf
+    int             scanPos;               //   next record in it
+    PF_LSN          scanLSN;               //   LSN of pScanBuf[0]
+};
+
+#endif
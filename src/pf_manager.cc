@@ -12,6 +12,7 @@
 #include <sys/types.h>
 #include "pf_internal.h"
 #include "pf_buffermgr.h"
+#include "pf_logmgr.h"
 
 //
 // PF_Manager
@@ -19,12 +20,41 @@
 // Desc: Constructor - intended to be called once at begin of program
 //       Handles creation, deletion, opening and closing of files.
 //       It is associated with a PF_BufferMgr that manages the page
-//       buffer and executes the page replacement policies.
+//       buffer and executes the page replacement policies, and with one
+//       for each larger page size files are opened with.  These make up
+//       the default pool; other pools are created by SetPoolSize.
+// In:   _policy - page replacement policy of the buffer managers
 //
-PF_Manager::PF_Manager()
+PF_Manager::PF_Manager(PF_ReplacePolicy _policy)
 {
-   // Create Buffer Manager
-   pBufferMgr = new PF_BufferMgr(PF_BUFFER_SIZE);
+   cleanTarget = PF_CLEAN_TARGET;
+
+   for (int i = 0; i < PF_MAX_POOLS; i++) {
+      pools[i].name[0] = '\0';
+      pools[i].tunePages = 0;
+      pools[i].bCurve = FALSE;
+      for (int c = 0; c < PF_PAGE_CLASSES; c++)
+         pools[i].pBufferMgrs[c] = NULL;
+   }
+
+   // Create Buffer Manager of PF_PAGE_SIZE pages; the others are created
+   // when needed
+   strcpy(pools[0].name, PF_DEFAULT_POOL);
+   pools[0].policy = _policy;
+   pools[0].bufferPages = PF_BUFFER_SIZE;
+   pools[0].pBufferMgrs[0] = new PF_BufferMgr(pools[0].bufferPages,
+         pools[0].policy);
+
+   ppFileStats = NULL;
+   numFileStats = maxFileStats = 0;
+   pWarmSets = NULL;
+   numCloses = 0;
+   numOpen = 0;
+   pLog = NULL;
+   pthread_mutex_init(&ckptLatch, NULL);
+   ppBoundFiles = NULL;
+   pBoundPools = NULL;
+   numBound = maxBound = 0;
 }
 
 //
@@ -36,8 +66,234 @@ PF_Manager::PF_Manager()
 //
 PF_Manager::~PF_Manager()
 {
+   // No warm-up may go on in the buffers
+   for (int i = 0; i < numFileStats; i++)
+      StopWarmUp(i);
+
    // Destroy the buffer manager objects
-   delete pBufferMgr;
+   for (int i = 0; i < PF_MAX_POOLS; i++)
+      for (int c = 0; c < PF_PAGE_CLASSES; c++)
+         delete pools[i].pBufferMgrs[c];
+   delete pLog;
+   pthread_mutex_destroy(&ckptLatch);
+
+   for (int i = 0; i < numFileStats; i++) {
+      delete [] ppFileStats[i]->fileName;
+      delete ppFileStats[i];
+      delete [] pWarmSets[i].pPages;
+   }
+   delete [] ppFileStats;
+   delete [] pWarmSets;
+
+   for (int i = 0; i < numBound; i++)
+      delete [] ppBoundFiles[i];
+   delete [] ppBoundFiles;
+   delete [] pBoundPools;
+}
+
+//
+// BufferMgr
+//
+// Desc: Internal.  The buffer manager of a pool of pages of pageSize,
+//       which is created with the settings of the pool if there is none
+//       yet
+// In:   pool - the pool
+//       pageSize - # of bytes of data of a page
+// Ret:  the buffer manager, or NULL if there are no pages of pageSize
+//
+PF_BufferMgr *PF_Manager::BufferMgr(PF_Pool &pool, int pageSize)
+{
+   int c = PF_PageClass(pageSize);
+
+   if (c < 0)
+      return (NULL);
+   if (pool.pBufferMgrs[c] == NULL) {
+      pool.pBufferMgrs[c] = new PF_BufferMgr(
+            PF_ClassPages(pool.bufferPages, c), pool.policy, 0, pageSize);
+      pool.pBufferMgrs[c]->SetCleanTarget(cleanTarget);
+      pool.pBufferMgrs[c]->SetLog(pLog);
+      pool.pBufferMgrs[c]->KeepCurve(pool.bCurve || pool.tunePages > 0);
+   }
+   return (pool.pBufferMgrs[c]);
+}
+
+//
+// Pool
+//
+// Desc: Internal.  The pool named poolName
+// Ret:  the pool, or NULL if there is none
+//
+PF_Pool *PF_Manager::Pool(const char *poolName)
+{
+   for (int i = 0; i < PF_MAX_POOLS; i++)
+      if (pools[i].name[0] != '\0' && strcmp(pools[i].name, poolName) == 0)
+         return (&pools[i]);
+   return (NULL);
+}
+
+//
+// FilePool
+//
+// Desc: Internal.  The pool the file fileName is bound to
+// In:   fileName - name of the file, as given to OpenFile
+// Ret:  the pool
+//
+PF_Pool &PF_Manager::FilePool(const char *fileName)
+{
+   for (int i = 0; i < numBound; i++)
+      if (strcmp(ppBoundFiles[i], fileName) == 0)
+         return (pools[pBoundPools[i]]);
+   return (pools[0]);
+}
+
+//
+// FileNo
+//
+// Desc: Internal.  The # of fileName among the files the PF_Manager
+//       knows: its statistics are ppFileStats[#] and its warm set
+//       pWarmSets[#].  They are created when it is first opened (or its
+//       warm set loaded).  The statistics stay where they are as long as
+//       the PF_Manager, so that the buffer managers may count in them.
+// In:   fileName - name of the file, as given to OpenFile
+// Ret:  the # of the file
+//
+int PF_Manager::FileNo(const char *fileName)
+{
+   PF_FileStats *pStats;
+   int i;
+
+   for (i = 0; i < numFileStats; i++)
+      if (strcmp(ppFileStats[i]->fileName, fileName) == 0)
+         return (i);
+
+   // Make room for another one
+   if (numFileStats == maxFileStats) {
+      maxFileStats = (maxFileStats > 0) ? 2 * maxFileStats : 16;
+      PF_FileStats **ppNewStats = new PF_FileStats *[maxFileStats];
+      PF_WarmSet *pNewWarmSets = new PF_WarmSet[maxFileStats];
+      for (i = 0; i < numFileStats; i++) {
+         ppNewStats[i] = ppFileStats[i];
+         pNewWarmSets[i] = pWarmSets[i];
+      }
+      delete [] ppFileStats;
+      delete [] pWarmSets;
+      ppFileStats = ppNewStats;
+      pWarmSets = pNewWarmSets;
+   }
+
+   pStats = new PF_FileStats;
+   memset(pStats, 0, sizeof(*pStats));
+   pStats->fileName = new char[strlen(fileName) + 1];
+   strcpy(pStats->fileName, fileName);
+   ppFileStats[numFileStats] = pStats;
+   memset(&pWarmSets[numFileStats], 0, sizeof(PF_WarmSet));
+   return (numFileStats++);
+}
+
+//
+// WarmUp
+//
+// Desc: Internal.  Start bringing the pages of the warm set of a file
+//       that was just opened into the buffer, in file order, in a thread
+//       of its own (WarmUpPages): the file can be used meanwhile.  If no
+//       thread can be started, they are left out: the warm set is only a
+//       guess.
+// In:   fileHandle - the open file
+//
+void PF_Manager::WarmUp(PF_FileHandle &fileHandle)
+{
+   PF_WarmSet &warm = pWarmSets[fileHandle.fileNo];
+   PF_WarmUp *pWarmUp = new PF_WarmUp;
+
+   // The pages are those the file still has
+   pWarmUp->pBufferMgr = fileHandle.pBufferMgr;
+   pWarmUp->fd = fileHandle.unixfd;
+   pWarmUp->pPages = warm.pPages;
+   pWarmUp->numPages = warm.numPages;
+   while (pWarmUp->numPages > 0 &&
+         pWarmUp->pPages[pWarmUp->numPages - 1] >= fileHandle.hdr.numPages)
+      pWarmUp->numPages--;
+   pWarmUp->bStop = FALSE;
+   warm.pPages = NULL;
+   warm.numPages = 0;
+   warm.bPending = FALSE;
+
+   if (pthread_create(&pWarmUp->thread, NULL, WarmUpPages, pWarmUp)) {
+      delete [] pWarmUp->pPages;
+      delete pWarmUp;
+      return;
+   }
+   warm.pWarmUp = pWarmUp;
+}
+
+//
+// WarmUpPages
+//
+// Desc: Internal.  Bring the pages of a PF_WarmUp into the buffer, in a
+//       warm-up thread.  They are read ahead while the reads can be
+//       queued; when the queue is full, the thread reads the next page
+//       itself, and then queues reads again.  Pages that cannot be read
+//       are skipped.  Stops early once bStop is set.
+// In:   pWarmUp - the PF_WarmUp
+// Ret:  NULL
+//
+void *PF_Manager::WarmUpPages(void *_pWarmUp)
+{
+   PF_WarmUp *pWarmUp = (PF_WarmUp *)_pWarmUp;
+   PF_BufferMgr *pBufferMgr = pWarmUp->pBufferMgr;
+   char *pData;
+
+   for (int i = 0; i < pWarmUp->numPages &&
+         !__atomic_load_n(&pWarmUp->bStop, __ATOMIC_ACQUIRE); i++) {
+      PageNum pageNum = pWarmUp->pPages[i];
+      if (pBufferMgr->Prefetch(pWarmUp->fd, pageNum) == PF_NOBUF &&
+            pBufferMgr->GetPage(pWarmUp->fd, pageNum, &pData) == 0)
+         pBufferMgr->UnpinPage(pWarmUp->fd, pageNum);
+   }
+   return (NULL);
+}
+
+//
+// StopWarmUp
+//
+// Desc: Internal.  Stop the warm-up thread of a file, if it has one, or
+//       let it read the rest of its pages, and wait for it to be done
+// In:   fileNo - # of the file
+//       bWait - TRUE to let it read the rest
+//
+void PF_Manager::StopWarmUp(int fileNo, int bWait)
+{
+   PF_WarmUp *pWarmUp = pWarmSets[fileNo].pWarmUp;
+
+   if (pWarmUp == NULL)
+      return;
+   if (!bWait)
+      __atomic_store_n(&pWarmUp->bStop, TRUE, __ATOMIC_RELEASE);
+   pthread_join(pWarmUp->thread, NULL);
+   delete [] pWarmUp->pPages;
+   delete pWarmUp;
+   pWarmSets[fileNo].pWarmUp = NULL;
+}
+
+//
+// WaitWarmUp
+//
+// Desc: Wait until the pages of the warm set of an open file are in the
+//       buffer (or were skipped).  Returns at once if the file had none.
+// In:   fileHandle - the open file
+// Ret:  PF_CLOSEDFILE
+//
+RC PF_Manager::WaitWarmUp(const PF_FileHandle &fileHandle)
+{
+   if (!fileHandle.bFileOpen)
+      return (PF_CLOSEDFILE);
+
+   PF_WarmUp *pWarmUp = pWarmSets[fileHandle.fileNo].pWarmUp;
+   if (pWarmUp != NULL && pWarmUp->fd == fileHandle.unixfd)
+      StopWarmUp(fileHandle.fileNo, TRUE);
+
+   // Return ok
+   return (0);
 }
 
 //
@@ -45,12 +301,22 @@ PF_Manager::~PF_Manager()
 //
 // Desc: Create a new PF file named fileName
 // In:   fileName - name of file to create
-// Ret:  PF return code
+//       pageSize - # of bytes of data of its pages: PF_PAGE_SIZE, or
+//       PF_PageSize(n) for pages of n K (n = 8, 16, 32 or 64)
+//       extentPages - # of pages the file grows by at a time (see
+//       PF_FileHdr); 0 or 1 to grow a page at a time
+//       bCompress - compress the pages on disk
+// Ret:  PF_BADPAGESIZE or other PF return code
 //
-RC PF_Manager::CreateFile (const char *fileName)
+RC PF_Manager::CreateFile (const char *fileName, int pageSize,
+      int extentPages, int bCompress)
 {
    int fd;		// unix file descriptor
    int numBytes;		// return code form write syscall
+   RC rc;
+
+   if (PF_PageClass(pageSize) < 0)
+      return (PF_BADPAGESIZE);
 
    // Create file for exclusive use
    if ((fd = open(fileName,
@@ -71,6 +337,11 @@ RC PF_Manager::CreateFile (const char *fileName)
    PF_FileHdr *hdr = (PF_FileHdr*)hdrBuf;
    hdr->firstFree = PF_PAGE_LIST_END;
    hdr->numPages = 0;
+   hdr->pageSize = pageSize;
+   hdr->bCompressed = bCompress;
+   hdr->extentPages = extentPages;
+   hdr->allocPages = 0;
+   hdr->mapPages = PF_MAP_PAGES;
 
    // Write header to file
    if((numBytes = write(fd, hdrBuf, PF_FILE_HDR_SIZE))
@@ -87,10 +358,21 @@ RC PF_Manager::CreateFile (const char *fileName)
          return (PF_HDRWRITE);
    }
 
+   // With a log, the file must be there for the changes logged from now
+   // on: its records start over from here
+   if (pLog != NULL && fdatasync(fd) < 0) {
+      close(fd);
+      unlink(fileName);
+      return (PF_UNIX);
+   }
+
    // Close file
    if(close(fd) < 0)
       return (PF_UNIX);
 
+   if (pLog != NULL && (rc = LogFile(PF_LOGREC_CREATE, fileName)))
+      return (rc);
+
    // Return ok
    return (0);
 }
@@ -104,10 +386,16 @@ RC PF_Manager::CreateFile (const char *fileName)
 //
 RC PF_Manager::DestroyFile (const char *fileName)
 {
+   RC rc;
+
    // Remove the file
    if (unlink(fileName) < 0)
       return (PF_UNIX);
 
+   // Its records in the log are not to be applied any more
+   if (pLog != NULL && (rc = LogFile(PF_LOGREC_DESTROY, fileName)))
+      return (rc);
+
    // Return ok
    return (0);
 }
@@ -123,44 +411,85 @@ RC PF_Manager::DestroyFile (const char *fileName)
 //       of a file is for writing, problems may occur because some writes may
 //       not be seen by a reader of another instance of the file.
 // In:   fileName - name of file to open
+//       ioMode - PF_IO_BUFFERED (default) to go through the OS cache,
+//                PF_IO_DIRECT to bypass it, PF_IO_MMAP to map the file
+//                and read its pages in place (the file cannot be changed
+//                then, and must not be changed by others while it is open)
 // Out:  fileHandle - refer to the open file
 //                    this function modifies local var's in fileHandle
 //       to point to the file data in the file table, and to point to the
 //       buffer manager object
-// Ret:  PF_FILEOPEN or other PF return code
+// Ret:  PF_FILEOPEN, PF_NODIRECTIO, PF_BADPAGESIZE or other PF return code
 //
-RC PF_Manager::OpenFile (const char *fileName, PF_FileHandle &fileHandle)
+RC PF_Manager::OpenFile (const char *fileName, PF_FileHandle &fileHandle,
+      PF_IOMode ioMode)
 {
    int rc;                   // return code
+   ssize_t numBytes;         // return code of pread
+   PF_BufferMgr *pBufferMgr; // buffer manager of the pages of the file
 
    // Ensure file is not already open
    if (fileHandle.bFileOpen)
       return (PF_FILEOPEN);
 
-   // Open the file
+   // A good time to resize the pools that follow their curve
+   TunePools();
+
+   // Open the file (mapped files are only read)
    if ((fileHandle.unixfd = open(fileName,
 #ifdef PC
          O_BINARY |
 #endif
-         O_RDWR)) < 0)
+         (ioMode == PF_IO_MMAP ? O_RDONLY : O_RDWR))) < 0)
       return (PF_UNIX);
 
-   // Read the file header
-   {
-      int numBytes = read(fileHandle.unixfd, (char *)&fileHandle.hdr,
-            sizeof(PF_FileHdr));
-      if (numBytes != sizeof(PF_FileHdr)) {
-         rc = (numBytes < 0) ? PF_UNIX : PF_HDRREAD;
-         goto err;
-      }
+   // Read the file header: its page size tells which buffer manager of
+   // the pool of the file the pages go to
+   if ((numBytes = pread(fileHandle.unixfd, (char *)&fileHandle.hdr,
+         sizeof(PF_FileHdr), 0)) != sizeof(PF_FileHdr)) {
+      rc = (numBytes < 0) ? PF_UNIX : PF_HDRREAD;
+      goto err;
+   }
+   if (fileHandle.hdr.pageSize == 0)
+      fileHandle.hdr.pageSize = PF_PAGE_SIZE;
+   if ((pBufferMgr = BufferMgr(FilePool(fileName),
+         fileHandle.hdr.pageSize)) == NULL) {
+      rc = PF_BADPAGESIZE;
+      goto err;
+   }
+
+   // Compressed pages cannot be used in place: a compressed file opened
+   // with PF_IO_MMAP is read through the buffer instead (still read-only)
+   if (fileHandle.hdr.bCompressed && ioMode == PF_IO_MMAP) {
+      fileHandle.bReadOnly = TRUE;
+      ioMode = PF_IO_BUFFERED;
    }
+   else
+      fileHandle.bReadOnly = (ioMode == PF_IO_MMAP);
+
+   // Let the buffer manager do the I/O for the file, logging its changes
+   // if there is a log
+   fileHandle.fileNo = FileNo(fileName);
+   if (pLog != NULL && !fileHandle.bReadOnly &&
+         (rc = pLog->Name(fileHandle.fileNo, fileName)))
+      goto err;
+   if ((rc = pBufferMgr->AttachFile(fileHandle.unixfd, ioMode,
+         fileHandle.hdr.bCompressed, ppFileStats[fileHandle.fileNo],
+         (pLog != NULL && !fileHandle.bReadOnly) ? fileHandle.fileNo : -1)))
+      goto err;
 
    // Set file header to be not changed
    fileHandle.bHdrChanged = FALSE;
+   fileHandle.firstClear = 0;
 
    // Set local variables in file handle object to refer to open file
    fileHandle.pBufferMgr = pBufferMgr;
    fileHandle.bFileOpen = TRUE;
+   numOpen++;
+
+   // Bring back the pages that were in the buffer on the last run
+   if (pWarmSets[fileHandle.fileNo].bPending)
+      WarmUp(fileHandle);
 
    // Return ok
    return 0;
@@ -189,23 +518,60 @@ err:
 RC PF_Manager::CloseFile(PF_FileHandle &fileHandle)
 {
    RC rc;
+   PageNum *pPages;
+   int numPages;
 
    // Ensure fileHandle refers to open file
    if (!fileHandle.bFileOpen)
       return (PF_CLOSEDFILE);
 
-   // Flush all buffers for this file and write out the header
-   if ((rc = fileHandle.FlushPages()))
+   // Its pages are not to be read any more
+   if (pWarmSets[fileHandle.fileNo].pWarmUp != NULL &&
+         pWarmSets[fileHandle.fileNo].pWarmUp->fd == fileHandle.unixfd)
+      StopWarmUp(fileHandle.fileNo);
+
+   // Note which of its pages are in the buffer (its warm set), since
+   // they leave it with the file
+   if ((rc = fileHandle.pBufferMgr->ResidentPages(fileHandle.unixfd,
+         pPages, numPages)))
+      return (rc);
+
+   // Flush all buffers for this file and write out the header.  With a
+   // log, the next checkpoint (or CloseLog) syncs them, as it syncs the
+   // open files.
+   if (pLog != NULL)
+      pLog->Closed(fileHandle.fileNo);
+   if ((rc = fileHandle.FlushPages())) {
+      delete [] pPages;
+      return (rc);
+   }
+
+   // The warm set is only remembered once the file is let go of
+   PF_WarmSet &warm = pWarmSets[fileHandle.fileNo];
+   delete [] warm.pPages;
+   warm.pPages = pPages;
+   warm.numPages = numPages;
+   warm.lastClose = ++numCloses;
+   warm.bPending = FALSE;
+
+   // The buffer manager is done with the file
+   if ((rc = fileHandle.pBufferMgr->DetachFile(fileHandle.unixfd)))
       return (rc);
 
    // Close the file
    if (close(fileHandle.unixfd) < 0)
       return (PF_UNIX);
    fileHandle.bFileOpen = FALSE;
+   numOpen--;
 
    // Reset the buffer manager pointer in the file handle
    fileHandle.pBufferMgr = NULL;
 
+   // A good time to resize the pools that follow their curve, and to
+   // take a checkpoint
+   TunePools();
+   AutoCheckpoint();
+
    // Return ok
    return 0;
 }
@@ -213,7 +579,7 @@ RC PF_Manager::CloseFile(PF_FileHandle &fileHandle)
 //
 // ClearBuffer
 //
-// Desc: Remove all entries from the buffer manager.
+// Desc: Remove all entries from the buffer managers.
 //       This routine will be called via the system command and is only
 //       really useful if the user wants to run some performance
 //       comparison starting with an clean buffer.
@@ -224,13 +590,20 @@ RC PF_Manager::CloseFile(PF_FileHandle &fileHandle)
 //
 RC PF_Manager::ClearBuffer()
 {
-   return pBufferMgr->ClearBuffer();
+   RC rc;
+
+   for (int i = 0; i < PF_MAX_POOLS; i++)
+      for (int c = 0; c < PF_PAGE_CLASSES; c++)
+         if (pools[i].pBufferMgrs[c] != NULL &&
+               (rc = pools[i].pBufferMgrs[c]->ClearBuffer()))
+            return (rc);
+   return (0);
 }
 
 //
 // PrintBuffer
 //
-// Desc: Display all of the pages within the buffer.
+// Desc: Display all of the pages within the buffers.
 //       This routine will be called via the system command.
 // In:   Nothing
 // Out:  Nothing
@@ -239,23 +612,1275 @@ RC PF_Manager::ClearBuffer()
 //
 RC PF_Manager::PrintBuffer()
 {
-   return pBufferMgr->PrintBuffer();
+   RC rc;
+
+   for (int i = 0; i < PF_MAX_POOLS; i++) {
+      if (i > 0 && pools[i].name[0] != '\0')
+         printf("Pool %s:\n", pools[i].name);
+      for (int c = 0; c < PF_PAGE_CLASSES; c++)
+         if (pools[i].pBufferMgrs[c] != NULL) {
+            if (c > 0)
+               printf("Buffer of %dK pages:\n", 4 << c);
+            if ((rc = pools[i].pBufferMgrs[c]->PrintBuffer()))
+               return (rc);
+         }
+   }
+   return (0);
+}
+
+//
+// PrintCurve
+//
+// Desc: Display the miss-ratio curve of each buffer manager.
+//       This routine will be called via the system command.
+// Ret:  Returns the result of PF_BufferMgr::PrintCurve
+//
+RC PF_Manager::PrintCurve()
+{
+   RC rc;
+
+   for (int i = 0; i < PF_MAX_POOLS; i++) {
+      if (i > 0 && pools[i].name[0] != '\0')
+         printf("Pool %s:\n", pools[i].name);
+      for (int c = 0; c < PF_PAGE_CLASSES; c++)
+         if (pools[i].pBufferMgrs[c] != NULL) {
+            if (c > 0)
+               printf("Buffer of %dK pages:\n", 4 << c);
+            fflush(stdout);
+            if ((rc = pools[i].pBufferMgrs[c]->PrintCurve()))
+               return (rc);
+         }
+   }
+   return (0);
+}
+
+//
+// GetFileStats
+//
+// Desc: Statistics of the files opened so far: what the buffer did for
+//       each, and how many of its pages are in the buffer now
+// Out:  pStats - new array of the statistics, which the caller deletes;
+//       their fileName belongs to the PF_Manager
+//       numFiles - # of files in it
+// Ret:  0
+//
+RC PF_Manager::GetFileStats(PF_FileStats *&pStats, int &numFiles)
+{
+   int i;
+
+   for (i = 0; i < numFileStats; i++)
+      ppFileStats[i]->residentPages = 0;
+   for (i = 0; i < PF_MAX_POOLS; i++)
+      for (int c = 0; c < PF_PAGE_CLASSES; c++)
+         if (pools[i].pBufferMgrs[c] != NULL)
+            pools[i].pBufferMgrs[c]->CountResident();
+
+   numFiles = numFileStats;
+   pStats = new PF_FileStats[numFiles > 0 ? numFiles : 1];
+   for (i = 0; i < numFiles; i++)
+      pStats[i] = *ppFileStats[i];
+   return (0);
+}
+
+//
+// ResetFileStats
+//
+// Desc: Set the counts of the statistics of every file back to 0
+//
+void PF_Manager::ResetFileStats()
+{
+   for (int i = 0; i < numFileStats; i++) {
+      ppFileStats[i]->hits = ppFileStats[i]->misses = 0;
+      ppFileStats[i]->evictions = ppFileStats[i]->writeBacks = 0;
+   }
 }
 
 //
 // ResizeBuffer
 //
-// Desc: Resizes the buffer manager to the size passed in.
+// Desc: Resizes the buffer managers of the default pool to the size
+//       passed in (see PF_ClassPages for those of larger pages).
 //       This routine will be called via the system command.
 // In:   The new buffer size
 // Out:  Nothing
 // Ret:  Returns the result of PF_BufferMgr::ResizeBuffer
 //       It is a code: 0 for success, PF_TOOSMALL when iNewSize
-//       would be too small.
+//       would be too small, PF_PAGELATCHED while a page is latched.
 //
 RC PF_Manager::ResizeBuffer(int iNewSize)
 {
-   return pBufferMgr->ResizeBuffer(iNewSize);
+   return (SetPoolSize(PF_DEFAULT_POOL, iNewSize));
+}
+
+//
+// SetReplacePolicy
+//
+// Desc: Selects the page replacement policy of the buffer managers of
+//       the default pool.  Pages already in the buffer stay resident.
+// In:   _policy - one of the PF_REPLACE_* policies
+// Ret:  PF_BADPOLICY for an unknown policy, 0 otherwise
+//
+RC PF_Manager::SetReplacePolicy(PF_ReplacePolicy _policy)
+{
+   return (SetPoolPolicy(PF_DEFAULT_POOL, _policy));
+}
+
+//
+// SetCleanTarget
+//
+// Desc: Sets how much of the buffer pools the page cleaner keeps clean
+//       (see PF_BufferMgr::SetCleanTarget).  0 turns the cleaner off.
+// In:   percent - 0 to 100
+// Ret:  0
+//
+RC PF_Manager::SetCleanTarget(int percent)
+{
+   RC rc;
+
+   for (int i = 0; i < PF_MAX_POOLS; i++)
+      for (int c = 0; c < PF_PAGE_CLASSES; c++)
+         if (pools[i].pBufferMgrs[c] != NULL &&
+               (rc = pools[i].pBufferMgrs[c]->SetCleanTarget(percent)))
+            return (rc);
+   cleanTarget = percent;
+   return (0);
+}
+
+//
+// SetPoolSize
+//
+// Desc: Resizes the buffer managers of a pool (see
+//       PF_BufferMgr::ResizeBuffer), or creates the pool if there is
+//       none of that name.  Its buffer managers are created when the
+//       first file with their page size is opened.
+// In:   poolName - name of the pool, at most MAXNAME characters
+//       numPages - size of the pool in PF_PAGE_SIZE pages (see
+//       PF_ClassPages for the pools of larger pages)
+// Ret:  PF_TOOSMALL, PF_TOOMANYPOOLS, PF_NOPOOL if the name cannot be that
+//       of a pool, or other PF return code
+//
+RC PF_Manager::SetPoolSize(const char *poolName, int numPages)
+{
+   PF_Pool *pPool;
+   RC rc;
+
+   if (numPages < 1)
+      return (PF_TOOSMALL);
+
+   if ((pPool = Pool(poolName)) == NULL) {
+      int i;
+      if (poolName[0] == '\0' || strlen(poolName) > MAXNAME)
+         return (PF_NOPOOL);
+      for (i = 0; i < PF_MAX_POOLS && pools[i].name[0] != '\0'; i++)
+         ;
+      if (i == PF_MAX_POOLS)
+         return (PF_TOOMANYPOOLS);
+      pPool = &pools[i];
+      strcpy(pPool->name, poolName);
+      pPool->policy = pools[0].policy;
+      pPool->bufferPages = numPages;
+      pPool->tunePages = 0;
+      pPool->bCurve = FALSE;
+      return (0);
+   }
+
+   // If a buffer manager cannot be resized, those resized before it go
+   // back to their size (as far as they can)
+   for (int c = 0; c < PF_PAGE_CLASSES; c++)
+      if (pPool->pBufferMgrs[c] != NULL &&
+            (rc = pPool->pBufferMgrs[c]->ResizeBuffer(
+            PF_ClassPages(numPages, c)))) {
+         while (--c >= 0)
+            if (pPool->pBufferMgrs[c] != NULL)
+               pPool->pBufferMgrs[c]->ResizeBuffer(
+                     PF_ClassPages(pPool->bufferPages, c));
+         return (rc);
+      }
+   pPool->bufferPages = numPages;
+   return (0);
+}
+
+//
+// SetPoolPolicy
+//
+// Desc: Selects the page replacement policy of the buffer managers of a
+//       pool.  Pages already in the buffer stay resident.
+// In:   poolName - name of the pool
+//       _policy - one of the PF_REPLACE_* policies
+// Ret:  PF_NOPOOL, PF_BADPOLICY for an unknown policy, 0 otherwise
+//
+RC PF_Manager::SetPoolPolicy(const char *poolName, PF_ReplacePolicy _policy)
+{
+   PF_Pool *pPool;
+   RC rc;
+
+   if ((pPool = Pool(poolName)) == NULL)
+      return (PF_NOPOOL);
+   if (_policy < PF_REPLACE_LRU || _policy > PF_REPLACE_ARC)
+      return (PF_BADPOLICY);
+
+   for (int c = 0; c < PF_PAGE_CLASSES; c++)
+      if (pPool->pBufferMgrs[c] != NULL &&
+            (rc = pPool->pBufferMgrs[c]->SetReplacePolicy(_policy)))
+         return (rc);
+   pPool->policy = _policy;
+   return (0);
+}
+
+//
+// BindFile
+//
+// Desc: Have the pages of a file go to a pool from when it is next
+//       opened.  Where it is open already, its pages stay where they are
+//       until it is closed.
+// In:   fileName - name of the file, as given to OpenFile
+//       poolName - name of the pool (PF_DEFAULT_POOL: the default pool)
+// Ret:  PF_NOPOOL, 0 otherwise
+//
+RC PF_Manager::BindFile(const char *fileName, const char *poolName)
+{
+   PF_Pool *pPool;
+   int i, pool;
+
+   if ((pPool = Pool(poolName)) == NULL)
+      return (PF_NOPOOL);
+   pool = (int)(pPool - pools);
+
+   for (i = 0; i < numBound; i++)
+      if (strcmp(ppBoundFiles[i], fileName) == 0)
+         break;
+
+   // Files of the default pool are not kept
+   if (pool == 0) {
+      if (i < numBound) {
+         delete [] ppBoundFiles[i];
+         ppBoundFiles[i] = ppBoundFiles[--numBound];
+         pBoundPools[i] = pBoundPools[numBound];
+      }
+      return (0);
+   }
+   if (i < numBound) {
+      pBoundPools[i] = pool;
+      return (0);
+   }
+
+   // Make room for another one
+   if (numBound == maxBound) {
+      maxBound = (maxBound > 0) ? 2 * maxBound : 16;
+      char **ppNewFiles = new char *[maxBound];
+      int *pNewPools = new int[maxBound];
+      for (i = 0; i < numBound; i++) {
+         ppNewFiles[i] = ppBoundFiles[i];
+         pNewPools[i] = pBoundPools[i];
+      }
+      delete [] ppBoundFiles;
+      delete [] pBoundPools;
+      ppBoundFiles = ppNewFiles;
+      pBoundPools = pNewPools;
+   }
+
+   ppBoundFiles[numBound] = new char[strlen(fileName) + 1];
+   strcpy(ppBoundFiles[numBound], fileName);
+   pBoundPools[numBound++] = pool;
+   return (0);
+}
+
+//
+// SetAutoTune
+//
+// Desc: Have a pool be sized by its miss-ratio curve (see TunePools)
+// In:   poolName - name of the pool
+//       maxPages - most pages of PF_PAGE_SIZE the pool may have (as for
+//       SetPoolSize); 0 to stop tuning it
+// Ret:  PF_NOPOOL, PF_TOOSMALL, 0 otherwise
+//
+RC PF_Manager::SetAutoTune(const char *poolName, int maxPages)
+{
+   PF_Pool *pPool;
+
+   if ((pPool = Pool(poolName)) == NULL)
+      return (PF_NOPOOL);
+   if (maxPages < 0)
+      return (PF_TOOSMALL);
+
+   pPool->tunePages = maxPages;
+   for (int c = 0; c < PF_PAGE_CLASSES; c++)
+      if (pPool->pBufferMgrs[c] != NULL) {
+         pPool->pBufferMgrs[c]->KeepCurve(pPool->bCurve || maxPages > 0);
+         pPool->pBufferMgrs[c]->ResetCurve();
+      }
+   return (0);
+}
+
+//
+// SetCurve
+//
+// Desc: Keep the miss-ratio curve of a pool, or stop keeping it (a pool
+//       being tuned keeps it all the same)
+// In:   poolName - name of the pool
+//       bKeep - keep it
+// Ret:  PF_NOPOOL, 0 otherwise
+//
+RC PF_Manager::SetCurve(const char *poolName, int bKeep)
+{
+   PF_Pool *pPool;
+
+   if ((pPool = Pool(poolName)) == NULL)
+      return (PF_NOPOOL);
+
+   pPool->bCurve = bKeep;
+   for (int c = 0; c < PF_PAGE_CLASSES; c++)
+      if (pPool->pBufferMgrs[c] != NULL)
+         pPool->pBufferMgrs[c]->KeepCurve(bKeep || pPool->tunePages > 0);
+   return (0);
+}
+
+//
+// GetPoolSize
+//
+// Desc: Size of a pool, in pages of PF_PAGE_SIZE (as for SetPoolSize)
+// In:   poolName - name of the pool
+// Out:  numPages - its size
+// Ret:  PF_NOPOOL, 0 otherwise
+//
+RC PF_Manager::GetPoolSize(const char *poolName, int &numPages)
+{
+   PF_Pool *pPool;
+
+   if ((pPool = Pool(poolName)) == NULL)
+      return (PF_NOPOOL);
+   numPages = pPool->bufferPages;
+   return (0);
+}
+
+//
+// GetCurve
+//
+// Desc: A point of the miss-ratio curve of a pool
+// In:   poolName - name of the pool
+//       numPages - size of the pool, as for SetPoolSize
+// Out:  hits - # of the pages asked for that it would have found in the
+//       buffer with numPages pages
+//       numRequests - # of pages asked for of the pool since its curve
+//       was last reset (by a resize, or SetAutoTune)
+// Ret:  PF_NOPOOL, 0 otherwise
+//
+RC PF_Manager::GetCurve(const char *poolName, int numPages, int &hits,
+      int &numRequests)
+{
+   PF_Pool *pPool;
+
+   if ((pPool = Pool(poolName)) == NULL)
+      return (PF_NOPOOL);
+   hits = PoolHits(*pPool, numPages);
+   numRequests = 0;
+   for (int c = 0; c < PF_PAGE_CLASSES; c++)
+      if (pPool->pBufferMgrs[c] != NULL)
+         numRequests += pPool->pBufferMgrs[c]->CurveRequests();
+   return (0);
+}
+
+//
+// PoolHits
+//
+// Desc: Internal.  # of the pages asked for of a pool since its curves
+//       were reset that it would have found in the buffer with numPages
+//       pages (see PF_ClassPages for its buffers of larger pages)
+//
+int PF_Manager::PoolHits(PF_Pool &pool, int numPages)
+{
+   int hits = 0;
+
+   for (int c = 0; c < PF_PAGE_CLASSES; c++)
+      if (pool.pBufferMgrs[c] != NULL)
+         hits += pool.pBufferMgrs[c]->CurveHits(PF_ClassPages(numPages, c));
+   return (hits);
+}
+
+//
+// TunePools
+//
+// Desc: Internal.  Resize the pools being tuned whose curve tells of a
+//       better size, once PF_TUNE_REQUESTS pages were asked for of them.
+//       The sizes tried go by an eighth of the pool, up to as far as the
+//       curve goes and the pool may grow (the curve only goes up with the
+//       size).  The pool takes the smallest size that finds all but
+//       PF_TUNE_SLACK % of the pages the largest one finds, but no
+//       fewer pages than any of its buffer managers has shards.  The
+//       curve then starts afresh, unless the pool could not be resized
+//       because a page was latched: that is tried again the next time.
+//       Other threads may go on using the pool meanwhile.
+//
+void PF_Manager::TunePools()
+{
+   for (int i = 0; i < PF_MAX_POOLS; i++) {
+      PF_Pool &pool = pools[i];
+      int numRequests = 0, c, size, step, maxSize, bestHits, newSize;
+      RC rc = 0;
+
+      if (pool.name[0] == '\0' || pool.tunePages == 0)
+         continue;
+      for (c = 0; c < PF_PAGE_CLASSES; c++)
+         if (pool.pBufferMgrs[c] != NULL)
+            numRequests += pool.pBufferMgrs[c]->CurveRequests();
+      if (numRequests < PF_TUNE_REQUESTS)
+         continue;
+
+      step = (pool.bufferPages >= 8) ? pool.bufferPages / 8 : 1;
+      maxSize = PF_CURVE_FACTOR * pool.bufferPages;
+      if (maxSize > pool.tunePages)
+         maxSize = pool.tunePages;
+      size = (PF_TUNE_MIN_PAGES < maxSize) ? PF_TUNE_MIN_PAGES : maxSize;
+      for (c = 0; c < PF_PAGE_CLASSES; c++)
+         while (pool.pBufferMgrs[c] != NULL &&
+               PF_ClassPages(size, c) < pool.pBufferMgrs[c]->NumShards())
+            size++;
+      if (maxSize < size)
+         continue;               // it may not grow enough to be tuned
+
+      // The largest size does best: take the smallest one that does
+      // about as well
+      bestHits = PoolHits(pool, maxSize);
+      for (newSize = size; newSize < maxSize; newSize += step)
+         if ((long long)PoolHits(pool, newSize) * 100 >=
+               (long long)bestHits * 100 -
+               (long long)PF_TUNE_SLACK * numRequests)
+            break;
+      if (newSize > maxSize)
+         newSize = maxSize;
+
+      // A resize starts the curves afresh
+      if (newSize != pool.bufferPages &&
+            (rc = SetPoolSize(pool.name, newSize)) == PF_PAGELATCHED)
+         continue;
+      if (newSize == pool.bufferPages || rc)
+         for (c = 0; c < PF_PAGE_CLASSES; c++)
+            if (pool.pBufferMgrs[c] != NULL)
+               pool.pBufferMgrs[c]->ResetCurve();
+   }
+}
+
+//
+// PF_ComparePageNum - for sorting page numbers with qsort
+//
+static int PF_ComparePageNum(const void *p1, const void *p2)
+{
+   PageNum n1 = *(const PageNum *)p1, n2 = *(const PageNum *)p2;
+   return (n1 < n2 ? -1 : (n1 > n2 ? 1 : 0));
+}
+
+//
+// PF_WriteInts - write numInts ints to fd
+// Ret:  PF_UNIX if they could not be written
+//
+static RC PF_WriteInts(int fd, const int *pInts, int numInts)
+{
+   int numBytes = numInts * sizeof(int);
+   return (write(fd, pInts, numBytes) == numBytes ? 0 : PF_UNIX);
+}
+
+//
+// SaveWarmSet
+//
+// Desc: Write the warm set of each file to a manifest: the pages that
+//       were in the buffer when the file was last closed (or that were
+//       loaded for it and not yet read back).  The files come in the
+//       order in which they were closed, their pages coldest first:
+//          PF_WARM_MAGIC, # of files,
+//          then for each file: length of its name, its name (padded to
+//          a whole number of ints), # of pages and the pages
+//       Files still open are left out.
+// In:   manifestName - name of the manifest, replaced if it is there
+// Ret:  PF return code
+//
+RC PF_Manager::SaveWarmSet(const char *manifestName)
+{
+   int fd, i, j, numFiles;
+   int *pOrder = new int[numFileStats > 0 ? numFileStats : 1];
+   RC rc = 0;
+
+   // The files that have a warm set, the most recently closed last
+   for (numFiles = 0, i = 0; i < numFileStats; i++) {
+      if (pWarmSets[i].numPages == 0)
+         continue;
+      for (j = numFiles++; j > 0 &&
+            pWarmSets[pOrder[j - 1]].lastClose > pWarmSets[i].lastClose; j--)
+         pOrder[j] = pOrder[j - 1];
+      pOrder[j] = i;
+   }
+
+   if ((fd = open(manifestName,
+#ifdef PC
+         O_BINARY |
+#endif
+         O_CREAT | O_TRUNC | O_WRONLY, CREATION_MASK)) < 0) {
+      delete [] pOrder;
+      return (PF_UNIX);
+   }
+
+   int head[2] = { PF_WARM_MAGIC, numFiles };
+   rc = PF_WriteInts(fd, head, 2);
+   for (i = 0; i < numFiles && !rc; i++) {
+      PF_WarmSet &warm = pWarmSets[pOrder[i]];
+      const char *fileName = ppFileStats[pOrder[i]]->fileName;
+      int nameLen = strlen(fileName);
+      int nameInts = (nameLen + sizeof(int) - 1) / sizeof(int);
+
+      // The name is padded with '\0' to a whole number of ints
+      int *pName = new int[nameInts];
+      memset(pName, 0, nameInts * sizeof(int));
+      memcpy(pName, fileName, nameLen);
+      if (!(rc = PF_WriteInts(fd, &nameLen, 1)) &&
+            !(rc = PF_WriteInts(fd, pName, nameInts)) &&
+            !(rc = PF_WriteInts(fd, &warm.numPages, 1)))
+         rc = PF_WriteInts(fd, warm.pPages, warm.numPages);
+      delete [] pName;
+   }
+   delete [] pOrder;
+
+   if (close(fd) < 0 && !rc)
+      rc = PF_UNIX;
+
+   // A manifest cut short is worse than none
+   if (rc)
+      unlink(manifestName);
+   return (rc);
+}
+
+//
+// LoadWarmSet
+//
+// Desc: Read a manifest written by SaveWarmSet, typically on an earlier
+//       run.  The pages of each file become its warm set, which is
+//       brought into the buffer when the file is next opened.  Each pool
+//       keeps only as many pages of its files as it holds: the most
+//       recently used ones.  Meanwhile the OS is asked to read the pages
+//       kept ahead, in file order, so that they come from memory then.
+//       Pages that are no longer in a file and files that are no longer
+//       there are left out.
+// In:   manifestName - name of the manifest
+// Ret:  PF_UNIX if there is no manifest, PF_HDRREAD if it is damaged, or
+//       another PF return code
+//
+RC PF_Manager::LoadWarmSet(const char *manifestName)
+{
+   struct stat st;
+   int fd, i, f, numFiles, numInts;
+   int *pManifest, *pNext, *pEnd;
+   int budget[PF_MAX_POOLS][PF_PAGE_CLASSES];
+   RC rc = 0;
+
+   // Read the manifest at once
+   if ((fd = open(manifestName,
+#ifdef PC
+         O_BINARY |
+#endif
+         O_RDONLY)) < 0)
+      return (PF_UNIX);
+   if (fstat(fd, &st) < 0) {
+      close(fd);
+      return (PF_UNIX);
+   }
+   if (st.st_size % sizeof(int) != 0) {
+      close(fd);
+      return (PF_HDRREAD);         // not a whole number of ints
+   }
+   numInts = st.st_size / sizeof(int);
+   pManifest = new int[numInts > 0 ? numInts : 1];
+   if (read(fd, pManifest, st.st_size) != st.st_size)
+      rc = PF_UNIX;
+   close(fd);
+   if (!rc && (numInts < 2 || pManifest[0] != PF_WARM_MAGIC ||
+         pManifest[1] < 0 || pManifest[1] > numInts))
+      rc = PF_HDRREAD;
+   if (rc) {
+      delete [] pManifest;
+      return (rc);
+   }
+
+   // Find where the entry of each file starts
+   numFiles = pManifest[1];
+   int **ppEntries = new int *[numFiles > 0 ? numFiles : 1];
+   pEnd = pManifest + numInts;
+   for (pNext = pManifest + 2, f = 0; f < numFiles && !rc; f++) {
+      int nameInts, numPages;
+
+      ppEntries[f] = pNext;
+      if (pEnd - pNext < 1 || pNext[0] <= 0 ||
+            pNext[0] > (pEnd - pNext) * (int)sizeof(int)) {
+         rc = PF_HDRREAD;
+         break;
+      }
+      nameInts = (pNext[0] + sizeof(int) - 1) / sizeof(int);
+      if (pEnd - pNext < 2 + nameInts ||
+            (numPages = pNext[1 + nameInts]) < 0 ||
+            numPages > pEnd - pNext - 2 - nameInts)
+         rc = PF_HDRREAD;
+      else
+         pNext += 2 + nameInts + numPages;
+   }
+   if (rc) {
+      delete [] ppEntries;
+      delete [] pManifest;
+      return (rc);
+   }
+
+   for (i = 0; i < PF_MAX_POOLS; i++)
+      for (int c = 0; c < PF_PAGE_CLASSES; c++)
+         budget[i][c] = -1;
+
+   // The most recently closed files first
+   for (f = numFiles - 1; f >= 0; f--) {
+      int nameLen = ppEntries[f][0];
+      int nameInts = (nameLen + sizeof(int) - 1) / sizeof(int);
+      int numPages = ppEntries[f][1 + nameInts];
+      PageNum *pPages = (PageNum *)&ppEntries[f][2 + nameInts];
+      char *fileName = new char[nameLen + 1];
+      PF_FileHdr hdr;
+      int numKept, c, p;
+
+      memcpy(fileName, &ppEntries[f][1], nameLen);
+      fileName[nameLen] = '\0';
+
+      // The header of the file tells the size of its pages
+      if ((fd = open(fileName,
+#ifdef PC
+            O_BINARY |
+#endif
+            O_RDONLY)) < 0) {
+         delete [] fileName;
+         continue;
+      }
+      if (pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+            (c = PF_PageClass(hdr.pageSize ? hdr.pageSize : PF_PAGE_SIZE))
+            < 0) {
+         close(fd);
+         delete [] fileName;
+         continue;
+      }
+
+      // The pages the pool of the file still has room for, hottest last
+      p = &FilePool(fileName) - pools;
+      if (budget[p][c] < 0)
+         budget[p][c] = PF_ClassPages(pools[p].bufferPages, c);
+      numKept = numPages < budget[p][c] ? numPages : budget[p][c];
+      budget[p][c] -= numKept;
+
+      int fileNo = FileNo(fileName);
+      PF_WarmSet &warm = pWarmSets[fileNo];
+      delete [] warm.pPages;
+      warm.pPages = new PageNum[numKept > 0 ? numKept : 1];
+      warm.numPages = 0;
+      for (i = numPages - numKept; i < numPages; i++)
+         if (pPages[i] >= 0 && pPages[i] < hdr.numPages)
+            warm.pPages[warm.numPages++] = pPages[i];
+      qsort(warm.pPages, warm.numPages, sizeof(PageNum), PF_ComparePageNum);
+      warm.lastClose = numCloses + 1 + f;
+      warm.bPending = (warm.numPages > 0);
+
+      // Have the OS read them ahead, consecutive pages at once
+      off_t pageBytes = (hdr.pageSize ? hdr.pageSize : PF_PAGE_SIZE) +
+         sizeof(PF_PageHdr);
+      for (i = 0; i < warm.numPages; ) {
+         int run = 1;
+         while (i + run < warm.numPages &&
+               warm.pPages[i + run] == warm.pPages[i] + run)
+            run++;
+#ifdef POSIX_FADV_WILLNEED
+         posix_fadvise(fd, PF_FILE_HDR_SIZE + warm.pPages[i] * pageBytes,
+               run * pageBytes, POSIX_FADV_WILLNEED);
+#endif
+         i += run;
+      }
+      close(fd);
+      delete [] fileName;
+   }
+   numCloses += numFiles;
+
+   delete [] ppEntries;
+   delete [] pManifest;
+   return (0);
+}
+
+//
+// LogFile
+//
+// Desc: Internal.  Log that a file was created or destroyed, and wait
+//       for the record to be on the disk: the records of the file before
+//       it are not to be applied any more
+// In:   type - PF_LOGREC_CREATE or PF_LOGREC_DESTROY
+//       fileName - name of the file
+// Ret:  error writing the log
+//
+RC PF_Manager::LogFile(int type, const char *fileName)
+{
+   int fileNo = FileNo(fileName);
+   PF_LSN lsn;
+   RC rc;
+
+   if ((rc = pLog->Name(fileNo, fileName)) ||
+         (rc = pLog->Append(type, fileNo, -1, 0, NULL, 0, lsn)))
+      return (rc);
+   return (pLog->Flush(lsn));
+}
+
+//
+// OpenLog
+//
+// Desc: Open the write-ahead log logName (creating it if need be), bring
+//       the files it has records of up to date, and log the changes to
+//       the files opened from now on.  No file may be open.
+// In:   logName - name of the log file
+// Ret:  PF_FILEOPEN if a log or a file is open, PF_HDRREAD if logName is
+//       no log, or other PF return code
+//
+RC PF_Manager::OpenLog(const char *logName)
+{
+   PF_LogMgr *pNewLog;
+   RC rc;
+
+   if (pLog != NULL || numOpen > 0)
+      return (PF_FILEOPEN);
+
+   // The files are up to date on the disk once they are redone: the
+   // records can go
+   pNewLog = new PF_LogMgr;
+   if ((rc = pNewLog->Open(logName)) ||
+         (rc = Redo(*pNewLog)) ||
+         (rc = pNewLog->Truncate())) {
+      delete pNewLog;
+      return (rc);
+   }
+
+   pLog = pNewLog;
+   for (int i = 0; i < PF_MAX_POOLS; i++)
+      for (int c = 0; c < PF_PAGE_CLASSES; c++)
+         if (pools[i].pBufferMgrs[c] != NULL)
+            pools[i].pBufferMgrs[c]->SetLog(pLog);
+
+   // Return ok
+   return (0);
+}
+
+//
+// CloseLog
+//
+// Desc: Close the write-ahead log.  The files must be closed: their pages
+//       were written then, and those closed since the last checkpoint
+//       are synced here so that the records can be dropped.
+// Ret:  PF_NOLOG, PF_FILEOPEN if a file is open, or other PF return code
+//
+RC PF_Manager::CloseLog()
+{
+   RC rc;
+
+   if (pLog == NULL)
+      return (PF_NOLOG);
+   if (numOpen > 0)
+      return (PF_FILEOPEN);
+
+   // Sync the files closed since the last checkpoint (those that are
+   // gone need not be)
+   if ((rc = pLog->FlushAll()) ||
+         (rc = pLog->SyncClosed()))
+      return (rc);
+
+   if ((rc = pLog->Truncate()) ||
+         (rc = pLog->Close()))
+      return (rc);
+
+   for (int i = 0; i < PF_MAX_POOLS; i++)
+      for (int c = 0; c < PF_PAGE_CLASSES; c++)
+         if (pools[i].pBufferMgrs[c] != NULL)
+            pools[i].pBufferMgrs[c]->SetLog(NULL);
+   delete pLog;
+   pLog = NULL;
+
+   // Return ok
+   return (0);
+}
+
+//
+// Commit
+//
+// Desc: Make the changes logged so far durable: log the pages still
+//       pinned that were changed without a log record, and wait until the
+//       log is on the disk up to its last record.  Threads that commit
+//       meanwhile share the write.  A checkpoint is taken if one is due.
+// Ret:  PF_NOLOG, or error writing the log
+//
+RC PF_Manager::Commit()
+{
+   RC rc;
+
+   if (pLog == NULL)
+      return (PF_NOLOG);
+   for (int i = 0; i < PF_MAX_POOLS; i++)
+      for (int c = 0; c < PF_PAGE_CLASSES; c++)
+         if (pools[i].pBufferMgrs[c] != NULL &&
+               (rc = pools[i].pBufferMgrs[c]->LogPinned()))
+            return (rc);
+   if ((rc = pLog->FlushAll()))
+      return (rc);
+   AutoCheckpoint();
+   return (0);
+}
+
+//
+// GetLogStats
+//
+// Desc: # of records appended to the log since it was opened, and of
+//       writes of the log (each followed by an fdatasync)
+// Ret:  PF_NOLOG
+//
+RC PF_Manager::GetLogStats(int &numRecords, int &numWrites)
+{
+   if (pLog == NULL)
+      return (PF_NOLOG);
+   pLog->GetStats(numRecords, numWrites);
+   return (0);
+}
+
+//
+// Checkpoint
+//
+// Desc: Take a checkpoint of the log, so that restart replays it from the
+//       oldest change to a page that is still dirty.  Other threads may
+//       go on using the buffer meanwhile.
+// Ret:  PF_NOLOG, or other PF return code
+//
+RC PF_Manager::Checkpoint()
+{
+   RC rc;
+
+   if (pLog == NULL)
+      return (PF_NOLOG);
+   pthread_mutex_lock(&ckptLatch);
+   rc = TakeCheckpoint();
+   pthread_mutex_unlock(&ckptLatch);
+   return (rc);
+}
+
+//
+// AutoCheckpoint
+//
+// Desc: Internal.  Take a checkpoint if PF_CKPT_BYTES were logged since
+//       the last one, unless another thread is taking one.  An error is
+//       not reported: the next checkpoint tries again, and until then
+//       restart only takes longer.
+//
+void PF_Manager::AutoCheckpoint()
+{
+   if (pLog == NULL || pLog->SinceCheckpoint() < PF_CKPT_BYTES ||
+         pthread_mutex_trylock(&ckptLatch))
+      return;
+   if (pLog->SinceCheckpoint() >= PF_CKPT_BYTES)
+      TakeCheckpoint();
+   pthread_mutex_unlock(&ckptLatch);
+}
+
+//
+// TakeCheckpoint
+//
+// Desc: Internal.  Take a fuzzy checkpoint (ckptLatch is held):
+//       - the pages first changed before the previous checkpoint began
+//         are written, so that restart never goes back further than it
+//       - the names of the files and their headers are logged again, so
+//         that the records before are not needed for them
+//       - the dirty page table (each dirty page and the LSN of its first
+//         change that was not written) is logged, in as many
+//         PF_LOGREC_CKPT records as it takes
+//       - the files are synced, the open ones and those closed since the
+//         last checkpoint: the pages written so far are on the disk
+//       Then the log header points to the checkpoint, and the records
+//       before the oldest change to a dirty page are dropped.
+// Ret:  PF return code
+//
+RC PF_Manager::TakeCheckpoint()
+{
+   PF_DirtyPage *pAll = NULL, *pPages;
+   int numAll = 0, maxAll = 0, numPages, first, i, c;
+   PF_LSN beginLSN, prevBeginLSN, redoLSN, lsn;
+   RC rc = 0;
+
+   beginLSN = redoLSN = pLog->EndLSN();
+   prevBeginLSN = pLog->CheckpointBegin();
+
+   for (i = 0; i < PF_MAX_POOLS && !rc; i++)
+      for (c = 0; c < PF_PAGE_CLASSES && !rc; c++)
+         if (pools[i].pBufferMgrs[c] != NULL && prevBeginLSN > 0)
+            rc = pools[i].pBufferMgrs[c]->CleanOld(prevBeginLSN);
+   if (rc || (rc = pLog->NameAll()))
+      return (rc);
+   for (i = 0; i < PF_MAX_POOLS && !rc; i++)
+      for (c = 0; c < PF_PAGE_CLASSES && !rc; c++)
+         if (pools[i].pBufferMgrs[c] != NULL)
+            rc = pools[i].pBufferMgrs[c]->LogFileHdrs();
+   if (rc)
+      return (rc);
+
+   // The dirty page table, from each buffer manager
+   for (i = 0; i < PF_MAX_POOLS && !rc; i++)
+      for (c = 0; c < PF_PAGE_CLASSES && !rc; c++) {
+         if (pools[i].pBufferMgrs[c] == NULL ||
+               (rc = pools[i].pBufferMgrs[c]->DirtyPages(pPages,
+               numPages)))
+            continue;
+         if (numAll + numPages > maxAll) {
+            maxAll = 2 * (numAll + numPages);
+            PF_DirtyPage *pNewAll = new PF_DirtyPage[maxAll];
+            if (numAll > 0)
+               memcpy(pNewAll, pAll, numAll * sizeof(PF_DirtyPage));
+            delete [] pAll;
+            pAll = pNewAll;
+         }
+         if (numPages > 0)
+            memcpy(pAll + numAll, pPages, numPages * sizeof(PF_DirtyPage));
+         numAll += numPages;
+         delete [] pPages;
+      }
+   for (i = 0; i < numAll; i++)
+      if (pAll[i].recLSN < redoLSN)
+         redoLSN = pAll[i].recLSN;
+
+   // Log it, in parts; the last one is where the checkpoint ends
+   first = 0;
+   do {
+      int num = numAll - first;
+      if (num > PF_CKPT_MAX_PAGES)
+         num = PF_CKPT_MAX_PAGES;
+      int dataLength = sizeof(PF_CkptData) + num * sizeof(PF_DirtyPage);
+      char *pData = new char[dataLength];
+      ((PF_CkptData *)pData)->beginLSN = beginLSN;
+      if (num > 0)
+         memcpy(pData + sizeof(PF_CkptData), pAll + first,
+               num * sizeof(PF_DirtyPage));
+      first += num;
+      rc = pLog->Append(PF_LOGREC_CKPT, -1, num, first == numAll, pData,
+            dataLength, lsn);
+      delete [] pData;
+   } while (!rc && first < numAll);
+   delete [] pAll;
+
+   for (i = 0; i < PF_MAX_POOLS && !rc; i++)
+      for (c = 0; c < PF_PAGE_CLASSES && !rc; c++)
+         if (pools[i].pBufferMgrs[c] != NULL)
+            rc = pools[i].pBufferMgrs[c]->SyncFiles();
+   if (rc || (rc = pLog->SyncClosed()))
+      return (rc);
+
+   return (pLog->SetCheckpoint(lsn, beginLSN, redoLSN));
+}
+
+//
+// PF_RedoFile: a file the log has records of, while they are applied
+//
+struct PF_RedoFile {
+   char          *fileName;     // as named in the log, NULL if unnamed
+   PF_LSN        bornLSN;       // it was created or destroyed here: the
+                                //   records before are of another file
+   int           bGone;         // it was destroyed last
+   int           state;         // PF_REDO_*
+   PF_FileHandle fileHandle;    // while it is open
+};
+
+enum { PF_REDO_CLOSED, PF_REDO_OPEN, PF_REDO_SKIPPED };
+
+//
+// PF_RedoQueue: records to apply to the files of one redo thread
+//
+struct PF_RedoQueue {
+   PF_RedoFile *pFiles;         // the files, all open
+   char        *pRecs;          // copies of the records, one after the other
+   int         numBytes;        //   # of bytes of them
+   pthread_t   thread;
+   int         bThread;         // thread is running
+   RC          rc;              // of the thread
+};
+
+//
+// PF_CompareDirtyPage - for sorting and searching the dirty page table
+// with qsort and bsearch
+//
+static int PF_CompareDirtyPage(const void *p1, const void *p2)
+{
+   const PF_DirtyPage *d1 = (const PF_DirtyPage *)p1;
+   const PF_DirtyPage *d2 = (const PF_DirtyPage *)p2;
+
+   if (d1->fileNo != d2->fileNo)
+      return (d1->fileNo < d2->fileNo ? -1 : 1);
+   return (d1->pageNum < d2->pageNum ? -1 :
+         (d1->pageNum > d2->pageNum ? 1 : 0));
+}
+
+//
+// Redo
+//
+// Desc: Internal.  Apply the records of the log to the files, as if the
+//       changes were made again: the pages and headers that the records
+//       give after images of are brought to them.  Files that cannot be
+//       opened any more are skipped.  The files are written and synced
+//       afterwards.  The changes are not logged (pLog is not set yet).
+//
+//       With a checkpoint, only the records from the oldest change to a
+//       page dirty at the checkpoint on are read.  Those before the
+//       checkpoint began are applied only to the pages dirty then, and
+//       from their first change that was not written.
+//
+//       The records are read here and handed to PF_REDO_THREADS threads
+//       by file, in batches: the changes to a file are applied in the
+//       order they were made, and different files at the same time.
+// In:   log - the log, just opened
+// Ret:  PF return code
+//
+RC PF_Manager::Redo(PF_LogMgr &log)
+{
+   PF_RedoFile *pFiles = NULL;
+   int numFiles = 0;
+   PF_RedoQueue queues[PF_REDO_THREADS];
+   PF_DirtyPage *pDirty = NULL;
+   int numDirty = 0;
+   PF_LSN beginLSN = 0, redoLSN = 0, ckptLSN = log.CheckpointLSN();
+   PF_LogRec *pRec;
+   PF_LSN lsn;
+   int i, bEOF;
+   RC rc;
+
+   for (i = 0; i < PF_REDO_THREADS; i++) {
+      queues[i].pRecs = NULL;
+      queues[i].bThread = FALSE;
+   }
+
+   // The checkpoint: where it began, from its last record, and the dirty
+   // page table, from all of its records
+   if (ckptLSN > 0) {
+      if ((rc = log.Scan(ckptLSN)) ||
+            (rc = log.NextRec(lsn, pRec)))
+         return (rc == PF_EOF ? PF_HDRREAD : rc);
+      if (pRec->type != PF_LOGREC_CKPT)
+         return (PF_HDRREAD);
+      beginLSN = redoLSN = ((PF_CkptData *)(pRec + 1))->beginLSN;
+
+      if ((rc = log.Scan(beginLSN)))
+         return (rc);
+      while (!(rc = log.NextRec(lsn, pRec)) && lsn <= ckptLSN) {
+         if (pRec->type != PF_LOGREC_CKPT ||
+               ((PF_CkptData *)(pRec + 1))->beginLSN != beginLSN)
+            continue;
+         PF_DirtyPage *pNewDirty = new PF_DirtyPage[numDirty +
+            pRec->pageNum + 1];
+         if (numDirty > 0)
+            memcpy(pNewDirty, pDirty, numDirty * sizeof(PF_DirtyPage));
+         memcpy(pNewDirty + numDirty,
+               (char *)(pRec + 1) + sizeof(PF_CkptData),
+               pRec->pageNum * sizeof(PF_DirtyPage));
+         delete [] pDirty;
+         pDirty = pNewDirty;
+         numDirty += pRec->pageNum;
+      }
+      if (rc && rc != PF_EOF)
+         goto done;
+      for (i = 0; i < numDirty; i++)
+         if (pDirty[i].recLSN < redoLSN)
+            redoLSN = pDirty[i].recLSN;
+      qsort(pDirty, numDirty, sizeof(PF_DirtyPage), PF_CompareDirtyPage);
+   }
+
+   // First pass: the files, and where their last incarnation starts
+   if ((rc = log.Scan(redoLSN)))
+      goto done;
+   while (!(rc = log.NextRec(lsn, pRec))) {
+      if (pRec->fileNo < 0)
+         continue;
+      if (pRec->fileNo >= numFiles) {
+         int newNumFiles = (numFiles > 0) ? numFiles : 16;
+         while (newNumFiles <= pRec->fileNo)
+            newNumFiles *= 2;
+         PF_RedoFile *pNewFiles = new PF_RedoFile[newNumFiles];
+         for (i = 0; i < newNumFiles; i++) {
+            pNewFiles[i].fileName = (i < numFiles) ? pFiles[i].fileName :
+               NULL;
+            pNewFiles[i].bornLSN = (i < numFiles) ? pFiles[i].bornLSN : 0;
+            pNewFiles[i].bGone = (i < numFiles) ? pFiles[i].bGone : FALSE;
+            pNewFiles[i].state = PF_REDO_CLOSED;
+         }
+         delete [] pFiles;
+         pFiles = pNewFiles;
+         numFiles = newNumFiles;
+      }
+      PF_RedoFile &file = pFiles[pRec->fileNo];
+      if (pRec->type == PF_LOGREC_FILE && file.fileName == NULL) {
+         file.fileName = new char[pRec->dataLength + 1];
+         memcpy(file.fileName, (char *)(pRec + 1), pRec->dataLength);
+         file.fileName[pRec->dataLength] = '\0';
+      }
+      else if (pRec->type == PF_LOGREC_CREATE ||
+            pRec->type == PF_LOGREC_DESTROY) {
+         file.bornLSN = lsn;
+         file.bGone = (pRec->type == PF_LOGREC_DESTROY);
+      }
+   }
+   if (rc != PF_EOF)
+      goto done;
+
+   // Second pass: the changes, handed to the threads
+   for (i = 0; i < PF_REDO_THREADS; i++) {
+      queues[i].pFiles = pFiles;
+      queues[i].pRecs = new char[PF_REDO_BATCH];
+      queues[i].numBytes = 0;
+   }
+   if ((rc = log.Scan(redoLSN)))
+      goto done;
+   do {
+      PF_RedoQueue *pQueue = NULL;
+
+      if (!(bEOF = (rc = log.NextRec(lsn, pRec)) != 0)) {
+         if (pRec->fileNo < 0 || pRec->fileNo >= numFiles)
+            continue;
+         PF_RedoFile &file = pFiles[pRec->fileNo];
+         if (file.fileName == NULL || file.bGone || lsn < file.bornLSN ||
+               file.state == PF_REDO_SKIPPED)
+            continue;
+         if (pRec->type != PF_LOGREC_ALLOC && pRec->type != PF_LOGREC_PAGE &&
+               pRec->type != PF_LOGREC_HDR)
+            continue;
+
+         // Before the checkpoint began, only changes to the pages it
+         // found dirty that were not written yet (headers were logged
+         // whole by the checkpoint)
+         if (lsn < beginLSN) {
+            PF_DirtyPage key, *pFound;
+            key.fileNo = pRec->fileNo;
+            key.pageNum = pRec->pageNum;
+            if (pRec->type == PF_LOGREC_HDR || numDirty == 0 ||
+                  (pFound = (PF_DirtyPage *)bsearch(&key, pDirty, numDirty,
+                  sizeof(PF_DirtyPage), PF_CompareDirtyPage)) == NULL ||
+                  lsn < pFound->recLSN)
+               continue;
+         }
+
+         // Open the file when it is first needed
+         if (file.state == PF_REDO_CLOSED) {
+            if (OpenFile(file.fileName, file.fileHandle)) {
+               file.state = PF_REDO_SKIPPED;
+               continue;
+            }
+            file.state = PF_REDO_OPEN;
+         }
+         pQueue = &queues[pRec->fileNo % PF_REDO_THREADS];
+      }
+      else if (rc != PF_EOF)
+         goto done;
+
+      // Apply the batch at the end, or when the record does not fit
+      if (bEOF || pQueue->numBytes + pRec->length > PF_REDO_BATCH) {
+         for (i = 0; i < PF_REDO_THREADS; i++) {
+            queues[i].rc = 0;
+            queues[i].bThread = queues[i].numBytes > 0 &&
+               !pthread_create(&queues[i].thread, NULL, RedoFiles,
+               &queues[i]);
+            if (!queues[i].bThread && queues[i].numBytes > 0)
+               RedoFiles(&queues[i]);
+         }
+         rc = 0;
+         for (i = 0; i < PF_REDO_THREADS; i++) {
+            if (queues[i].bThread)
+               pthread_join(queues[i].thread, NULL);
+            queues[i].bThread = FALSE;
+            queues[i].numBytes = 0;
+            if (queues[i].rc && !rc)
+               rc = queues[i].rc;
+         }
+         if (rc)
+            goto done;
+      }
+      if (!bEOF) {
+         memcpy(pQueue->pRecs + pQueue->numBytes, pRec, pRec->length);
+         pQueue->numBytes += pRec->length;
+      }
+   } while (!bEOF);
+
+done:
+   // Write the files out and close them
+   for (i = 0; i < numFiles; i++) {
+      if (pFiles[i].state == PF_REDO_OPEN) {
+         RC rc2;
+         if ((rc2 = pFiles[i].fileHandle.FlushPages(TRUE)) ||
+               (rc2 = CloseFile(pFiles[i].fileHandle)))
+            if (!rc)
+               rc = rc2;
+      }
+      delete [] pFiles[i].fileName;
+   }
+   for (i = 0; i < PF_REDO_THREADS; i++)
+      delete [] queues[i].pRecs;
+   delete [] pFiles;
+   delete [] pDirty;
+   return (rc);
+}
+
+//
+// RedoFiles
+//
+// Desc: Internal.  Apply the records of a PF_RedoQueue to its files, in
+//       a redo thread.  Each file has its records in one queue only.
+//       The queue stops at the first record that cannot be applied.
+// In:   pQueue - the PF_RedoQueue; its rc is set to the error
+// Ret:  NULL
+//
+void *PF_Manager::RedoFiles(void *_pQueue)
+{
+   PF_RedoQueue *pQueue = (PF_RedoQueue *)_pQueue;
+   PF_LogRec *pRec;
+   char *pPage;
+   RC rc = 0;
+
+   for (int pos = 0; pos < pQueue->numBytes && !rc;
+         pos += pRec->length) {
+      pRec = (PF_LogRec *)(pQueue->pRecs + pos);
+      PF_FileHandle &fh = pQueue->pFiles[pRec->fileNo].fileHandle;
+      int frameSize = fh.hdr.pageSize + sizeof(PF_PageHdr);
+
+      switch (pRec->type) {
+      case PF_LOGREC_ALLOC:
+         rc = fh.pBufferMgr->AllocatePage(fh.unixfd, pRec->pageNum, &pPage);
+         if (rc == PF_PAGEINBUF)
+            rc = fh.pBufferMgr->GetPage(fh.unixfd, pRec->pageNum, &pPage);
+         if (!rc) {
+            memset(pPage, 0, frameSize);
+            ((PF_PageHdr *)pPage)->nextFree = PF_PAGE_USED;
+         }
+         break;
+
+      case PF_LOGREC_PAGE:
+         if (pRec->offset < 0 || pRec->offset + pRec->dataLength > frameSize)
+            continue;              // no such bytes: the record is skipped
+         if (!(rc = fh.pBufferMgr->GetPage(fh.unixfd, pRec->pageNum,
+               &pPage)))
+            memcpy(pPage + pRec->offset, (char *)(pRec + 1),
+                  pRec->dataLength);
+         break;
+
+      case PF_LOGREC_HDR:
+         if (pRec->offset >= 0 &&
+               pRec->offset + pRec->dataLength <= (int)sizeof(PF_FileHdr)) {
+            memcpy((char *)&fh.hdr + pRec->offset, (char *)(pRec + 1),
+                  pRec->dataLength);
+            fh.bHdrChanged = TRUE;
+            fh.firstClear = 0;
+         }
+         continue;
+      }
+
+      // The first error stops the queue, and is the one reported
+      if (rc)
+         break;
+      if (!(rc = fh.pBufferMgr->MarkDirty(fh.unixfd, pRec->pageNum)))
+         rc = fh.pBufferMgr->UnpinPage(fh.unixfd, pRec->pageNum);
+   }
+
+   pQueue->rc = rc;
+   return (NULL);
 }
 
 //------------------------------------------------------------------------------
@@ -264,20 +1889,21 @@ RC PF_Manager::ResizeBuffer(int iNewSize)
 // associated with a particular file.  These should be used if you
 // want memory that is bounded by the size of the buffer pool.
 //
-// The PF_Manager just passes the calls down to the Buffer manager.
+// The PF_Manager just passes the calls down to the Buffer manager of
+// PF_PAGE_SIZE pages of the default pool.
 //------------------------------------------------------------------------------
 
 RC PF_Manager::GetBlockSize(int &length) const
 {
-   return pBufferMgr->GetBlockSize(length);
+   return pools[0].pBufferMgrs[0]->GetBlockSize(length);
 }
 
 RC PF_Manager::AllocateBlock(char *&buffer)
 {
-   return pBufferMgr->AllocateBlock(buffer);
+   return pools[0].pBufferMgrs[0]->AllocateBlock(buffer);
 }
 
 RC PF_Manager::DisposeBlock(char *buffer)
 {
-   return pBufferMgr->DisposeBlock(buffer);
+   return pools[0].pBufferMgrs[0]->DisposeBlock(buffer);
 }
@@ -0,0 +1,223 @@
+//
+// File:        pf_misscurve.cc
+// Description: PF_MissCurve class implementation
+//
+// See pf_misscurve.h.  The distance of a page thrown out is the # of
+// pages thrown out after it, counted by numbering the evictions: a buffer
+// that had kept it would have needed that many more pages (in LRU order,
+// and leaving aside the pages thrown out after it that came back, which
+// makes the estimate err on the large side).
+//
+// The stamps go up to twice the # of slots; then the slots stamped are
+// stamped again from 0 in the same order and the tree built anew, which
+// takes O(n) once every n uses or more.
+//
+
+#include "pf_internal.h"
+#include "pf_buffermgr.h"
+#include "pf_misscurve.h"
+
+//
+// PF_MissCurve
+//
+// Desc: Constructor.  The curve goes up to PF_CURVE_FACTOR times the size
+//       of the shard.
+// In:   _numPages - # of pages of the shard
+//
+PF_MissCurve::PF_MissCurve(int _numPages) :
+   ghosts((PF_CURVE_FACTOR - 1) * _numPages)
+{
+   numPages = _numPages;
+   maxDistance = PF_CURVE_FACTOR * numPages;
+   pHits = new int[maxDistance];
+   pEvictNo = new int[ghosts.Capacity()];
+   PF_SlotLinks::InitList(ghostList);
+   numEvicted = 0;
+   Reset();
+
+   maxStamps = 2 * numPages;
+   pStamp = new int[numPages];
+   pSlotOf = new int[maxStamps];
+   pTree = new int[maxStamps + 1];
+   for (int slot = 0; slot < numPages; slot++)
+      pStamp[slot] = -1;
+   for (int s = 0; s < maxStamps; s++)
+      pSlotOf[s] = -1;
+   for (int i = 0; i <= maxStamps; i++)
+      pTree[i] = 0;
+   nextStamp = 0;
+   numStamped = 0;
+}
+
+PF_MissCurve::~PF_MissCurve()
+{
+   delete [] pHits;
+   delete [] pEvictNo;
+   delete [] pStamp;
+   delete [] pSlotOf;
+   delete [] pTree;
+}
+
+//
+// Hit
+//
+// Desc: Count a request for a page in the buffer at its rank: the # of
+//       slots stamped after its own (all of them if it has none)
+// In:   slot - slot of the page
+//
+void PF_MissCurve::Hit(int slot)
+{
+   int rank = numStamped;
+
+   // Stamps up to that of slot, from the tree
+   if (pStamp[slot] >= 0)
+      for (int i = pStamp[slot] + 1; i > 0; i -= i & -i)
+         rank -= pTree[i];
+   if (rank < maxDistance)
+      pHits[rank]++;
+   numRequests++;
+   Stamp(slot);
+}
+
+//
+// Used, Freed
+//
+// Desc: A page was put in slot (it is the one used last), or slot was
+//       freed
+//
+void PF_MissCurve::Used(int slot)
+{
+   Stamp(slot);
+}
+
+void PF_MissCurve::Freed(int slot)
+{
+   Unstamp(slot);
+}
+
+//
+// Stamp, Unstamp
+//
+// Desc: Internal.  Give slot the next stamp, or take its stamp away
+//
+void PF_MissCurve::Stamp(int slot)
+{
+   Unstamp(slot);
+
+   // Stamp the slots again from 0, in the same order
+   if (nextStamp == maxStamps) {
+      nextStamp = 0;
+      for (int s = 0; s < maxStamps; s++)
+         if (pSlotOf[s] >= 0) {
+            int stamped = pSlotOf[s];
+            pSlotOf[s] = -1;
+            pSlotOf[nextStamp] = stamped;
+            pStamp[stamped] = nextStamp++;
+         }
+
+      // Build the tree from the counts
+      for (int i = 1; i <= maxStamps; i++)
+         pTree[i] = (i <= nextStamp);
+      for (int i = 1; i <= maxStamps; i++)
+         if (i + (i & -i) <= maxStamps)
+            pTree[i + (i & -i)] += pTree[i];
+   }
+
+   pStamp[slot] = nextStamp;
+   pSlotOf[nextStamp] = slot;
+   for (int i = nextStamp + 1; i <= maxStamps; i += i & -i)
+      pTree[i]++;
+   nextStamp++;
+   numStamped++;
+}
+
+void PF_MissCurve::Unstamp(int slot)
+{
+   if (pStamp[slot] < 0)
+      return;
+   for (int i = pStamp[slot] + 1; i <= maxStamps; i += i & -i)
+      pTree[i]--;
+   pSlotOf[pStamp[slot]] = -1;
+   pStamp[slot] = -1;
+   numStamped--;
+}
+
+//
+// Miss
+//
+// Desc: Count a request for a page that is not in the buffer.  If it was
+//       thrown out lately, a larger buffer would have found it; it is no
+//       ghost any more as it is back in the buffer.
+// In:   fd, pageNum - the page
+//
+void PF_MissCurve::Miss(int fd, PageNum pageNum)
+{
+   int node;
+
+   if ((node = ghosts.Find(fd, pageNum)) != INVALID_SLOT) {
+      int distance = numPages + numEvicted - pEvictNo[node] - 1;
+      if (distance < maxDistance)
+         pHits[distance]++;
+      ghosts.Remove(ghostList, node);
+   }
+   numRequests++;
+}
+
+//
+// Evicted
+//
+// Desc: Remember a page that was thrown out to make room; the oldest
+//       ghost is forgotten if there are too many
+// In:   fd, pageNum - the page
+//
+void PF_MissCurve::Evicted(int fd, PageNum pageNum)
+{
+   int node;
+
+   if ((node = ghosts.Find(fd, pageNum)) != INVALID_SLOT)
+      ghosts.Remove(ghostList, node);
+   if ((node = ghosts.Add(ghostList, fd, pageNum)) != INVALID_SLOT)
+      pEvictNo[node] = numEvicted;
+   numEvicted++;
+}
+
+//
+// Forget
+//
+// Desc: Forget the ghosts of fd, whose descriptor may be reused by
+//       another file
+//
+void PF_MissCurve::Forget(int fd)
+{
+   ghosts.Purge(ghostList, fd);
+}
+
+//
+// Hits
+//
+// Desc: # of the requests counted that a shard of _numPages pages would
+//       have found in the buffer.  Beyond PF_CURVE_FACTOR times the size
+//       of the shard the curve is flat.
+// In:   _numPages - size of the shard
+// Ret:  # of requests
+//
+int PF_MissCurve::Hits(int _numPages) const
+{
+   int hits = 0;
+
+   for (int d = 0; d < _numPages && d < maxDistance; d++)
+      hits += pHits[d];
+   return (hits);
+}
+
+//
+// Reset
+//
+// Desc: Start counting the requests afresh.  The ghosts stay.
+//
+void PF_MissCurve::Reset()
+{
+   for (int d = 0; d < maxDistance; d++)
+      pHits[d] = 0;
+   numRequests = 0;
+}
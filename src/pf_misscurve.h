@@ -0,0 +1,80 @@
+//
+// File:        pf_misscurve.h
+// Description: Miss-ratio curve of a buffer shard
+//
+// A PF_MissCurve predicts how many of the pages asked for of a shard of
+// the buffer would have been found in it had it had another size.  Each
+// request is put down at its stack distance, as if pages were replaced
+// in LRU order:
+//
+//    - a page in the buffer at its rank, the # of pages in the buffer that
+//      were used more recently.  The curve stamps the slots of the shard
+//      as their pages are used, and counts the stamps in a Fenwick tree,
+//      so that the rank takes O(log n);
+//    - a page that is not, but was thrown out lately, at the size of the
+//      shard plus the # of pages thrown out after it.  These pages are
+//      remembered (fd, pageNum only) in a ghost list of PF_CURVE_FACTOR-1
+//      times the size of the shard.
+//
+// A shard of n pages would have found the requests at a distance below n.
+// Other pages (never seen, or gone too long ago) are misses at any size.
+// The shard latch protects the curve.  A shard only has a curve while it
+// is kept (see PF_BufferMgr::KeepCurve); the pages in it then, which were
+// never stamped, count as used before any other.
+//
+
+#ifndef PF_MISSCURVE_H
+#define PF_MISSCURVE_H
+
+#include "pf_internal.h"
+#include "pf_replacement.h"
+
+//
+// PF_MissCurve - stack distances of the page requests of a shard
+//
+class PF_MissCurve {
+public:
+    PF_MissCurve  (int numPages);                 // for numPages pages
+    ~PF_MissCurve ();
+
+    // The page in slot was asked for, and was in the buffer
+    void Hit      (int slot);
+    // A page was put in slot, or slot was freed
+    void Used     (int slot);
+    void Freed    (int slot);
+    // (fd, pageNum), which is not in the buffer, was asked for
+    void Miss     (int fd, PageNum pageNum);
+    // (fd, pageNum) was thrown out of the buffer to make room
+    void Evicted  (int fd, PageNum pageNum);
+    // Forget the pages of a file that was thrown out
+    void Forget   (int fd);
+
+    // # of requests a buffer of numPages pages would have found in it,
+    // and # of requests, since the curve was last reset
+    int  Hits     (int numPages) const;
+    int  Requests () const { return numRequests; }
+    void Reset    ();
+
+private:
+    int          numPages;                        // # of pages of the shard
+    int          maxDistance;                     // # of entries of pHits
+    int          *pHits;                          // requests by distance
+    int          numRequests;                     // requests counted
+    PF_GhostDir  ghosts;                          // pages thrown out,
+    PF_SlotList  ghostList;                       //   latest at the head
+    int          *pEvictNo;                       // # of eviction of each
+                                                  //   ghost node
+    int          numEvicted;                      // evictions so far
+
+    // Stamps of the slots, in the order of their last use
+    void Stamp    (int slot);
+    void Unstamp  (int slot);
+    int          maxStamps;                       // stamps before renumbering
+    int          *pStamp;                         // stamp of each slot, -1
+    int          *pSlotOf;                        // slot of each stamp, -1
+    int          *pTree;                          // Fenwick tree of stamps
+    int          nextStamp;                       // next stamp handed out
+    int          numStamped;                      // # of slots stamped
+};
+
+#endif
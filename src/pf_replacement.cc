@@ -0,0 +1,748 @@
+//
+// File:        pf_replacement.cc
+// Description: Page replacement policies for PF_BufferMgr
+//
+// LRU   - the original policy of the buffer manager.  Every reference
+//         moves the page to the MRU end of a list.
+// CLOCK - second chance.  A reference only sets a bit; the clock hand
+//         clears bits until it finds an unreferenced page.
+// 2Q    - pages enter a FIFO (A1in).  Only pages referenced again after
+//         having been evicted from A1in (remembered in the A1out ghost
+//         queue) are promoted to the LRU main queue (Am).  A scan touches
+//         every page exactly once and therefore never reaches Am.
+// LRU-K - evicts the page whose K-th most recent reference is the
+//         oldest.  Pages referenced fewer than K times go first.
+// ARC   - adaptive replacement cache (Megiddo & Modha).  Balances a
+//         recency list (T1) against a frequency list (T2) using ghost
+//         lists of recently evicted pages (B1, B2).
+//
+
+#include "pf_internal.h"
+#include "pf_buffermgr.h"
+#include "pf_replacement.h"
+
+//------------------------------------------------------------------------------
+// PF_SlotLinks
+//------------------------------------------------------------------------------
+
+PF_SlotLinks::PF_SlotLinks(int numNodes)
+{
+   next = new int[numNodes];
+   prev = new int[numNodes];
+   for (int i = 0; i < numNodes; i++)
+      next[i] = prev[i] = INVALID_SLOT;
+}
+
+PF_SlotLinks::~PF_SlotLinks()
+{
+   delete [] next;
+   delete [] prev;
+}
+
+//
+// InitList
+//
+// Desc: Make list an empty list
+//
+void PF_SlotLinks::InitList(PF_SlotList &list)
+{
+   list.head = list.tail = INVALID_SLOT;
+   list.length = 0;
+}
+
+//
+// LinkHead
+//
+// Desc: Insert node at the head (MRU end) of list
+//
+void PF_SlotLinks::LinkHead(PF_SlotList &list, int node)
+{
+   next[node] = list.head;
+   prev[node] = INVALID_SLOT;
+
+   if (list.head != INVALID_SLOT)
+      prev[list.head] = node;
+   list.head = node;
+
+   if (list.tail == INVALID_SLOT)
+      list.tail = node;
+
+   list.length++;
+}
+
+//
+// Unlink
+//
+// Desc: Remove node from list.  node must be on list.
+//
+void PF_SlotLinks::Unlink(PF_SlotList &list, int node)
+{
+   if (list.head == node)
+      list.head = next[node];
+   if (list.tail == node)
+      list.tail = prev[node];
+   if (next[node] != INVALID_SLOT)
+      prev[next[node]] = prev[node];
+   if (prev[node] != INVALID_SLOT)
+      next[prev[node]] = next[node];
+
+   next[node] = prev[node] = INVALID_SLOT;
+   list.length--;
+}
+
+//------------------------------------------------------------------------------
+// PF_GhostDir
+//------------------------------------------------------------------------------
+
+PF_GhostDir::PF_GhostDir(int _capacity) :
+   links(_capacity > 0 ? _capacity : 1),
+   hashTable(_capacity > 0 ? _capacity : 1)
+{
+   capacity = _capacity > 0 ? _capacity : 1;
+   fds = new int[capacity];
+   pageNums = new PageNum[capacity];
+
+   // Initially every node is free.  The free list is threaded through
+   // the fds array to avoid yet another array.
+   for (int i = 0; i < capacity; i++)
+      fds[i] = i + 1;
+   fds[capacity - 1] = INVALID_SLOT;
+   free = 0;
+}
+
+PF_GhostDir::~PF_GhostDir()
+{
+   delete [] fds;
+   delete [] pageNums;
+}
+
+//
+// Find
+//
+// Ret:  ghost node holding (fd, pageNum), or INVALID_SLOT
+//
+int PF_GhostDir::Find(int fd, PageNum pageNum)
+{
+   int node;
+
+   if (hashTable.Find(fd, pageNum, node))
+      return (INVALID_SLOT);
+   return (node);
+}
+
+//
+// Add
+//
+// Desc: Remember (fd, pageNum) at the MRU end of list.  When the
+//       directory is full the oldest ghost of list is forgotten first.
+// Ret:  ghost node used, or INVALID_SLOT if nothing could be recycled
+//
+int PF_GhostDir::Add(PF_SlotList &list, int fd, PageNum pageNum)
+{
+   int node;
+
+   // A page can only be remembered once
+   if ((node = Find(fd, pageNum)) != INVALID_SLOT)
+      return (node);
+
+   if (free == INVALID_SLOT) {
+      if (list.tail == INVALID_SLOT)
+         return (INVALID_SLOT);
+      Remove(list, list.tail);
+   }
+
+   node = free;
+   free = fds[node];
+
+   fds[node] = fd;
+   pageNums[node] = pageNum;
+   hashTable.Insert(fd, pageNum, node);
+   links.LinkHead(list, node);
+
+   return (node);
+}
+
+//
+// Remove
+//
+// Desc: Forget ghost node, which must be on list
+//
+void PF_GhostDir::Remove(PF_SlotList &list, int node)
+{
+   hashTable.Delete(fds[node], pageNums[node]);
+   links.Unlink(list, node);
+
+   fds[node] = free;
+   free = node;
+}
+
+//
+// Purge
+//
+// Desc: Forget all ghosts of fd on list.  Called when a file leaves the
+//       buffer so that a later file reusing the descriptor does not
+//       inherit its history.
+//
+void PF_GhostDir::Purge(PF_SlotList &list, int fd)
+{
+   int node = list.head;
+   while (node != INVALID_SLOT) {
+      int next = links.Next(node);
+      if (fds[node] == fd)
+         Remove(list, node);
+      node = next;
+   }
+}
+
+//
+// PF_CollectTail
+//
+// Desc: Append the unpinned pages of list, from its LRU end on, to slots
+//       (for NextVictims)
+// In:   num - # of slots filled already
+//       max - size of slots
+// Ret:  new # of slots filled
+//
+static int PF_CollectTail(const PF_SlotLinks &links, const PF_SlotList &list,
+      const PF_BufPageDesc *bufTable, int *slots, int num, int max)
+{
+   for (int slot = list.tail; slot != INVALID_SLOT && num < max;
+         slot = links.Prev(slot))
+      if (PF_Unpinned(bufTable[slot]))
+         slots[num++] = slot;
+   return (num);
+}
+
+//------------------------------------------------------------------------------
+// LRU
+//------------------------------------------------------------------------------
+
+class PF_LRUReplacer : public PF_Replacer {
+public:
+   PF_LRUReplacer(int numSlots) : links(numSlots)
+   {
+      PF_SlotLinks::InitList(lru);
+   }
+
+   const char *Name() const { return "LRU"; }
+
+   void Admit(int slot, int fd, PageNum pageNum) { links.LinkHead(lru, slot); }
+   void Access(int slot)
+   {
+      links.Unlink(lru, slot);
+      links.LinkHead(lru, slot);
+   }
+   void Unpin(int slot) { Access(slot); }
+   void Remove(int slot) { links.Unlink(lru, slot); }
+   void Evict(int slot, int fd, PageNum pageNum) { links.Unlink(lru, slot); }
+   void Forget(int fd) {}
+
+   RC Victim(const PF_BufPageDesc *bufTable, int fd, PageNum pageNum,
+         int &slot)
+   {
+      // Choose the least-recently used page that is unpinned
+      for (slot = lru.tail; slot != INVALID_SLOT; slot = links.Prev(slot))
+         if (PF_Evictable(bufTable[slot]))
+            return (0);
+      return (PF_NOBUF);
+   }
+
+   int NextVictims(const PF_BufPageDesc *bufTable, int *slots, int max) const
+   {
+      return (PF_CollectTail(links, lru, bufTable, slots, 0, max));
+   }
+
+private:
+   PF_SlotLinks links;
+   PF_SlotList  lru;
+};
+
+//------------------------------------------------------------------------------
+// CLOCK
+//------------------------------------------------------------------------------
+
+class PF_ClockReplacer : public PF_Replacer {
+public:
+   PF_ClockReplacer(int _numSlots)
+   {
+      numSlots = _numSlots;
+      hand = 0;
+      ref = new char[numSlots];
+      resident = new char[numSlots];
+      memset(ref, 0, numSlots);
+      memset(resident, 0, numSlots);
+   }
+   ~PF_ClockReplacer()
+   {
+      delete [] ref;
+      delete [] resident;
+   }
+
+   const char *Name() const { return "CLOCK"; }
+
+   void Admit(int slot, int fd, PageNum pageNum)
+   {
+      resident[slot] = TRUE;
+      ref[slot] = TRUE;
+   }
+   void Access(int slot) { ref[slot] = TRUE; }
+   void Unpin(int slot) { ref[slot] = TRUE; }
+   void Remove(int slot) { resident[slot] = ref[slot] = FALSE; }
+   void Evict(int slot, int fd, PageNum pageNum) { Remove(slot); }
+   void Forget(int fd) {}
+
+   RC Victim(const PF_BufPageDesc *bufTable, int fd, PageNum pageNum,
+         int &slot)
+   {
+      // Two full turns of the hand are enough: the first one clears
+      // every reference bit of an unpinned page
+      for (int i = 0; i < 2 * numSlots; i++) {
+         slot = hand;
+         hand = (hand + 1) % numSlots;
+
+         if (!resident[slot] || !PF_Evictable(bufTable[slot]))
+            continue;
+         if (ref[slot]) {
+            ref[slot] = FALSE;
+            continue;
+         }
+         return (0);
+      }
+      return (PF_NOBUF);
+   }
+
+   int NextVictims(const PF_BufPageDesc *bufTable, int *slots, int max) const
+   {
+      int num = 0;
+
+      // Going round from the hand: the unreferenced pages go first, the
+      // referenced ones after the hand has cleared their bit
+      for (int pass = 0; pass < 2; pass++)
+         for (int i = 0; i < numSlots && num < max; i++) {
+            int slot = (hand + i) % numSlots;
+            if (resident[slot] && PF_Unpinned(bufTable[slot]) &&
+                  ref[slot] == pass)
+               slots[num++] = slot;
+         }
+      return (num);
+   }
+
+private:
+   int  numSlots;
+   int  hand;                    // next slot the clock hand looks at
+   char *ref;                    // reference bit of each slot
+   char *resident;               // TRUE if the slot holds a page
+};
+
+//------------------------------------------------------------------------------
+// 2Q
+//------------------------------------------------------------------------------
+
+class PF_2QReplacer : public PF_Replacer {
+public:
+   PF_2QReplacer(int numSlots) :
+      links(numSlots), a1out(Max(1, numSlots * PF_2Q_KOUT / 100))
+   {
+      kin = Max(1, numSlots * PF_2Q_KIN / 100);
+      where = new char[numSlots];
+      memset(where, NONE, numSlots);
+      PF_SlotLinks::InitList(a1in);
+      PF_SlotLinks::InitList(am);
+      PF_SlotLinks::InitList(ghosts);
+   }
+   ~PF_2QReplacer() { delete [] where; }
+
+   const char *Name() const { return "2Q"; }
+
+   void Admit(int slot, int fd, PageNum pageNum)
+   {
+      int node;
+
+      // Referenced again after falling out of A1in: this is a hot page
+      if ((node = a1out.Find(fd, pageNum)) != INVALID_SLOT) {
+         a1out.Remove(ghosts, node);
+         links.LinkHead(am, slot);
+         where[slot] = AM;
+      }
+      else {
+         links.LinkHead(a1in, slot);
+         where[slot] = A1IN;
+      }
+   }
+   void Access(int slot)
+   {
+      // References to a page in A1in are considered correlated
+      if (where[slot] == AM) {
+         links.Unlink(am, slot);
+         links.LinkHead(am, slot);
+      }
+   }
+   void Unpin(int slot) {}
+   void Remove(int slot)
+   {
+      if (where[slot] == A1IN)
+         links.Unlink(a1in, slot);
+      else if (where[slot] == AM)
+         links.Unlink(am, slot);
+      where[slot] = NONE;
+   }
+   void Evict(int slot, int fd, PageNum pageNum)
+   {
+      if (where[slot] == A1IN)
+         a1out.Add(ghosts, fd, pageNum);
+      Remove(slot);
+   }
+   void Forget(int fd) { a1out.Purge(ghosts, fd); }
+
+   RC Victim(const PF_BufPageDesc *bufTable, int fd, PageNum pageNum,
+         int &slot)
+   {
+      if (a1in.length > kin && LastEvictable(bufTable, a1in, slot))
+         return (0);
+      if (LastEvictable(bufTable, am, slot) ||
+            LastEvictable(bufTable, a1in, slot))
+         return (0);
+      return (PF_NOBUF);
+   }
+
+   int NextVictims(const PF_BufPageDesc *bufTable, int *slots, int max) const
+   {
+      if (a1in.length > kin) {
+         int num = PF_CollectTail(links, a1in, bufTable, slots, 0, max);
+         return (PF_CollectTail(links, am, bufTable, slots, num, max));
+      }
+      int num = PF_CollectTail(links, am, bufTable, slots, 0, max);
+      return (PF_CollectTail(links, a1in, bufTable, slots, num, max));
+   }
+
+private:
+   enum { NONE, A1IN, AM };
+
+   static int Max(int a, int b) { return (a > b) ? a : b; }
+
+   int LastEvictable(const PF_BufPageDesc *bufTable, const PF_SlotList &list,
+         int &slot)
+   {
+      for (slot = list.tail; slot != INVALID_SLOT; slot = links.Prev(slot))
+         if (PF_Evictable(bufTable[slot]))
+            return (TRUE);
+      return (FALSE);
+   }
+
+   int          kin;             // target size of A1in
+   char         *where;          // queue each slot is on
+   PF_SlotLinks links;
+   PF_SlotList  a1in;            // FIFO of pages seen once
+   PF_SlotList  am;              // LRU of pages seen again
+   PF_GhostDir  a1out;           // pages recently evicted from A1in
+   PF_SlotList  ghosts;          // FIFO order of a1out
+};
+
+//------------------------------------------------------------------------------
+// LRU-K
+//------------------------------------------------------------------------------
+
+//
+// PF_LRUKEntry - a page in line to be replaced, sorted by its K-th and then
+// its last reference
+//
+struct PF_LRUKEntry {
+   long long kth;
+   long long last;
+   int       slot;
+};
+
+static int PF_CompareLRUKEntry(const void *p1, const void *p2)
+{
+   const PF_LRUKEntry *e1 = (const PF_LRUKEntry *)p1;
+   const PF_LRUKEntry *e2 = (const PF_LRUKEntry *)p2;
+   if (e1->kth != e2->kth)
+      return ((e1->kth > e2->kth) - (e1->kth < e2->kth));
+   return ((e1->last > e2->last) - (e1->last < e2->last));
+}
+
+class PF_LRUKReplacer : public PF_Replacer {
+public:
+   PF_LRUKReplacer(int _numSlots) : history(_numSlots)
+   {
+      numSlots = _numSlots;
+      now = 0;
+      hist = new long long[numSlots * PF_LRUK_K];
+      ghostHist = new long long[history.Capacity() * PF_LRUK_K];
+      resident = new char[numSlots];
+      memset(resident, 0, numSlots);
+      PF_SlotLinks::InitList(ghosts);
+   }
+   ~PF_LRUKReplacer()
+   {
+      delete [] hist;
+      delete [] ghostHist;
+      delete [] resident;
+   }
+
+   const char *Name() const { return "LRU-K"; }
+
+   void Admit(int slot, int fd, PageNum pageNum)
+   {
+      int node;
+
+      // Pick up the reference history of a recently evicted page
+      if ((node = history.Find(fd, pageNum)) != INVALID_SLOT) {
+         memcpy(&hist[slot * PF_LRUK_K], &ghostHist[node * PF_LRUK_K],
+               PF_LRUK_K * sizeof(long long));
+         history.Remove(ghosts, node);
+      }
+      else
+         memset(&hist[slot * PF_LRUK_K], 0, PF_LRUK_K * sizeof(long long));
+
+      resident[slot] = TRUE;
+      Access(slot);
+   }
+   void Access(int slot)
+   {
+      long long *h = &hist[slot * PF_LRUK_K];
+      for (int k = PF_LRUK_K - 1; k > 0; k--)
+         h[k] = h[k - 1];
+      h[0] = ++now;
+   }
+   void Unpin(int slot) {}
+   void Remove(int slot) { resident[slot] = FALSE; }
+   void Evict(int slot, int fd, PageNum pageNum)
+   {
+      int node;
+
+      if ((node = history.Add(ghosts, fd, pageNum)) != INVALID_SLOT)
+         memcpy(&ghostHist[node * PF_LRUK_K], &hist[slot * PF_LRUK_K],
+               PF_LRUK_K * sizeof(long long));
+      resident[slot] = FALSE;
+   }
+   void Forget(int fd) { history.Purge(ghosts, fd); }
+
+   RC Victim(const PF_BufPageDesc *bufTable, int fd, PageNum pageNum,
+         int &slot)
+   {
+      // The victim has the oldest K-th reference; a page referenced
+      // fewer than K times has an infinite backward K-distance (0 here).
+      // Ties go to the least recently used page.
+      slot = INVALID_SLOT;
+      for (int s = 0; s < numSlots; s++) {
+         if (!resident[s] || !PF_Evictable(bufTable[s]))
+            continue;
+         if (slot == INVALID_SLOT || Older(s, slot))
+            slot = s;
+      }
+      return (slot == INVALID_SLOT) ? PF_NOBUF : 0;
+   }
+
+   int NextVictims(const PF_BufPageDesc *bufTable, int *slots, int max) const
+   {
+      PF_LRUKEntry *pEntries = new PF_LRUKEntry[numSlots];
+      int num = 0, s;
+
+      // Sort the unpinned pages once, in the order of Older
+      for (s = 0; s < numSlots; s++) {
+         if (!resident[s] || !PF_Unpinned(bufTable[s]))
+            continue;
+         pEntries[num].kth = hist[s * PF_LRUK_K + PF_LRUK_K - 1];
+         pEntries[num].last = hist[s * PF_LRUK_K];
+         pEntries[num].slot = s;
+         num++;
+      }
+      qsort(pEntries, num, sizeof(PF_LRUKEntry), PF_CompareLRUKEntry);
+
+      if (num > max)
+         num = max;
+      for (s = 0; s < num; s++)
+         slots[s] = pEntries[s].slot;
+      delete [] pEntries;
+      return (num);
+   }
+
+private:
+   int Older(int s1, int s2) const
+   {
+      long long k1 = hist[s1 * PF_LRUK_K + PF_LRUK_K - 1];
+      long long k2 = hist[s2 * PF_LRUK_K + PF_LRUK_K - 1];
+      if (k1 != k2)
+         return (k1 < k2);
+      return (hist[s1 * PF_LRUK_K] < hist[s2 * PF_LRUK_K]);
+   }
+
+   int          numSlots;
+   long long    now;             // logical clock, one tick per reference
+   long long    *hist;           // last K reference times of each slot
+   long long    *ghostHist;      // same for evicted pages
+   char         *resident;       // TRUE if the slot holds a page
+   PF_GhostDir  history;         // evicted pages whose history we keep
+   PF_SlotList  ghosts;          // FIFO order of history
+};
+
+//------------------------------------------------------------------------------
+// ARC
+//------------------------------------------------------------------------------
+
+class PF_ARCReplacer : public PF_Replacer {
+public:
+   PF_ARCReplacer(int numSlots) : links(numSlots), ghostDir(numSlots)
+   {
+      c = numSlots;
+      p = 0;
+      where = new char[numSlots];
+      memset(where, NONE, numSlots);
+      ghostWhere = new char[ghostDir.Capacity()];
+      PF_SlotLinks::InitList(t1);
+      PF_SlotLinks::InitList(t2);
+      PF_SlotLinks::InitList(b1);
+      PF_SlotLinks::InitList(b2);
+   }
+   ~PF_ARCReplacer()
+   {
+      delete [] where;
+      delete [] ghostWhere;
+   }
+
+   const char *Name() const { return "ARC"; }
+
+   void Admit(int slot, int fd, PageNum pageNum)
+   {
+      int node = ghostDir.Find(fd, pageNum);
+
+      if (node == INVALID_SLOT) {
+         // Brand new page: recency side
+         links.LinkHead(t1, slot);
+         where[slot] = T1;
+         return;
+      }
+
+      // Ghost hit: adapt the target size of T1 and promote to T2
+      if (ghostWhere[node] == B1) {
+         p = Min(c, p + Max(1, b2.length / Max(1, b1.length)));
+         ghostDir.Remove(b1, node);
+      }
+      else {
+         p = Max(0, p - Max(1, b1.length / Max(1, b2.length)));
+         ghostDir.Remove(b2, node);
+      }
+      links.LinkHead(t2, slot);
+      where[slot] = T2;
+   }
+   void Access(int slot)
+   {
+      Remove(slot);
+      links.LinkHead(t2, slot);
+      where[slot] = T2;
+   }
+   void Unpin(int slot) {}
+   void Remove(int slot)
+   {
+      if (where[slot] == T1)
+         links.Unlink(t1, slot);
+      else if (where[slot] == T2)
+         links.Unlink(t2, slot);
+      where[slot] = NONE;
+   }
+   void Evict(int slot, int fd, PageNum pageNum)
+   {
+      int node;
+
+      if (where[slot] == T1) {
+         if ((node = ghostDir.Add(b1, fd, pageNum)) != INVALID_SLOT)
+            ghostWhere[node] = B1;
+      }
+      else if (where[slot] == T2) {
+         if ((node = ghostDir.Add(b2, fd, pageNum)) != INVALID_SLOT)
+            ghostWhere[node] = B2;
+      }
+      Remove(slot);
+
+      // Keep |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c
+      while (b1.length && t1.length + b1.length > c)
+         ghostDir.Remove(b1, b1.tail);
+      while (b2.length && t1.length + t2.length + b1.length + b2.length > 2*c)
+         ghostDir.Remove(b2, b2.tail);
+   }
+   void Forget(int fd)
+   {
+      ghostDir.Purge(b1, fd);
+      ghostDir.Purge(b2, fd);
+   }
+
+   RC Victim(const PF_BufPageDesc *bufTable, int fd, PageNum pageNum,
+         int &slot)
+   {
+      int node = ghostDir.Find(fd, pageNum);
+      int inB2 = (node != INVALID_SLOT && ghostWhere[node] == B2);
+
+      // REPLACE(x, p) of the paper, falling back to the other list when
+      // every page of the preferred one is pinned
+      if (t1.length > 0 && (t1.length > p || (inB2 && t1.length == p))) {
+         if (LastEvictable(bufTable, t1, slot) ||
+               LastEvictable(bufTable, t2, slot))
+            return (0);
+      }
+      else if (LastEvictable(bufTable, t2, slot) ||
+            LastEvictable(bufTable, t1, slot))
+         return (0);
+      return (PF_NOBUF);
+   }
+
+   int NextVictims(const PF_BufPageDesc *bufTable, int *slots, int max) const
+   {
+      // Same preference as Victim, without a page being asked for
+      if (t1.length > 0 && t1.length > p) {
+         int num = PF_CollectTail(links, t1, bufTable, slots, 0, max);
+         return (PF_CollectTail(links, t2, bufTable, slots, num, max));
+      }
+      int num = PF_CollectTail(links, t2, bufTable, slots, 0, max);
+      return (PF_CollectTail(links, t1, bufTable, slots, num, max));
+   }
+
+private:
+   enum { NONE, T1, T2, B1, B2 };
+
+   static int Min(int a, int b) { return (a < b) ? a : b; }
+   static int Max(int a, int b) { return (a > b) ? a : b; }
+
+   int LastEvictable(const PF_BufPageDesc *bufTable, const PF_SlotList &list,
+         int &slot)
+   {
+      for (slot = list.tail; slot != INVALID_SLOT; slot = links.Prev(slot))
+         if (PF_Evictable(bufTable[slot]))
+            return (TRUE);
+      return (FALSE);
+   }
+
+   int          c;               // number of slots
+   int          p;               // target size of T1
+   char         *where;          // list each slot is on
+   char         *ghostWhere;     // list each ghost is on
+   PF_SlotLinks links;
+   PF_SlotList  t1;              // resident, seen once recently
+   PF_SlotList  t2;              // resident, seen at least twice
+   PF_GhostDir  ghostDir;        // B1 and B2 entries
+   PF_SlotList  b1;              // evicted from T1
+   PF_SlotList  b2;              // evicted from T2
+};
+
+//
+// PF_NewReplacer
+//
+// Desc: Build the replacer implementing policy for numSlots slots
+// Ret:  new replacer (caller deletes), or NULL for an unknown policy
+//
+PF_Replacer *PF_NewReplacer(PF_ReplacePolicy policy, int numSlots)
+{
+   switch (policy) {
+   case PF_REPLACE_LRU:
+      return new PF_LRUReplacer(numSlots);
+   case PF_REPLACE_CLOCK:
+      return new PF_ClockReplacer(numSlots);
+   case PF_REPLACE_2Q:
+      return new PF_2QReplacer(numSlots);
+   case PF_REPLACE_LRUK:
+      return new PF_LRUKReplacer(numSlots);
+   case PF_REPLACE_ARC:
+      return new PF_ARCReplacer(numSlots);
+   }
+   return (NULL);
+}
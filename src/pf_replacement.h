@@ -0,0 +1,124 @@
+//
+// File:        pf_replacement.h
+// Description: Page replacement policies for PF_BufferMgr
+//
+// The buffer manager owns the frames, the hash table and the free list.
+// Everything that has to do with choosing which resident page to throw
+// out is delegated to a PF_Replacer.  The buffer manager tells the
+// replacer when a page is loaded, referenced, unpinned, dropped or
+// evicted, and asks it for a victim when the free list is empty.  The
+// page cleaner of the buffer manager also asks which pages are next in
+// line, to write them before they are replaced.
+//
+// Slots handed to a replacer are buffer slot numbers (0..numSlots-1).
+//
+
+#ifndef PF_REPLACEMENT_H
+#define PF_REPLACEMENT_H
+
+#include "pf_internal.h"
+#include "pf_hashtable.h"
+
+struct PF_BufPageDesc;
+
+//
+// PF_SlotList - head/tail/length of a list threaded through PF_SlotLinks
+//
+struct PF_SlotList {
+    int head;           // MRU node
+    int tail;           // LRU node
+    int length;         // # of nodes in the list
+};
+
+//
+// PF_SlotLinks - next/prev "pointers" for a set of integer nodes
+//
+// Several lists can share one PF_SlotLinks as long as a node is never
+// on more than one of them at a time.
+//
+class PF_SlotLinks {
+public:
+    PF_SlotLinks  (int numNodes);
+    ~PF_SlotLinks ();
+
+    static void InitList (PF_SlotList &list);
+    void LinkHead (PF_SlotList &list, int node);  // Insert node as MRU
+    void Unlink   (PF_SlotList &list, int node);  // Remove node
+    int  Prev     (int node) const { return prev[node]; }
+    int  Next     (int node) const { return next[node]; }
+
+private:
+    int *next;
+    int *prev;
+};
+
+//
+// PF_GhostDir - bounded directory of recently evicted page identities
+//
+// Ghost entries carry no data, only (fd, pageNum).  They live on lists
+// owned by the caller (e.g. B1/B2 for ARC) and can be found by page.
+//
+class PF_GhostDir {
+public:
+    PF_GhostDir  (int capacity);
+    ~PF_GhostDir ();
+
+    // Return the ghost node for (fd, pageNum) or INVALID_SLOT
+    int  Find    (int fd, PageNum pageNum);
+    // Add (fd, pageNum) at the MRU end of list; returns the node used.
+    // If the directory is full the LRU node of list is recycled.
+    int  Add     (PF_SlotList &list, int fd, PageNum pageNum);
+    // Forget a ghost node
+    void Remove  (PF_SlotList &list, int node);
+    // Forget every ghost of a file
+    void Purge   (PF_SlotList &list, int fd);
+
+    int  Capacity() const { return capacity; }
+
+private:
+    int          capacity;
+    int          free;            // head of the free node list
+    int          *fds;            // fd of each node
+    PageNum      *pageNums;       // page number of each node
+    PF_SlotLinks links;           // list linkage of the nodes
+    PF_HashTable hashTable;       // (fd, pageNum) -> node
+};
+
+//
+// PF_Replacer - interface of a page replacement policy
+//
+class PF_Replacer {
+public:
+    virtual ~PF_Replacer() {};
+
+    // Name of the policy, for PrintBuffer
+    virtual const char *Name() const = 0;
+
+    // A page was read (or allocated) into slot
+    virtual void Admit  (int slot, int fd, PageNum pageNum) = 0;
+    // A resident page was referenced again
+    virtual void Access (int slot) = 0;
+    // The last pin on a page was released
+    virtual void Unpin  (int slot) = 0;
+    // A page was removed from the buffer without being replaced
+    // (flush, clear); no history is kept for it
+    virtual void Remove (int slot) = 0;
+    // A page chosen by Victim() was thrown out of the buffer
+    virtual void Evict  (int slot, int fd, PageNum pageNum) = 0;
+    // A file left the buffer; forget whatever history is kept for fd
+    virtual void Forget (int fd) = 0;
+    // Choose an unpinned page to replace in favor of (fd, pageNum)
+    // Ret: PF_NOBUF if every page is pinned
+    virtual RC   Victim (const PF_BufPageDesc *bufTable,
+                         int fd, PageNum pageNum, int &slot) = 0;
+    // Fill slots with up to max unpinned pages (see PF_Unpinned), roughly
+    // in the order in which they would be replaced.  Changes nothing.
+    // Ret: # of slots filled
+    virtual int  NextVictims(const PF_BufPageDesc *bufTable, int *slots,
+                         int max) const = 0;
+};
+
+// Build a replacer for numSlots buffer slots
+PF_Replacer *PF_NewReplacer(PF_ReplacePolicy policy, int numSlots);
+
+#endif
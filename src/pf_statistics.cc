@@ -30,6 +30,10 @@ void PF_Statistics()
    int *piRP = pStatisticsMgr->Get(PF_READPAGE);
    int *piWP = pStatisticsMgr->Get(PF_WRITEPAGE);
    int *piFP = pStatisticsMgr->Get(PF_FLUSHPAGES);
+   int *piPP = pStatisticsMgr->Get(PF_PREFETCHPAGE);
+   int *piWR = pStatisticsMgr->Get(PF_WRITERUN);
+   int *piCP = pStatisticsMgr->Get(PF_CLEANPAGE);
+   int *piDV = pStatisticsMgr->Get(PF_DIRTYVICTIM);
 
    cout << "PF Layer Statistics\n";
    cout << "-------------------\n";
@@ -44,12 +48,23 @@ void PF_Statistics()
 
    cout << "Number of read requests: ";
    if (piRP) cout << *piRP; else cout << "None";
+   cout << "\n  Number read ahead: ";
+   if (piPP) cout << *piPP; else cout << "None";
    cout << "\nNumber of write requests: ";
    if (piWP) cout << *piWP; else cout << "None";
+   cout << "\n  Number of writes (runs of pages): ";
+   if (piWR) cout << *piWR; else cout << "None";
+   cout << "\n  Number written by the page cleaner: ";
+   if (piCP) cout << *piCP; else cout << "None";
+   cout << "\n  Number written to replace a dirty page: ";
+   if (piDV) cout << *piDV; else cout << "None";
    cout << "\n-------------------\n";
    cout << "Number of flushes: ";
    if (piFP) cout << *piFP; else cout << "None";
    cout << "\n-------------------\n";
+   cout << "Times (# of operations, percentiles):\n";
+   pStatisticsMgr->PrintTimes();
+   cout << "-------------------\n";
 
    // Must delete the memory returned from StatisticsMgr::Get
    delete piGP;
@@ -58,6 +73,10 @@ void PF_Statistics()
    delete piRP;
    delete piWP;
    delete piFP;
+   delete piPP;
+   delete piWR;
+   delete piCP;
+   delete piDV;
 }
 
 #endif
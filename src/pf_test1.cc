@@ -503,6 +503,27 @@ RC TestHash()
             return(rc);
          }
 
+   cout << "Growing the table, then deleting every other entry\n";
+
+   for (p = 0; p < 1000; p++)
+      if ((rc = ht.Insert(3, p, p)))
+         return(rc);
+   if (ht.Insert(3, 500, 0) != PF_HASHPAGEEXIST) {
+      cout << "Inserting a duplicate hash entry should fail\n";
+      return (PF_HASHPAGEEXIST);
+   }
+   for (p = 0; p < 1000; p += 2)
+      if ((rc = ht.Delete(3, p)))
+         return(rc);
+   for (p = 0; p < 1000; p++) {
+      rc = ht.Find(3, p, s);
+      if ((p % 2 == 0 && rc != PF_HASHNOTFOUND) ||
+            (p % 2 == 1 && (rc || s != p))) {
+         cout << "Wrong hash entry for page " << p << "\n";
+         return (rc ? rc : PF_HASHNOTFOUND);
+      }
+   }
+
    // Return ok
    return (0);
 }
@@ -0,0 +1,212 @@
+//
+// File:        pf_test10.cc
+// Description: Test the extent-based growth of PF files
+//
+// A file created with extents of EXTENT pages must be EXTENT pages long
+// on the disk as soon as its first page is allocated, and grow by another
+// EXTENT pages only when its last extent is used up, also after it is
+// reopened.  A file created without extents grows a page at a time.  The
+// pages must read back right in both.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "pf.h"
+#include "pf_internal.h"
+#include "pf_testutil.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define FILE1        "file1"
+#define EXTENT       64                     // pages of an extent
+#define PAGE_BYTES   (PF_PAGE_SIZE + (int)sizeof(PF_PageHdr))
+
+//
+// FilePages
+//
+// Desc: # of pages FILE1 has room for on the disk
+//
+static int FilePages()
+{
+   struct stat st;
+
+   if (stat(FILE1, &st) < 0) {
+      cout << "Cannot stat " << FILE1 << "!\n";
+      exit(1);
+   }
+   return ((int)((st.st_size - PF_FILE_HDR_SIZE) / PAGE_BYTES));
+}
+
+//
+// ExpectPages
+//
+// Desc: Check that FILE1 has room for numPages pages
+//
+static void ExpectPages(int numPages)
+{
+   Expect("Pages on disk", FilePages(), numPages);
+}
+
+//
+// AllocatePages
+//
+// Desc: Allocate and fill numPages pages
+//
+RC AllocatePages(PF_FileHandle &fh, int numPages)
+{
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+
+   for (int i = 0; i < numPages; i++) {
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+      FillPage(pData, pageNum);
+      if ((rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+   return (0);
+}
+
+//
+// CheckPages
+//
+// Desc: Check the numPages pages of FILE1
+//
+RC CheckPages(PF_Manager &pfm, int numPages)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   RC rc;
+
+   if ((rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+   for (PageNum i = 0; i < numPages; i++) {
+      if ((rc = fh.GetThisPage(i, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      CheckPage(pData, i);
+      if ((rc = fh.UnpinPage(i)))
+         return (rc);
+   }
+   if ((rc = fh.GetThisPage(numPages, ph)) != PF_INVALIDPAGE) {
+      cout << "Page " << numPages << " should not exist!\n";
+      exit(1);
+   }
+   return (pfm.CloseFile(fh));
+}
+
+//
+// TestExtents
+//
+// Desc: Grow a file by extents of EXTENT pages
+//
+RC TestExtents(PF_Manager &pfm)
+{
+   PF_FileHandle fh;
+   RC rc;
+
+   cout << "Growing by " << EXTENT << " pages\n";
+
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1, PF_PAGE_SIZE, EXTENT)) ||
+         (rc = pfm.OpenFile(FILE1, fh)) ||
+         (rc = AllocatePages(fh, 1)))
+      return (rc);
+
+   // Where the file system cannot preallocate, the file grows as pages
+   // are written
+   if (FilePages() == 0) {
+      cout << "  The file system does not preallocate\n";
+      if ((rc = AllocatePages(fh, EXTENT)) ||
+            (rc = pfm.CloseFile(fh)) ||
+            (rc = CheckPages(pfm, EXTENT + 1)))
+         return (rc);
+      return (pfm.DestroyFile(FILE1));
+   }
+
+   ExpectPages(EXTENT);
+   if ((rc = AllocatePages(fh, EXTENT - 1)))
+      return (rc);
+   ExpectPages(EXTENT);
+   if ((rc = AllocatePages(fh, 1)))
+      return (rc);
+   ExpectPages(2 * EXTENT);
+
+   // The extent is remembered in the header
+   if ((rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.OpenFile(FILE1, fh)) ||
+         (rc = AllocatePages(fh, EXTENT - 1)))
+      return (rc);
+   ExpectPages(2 * EXTENT);
+   if ((rc = AllocatePages(fh, 1)))
+      return (rc);
+   ExpectPages(3 * EXTENT);
+
+   if ((rc = pfm.CloseFile(fh)) ||
+         (rc = CheckPages(pfm, 2 * EXTENT + 1)))
+      return (rc);
+   ExpectPages(3 * EXTENT);
+
+   return (pfm.DestroyFile(FILE1));
+}
+
+//
+// TestNoExtents
+//
+// Desc: Grow a file a page at a time
+//
+RC TestNoExtents(PF_Manager &pfm)
+{
+   PF_FileHandle fh;
+   RC rc;
+
+   cout << "Growing by single pages\n";
+
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1, PF_PAGE_SIZE, 0)) ||
+         (rc = pfm.OpenFile(FILE1, fh)) ||
+         (rc = AllocatePages(fh, EXTENT + 3)))
+      return (rc);
+   if ((rc = pfm.CloseFile(fh)) ||
+         (rc = CheckPages(pfm, EXTENT + 3)))
+      return (rc);
+   ExpectPages(EXTENT + 3);
+
+   return (pfm.DestroyFile(FILE1));
+}
+
+int main()
+{
+   PF_Manager pfm;
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF extent test.\n";
+   cout << "----------------------\n";
+
+   if ((rc = TestExtents(pfm)) ||
+         (rc = TestNoExtents(pfm))) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF extent test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
@@ -0,0 +1,217 @@
+//
+// File:        pf_test11.cc
+// Description: Test PF files with pages larger than PF_PAGE_SIZE
+//
+// A file is created with each page size, and all of them are written at
+// once, a page of each in turn, so that their buffer pools are in use
+// together.  Each file has more pages than its pool, so pages are
+// replaced and read again.  Every byte of every page is checked, the
+// files must have the length their page size gives, and page sizes that
+// do not exist must be refused.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "pf.h"
+#include "pf_internal.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define NUM_PAGES    (2 * PF_BUFFER_SIZE)   // pages of each file
+
+static const int kBytes[PF_PAGE_CLASSES] = { 4, 8, 16, 32, 64 };
+
+//
+// Fill, Check
+//
+// Desc: Fill a page with a pattern derived from its number and size, or
+//       check that it holds that pattern
+//
+static void Fill(char *pData, int pageSize, PageNum pageNum)
+{
+   for (int i = 0; i < pageSize; i++)
+      pData[i] = (char)(pageNum * 3 + pageSize + i * 13);
+}
+
+static void Check(const char *pData, int pageSize, PageNum pageNum)
+{
+   for (int i = 0; i < pageSize; i++)
+      if (pData[i] != (char)(pageNum * 3 + pageSize + i * 13)) {
+         cout << "Page " << pageNum << " of the " << pageSize
+            << " byte file has the wrong contents!\n";
+         exit(1);
+      }
+}
+
+//
+// FileName
+//
+// Desc: Name of the file of pages of kBytes K
+//
+static const char *FileName(int c)
+{
+   static char names[PF_PAGE_CLASSES][16];
+
+   sprintf(names[c], "file%dk", kBytes[c]);
+   return (names[c]);
+}
+
+//
+// WriteFiles
+//
+// Desc: Create a file of each page size and write NUM_PAGES pages to
+//       each, a page of each file in turn
+//
+RC WriteFiles(PF_Manager &pfm)
+{
+   PF_FileHandle fh[PF_PAGE_CLASSES];
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   int pageSize;
+   RC rc;
+   int c;
+
+   cout << "Writing " << NUM_PAGES << " pages of each size\n";
+
+   for (c = 0; c < PF_PAGE_CLASSES; c++) {
+      unlink(FileName(c));
+      if ((rc = pfm.CreateFile(FileName(c), PF_PageSize(kBytes[c]), 0)) ||
+            (rc = pfm.OpenFile(FileName(c), fh[c])) ||
+            (rc = fh[c].GetPageSize(pageSize)))
+         return (rc);
+      if (pageSize != PF_PageSize(kBytes[c])) {
+         cout << "File of " << kBytes[c] << "K pages has pages of "
+            << pageSize << " bytes!\n";
+         exit(1);
+      }
+   }
+
+   for (int i = 0; i < NUM_PAGES; i++)
+      for (c = 0; c < PF_PAGE_CLASSES; c++) {
+         if ((rc = fh[c].AllocatePage(ph)) ||
+               (rc = ph.GetData(pData)) ||
+               (rc = ph.GetPageNum(pageNum)))
+            return (rc);
+         Fill(pData, PF_PageSize(kBytes[c]), pageNum);
+         if ((rc = fh[c].MarkDirty(pageNum)) ||
+               (rc = fh[c].UnpinPage(pageNum)))
+            return (rc);
+      }
+
+   for (c = 0; c < PF_PAGE_CLASSES; c++)
+      if ((rc = pfm.CloseFile(fh[c])))
+         return (rc);
+
+   return (0);
+}
+
+//
+// ReadFiles
+//
+// Desc: Check the length of the files and scan them all at once
+//
+RC ReadFiles(PF_Manager &pfm)
+{
+   PF_FileHandle fh[PF_PAGE_CLASSES];
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   struct stat st;
+   RC rc;
+   int c;
+
+   cout << "Reading them back\n";
+
+   for (c = 0; c < PF_PAGE_CLASSES; c++) {
+      if (stat(FileName(c), &st) < 0 ||
+            st.st_size != PF_FILE_HDR_SIZE + (off_t)NUM_PAGES *
+            (PF_PageSize(kBytes[c]) + (int)sizeof(PF_PageHdr))) {
+         cout << "File of " << kBytes[c] << "K pages has the wrong length!\n";
+         exit(1);
+      }
+      if ((rc = pfm.OpenFile(FileName(c), fh[c])))
+         return (rc);
+   }
+
+   for (PageNum i = 0; i < NUM_PAGES; i++)
+      for (c = 0; c < PF_PAGE_CLASSES; c++) {
+         if ((rc = (i == 0) ? fh[c].GetFirstPage(ph) :
+               fh[c].GetNextPage(i - 1, ph)) ||
+               (rc = ph.GetData(pData)) ||
+               (rc = ph.GetPageNum(pageNum)))
+            return (rc);
+         if (pageNum != i) {
+            cout << "Scan got page " << pageNum << " instead of " << i
+               << "!\n";
+            exit(1);
+         }
+         Check(pData, PF_PageSize(kBytes[c]), pageNum);
+         if ((rc = fh[c].UnpinPage(pageNum)))
+            return (rc);
+      }
+
+   for (c = 0; c < PF_PAGE_CLASSES; c++)
+      if ((rc = fh[c].GetNextPage(NUM_PAGES - 1, ph)) != PF_EOF ||
+            (rc = pfm.CloseFile(fh[c])) ||
+            (rc = pfm.DestroyFile(FileName(c))))
+         return (rc ? rc : PF_EOF);
+
+   return (0);
+}
+
+//
+// TestBadSizes
+//
+// Desc: Page sizes other than those of the size classes are refused
+//
+RC TestBadSizes(PF_Manager &pfm)
+{
+   int badSizes[] = { 0, PF_PAGE_SIZE - 1, PF_PageSize(2), PF_PageSize(12),
+      PF_PageSize(128) };
+
+   cout << "Refusing other page sizes\n";
+
+   for (unsigned int i = 0; i < sizeof(badSizes) / sizeof(int); i++)
+      if (pfm.CreateFile(FileName(0), badSizes[i]) != PF_BADPAGESIZE) {
+         cout << "Page size " << badSizes[i] << " was accepted!\n";
+         exit(1);
+      }
+   if (access(FileName(0), F_OK) == 0) {
+      cout << "A file was created!\n";
+      exit(1);
+   }
+   return (0);
+}
+
+int main()
+{
+   PF_Manager pfm;
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF page size test.\n";
+   cout << "----------------------\n";
+
+   if ((rc = WriteFiles(pfm)) ||
+         (rc = pfm.ClearBuffer()) ||
+         (rc = ReadFiles(pfm)) ||
+         (rc = TestBadSizes(pfm))) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF page size test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
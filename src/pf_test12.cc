@@ -0,0 +1,336 @@
+//
+// File:        pf_test12.cc
+// Description: Test PF files whose pages are compressed on disk
+//
+// Two files of 4K pages, then of 16K pages, are written with the same
+// pages, one of them compressed: most pages are mostly '\0' padding,
+// every NOISY-th one is noise that does not compress.  The compressed
+// file must take much less room on the disk (where the file system can
+// give blocks back), and read back right in any order, also with direct
+// I/O and mapped (which reads a compressed file through the buffer).  A
+// page rewritten from compressible to noise and back must keep its
+// contents, and so must all of them, which moves the pages around.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "pf.h"
+#include "pf_internal.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define FILE1        "file1"                // compressed
+#define FILE2        "file2"                // not compressed
+#define NUM_PAGES    (2 * PF_BUFFER_SIZE)   // pages of each file
+#define NOISY        8                      // every NOISY-th page is noise
+#define USED_BYTES   600                    // bytes of a page not padding
+
+static int pageSize;                        // of the files tested
+
+//
+// Fill, Check
+//
+// Desc: Fill a page with the contents derived from its number (and
+//       bNoisy: noise), or check that it holds them
+//
+static char Byte(PageNum pageNum, int i, int bNoisy)
+{
+   if (bNoisy)
+      return ((char)((pageNum * 2654435761U + i * 40503U) >> 13));
+   return (i < USED_BYTES ? (char)(pageNum + i / 16) : '\0');
+}
+
+static void Fill(char *pData, PageNum pageNum, int bNoisy)
+{
+   for (int i = 0; i < pageSize; i++)
+      pData[i] = Byte(pageNum, i, bNoisy);
+}
+
+static void Check(const char *pData, PageNum pageNum, int bNoisy)
+{
+   for (int i = 0; i < pageSize; i++)
+      if (pData[i] != Byte(pageNum, i, bNoisy)) {
+         cout << "Page " << pageNum << " has the wrong contents!\n";
+         exit(1);
+      }
+}
+
+//
+// DiskBytes
+//
+// Desc: # of bytes a file takes on the disk
+//
+static long DiskBytes(const char *fileName)
+{
+   struct stat st;
+
+   if (stat(fileName, &st) < 0) {
+      cout << "Cannot stat " << fileName << "!\n";
+      exit(1);
+   }
+   return ((long)st.st_blocks * 512);
+}
+
+//
+// Compressed
+//
+// Desc: Whether the header of a file says its pages are compressed
+//
+static int Compressed(const char *fileName)
+{
+   PF_FileHdr hdr;
+   int fd;
+
+   if ((fd = open(fileName, O_RDONLY)) < 0 ||
+         pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+         close(fd)) {
+      cout << "Cannot read the header of " << fileName << "!\n";
+      exit(1);
+   }
+   return (hdr.bCompressed);
+}
+
+//
+// WriteFile
+//
+// Desc: Create a file and write NUM_PAGES pages to it
+//
+RC WriteFile(PF_Manager &pfm, const char *fileName, int bCompress)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+
+   unlink(fileName);
+   if ((rc = pfm.CreateFile(fileName, pageSize, 0, bCompress)) ||
+         (rc = pfm.OpenFile(fileName, fh)))
+      return (rc);
+
+   for (int i = 0; i < NUM_PAGES; i++) {
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+      Fill(pData, pageNum, pageNum % NOISY == 0);
+      if ((rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+
+   return (pfm.CloseFile(fh));
+}
+
+//
+// CheckFile
+//
+// Desc: Read the pages of FILE1 in a shuffled order, opened with ioMode
+//
+RC CheckFile(PF_Manager &pfm, PF_IOMode ioMode)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   RC rc;
+
+   if ((rc = pfm.OpenFile(FILE1, fh, ioMode)))
+      return (rc);
+
+   // 37 is prime to NUM_PAGES: the stride visits every page
+   for (int i = 0; i < NUM_PAGES; i++) {
+      PageNum pageNum = (PageNum)((i * 37 + 5) % NUM_PAGES);
+
+      if ((rc = fh.GetThisPage(pageNum, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      Check(pData, pageNum, pageNum % NOISY == 0);
+      if ((rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+
+   if ((rc = pfm.CloseFile(fh)))
+      return (rc);
+   return (pfm.ClearBuffer());
+}
+
+//
+// Rewrite
+//
+// Desc: Write page pageNum of FILE1 as noise (or not, if !bNoisy), then
+//       check it and its neighbours with the buffer cleared
+//
+RC Rewrite(PF_Manager &pfm, PageNum pageNum, int bNoisy)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   RC rc;
+
+   if ((rc = pfm.OpenFile(FILE1, fh)) ||
+         (rc = fh.GetThisPage(pageNum, ph)) ||
+         (rc = ph.GetData(pData)))
+      return (rc);
+   Fill(pData, pageNum, bNoisy);
+   if ((rc = fh.MarkDirty(pageNum)) ||
+         (rc = fh.UnpinPage(pageNum)) ||
+         (rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.ClearBuffer()) ||
+         (rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+
+   for (PageNum i = pageNum - 1; i <= pageNum + 1; i++) {
+      if ((rc = fh.GetThisPage(i, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      Check(pData, i, i == pageNum ? bNoisy : i % NOISY == 0);
+      if ((rc = fh.UnpinPage(i)))
+         return (rc);
+   }
+
+   if ((rc = pfm.CloseFile(fh)))
+      return (rc);
+   return (pfm.ClearBuffer());
+}
+
+//
+// RewriteAll
+//
+// Desc: Write all the pages of FILE1 as noise (or as they were, if
+//       !bNoisy), then check them with the buffer cleared
+//
+RC RewriteAll(PF_Manager &pfm, int bNoisy)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   RC rc;
+
+   if ((rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+   for (PageNum i = 0; i < NUM_PAGES; i++) {
+      if ((rc = fh.GetThisPage(i, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      Fill(pData, i, bNoisy || i % NOISY == 0);
+      if ((rc = fh.MarkDirty(i)) ||
+            (rc = fh.UnpinPage(i)))
+         return (rc);
+   }
+   if ((rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.ClearBuffer()))
+      return (rc);
+
+   if (!bNoisy)
+      return (CheckFile(pfm, PF_IO_BUFFERED));
+   if ((rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+   for (PageNum i = 0; i < NUM_PAGES; i++) {
+      if ((rc = fh.GetThisPage(i, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      Check(pData, i, TRUE);
+      if ((rc = fh.UnpinPage(i)))
+         return (rc);
+   }
+   if ((rc = pfm.CloseFile(fh)))
+      return (rc);
+   return (pfm.ClearBuffer());
+}
+
+//
+// TestCompression
+//
+// Desc: Write the two files and compare them
+//
+RC TestCompression(PF_Manager &pfm)
+{
+   RC rc;
+
+   cout << "Writing " << NUM_PAGES << " pages of " << pageSize
+      << " bytes, compressed and not\n";
+
+   if ((rc = WriteFile(pfm, FILE1, TRUE)) ||
+         (rc = WriteFile(pfm, FILE2, FALSE)) ||
+         (rc = pfm.ClearBuffer()))
+      return (rc);
+
+   long compressed = DiskBytes(FILE1), plain = DiskBytes(FILE2);
+   cout << "  On disk: " << compressed << " bytes compressed, " << plain
+      << " not\n";
+   if (compressed > plain) {
+      cout << "The compressed file is larger!\n";
+      exit(1);
+   }
+
+   // Where the file system cannot punch holes, the pages take their
+   // whole place
+   if (compressed == plain)
+      cout << "  The file system does not give blocks back\n";
+   else if (compressed > plain / 2) {
+      cout << "Expected less than half of it!\n";
+      exit(1);
+   }
+
+   // Direct I/O may not be available
+   cout << "Reading the compressed file back\n";
+   if ((rc = CheckFile(pfm, PF_IO_BUFFERED)) ||
+         ((rc = CheckFile(pfm, PF_IO_DIRECT)) && rc != PF_NODIRECTIO) ||
+         (rc = CheckFile(pfm, PF_IO_MMAP)))
+      return (rc);
+
+   cout << "Rewriting a page as noise and back\n";
+   if ((rc = Rewrite(pfm, 3, TRUE)) ||
+         (rc = Rewrite(pfm, 3, FALSE)) ||
+         (rc = CheckFile(pfm, PF_IO_BUFFERED)))
+      return (rc);
+
+   cout << "Rewriting all pages as noise and back\n";
+   if ((rc = RewriteAll(pfm, TRUE)) ||
+         (rc = RewriteAll(pfm, FALSE)) ||
+         ((rc = CheckFile(pfm, PF_IO_DIRECT)) && rc != PF_NODIRECTIO))
+      return (rc);
+
+   // The headers say which file is compressed
+   if (!Compressed(FILE1) || Compressed(FILE2)) {
+      cout << "The headers are wrong!\n";
+      exit(1);
+   }
+
+   if ((rc = pfm.DestroyFile(FILE1)))
+      return (rc);
+   return (pfm.DestroyFile(FILE2));
+}
+
+int main()
+{
+   PF_Manager pfm;
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF compression test.\n";
+   cout << "----------------------\n";
+
+   for (int kBytes = 4; kBytes <= 16; kBytes *= 4) {
+      pageSize = PF_PageSize(kBytes);
+      if ((rc = TestCompression(pfm))) {
+         PF_PrintError(rc);
+         return (1);
+      }
+   }
+
+   cout << "Ending PF compression test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
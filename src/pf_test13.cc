@@ -0,0 +1,207 @@
+//
+// File:        pf_test13.cc
+// Description: Test the statistics manager
+//
+// NUM_THREADS threads count PF statistics at once, by number and by key;
+// none of the counts may be lost.  The other operations of Register, Get
+// and Reset must work on the PF statistics as on any other key.  Reading
+// and writing a file larger than the buffer must time its reads, writes
+// and evictions.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <pthread.h>
+#include "pf.h"
+#include "pf_internal.h"
+#include "pf_testutil.h"
+#include "statistics.h"
+
+using namespace std;
+
+#ifdef PF_STATS
+// This is defined within pf_buffermgr.cc
+extern StatisticsMgr *pStatisticsMgr;
+#endif
+
+//
+// Defines
+//
+#define FILE1        "file1"
+#define NUM_THREADS  8
+#define NUM_ADDS     100000                 // counts of each thread
+#define NUM_PAGES    (2 * PF_BUFFER_SIZE)   // pages in the test file
+
+//
+// Value
+//
+// Desc: Current value of a statistic, -1 if it is not tracked
+//
+static int Value(StatisticsMgr &stats, const char *psKey)
+{
+   int *piValue = stats.Get(psKey);
+   int value = piValue ? *piValue : -1;
+   delete piValue;
+   return (value);
+}
+
+//
+// Counter
+//
+// Desc: The counting of each thread
+//
+static void *Counter(void *pStats)
+{
+   StatisticsMgr &stats = *(StatisticsMgr *)pStats;
+   int two = 2;
+
+   for (int i = 0; i < NUM_ADDS; i++) {
+      stats.Add(PF_STAT_GETPAGE);
+      stats.Register(PF_PAGEFOUND, STAT_ADDVALUE, &two);
+      stats.Register("OTHER", STAT_ADDONE);
+   }
+   return (NULL);
+}
+
+//
+// TestCounters
+//
+// Desc: Count from several threads, then try the other operations
+//
+void TestCounters()
+{
+   StatisticsMgr stats;
+   pthread_t threads[NUM_THREADS];
+   int value = 7;
+
+   cout << NUM_THREADS << " threads counting\n";
+
+   if (Value(stats, PF_GETPAGE) != -1 || stats.Reset(PF_GETPAGE) !=
+         STAT_UNKNOWN_KEY) {
+      cout << "A statistic is there before it is counted!\n";
+      exit(1);
+   }
+
+   long long start = StatNow();
+   for (int i = 0; i < NUM_THREADS; i++)
+      pthread_create(&threads[i], NULL, Counter, &stats);
+   for (int i = 0; i < NUM_THREADS; i++)
+      pthread_join(threads[i], NULL);
+   cout << "  Took " << (StatNow() - start) / 1000000 << " ms\n";
+
+   Expect(PF_GETPAGE, Value(stats, PF_GETPAGE), NUM_THREADS * NUM_ADDS);
+   Expect(PF_PAGEFOUND, Value(stats, "PAGEFOUND"),
+         2 * NUM_THREADS * NUM_ADDS);
+   Expect("OTHER", Value(stats, "OTHER"), NUM_THREADS * NUM_ADDS);
+
+   cout << "Other operations\n";
+   stats.Register(PF_GETPAGE, STAT_SETVALUE, &value);
+   stats.Register(PF_GETPAGE, STAT_MULTVALUE, &value);
+   stats.Register(PF_GETPAGE, STAT_SUBVALUE, &value);
+   Expect("(7 * 7) - 7", Value(stats, PF_GETPAGE), 42);
+   stats.Register(PF_GETPAGE, STAT_DIVVALUE, &value);
+   Expect("42 / 7", Value(stats, PF_GETPAGE), 6);
+
+   Expect("Reset", stats.Reset(PF_GETPAGE), 0);
+   Expect(PF_GETPAGE, Value(stats, PF_GETPAGE), -1);
+   stats.Reset();
+   Expect(PF_PAGEFOUND, Value(stats, PF_PAGEFOUND), -1);
+   Expect("OTHER", Value(stats, "OTHER"), -1);
+}
+
+#ifdef PF_STATS
+//
+// TimedOps
+//
+// Desc: # of operations timed by timer
+//
+static long long TimedOps(PF_StatTimer timer)
+{
+   long long counts[STAT_TIME_BUCKETS], total = 0;
+
+   pStatisticsMgr->GetTimes(timer, counts);
+   for (int b = 0; b < STAT_TIME_BUCKETS; b++)
+      total += counts[b];
+   return (total);
+}
+#endif
+
+//
+// TestTimes
+//
+// Desc: Write and read a file larger than the buffer
+//
+RC TestTimes(PF_Manager &pfm)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   PageNum pageNum;
+   RC rc;
+
+   cout << "Timing " << NUM_PAGES << " pages\n";
+
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1)) ||
+         (rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+
+#ifdef PF_STATS
+   pStatisticsMgr->Reset();
+#endif
+
+   for (int i = 0; i < NUM_PAGES; i++)
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetPageNum(pageNum)) ||
+            (rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   if ((rc = fh.FlushPages()))
+      return (rc);
+   for (PageNum i = 0; i < NUM_PAGES; i++)
+      if ((rc = fh.GetThisPage(i, ph)) ||
+            (rc = fh.UnpinPage(i)))
+         return (rc);
+
+#ifdef PF_STATS
+   long long reads = TimedOps(PF_TIME_READ);
+   long long writes = TimedOps(PF_TIME_WRITE);
+   long long evictions = TimedOps(PF_TIME_EVICT);
+   cout << "  Reads " << reads << ", writes " << writes << ", evictions "
+      << evictions << "\n";
+   if (reads == 0 || writes == 0 || evictions == 0) {
+      cout << "Operations were not timed!\n";
+      exit(1);
+   }
+   pStatisticsMgr->PrintTimes();
+#endif
+
+   if ((rc = pfm.CloseFile(fh)))
+      return (rc);
+   return (pfm.DestroyFile(FILE1));
+}
+
+int main()
+{
+   PF_Manager pfm;
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF statistics test.\n";
+   cout << "----------------------\n";
+
+   TestCounters();
+   if ((rc = TestTimes(pfm))) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF statistics test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
@@ -0,0 +1,157 @@
+//
+// File:        pf_test14.cc
+// Description: Test the statistics the buffer keeps for each file
+//
+// A small file is read over and over while a file larger than the
+// buffer is read once.  With PF_STATS the small file must have the hits
+// and the large one the misses, evictions must be charged to the file
+// whose pages went out, and writes to the file written.  Without it only
+// the pages in the buffer are counted.  The counts must outlive the file
+// being closed and come back to 0 when reset.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include "pf.h"
+#include "pf_internal.h"
+#include "pf_testutil.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define HOT          "hot"
+#define COLD         "cold"
+#define HOT_PAGES    (PF_BUFFER_SIZE / 4)   // pages of the small file
+#define COLD_PAGES   (2 * PF_BUFFER_SIZE)   // pages of the large file
+#define ROUNDS       10                     // times the small one is read
+
+//
+// Find
+//
+// Desc: The statistics of fileName
+//
+static PF_FileStats Find(PF_Manager &pfm, const char *fileName)
+{
+   PF_FileStats *pStats, stats;
+   int numFiles, i;
+
+   if (pfm.GetFileStats(pStats, numFiles)) {
+      cout << "Cannot get the statistics!\n";
+      exit(1);
+   }
+   for (i = 0; i < numFiles; i++)
+      if (strcmp(pStats[i].fileName, fileName) == 0)
+         break;
+   if (i == numFiles) {
+      cout << "No statistics for " << fileName << "!\n";
+      exit(1);
+   }
+   stats = pStats[i];
+   delete [] pStats;
+   return (stats);
+}
+
+//
+// TestFileStats
+//
+// Desc: Read the two files and look at their statistics
+//
+RC TestFileStats(PF_Manager &pfm)
+{
+   PF_FileHandle hot, cold;
+   PF_FileStats stats;
+   RC rc;
+
+   cout << "Writing " << HOT << " and " << COLD << "\n";
+   if ((rc = WriteFile(pfm, HOT, HOT_PAGES)) ||
+         (rc = WriteFile(pfm, COLD, COLD_PAGES)) ||
+         (rc = pfm.ClearBuffer()))
+      return (rc);
+
+#ifdef PF_STATS
+   stats = Find(pfm, HOT);
+   Expect("Pages of hot written", stats.writeBacks, HOT_PAGES);
+#endif
+   pfm.ResetFileStats();
+
+   cout << "Reading " << HOT << " " << ROUNDS << " times and " << COLD
+      << " once\n";
+   if ((rc = pfm.OpenFile(HOT, hot)) ||
+         (rc = pfm.OpenFile(COLD, cold)) ||
+         (rc = ReadPages(hot, HOT_PAGES)) ||
+         (rc = ReadPages(cold, COLD_PAGES)))
+      return (rc);
+   for (int i = 1; i < ROUNDS; i++)
+      if ((rc = ReadPages(hot, HOT_PAGES)))
+         return (rc);
+
+   stats = Find(pfm, COLD);
+#ifdef PF_STATS
+   Expect("Misses of cold", stats.misses, COLD_PAGES);
+   Expect("Hits of cold", stats.hits, 0);
+   Expect("Writes of cold", stats.writeBacks, 0);
+   if (stats.evictions < COLD_PAGES - PF_BUFFER_SIZE) {
+      cout << "Only " << stats.evictions << " pages of cold were evicted!\n";
+      exit(1);
+   }
+#endif
+   int coldResident = stats.residentPages;
+
+   stats = Find(pfm, HOT);
+#ifdef PF_STATS
+   if (stats.hits + stats.misses != ROUNDS * HOT_PAGES ||
+         stats.misses > 2 * HOT_PAGES) {
+      cout << "Hot has " << stats.hits << " hits and " << stats.misses
+         << " misses!\n";
+      exit(1);
+   }
+#endif
+   Expect("Pages in the buffer",
+         stats.residentPages + coldResident, PF_BUFFER_SIZE);
+   Expect("Pages of hot in the buffer", stats.residentPages, HOT_PAGES);
+
+   // The counts stay after the files are closed, until they are reset
+   if ((rc = pfm.CloseFile(hot)) ||
+         (rc = pfm.CloseFile(cold)) ||
+         (rc = pfm.ClearBuffer()))
+      return (rc);
+   stats = Find(pfm, COLD);
+   Expect("Pages of cold in the buffer", stats.residentPages, 0);
+#ifdef PF_STATS
+   Expect("Misses of cold after closing", stats.misses, COLD_PAGES);
+#endif
+   pfm.ResetFileStats();
+   stats = Find(pfm, COLD);
+   Expect("Misses of cold after reset", stats.misses, 0);
+
+   if ((rc = pfm.DestroyFile(HOT)))
+      return (rc);
+   return (pfm.DestroyFile(COLD));
+}
+
+int main()
+{
+   PF_Manager pfm;
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF file statistics test.\n";
+   cout << "----------------------\n";
+
+   if ((rc = TestFileStats(pfm))) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF file statistics test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
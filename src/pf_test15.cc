@@ -0,0 +1,212 @@
+//
+// File:        pf_test15.cc
+// Description: Test resizing a buffer holding the pages of an open file
+//
+// The buffer is filled with pages of a file, HOT_PAGES of which are read
+// over and over and a few of which are dirty, one page is kept pinned.
+// Growing the buffer must keep every page in it; shrinking it must keep
+// the hot pages (reading them again misses none) and throw out cold
+// pages only.  The pinned page must stay where it is, and every page must
+// keep its contents, the dirty ones once they are written out.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include "pf.h"
+#include "pf_internal.h"
+#include "pf_testutil.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define FILE1        "file1"
+#define NUM_PAGES    PF_BUFFER_SIZE          // pages of the file
+#define HOT_PAGES    (PF_BUFFER_SIZE / 4)    // pages read over and over
+#define SMALL_SIZE   (PF_BUFFER_SIZE / 2)    // size of the shrunk buffer
+#define PINNED       (NUM_PAGES - 1)         // page kept pinned
+
+//
+// Stats
+//
+// Desc: The statistics of FILE1
+//
+static PF_FileStats Stats(PF_Manager &pfm)
+{
+   PF_FileStats *pStats, stats;
+   int numFiles, i;
+
+   if (pfm.GetFileStats(pStats, numFiles)) {
+      cout << "Cannot get the statistics!\n";
+      exit(1);
+   }
+   for (i = 0; i < numFiles && strcmp(pStats[i].fileName, FILE1); i++)
+      ;
+   if (i == numFiles) {
+      cout << "No statistics for " << FILE1 << "!\n";
+      exit(1);
+   }
+   stats = pStats[i];
+   delete [] pStats;
+   return (stats);
+}
+
+//
+// ReadPages
+//
+// Desc: Get pages from first to last - 1 and check that page i starts
+//       with i + delta, unpin them
+//
+RC ReadPages(PF_FileHandle &fh, PageNum first, PageNum last, int delta)
+{
+   PF_PageHandle ph;
+   char *pData;
+   RC rc;
+
+   for (PageNum i = first; i < last; i++) {
+      if ((rc = fh.GetThisPage(i, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      if (*(int *)pData != i + delta) {
+         cout << "Page " << i << " has the wrong contents!\n";
+         exit(1);
+      }
+      if ((rc = fh.UnpinPage(i)))
+         return (rc);
+   }
+   return (0);
+}
+
+//
+// Misses
+//
+// Desc: # of misses of FILE1 reading its hot pages again.  Without
+//       PF_STATS nothing is counted and there are no misses.
+//
+static int Misses(PF_Manager &pfm, PF_FileHandle &fh)
+{
+   RC rc;
+
+   pfm.ResetFileStats();
+   if ((rc = ReadPages(fh, 0, HOT_PAGES, 0))) {
+      PF_PrintError(rc);
+      exit(1);
+   }
+   return (Stats(pfm).misses);
+}
+
+//
+// TestResize
+//
+// Desc: Fill the buffer, then grow and shrink it
+//
+RC TestResize(PF_Manager &pfm)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph, pinned;
+   char *pData, *pPinned;
+   PageNum pageNum;
+   RC rc;
+
+   cout << "Writing " << NUM_PAGES << " pages\n";
+
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1)) ||
+         (rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+   for (int i = 0; i < NUM_PAGES; i++) {
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+      *(int *)pData = pageNum;
+      if ((rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+   if ((rc = fh.FlushPages()) ||
+         (rc = pfm.ClearBuffer()))
+      return (rc);
+
+   // Fill the buffer: the cold pages, then the hot ones over and over.
+   // The first of the cold pages are made dirty.
+   if ((rc = ReadPages(fh, HOT_PAGES, NUM_PAGES, 0)))
+      return (rc);
+   for (PageNum i = HOT_PAGES; i < 2 * HOT_PAGES; i++) {
+      if ((rc = fh.GetThisPage(i, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      *(int *)pData = i + NUM_PAGES;
+      if ((rc = fh.MarkDirty(i)) ||
+            (rc = fh.UnpinPage(i)))
+         return (rc);
+   }
+   for (int round = 0; round < 3; round++)
+      if ((rc = ReadPages(fh, 0, HOT_PAGES, 0)))
+         return (rc);
+   if ((rc = fh.GetThisPage(PINNED, pinned)) ||
+         (rc = pinned.GetData(pPinned)))
+      return (rc);
+   Expect("Pages in the buffer", Stats(pfm).residentPages, NUM_PAGES);
+
+   cout << "Growing the buffer to " << 2 * PF_BUFFER_SIZE << " pages\n";
+   if ((rc = pfm.ResizeBuffer(2 * PF_BUFFER_SIZE)))
+      return (rc);
+   Expect("Pages in the buffer", Stats(pfm).residentPages, NUM_PAGES);
+   Expect("Misses reading the hot pages", Misses(pfm, fh), 0);
+
+   cout << "Shrinking the buffer to " << SMALL_SIZE << " pages\n";
+   if ((rc = pfm.ResizeBuffer(SMALL_SIZE)))
+      return (rc);
+   Expect("Pages in the buffer", Stats(pfm).residentPages, SMALL_SIZE);
+   Expect("Misses reading the hot pages", Misses(pfm, fh), 0);
+
+   // The pinned page has not moved
+   if ((rc = pinned.GetData(pData)))
+      return (rc);
+   Expect("Pinned page where it was", pData == pPinned, TRUE);
+   Expect("Pinned page contents", *(int *)pData, PINNED);
+   if ((rc = fh.UnpinPage(PINNED)))
+      return (rc);
+
+   // The pages changed come back from the disk as they were changed
+   cout << "Reading the pages back\n";
+   if ((rc = fh.FlushPages()) ||
+         (rc = pfm.ClearBuffer()) ||
+         (rc = ReadPages(fh, 0, HOT_PAGES, 0)) ||
+         (rc = ReadPages(fh, HOT_PAGES, 2 * HOT_PAGES, NUM_PAGES)) ||
+         (rc = ReadPages(fh, 2 * HOT_PAGES, NUM_PAGES, 0)))
+      return (rc);
+
+   // Back to the usual size
+   if ((rc = pfm.ResizeBuffer(PF_BUFFER_SIZE)) ||
+         (rc = pfm.CloseFile(fh)))
+      return (rc);
+   return (pfm.DestroyFile(FILE1));
+}
+
+int main()
+{
+   PF_Manager pfm;
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF buffer resize test.\n";
+   cout << "----------------------\n";
+
+   if ((rc = TestResize(pfm))) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF buffer resize test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
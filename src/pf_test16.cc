@@ -0,0 +1,180 @@
+//
+// File:        pf_test16.cc
+// Description: Test named buffer pools
+//
+// A small file is bound to a pool of its own and read, then a file twice
+// as large as the default pool is read: the pages of the small file must
+// all stay in the buffer, while the large one fills the default pool.
+// The pool can be resized and given another policy; a file bound back
+// to the default pool goes there when it is opened again.  Unknown
+// pools and too many pools must be refused.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include "pf.h"
+#include "pf_internal.h"
+#include "pf_testutil.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define HOT          "hot"
+#define COLD         "cold"
+#define POOL         "catalog"
+#define POOL_PAGES   8                      // pages of the pool
+#define HOT_PAGES    POOL_PAGES             // pages of the small file
+#define COLD_PAGES   (2 * PF_BUFFER_SIZE)   // pages of the large file
+
+//
+// Resident
+//
+// Desc: # of pages of fileName in the buffer
+//
+static int Resident(PF_Manager &pfm, const char *fileName)
+{
+   PF_FileStats *pStats;
+   int numFiles, numPages = 0;
+
+   if (pfm.GetFileStats(pStats, numFiles)) {
+      cout << "Cannot get the statistics!\n";
+      exit(1);
+   }
+   for (int i = 0; i < numFiles; i++)
+      if (strcmp(pStats[i].fileName, fileName) == 0)
+         numPages = pStats[i].residentPages;
+   delete [] pStats;
+   return (numPages);
+}
+
+//
+// ReadBoth
+//
+// Desc: Open the two files, read the small one, then the large one
+//
+RC ReadBoth(PF_Manager &pfm, PF_FileHandle &hot, PF_FileHandle &cold)
+{
+   RC rc;
+
+   if ((rc = pfm.OpenFile(HOT, hot)) ||
+         (rc = pfm.OpenFile(COLD, cold)) ||
+         (rc = ReadPages(hot, HOT_PAGES)) ||
+         (rc = ReadPages(cold, COLD_PAGES)))
+      return (rc);
+   return (0);
+}
+
+//
+// CloseBoth
+//
+// Desc: Close the two files and empty the buffer
+//
+RC CloseBoth(PF_Manager &pfm, PF_FileHandle &hot, PF_FileHandle &cold)
+{
+   RC rc;
+
+   if ((rc = pfm.CloseFile(hot)) ||
+         (rc = pfm.CloseFile(cold)) ||
+         (rc = pfm.ClearBuffer()))
+      return (rc);
+   return (0);
+}
+
+//
+// TestPools
+//
+// Desc: Read the files with and without a pool for the small one
+//
+RC TestPools(PF_Manager &pfm)
+{
+   PF_FileHandle hot, cold;
+   char poolName[16];
+   RC rc;
+
+   cout << "Writing " << HOT << " and " << COLD << "\n";
+   if ((rc = WriteFile(pfm, HOT, HOT_PAGES)) ||
+         (rc = WriteFile(pfm, COLD, COLD_PAGES)) ||
+         (rc = pfm.ClearBuffer()))
+      return (rc);
+
+   cout << "Reading them from the default pool\n";
+   if ((rc = ReadBoth(pfm, hot, cold)))
+      return (rc);
+   Expect("Pages of hot in the buffer", Resident(pfm, HOT), 0);
+   if ((rc = CloseBoth(pfm, hot, cold)))
+      return (rc);
+
+   cout << "Reading them with " << HOT << " in pool " << POOL << "\n";
+   if ((rc = pfm.SetPoolSize(POOL, POOL_PAGES)) ||
+         (rc = pfm.BindFile(HOT, POOL)) ||
+         (rc = ReadBoth(pfm, hot, cold)))
+      return (rc);
+   Expect("Pages of hot in the buffer", Resident(pfm, HOT), HOT_PAGES);
+   Expect("Pages of cold in the buffer", Resident(pfm, COLD),
+         PF_BUFFER_SIZE);
+
+   cout << "Changing the pool\n";
+   if ((rc = pfm.SetPoolPolicy(POOL, PF_REPLACE_ARC)) ||
+         (rc = pfm.SetPoolSize(POOL, POOL_PAGES / 2)))
+      return (rc);
+   Expect("Pages of hot in the buffer", Resident(pfm, HOT), POOL_PAGES / 2);
+   if ((rc = ReadPages(cold, COLD_PAGES)) ||
+         (rc = ReadPages(hot, HOT_PAGES)))
+      return (rc);
+   Expect("Pages of hot in the buffer", Resident(pfm, HOT), POOL_PAGES / 2);
+   if ((rc = CloseBoth(pfm, hot, cold)))
+      return (rc);
+   Expect("Pages of hot after clearing", Resident(pfm, HOT), 0);
+
+   cout << "Binding " << HOT << " back to the default pool\n";
+   if ((rc = pfm.BindFile(HOT, PF_DEFAULT_POOL)) ||
+         (rc = ReadBoth(pfm, hot, cold)))
+      return (rc);
+   Expect("Pages of hot in the buffer", Resident(pfm, HOT), 0);
+   if ((rc = CloseBoth(pfm, hot, cold)))
+      return (rc);
+
+   cout << "Errors\n";
+   Expect("Unknown pool", pfm.BindFile(HOT, "nosuch"), PF_NOPOOL);
+   Expect("Policy of unknown pool",
+         pfm.SetPoolPolicy("nosuch", PF_REPLACE_LRU), PF_NOPOOL);
+   Expect("Empty pool", pfm.SetPoolSize(POOL, 0), PF_TOOSMALL);
+   for (int i = 2; i < PF_MAX_POOLS; i++) {
+      sprintf(poolName, "pool%d", i);
+      if ((rc = pfm.SetPoolSize(poolName, POOL_PAGES)))
+         return (rc);
+   }
+   Expect("One pool too many", pfm.SetPoolSize("last", POOL_PAGES),
+         PF_TOOMANYPOOLS);
+
+   if ((rc = pfm.DestroyFile(HOT)))
+      return (rc);
+   return (pfm.DestroyFile(COLD));
+}
+
+int main()
+{
+   PF_Manager pfm;
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF buffer pool test.\n";
+   cout << "----------------------\n";
+
+   if ((rc = TestPools(pfm))) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF buffer pool test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
@@ -0,0 +1,266 @@
+//
+// File:        pf_test17.cc
+// Description: Test warming up the buffer from a saved manifest
+//
+// Two files of FILE_PAGES pages are read and closed, the second one
+// last, and the pages that were in the buffer are saved to a manifest.
+// A new PF_Manager (as on the next run) loads it: once the files are
+// opened and their warm-up is done, all of the pages of the second file
+// must come back, and as many of the
+// most recently read pages of the first as there is room for.  Reading
+// them then misses none.  A missing or damaged manifest (of an odd size,
+// or whose counts run past its end) must be refused and leave the buffer
+// cold.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include "pf.h"
+#include "pf_internal.h"
+#include "pf_testutil.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define FIRST        "first"
+#define SECOND       "second"
+#define MANIFEST     "warmup"
+#define FILE_PAGES   (3 * PF_BUFFER_SIZE / 4)   // pages of each file
+#define LEFT_PAGES   (PF_BUFFER_SIZE - FILE_PAGES)
+                                                // pages of FIRST that fit
+
+//
+// WriteFile
+//
+// Desc: Create a file of FILE_PAGES pages, page i starting with i
+//
+RC WriteFile(PF_Manager &pfm, const char *fileName)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+
+   unlink(fileName);
+   if ((rc = pfm.CreateFile(fileName)) ||
+         (rc = pfm.OpenFile(fileName, fh)))
+      return (rc);
+   for (int i = 0; i < FILE_PAGES; i++) {
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+      *(int *)pData = pageNum;
+      if ((rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+   return (pfm.CloseFile(fh));
+}
+
+//
+// ReadPages
+//
+// Desc: Get pages from first to last - 1, check their contents and unpin
+//       them
+//
+RC ReadPages(PF_FileHandle &fh, PageNum first, PageNum last)
+{
+   PF_PageHandle ph;
+   char *pData;
+   RC rc;
+
+   for (PageNum i = first; i < last; i++) {
+      if ((rc = fh.GetThisPage(i, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      if (*(int *)pData != i) {
+         cout << "Page " << i << " has the wrong contents!\n";
+         exit(1);
+      }
+      if ((rc = fh.UnpinPage(i)))
+         return (rc);
+   }
+   return (0);
+}
+
+//
+// Find
+//
+// Desc: The statistics of fileName
+//
+static PF_FileStats Find(PF_Manager &pfm, const char *fileName)
+{
+   PF_FileStats *pStats, stats;
+   int numFiles, i;
+
+   if (pfm.GetFileStats(pStats, numFiles)) {
+      cout << "Cannot get the statistics!\n";
+      exit(1);
+   }
+   for (i = 0; i < numFiles; i++)
+      if (strcmp(pStats[i].fileName, fileName) == 0)
+         break;
+   if (i == numFiles) {
+      cout << "No statistics for " << fileName << "!\n";
+      exit(1);
+   }
+   stats = pStats[i];
+   delete [] pStats;
+   return (stats);
+}
+
+//
+// FirstRun
+//
+// Desc: Read the files, FIRST before SECOND, and save the manifest
+//
+RC FirstRun()
+{
+   PF_Manager pfm;
+   PF_FileHandle fh;
+   RC rc;
+
+   if ((rc = WriteFile(pfm, FIRST)) ||
+         (rc = WriteFile(pfm, SECOND)) ||
+         (rc = pfm.ClearBuffer()))
+      return (rc);
+
+   cout << "Reading " << FIRST << " and " << SECOND << "\n";
+   if ((rc = pfm.OpenFile(FIRST, fh)) ||
+         (rc = ReadPages(fh, 0, FILE_PAGES)) ||
+         (rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.OpenFile(SECOND, fh)) ||
+         (rc = ReadPages(fh, 0, FILE_PAGES)) ||
+         (rc = pfm.CloseFile(fh)))
+      return (rc);
+   return (pfm.SaveWarmSet(MANIFEST));
+}
+
+//
+// NextRun
+//
+// Desc: Load the manifest into a new PF_Manager and open the files
+//
+RC NextRun()
+{
+   PF_Manager pfm;
+   PF_FileHandle first, second;
+   RC rc;
+
+   cout << "Loading the manifest\n";
+   if ((rc = pfm.LoadWarmSet(MANIFEST)) ||
+         (rc = pfm.OpenFile(FIRST, first)) ||
+         (rc = pfm.OpenFile(SECOND, second)) ||
+         (rc = pfm.WaitWarmUp(first)) ||
+         (rc = pfm.WaitWarmUp(second)))
+      return (rc);
+   Expect("Pages of second in the buffer",
+         Find(pfm, SECOND).residentPages, FILE_PAGES);
+   Expect("Pages of first in the buffer",
+         Find(pfm, FIRST).residentPages, LEFT_PAGES);
+
+   // The pages back are those read last; reading them misses none
+   pfm.ResetFileStats();
+   if ((rc = ReadPages(second, 0, FILE_PAGES)) ||
+         (rc = ReadPages(first, FILE_PAGES - LEFT_PAGES, FILE_PAGES)))
+      return (rc);
+   Expect("Misses of second", Find(pfm, SECOND).misses, 0);
+   Expect("Misses of first", Find(pfm, FIRST).misses, 0);
+
+   // They are not brought back again when the files are reopened
+   if ((rc = pfm.CloseFile(first)) ||
+         (rc = pfm.CloseFile(second)) ||
+         (rc = pfm.OpenFile(FIRST, first)))
+      return (rc);
+   if ((rc = pfm.WaitWarmUp(first)))
+      return (rc);
+   Expect("Pages of first reopened", Find(pfm, FIRST).residentPages, 0);
+   return (pfm.CloseFile(first));
+}
+
+//
+// WriteManifest
+//
+// Desc: Write numBytes bytes of junk as the manifest
+//
+static void WriteManifest(const void *pData, int numBytes)
+{
+   int fd;
+
+   unlink(MANIFEST);
+   if ((fd = open(MANIFEST, O_CREAT | O_WRONLY, 0600)) < 0 ||
+         write(fd, pData, numBytes) != numBytes ||
+         close(fd) < 0) {
+      cout << "Cannot write " << MANIFEST << "!\n";
+      exit(1);
+   }
+}
+
+//
+// BadManifests
+//
+// Desc: Load a missing and damaged manifests
+//
+RC BadManifests()
+{
+   PF_Manager pfm;
+   PF_FileHandle fh;
+   int junk[3] = { 1, 2, 3 };
+   char name[sizeof(int)] = { 'a', 'b', 'c', 'd' };
+   int huge[5] = { PF_WARM_MAGIC, 1, sizeof(name), 0, 0x7fffffff };
+   RC rc;
+
+   cout << "Missing and damaged manifests\n";
+   unlink(MANIFEST);
+   Expect("Missing manifest", pfm.LoadWarmSet(MANIFEST), PF_UNIX);
+   WriteManifest(junk, sizeof(junk));
+   Expect("Damaged manifest", pfm.LoadWarmSet(MANIFEST), PF_HDRREAD);
+   WriteManifest(junk, 2 * sizeof(int) + 1);
+   Expect("Manifest of an odd size", pfm.LoadWarmSet(MANIFEST),
+         PF_HDRREAD);
+   memcpy(&huge[3], name, sizeof(name));
+   WriteManifest(huge, sizeof(huge));
+   Expect("Manifest with too many pages", pfm.LoadWarmSet(MANIFEST),
+         PF_HDRREAD);
+   if ((rc = pfm.OpenFile(SECOND, fh)))
+      return (rc);
+   Expect("Pages of second in the buffer",
+         Find(pfm, SECOND).residentPages, 0);
+   if ((rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.DestroyFile(FIRST)) ||
+         (rc = pfm.DestroyFile(SECOND)))
+      return (rc);
+   unlink(MANIFEST);
+   return (0);
+}
+
+int main()
+{
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF buffer warm-up test.\n";
+   cout << "----------------------\n";
+
+   if ((rc = FirstRun()) ||
+         (rc = NextRun()) ||
+         (rc = BadManifests())) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF buffer warm-up test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
@@ -0,0 +1,282 @@
+//
+// File:        pf_test18.cc
+// Description: Test the miss-ratio curve and the tuning of the pool size
+//
+// The pages of a working set are read round and round (in an order that
+// does not look like a scan).  A working set that fits in the buffer
+// must have all of its rereads predicted as hits from its size up, and
+// none below; one larger than the buffer misses every time, but the
+// pages thrown out must predict hits at the size of the working set.
+// Tuning the default pool must then grow it to hold a large working set,
+// shrink it for a small one, and keep it within the pages it may have.
+// While a page of another file is latched, the resize must wait for the
+// next time a file is closed.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include "pf.h"
+#include "pf_internal.h"
+#include "pf_testutil.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define FILE1        "file1"
+#define FILE2        "file2"
+#define NUM_PAGES    (3 * PF_BUFFER_SIZE / 2)   // pages of the file
+#define SMALL_SET    (3 * PF_BUFFER_SIZE / 4)   // working set that fits
+#define TINY_SET     (PF_BUFFER_SIZE / 4)       // working set for shrinking
+#define STRIDE       7                          // prime to the sets
+#define BUDGET       (4 * PF_BUFFER_SIZE)       // most pages tuning gives
+
+//
+// Hits, Requests, PoolSize
+//
+// Desc: Points of the curve of the default pool, its size
+//
+static int Hits(PF_Manager &pfm, int numPages)
+{
+   int hits, numRequests;
+
+   if (pfm.GetCurve(PF_DEFAULT_POOL, numPages, hits, numRequests)) {
+      cout << "Cannot get the curve!\n";
+      exit(1);
+   }
+   return (hits);
+}
+
+static int Requests(PF_Manager &pfm)
+{
+   int hits, numRequests;
+
+   if (pfm.GetCurve(PF_DEFAULT_POOL, 1, hits, numRequests)) {
+      cout << "Cannot get the curve!\n";
+      exit(1);
+   }
+   return (numRequests);
+}
+
+static int PoolSize(PF_Manager &pfm)
+{
+   int numPages;
+
+   if (pfm.GetPoolSize(PF_DEFAULT_POOL, numPages)) {
+      cout << "Cannot get the pool size!\n";
+      exit(1);
+   }
+   return (numPages);
+}
+
+//
+// WriteFile
+//
+// Desc: Create FILE1, of NUM_PAGES pages
+//
+RC WriteFile(PF_Manager &pfm)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   PageNum pageNum;
+   RC rc;
+
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1)) ||
+         (rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+   for (int i = 0; i < NUM_PAGES; i++)
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetPageNum(pageNum)) ||
+            (rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   return (pfm.CloseFile(fh));
+}
+
+//
+// ReadRounds
+//
+// Desc: Open FILE1, read the pages 0 to setSize - 1 numRounds times,
+//       each time in the same order, and close it
+//
+RC ReadRounds(PF_Manager &pfm, int setSize, int numRounds)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   RC rc;
+
+   if ((rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+   for (int round = 0; round < numRounds; round++)
+      for (int i = 0; i < setSize; i++) {
+         PageNum pageNum = (i * STRIDE) % setSize;
+         if ((rc = fh.GetThisPage(pageNum, ph)) ||
+               (rc = fh.UnpinPage(pageNum)))
+            return (rc);
+      }
+   return (pfm.CloseFile(fh));
+}
+
+//
+// TestCurve
+//
+// Desc: The curve of a working set that fits and of one that does not
+//
+RC TestCurve()
+{
+   RC rc;
+
+   cout << "Reading " << SMALL_SET << " pages 5 times\n";
+   {
+      PF_Manager pfm;
+
+      if ((rc = WriteFile(pfm)) ||
+            (rc = pfm.ClearBuffer()))
+         return (rc);
+      Expect("Pages asked for without the curve kept", Requests(pfm), 0);
+   }
+   {
+      PF_Manager pfm;
+
+      if ((rc = pfm.SetCurve(PF_DEFAULT_POOL, TRUE)) ||
+            (rc = ReadRounds(pfm, SMALL_SET, 5)))
+         return (rc);
+      Expect("Pages asked for", Requests(pfm), 5 * SMALL_SET);
+      Expect("Hits with the buffer", Hits(pfm, PF_BUFFER_SIZE),
+            4 * SMALL_SET);
+      Expect("Hits with the working set", Hits(pfm, SMALL_SET),
+            4 * SMALL_SET);
+      Expect("Hits with a page less", Hits(pfm, SMALL_SET - 1), 0);
+      if ((rc = pfm.PrintCurve()))
+         return (rc);
+   }
+
+   cout << "Reading " << NUM_PAGES << " pages 4 times\n";
+   {
+      PF_Manager pfm;
+
+      if ((rc = pfm.SetCurve(PF_DEFAULT_POOL, TRUE)) ||
+            (rc = ReadRounds(pfm, NUM_PAGES, 4)))
+         return (rc);
+      Expect("Pages asked for", Requests(pfm), 4 * NUM_PAGES);
+      Expect("Hits with the buffer", Hits(pfm, PF_BUFFER_SIZE), 0);
+      Expect("Hits with the working set", Hits(pfm, NUM_PAGES),
+            3 * NUM_PAGES);
+      Expect("Hits with a page less", Hits(pfm, NUM_PAGES - 1), 0);
+      if ((rc = pfm.PrintCurve()))
+         return (rc);
+   }
+   return (0);
+}
+
+//
+// TestTuning
+//
+// Desc: Let the default pool follow its curve
+//
+RC TestTuning()
+{
+   PF_Manager pfm;
+   int rounds;
+   RC rc;
+
+   Expect("Tuning an unknown pool", pfm.SetAutoTune("nosuch", BUDGET),
+         PF_NOPOOL);
+   Expect("Tuning to a negative size",
+         pfm.SetAutoTune(PF_DEFAULT_POOL, -1), PF_TOOSMALL);
+
+   cout << "Tuning with " << NUM_PAGES << " pages read over and over\n";
+   rounds = PF_TUNE_REQUESTS / NUM_PAGES + 1;
+   if ((rc = pfm.SetAutoTune(PF_DEFAULT_POOL, BUDGET)) ||
+         (rc = ReadRounds(pfm, NUM_PAGES, rounds)))
+      return (rc);
+   int size = PoolSize(pfm);
+   cout << "  Pool size: " << size << "\n";
+   if (size < NUM_PAGES || size > NUM_PAGES + PF_BUFFER_SIZE / 8) {
+      cout << "Expected about " << NUM_PAGES << "!\n";
+      exit(1);
+   }
+   Expect("Pages asked for after the resize", Requests(pfm), 0);
+
+   cout << "Tuning with " << TINY_SET << " pages read over and over\n";
+   rounds = PF_TUNE_REQUESTS / TINY_SET + 1;
+   if ((rc = ReadRounds(pfm, TINY_SET, rounds)))
+      return (rc);
+   size = PoolSize(pfm);
+   cout << "  Pool size: " << size << "\n";
+   if (size < TINY_SET || size >= NUM_PAGES / 2) {
+      cout << "Expected about " << TINY_SET << "!\n";
+      exit(1);
+   }
+
+   // A latched page puts the resize off until FILE2 is closed
+   cout << "Tuning with " << SMALL_SET << " pages read, a page latched\n";
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   PageNum pageNum;
+   unlink(FILE2);
+   rounds = PF_TUNE_REQUESTS / SMALL_SET + 1;
+   if ((rc = pfm.CreateFile(FILE2)) ||
+         (rc = pfm.OpenFile(FILE2, fh)) ||
+         (rc = fh.AllocatePage(ph)) ||
+         (rc = ph.GetPageNum(pageNum)) ||
+         (rc = fh.LatchPage(pageNum)) ||
+         (rc = ReadRounds(pfm, SMALL_SET, rounds)))
+      return (rc);
+   Expect("Pool size with a page latched", PoolSize(pfm), size);
+   if ((rc = fh.UnlatchPage(pageNum)) ||
+         (rc = fh.UnpinPage(pageNum)) ||
+         (rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.DestroyFile(FILE2)))
+      return (rc);
+   size = PoolSize(pfm);
+   cout << "  Pool size: " << size << "\n";
+   if (size < SMALL_SET || size >= NUM_PAGES) {
+      cout << "Expected about " << SMALL_SET << "!\n";
+      exit(1);
+   }
+
+   // With no room for the working set, no size does better than the
+   // smallest
+   cout << "Tuning within " << SMALL_SET / 2 << " pages\n";
+   rounds = PF_TUNE_REQUESTS / NUM_PAGES + 1;
+   if ((rc = pfm.SetAutoTune(PF_DEFAULT_POOL, SMALL_SET / 2)) ||
+         (rc = ReadRounds(pfm, NUM_PAGES, rounds)))
+      return (rc);
+   Expect("Pool size", PoolSize(pfm), PF_TUNE_MIN_PAGES);
+
+   // Not tuned any more
+   if ((rc = pfm.SetAutoTune(PF_DEFAULT_POOL, 0)) ||
+         (rc = ReadRounds(pfm, TINY_SET, rounds)))
+      return (rc);
+   Expect("Pool size untuned", PoolSize(pfm), PF_TUNE_MIN_PAGES);
+
+   return (pfm.DestroyFile(FILE1));
+}
+
+int main()
+{
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF miss-ratio curve test.\n";
+   cout << "----------------------\n";
+
+   if ((rc = TestCurve()) ||
+         (rc = TestTuning())) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF miss-ratio curve test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
@@ -0,0 +1,351 @@
+//
+// File:        pf_test19.cc
+// Description: Test the write-ahead log
+//
+// A child process changes a logged file (through LogPage, and through
+// MarkDirty alone, which has the page logged whole once it is unpinned
+// or committed), commits and dies
+// without closing anything: no page of it reaches the disk.  Opening the
+// log again must bring all of the committed changes back.  A file that
+// was destroyed and created again must not get the records of the old
+// one.  Then threads that commit each change at once must share the
+// writes of the log, and closing the log must leave it empty.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "pf.h"
+#include "pf_internal.h"
+#include "pf_testutil.h"
+#include "pf_logmgr.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define FILE1        "file1"
+#define FILE2        "file2"
+#define LOGFILE      "pflog"
+#define NUM_PAGES    (PF_BUFFER_SIZE / 2)   // pages of FILE1: they all stay
+                                            //   in the buffer
+#define NUM_THREADS  8
+#define NUM_COMMITS  200                    // commits of each thread
+
+//
+// Fill
+//
+// Desc: The data of page pageNum: its number over and over, and the
+//       version at the start
+//
+static void Fill(char *pData, PageNum pageNum, int version)
+{
+   for (int i = 0; i < PF_PAGE_SIZE / (int)sizeof(int); i++)
+      ((int *)pData)[i] = pageNum;
+   ((int *)pData)[0] = version;
+}
+
+//
+// Crash
+//
+// Desc: In a child process: create FILE1 and FILE2 with the log open,
+//       change them, commit and exit without closing them
+//
+static void Crash()
+{
+   PF_Manager pfm;
+   PF_FileHandle fh1, fh2;
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+
+   if ((rc = pfm.OpenLog(LOGFILE)) ||
+         (rc = pfm.CreateFile(FILE1)) ||
+         (rc = pfm.OpenFile(FILE1, fh1)))
+      goto err;
+
+   // Odd pages are logged as the bytes that changed, even ones whole
+   for (int i = 0; i < NUM_PAGES; i++) {
+      if ((rc = fh1.AllocatePage(ph)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         goto err;
+      Fill(pData, pageNum, 1);
+      if ((rc = (pageNum % 2) ? fh1.LogPage(pageNum, 0, PF_PAGE_SIZE) :
+            fh1.MarkDirty(pageNum)) ||
+            (rc = fh1.UnpinPage(pageNum)))
+         goto err;
+   }
+
+   // Then the version of the first page is changed again
+   if ((rc = fh1.GetThisPage(0, ph)) ||
+         (rc = ph.GetData(pData)))
+      goto err;
+   ((int *)pData)[0] = 2;
+   if ((rc = fh1.LogPage(0, 0, sizeof(int))) ||
+         (rc = fh1.UnpinPage(0)))
+      goto err;
+
+   // And that of page 2, which is still pinned at the commit: it is
+   // logged whole then, not when one of its two pins is released
+   int numRecords, numRecords2, numWrites;
+   if ((rc = pfm.GetLogStats(numRecords, numWrites)) ||
+         (rc = fh1.GetThisPage(2, ph)) ||
+         (rc = fh1.GetThisPage(2, ph)) ||
+         (rc = ph.GetData(pData)))
+      goto err;
+   ((int *)pData)[0] = 2;
+   if ((rc = fh1.MarkDirty(2)) ||
+         (rc = fh1.UnpinPage(2)) ||
+         (rc = pfm.GetLogStats(numRecords2, numWrites)))
+      goto err;
+   if (numRecords2 != numRecords) {
+      cout << "Page logged before its last pin was released!\n";
+      _exit(1);
+   }
+
+   // FILE2 is changed, destroyed and created again, empty
+   if ((rc = pfm.CreateFile(FILE2)) ||
+         (rc = pfm.OpenFile(FILE2, fh2)) ||
+         (rc = fh2.AllocatePage(ph)) ||
+         (rc = ph.GetPageNum(pageNum)) ||
+         (rc = fh2.MarkDirty(pageNum)) ||
+         (rc = fh2.UnpinPage(pageNum)) ||
+         (rc = pfm.CloseFile(fh2)) ||
+         (rc = pfm.DestroyFile(FILE2)) ||
+         (rc = pfm.CreateFile(FILE2)))
+      goto err;
+
+   if ((rc = pfm.Commit()))
+      goto err;
+   _exit(0);
+
+err:
+   PF_PrintError(rc);
+   _exit(1);
+}
+
+//
+// TestRecovery
+//
+// Desc: Crash with changes in the buffer only, and recover them
+//
+RC TestRecovery()
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   pid_t pid;
+   int status;
+   RC rc;
+
+   cout << "Crashing with " << NUM_PAGES << " pages in the buffer\n";
+   unlink(FILE1);
+   unlink(FILE2);
+   unlink(LOGFILE);
+   if ((pid = fork()) == 0)
+      Crash();
+   if (pid < 0 || waitpid(pid, &status, 0) != pid ||
+         !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      cout << "The child did not get to commit!\n";
+      exit(1);
+   }
+
+   PF_Manager pfm;
+
+   // Nothing was written but the log
+   if ((rc = pfm.OpenFile(FILE1, fh)) ||
+         (rc = fh.GetFirstPage(ph)) != PF_EOF)
+      return (rc ? rc : PF_EOF);
+   if ((rc = pfm.CloseFile(fh)))
+      return (rc);
+
+   // Recover
+   if ((rc = pfm.OpenLog(LOGFILE)) ||
+         (rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+   Expect("Opening the log again", pfm.OpenLog(LOGFILE), PF_FILEOPEN);
+
+   int numGood = 0;
+   for (PageNum pageNum = 0; pageNum < NUM_PAGES; pageNum++) {
+      char expected[PF_PAGE_SIZE];
+      if ((rc = fh.GetThisPage(pageNum, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      Fill(expected, pageNum, (pageNum == 0 || pageNum == 2) ? 2 : 1);
+      if (memcmp(pData, expected, PF_PAGE_SIZE) == 0)
+         numGood++;
+      if ((rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+   Expect("Pages recovered", numGood, NUM_PAGES);
+   Expect("Page past the end", fh.GetThisPage(NUM_PAGES, ph),
+         PF_INVALIDPAGE);
+   Expect("Logging past the page", fh.LogPage(0, 1, PF_PAGE_SIZE),
+         PF_BADRANGE);
+   if ((rc = pfm.CloseFile(fh)))
+      return (rc);
+
+   // The records of the first FILE2 were not applied to the second
+   if ((rc = pfm.OpenFile(FILE2, fh)))
+      return (rc);
+   Expect("Pages of the new file", fh.GetFirstPage(ph), PF_EOF);
+   if ((rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.DestroyFile(FILE2)))
+      return (rc);
+
+   return (pfm.CloseLog());
+}
+
+//
+// Committer
+//
+// Desc: A thread that changes its own page of FILE1 and commits each
+//       change
+//
+struct Committer {
+   PF_Manager    *pPfm;
+   PF_FileHandle *pFileHandle;
+   PageNum       pageNum;
+   RC            rc;
+};
+
+static void *Commit(void *pArg)
+{
+   Committer *pCommitter = (Committer *)pArg;
+   PF_FileHandle &fh = *pCommitter->pFileHandle;
+   PageNum pageNum = pCommitter->pageNum;
+   PF_PageHandle ph;
+   char *pData;
+   RC rc = 0;
+
+   for (int i = 0; i < NUM_COMMITS && !rc; i++) {
+      if ((rc = fh.GetThisPage(pageNum, ph)) ||
+            (rc = ph.GetData(pData)))
+         break;
+      ((int *)pData)[0] = 100 + i;
+      if ((rc = fh.LogPage(pageNum, 0, sizeof(int))) ||
+            (rc = fh.UnpinPage(pageNum)))
+         break;
+      rc = pCommitter->pPfm->Commit();
+   }
+   pCommitter->rc = rc;
+   return (NULL);
+}
+
+//
+// TestGroupCommit
+//
+// Desc: Commit from NUM_THREADS threads at once
+//
+RC TestGroupCommit()
+{
+   PF_Manager pfm;
+   PF_FileHandle fh;
+   pthread_t threads[NUM_THREADS];
+   Committer committers[NUM_THREADS];
+   int numRecords, numWrites;
+   struct stat st;
+   RC rc;
+   int i;
+
+   cout << "Committing from " << NUM_THREADS << " threads\n";
+   Expect("Committing without a log", pfm.Commit(), PF_NOLOG);
+   Expect("Closing no log", pfm.CloseLog(), PF_NOLOG);
+   if ((rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+   Expect("Opening a log with a file open", pfm.OpenLog(LOGFILE),
+         PF_FILEOPEN);
+   if ((rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.OpenLog(LOGFILE)) ||
+         (rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+
+   for (i = 0; i < NUM_THREADS; i++) {
+      committers[i].pPfm = &pfm;
+      committers[i].pFileHandle = &fh;
+      committers[i].pageNum = i;
+      committers[i].rc = 0;
+      if (pthread_create(&threads[i], NULL, Commit, &committers[i])) {
+         cout << "Cannot start a thread!\n";
+         exit(1);
+      }
+   }
+   for (i = 0; i < NUM_THREADS; i++)
+      pthread_join(threads[i], NULL);
+   for (i = 0; i < NUM_THREADS; i++)
+      if (committers[i].rc)
+         return (committers[i].rc);
+
+   if ((rc = pfm.GetLogStats(numRecords, numWrites)))
+      return (rc);
+   cout << "  " << NUM_THREADS * NUM_COMMITS << " commits, "
+      << numRecords << " records, " << numWrites << " writes of the log\n";
+   if (numRecords < NUM_THREADS * NUM_COMMITS ||
+         numWrites > NUM_THREADS * NUM_COMMITS) {
+      cout << "Expected a record, and at most a write, per commit!\n";
+      exit(1);
+   }
+
+   Expect("Closing the log with a file open", pfm.CloseLog(), PF_FILEOPEN);
+   if ((rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.CloseLog()))
+      return (rc);
+   if (stat(LOGFILE, &st) < 0)
+      return (PF_UNIX);
+   Expect("Bytes left in the log", (int)st.st_size,
+         (int)sizeof(PF_LogHdr));
+
+   // The last versions are there without the log
+   PF_PageHandle ph;
+   char *pData;
+   int numGood = 0;
+   if ((rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+   for (i = 0; i < NUM_THREADS; i++) {
+      if ((rc = fh.GetThisPage(i, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      if (((int *)pData)[0] == 100 + NUM_COMMITS - 1)
+         numGood++;
+      if ((rc = fh.UnpinPage(i)))
+         return (rc);
+   }
+   Expect("Pages with their last version", numGood, NUM_THREADS);
+   if ((rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.DestroyFile(FILE1)))
+      return (rc);
+   unlink(LOGFILE);
+
+   return (0);
+}
+
+int main()
+{
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF write-ahead log test.\n";
+   cout << "----------------------\n";
+
+   if ((rc = TestRecovery()) ||
+         (rc = TestGroupCommit())) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF write-ahead log test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
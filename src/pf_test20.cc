@@ -0,0 +1,383 @@
+//
+// File:        pf_test20.cc
+// Description: Test checkpoints of the write-ahead log
+//
+// A child process changes logged files, takes two checkpoints in
+// between, commits and dies.  The second checkpoint must have written
+// the pages changed before the first one began, and restart must only
+// need the log from the oldest change to a page still dirty: the bytes
+// of the log before it are overwritten before the files are recovered.
+// The pages changed after the checkpoints (and one allocated between
+// them) must all be recovered.  Then enough is committed for a
+// checkpoint to be taken without being asked for.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include "pf.h"
+#include "pf_internal.h"
+#include "pf_testutil.h"
+#include "pf_logmgr.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define LOGFILE      "pflog"
+#define NUM_FILES    3                      // files changed at once
+#define NUM_PAGES    (PF_BUFFER_SIZE / 4)   // pages of each: they all stay
+                                            //   in the buffer
+
+static const char *fileNames[NUM_FILES] = { "file1", "file2", "file3" };
+
+//
+// Fill
+//
+// Desc: The data of page pageNum: its number over and over, and the
+//       version at the start
+//
+static void Fill(char *pData, PageNum pageNum, int version)
+{
+   for (int i = 0; i < PF_PAGE_SIZE / (int)sizeof(int); i++)
+      ((int *)pData)[i] = pageNum;
+   ((int *)pData)[0] = version;
+}
+
+//
+// Version
+//
+// Desc: Version page pageNum has after the crash: the first page was
+//       changed between the checkpoints, the second after them, and the
+//       last one allocated between them
+//
+static int Version(PageNum pageNum)
+{
+   return (pageNum == 0 ? 2 : (pageNum == 1 ? 3 :
+         (pageNum == NUM_PAGES ? 2 : 1)));
+}
+
+//
+// SetVersion
+//
+// Desc: Log the new version of a page of fh
+//
+static RC SetVersion(PF_FileHandle &fh, PageNum pageNum, int version)
+{
+   PF_PageHandle ph;
+   char *pData;
+   RC rc;
+
+   if ((rc = fh.GetThisPage(pageNum, ph)) ||
+         (rc = ph.GetData(pData)))
+      return (rc);
+   ((int *)pData)[0] = version;
+   if ((rc = fh.LogPage(pageNum, 0, sizeof(int))))
+      return (rc);
+   return (fh.UnpinPage(pageNum));
+}
+
+//
+// Crash
+//
+// Desc: In a child process: create the files with the log open, change
+//       them around two checkpoints, commit and exit without closing them
+//
+static void Crash()
+{
+   PF_Manager pfm;
+   PF_FileHandle fhs[NUM_FILES];
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   int f;
+   RC rc;
+
+   if ((rc = pfm.OpenLog(LOGFILE)))
+      goto err;
+   for (f = 0; f < NUM_FILES; f++) {
+      if ((rc = pfm.CreateFile(fileNames[f])) ||
+            (rc = pfm.OpenFile(fileNames[f], fhs[f])))
+         goto err;
+      for (int i = 0; i < NUM_PAGES; i++) {
+         if ((rc = fhs[f].AllocatePage(ph)) ||
+               (rc = ph.GetData(pData)) ||
+               (rc = ph.GetPageNum(pageNum)))
+            goto err;
+         Fill(pData, pageNum, 1);
+         if ((rc = fhs[f].LogPage(pageNum, 0, PF_PAGE_SIZE)) ||
+               (rc = fhs[f].UnpinPage(pageNum)))
+            goto err;
+      }
+   }
+   if ((rc = pfm.Checkpoint()))
+      goto err;
+
+   // Between the checkpoints: the first page changes, and a page is
+   // added, which stays dirty through the second one
+   for (f = 0; f < NUM_FILES; f++) {
+      if ((rc = SetVersion(fhs[f], 0, 2)) ||
+            (rc = fhs[f].AllocatePage(ph)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         goto err;
+      Fill(pData, pageNum, 2);
+      if ((rc = fhs[f].LogPage(pageNum, 0, PF_PAGE_SIZE)) ||
+            (rc = fhs[f].UnpinPage(pageNum)))
+         goto err;
+   }
+   if ((rc = pfm.Checkpoint()))
+      goto err;
+
+   // After them, the second page
+   for (f = 0; f < NUM_FILES; f++)
+      if ((rc = SetVersion(fhs[f], 1, 3)))
+         goto err;
+
+   if ((rc = pfm.Commit()))
+      goto err;
+   _exit(0);
+
+err:
+   PF_PrintError(rc);
+   _exit(1);
+}
+
+//
+// CountPages
+//
+// Desc: # of pages of the files that are on the disk as the first
+//       checkpoint found them.  Their headers are only in the log, so the
+//       pages are read from the files themselves.
+//
+static int CountPages()
+{
+   const int frameSize = PF_PAGE_SIZE + sizeof(PF_PageHdr);
+   char frame[PF_PAGE_SIZE + sizeof(PF_PageHdr)];
+   char expected[PF_PAGE_SIZE];
+   int numGood = 0, fd;
+
+   for (int f = 0; f < NUM_FILES; f++) {
+      if ((fd = open(fileNames[f], O_RDONLY)) < 0)
+         return (-1);
+      for (PageNum pageNum = 0; pageNum < NUM_PAGES; pageNum++) {
+         if (pread(fd, frame, frameSize, PF_FILE_HDR_SIZE +
+               pageNum * (off_t)frameSize) != frameSize)
+            continue;
+         Fill(expected, pageNum, pageNum == 0 ? 2 : 1);
+         if (memcmp(frame + sizeof(PF_PageHdr), expected,
+               PF_PAGE_SIZE) == 0)
+            numGood++;
+      }
+      close(fd);
+   }
+   return (numGood);
+}
+
+//
+// ClobberLog
+//
+// Desc: Overwrite the records of the log before the oldest change to a
+//       page that was dirty at the last checkpoint, which restart must
+//       not need.  The dirty page table must fit in the last record of
+//       the checkpoint.
+// Out:  redoLSN - where the records needed start
+//       endLSN - size of the log
+// Ret:  PF_UNIX
+//
+static RC ClobberLog(PF_LSN &redoLSN, PF_LSN &endLSN)
+{
+   PF_LogHdr hdr;
+   char *pRec = new char[PF_LOG_MAX_REC];
+   int fd;
+   RC rc = PF_UNIX;
+
+   if ((fd = open(LOGFILE, O_RDWR)) < 0) {
+      delete [] pRec;
+      return (PF_UNIX);
+   }
+   if (pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+         hdr.ckptLSN == 0 ||
+         pread(fd, pRec, PF_LOG_MAX_REC, hdr.ckptLSN) <
+         (ssize_t)(sizeof(PF_LogRec) + sizeof(PF_CkptData)) ||
+         ((PF_LogRec *)pRec)->type != PF_LOGREC_CKPT ||
+         !((PF_LogRec *)pRec)->offset)
+      goto done;
+
+   {
+      PF_LogRec *pLogRec = (PF_LogRec *)pRec;
+      PF_CkptData *pCkpt = (PF_CkptData *)(pLogRec + 1);
+      PF_DirtyPage *pPages = (PF_DirtyPage *)(pCkpt + 1);
+
+      redoLSN = pCkpt->beginLSN;
+      for (int i = 0; i < pLogRec->pageNum; i++)
+         if (pPages[i].recLSN < redoLSN)
+            redoLSN = pPages[i].recLSN;
+      endLSN = lseek(fd, 0, SEEK_END);
+
+      char garbage[PF_PAGE_SIZE];
+      memset(garbage, 0x5a, sizeof(garbage));
+      for (PF_LSN lsn = sizeof(PF_LogHdr); lsn < redoLSN;
+            lsn += sizeof(garbage)) {
+         int numBytes = (redoLSN - lsn < (PF_LSN)sizeof(garbage)) ?
+            (int)(redoLSN - lsn) : (int)sizeof(garbage);
+         if (pwrite(fd, garbage, numBytes, lsn) != numBytes)
+            goto done;
+      }
+   }
+   rc = 0;
+
+done:
+   close(fd);
+   delete [] pRec;
+   return (rc);
+}
+
+//
+// TestRestart
+//
+// Desc: Crash after two checkpoints, and recover from the last one
+//
+RC TestRestart()
+{
+   PF_Manager pfm;
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   PF_LSN redoLSN = 0, endLSN = 0;
+   char *pData;
+   pid_t pid;
+   int status, numGood, f;
+   RC rc;
+
+   cout << "Crashing with " << NUM_FILES << " files after 2 checkpoints\n";
+   for (f = 0; f < NUM_FILES; f++)
+      unlink(fileNames[f]);
+   unlink(LOGFILE);
+   if ((pid = fork()) == 0)
+      Crash();
+   if (pid < 0 || waitpid(pid, &status, 0) != pid ||
+         !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      cout << "The child did not get to commit!\n";
+      exit(1);
+   }
+
+   // The pages changed before the first checkpoint began were written
+   Expect("Pages written by the checkpoints", CountPages(),
+         NUM_FILES * NUM_PAGES);
+
+   if ((rc = ClobberLog(redoLSN, endLSN)))
+      return (rc);
+   cout << "  Log needed from byte " << (long)redoLSN << " of "
+      << (long)endLSN << "\n";
+   if (redoLSN < endLSN / 2) {
+      cout << "Expected most of the log not to be needed!\n";
+      exit(1);
+   }
+
+   // Recover
+   if ((rc = pfm.OpenLog(LOGFILE)))
+      return (rc);
+   numGood = 0;
+   for (f = 0; f < NUM_FILES; f++) {
+      if ((rc = pfm.OpenFile(fileNames[f], fh)))
+         return (rc);
+      for (PageNum pageNum = 0; pageNum <= NUM_PAGES; pageNum++) {
+         char expected[PF_PAGE_SIZE];
+         if ((rc = fh.GetThisPage(pageNum, ph)) ||
+               (rc = ph.GetData(pData)))
+            return (rc);
+         Fill(expected, pageNum, Version(pageNum));
+         if (memcmp(pData, expected, PF_PAGE_SIZE) == 0)
+            numGood++;
+         if ((rc = fh.UnpinPage(pageNum)))
+            return (rc);
+      }
+      Expect("Page past the end", fh.GetThisPage(NUM_PAGES + 1, ph),
+            PF_INVALIDPAGE);
+      if ((rc = pfm.CloseFile(fh)))
+         return (rc);
+   }
+   Expect("Pages recovered", numGood, NUM_FILES * (NUM_PAGES + 1));
+
+   return (pfm.CloseLog());
+}
+
+//
+// TestAutoCheckpoint
+//
+// Desc: Commit changes until more than PF_CKPT_BYTES were logged
+//
+RC TestAutoCheckpoint()
+{
+   PF_Manager pfm;
+   PF_FileHandle fh;
+   PF_LogHdr hdr;
+   int numCommits = PF_CKPT_BYTES / PF_PAGE_SIZE + 1;
+   int fd;
+   RC rc;
+
+   cout << "Committing " << numCommits << " pages\n";
+   Expect("Checkpoint without a log", pfm.Checkpoint(), PF_NOLOG);
+   if ((rc = pfm.OpenLog(LOGFILE)) ||
+         (rc = pfm.OpenFile(fileNames[0], fh)))
+      return (rc);
+   for (int i = 0; i < numCommits; i++) {
+      PageNum pageNum = i % NUM_PAGES;
+      PF_PageHandle ph;
+      char *pData;
+      if ((rc = fh.GetThisPage(pageNum, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      Fill(pData, pageNum, 10 + i);
+      if ((rc = fh.LogPage(pageNum, 0, PF_PAGE_SIZE)) ||
+            (rc = fh.UnpinPage(pageNum)) ||
+            (rc = pfm.Commit()))
+         return (rc);
+   }
+
+   if ((fd = open(LOGFILE, O_RDONLY)) < 0)
+      return (PF_UNIX);
+   if (pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr)) {
+      close(fd);
+      return (PF_UNIX);
+   }
+   close(fd);
+   Expect("Checkpoint taken", hdr.ckptLSN > 0, TRUE);
+
+   if ((rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.CloseLog()))
+      return (rc);
+   for (int f = 0; f < NUM_FILES; f++)
+      if ((rc = pfm.DestroyFile(fileNames[f])))
+         return (rc);
+   unlink(LOGFILE);
+
+   return (0);
+}
+
+int main()
+{
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF checkpoint test.\n";
+   cout << "----------------------\n";
+
+   if ((rc = TestRestart()) ||
+         (rc = TestAutoCheckpoint())) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF checkpoint test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
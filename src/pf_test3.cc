@@ -185,6 +185,50 @@ RC TestChunk()
    }
    cout << "Pass\n";
 
+   // Grow the buffer while these 25 chunks (and 5 of the first ten) are
+   // pinned.  They must stay where they are, and the new buffer pages
+   // must be usable.
+   cout << "Resizing the buffer to " << 2 * PF_BUFFER_SIZE << " pages: ";
+   if ((rc = pfm.ResizeBuffer(2 * PF_BUFFER_SIZE))) {
+      cout << "FAILED!\a\a\n";
+      return rc;
+   }
+   cout << "Pass\n";
+
+   if ((rc = VerifyChunks(25, (ptr2+10)))) {
+      cout << "FAILED!\a\a\n";
+      return rc;
+   }
+   cout << "Pass\n";
+
+   char *ptr4[2 * PF_BUFFER_SIZE - 30];
+   if ((rc = AllocateChunk(pfm, 2 * PF_BUFFER_SIZE - 30, ptr4))) {
+      cout << "FAILED!\a\a\n";
+      return rc;
+   }
+   cout << "Pass\n";
+
+   // Chunks allocated before the resize can still be disposed of
+   if ((rc = DisposeChunk(pfm, 25, (ptr2+10)))) {
+      cout << "FAILED!\a\a\n";
+      return rc;
+   }
+   cout << "Pass\n";
+
+   // Shrinking cannot drop pinned chunks
+   cout << "Resizing the buffer to " << PF_BUFFER_SIZE << " pages: ";
+   if ((rc = pfm.ResizeBuffer(PF_BUFFER_SIZE)) != PF_TOOSMALL) {
+      cout << "FAILED!\a\a\n";
+      return (rc ? rc : PF_TOOSMALL);
+   }
+   cout << "Pass\n";
+
+   if ((rc = VerifyChunks(2 * PF_BUFFER_SIZE - 30, ptr4))) {
+      cout << "FAILED!\a\a\n";
+      return rc;
+   }
+   cout << "Pass\n";
+
    // Finally, leave the chunks that are there lying around.  They will
    // be cleaned up by the PF Manager instance and no purify warnings
    // should result.
@@ -0,0 +1,285 @@
+//
+// File:        pf_test4.cc
+// Description: Test the page replacement policies of the PF component
+//
+// Every policy is run through the same workload: a file larger than the
+// buffer pool is written and read back, all buffer pages are pinned to
+// check that a policy never hands out a pinned page, and (with PF_STATS)
+// a small hot set is referenced around long sequential scans to show
+// which policies keep it resident.  The same hot set is then checked to
+// survive scans that pass the SEQUENTIAL and ONE_SHOT client hints.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <unistd.h>
+#include "pf.h"
+#include "pf_internal.h"
+
+using namespace std;
+
+#ifdef PF_STATS
+#include "statistics.h"
+
+// This is defined within pf_buffermgr.cc
+extern StatisticsMgr *pStatisticsMgr;
+#endif
+
+//
+// Defines
+//
+#define FILE1        "file1"
+#define NUM_PAGES    (4 * PF_BUFFER_SIZE)   // pages in the test file
+#define HOT_PAGES    (PF_BUFFER_SIZE / 4)   // pages of the hot set
+
+static const PF_ReplacePolicy policies[] = {
+   PF_REPLACE_LRU, PF_REPLACE_CLOCK, PF_REPLACE_2Q,
+   PF_REPLACE_LRUK, PF_REPLACE_ARC
+};
+static const char *policyNames[] = { "LRU", "CLOCK", "2Q", "LRU-K", "ARC" };
+#define NUM_POLICIES ((int)(sizeof(policies) / sizeof(policies[0])))
+
+//
+// ReadPages
+//
+// Desc: Fetch pages [first, last) once with hint, checking their contents
+//
+RC ReadPages(PF_FileHandle &fh, PageNum first, PageNum last,
+      ClientHint hint = NO_HINT)
+{
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+
+   for (PageNum i = first; i < last; i++) {
+      if ((rc = fh.GetThisPage(i, ph, hint)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+
+      if (pageNum != i || memcmp(pData, &i, sizeof(PageNum))) {
+         cout << "Page " << i << " has the wrong contents!\n";
+         exit(1);
+      }
+
+      if ((rc = fh.UnpinPage(i)))
+         return (rc);
+   }
+   return (0);
+}
+
+//
+// HotHits
+//
+// Desc: Read the hot set, return the # of its pages found in the buffer
+//       (-1 without PF_STATS)
+//
+RC HotHits(PF_FileHandle &fh, int &hits)
+{
+   RC rc;
+
+   hits = -1;
+#ifdef PF_STATS
+   int *piPF = pStatisticsMgr->Get(PF_PAGEFOUND);
+   hits = piPF ? -*piPF : 0;
+   delete piPF;
+#endif
+   if ((rc = ReadPages(fh, 0, HOT_PAGES)))
+      return (rc);
+#ifdef PF_STATS
+   piPF = pStatisticsMgr->Get(PF_PAGEFOUND);
+   hits += piPF ? *piPF : 0;
+   delete piPF;
+#endif
+   return (0);
+}
+
+//
+// TestPolicy
+//
+// Desc: Run the workload with a buffer manager using policy.
+// Out:  hotHits - # of hot set references served from the buffer on the
+//       last pass over the hot set (-1 without PF_STATS)
+//
+RC TestPolicy(PF_ReplacePolicy policy, int &hotHits)
+{
+   PF_Manager pfm(policy);
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+   int i;
+
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1)) ||
+         (rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+
+   // Write a file four times the size of the buffer pool
+   for (i = 0; i < NUM_PAGES; i++) {
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+      memcpy(pData, &pageNum, sizeof(PageNum));
+      if ((rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+
+   // Read it back twice; the dirty pages were written when replaced
+   if ((rc = ReadPages(fh, 0, NUM_PAGES)) ||
+         (rc = ReadPages(fh, 0, NUM_PAGES)))
+      return (rc);
+
+   // Pin a buffer's worth of pages; the next page must not fit
+   for (i = 0; i < PF_BUFFER_SIZE; i++)
+      if ((rc = fh.GetThisPage(i, ph)))
+         return (rc);
+   if ((rc = fh.GetThisPage(PF_BUFFER_SIZE, ph)) != PF_NOBUF) {
+      cout << "Pinned page was replaced! (" << rc << ")\n";
+      exit(1);
+   }
+   for (i = 0; i < PF_BUFFER_SIZE; i++)
+      if ((rc = fh.UnpinPage(i)))
+         return (rc);
+
+   // Start the hot set test from an empty buffer
+   if ((rc = fh.FlushPages()))
+      return (rc);
+
+   // Hot set twice, scan, hot set again, long scan
+   if ((rc = ReadPages(fh, 0, HOT_PAGES)) ||
+         (rc = ReadPages(fh, 0, HOT_PAGES)) ||
+         (rc = ReadPages(fh, HOT_PAGES, HOT_PAGES + PF_BUFFER_SIZE)) ||
+         (rc = ReadPages(fh, 0, HOT_PAGES)) ||
+         (rc = ReadPages(fh, HOT_PAGES + PF_BUFFER_SIZE, NUM_PAGES)))
+      return (rc);
+
+   if ((rc = HotHits(fh, hotHits)))
+      return (rc);
+
+   // Switching policy keeps the resident pages
+   if ((rc = pfm.SetReplacePolicy(PF_REPLACE_LRU)) ||
+         (rc = ReadPages(fh, 0, NUM_PAGES)))
+      return (rc);
+
+   if ((rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.DestroyFile(FILE1)))
+      return (rc);
+
+   return (0);
+}
+
+//
+// TestHints
+//
+// Desc: Scans that say so must not push the hot set out of the buffer,
+//       whatever the replacement policy
+//
+RC TestHints(PF_ReplacePolicy policy)
+{
+   PF_Manager pfm(policy);
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+   int i, hits;
+
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1)) ||
+         (rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+   for (i = 0; i < NUM_PAGES; i++) {
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+      memcpy(pData, &pageNum, sizeof(PageNum));
+      if ((rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+   if ((rc = fh.FlushPages()))
+      return (rc);
+
+   // Load the hot set, then scan the whole file with each scan hint
+   if ((rc = ReadPages(fh, 0, HOT_PAGES, KEEP_HOT)) ||
+         (rc = ReadPages(fh, 0, NUM_PAGES, SEQUENTIAL)) ||
+         (rc = HotHits(fh, hits)))
+      return (rc);
+   if (hits != -1 && hits != HOT_PAGES) {
+      cout << "SEQUENTIAL scan pushed out the hot set! (" << hits << ")\n";
+      exit(1);
+   }
+   if ((rc = ReadPages(fh, 0, NUM_PAGES, ONE_SHOT)) ||
+         (rc = HotHits(fh, hits)))
+      return (rc);
+   if (hits != -1 && hits != HOT_PAGES) {
+      cout << "ONE_SHOT scan pushed out the hot set! (" << hits << ")\n";
+      exit(1);
+   }
+
+   if ((rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.DestroyFile(FILE1)))
+      return (rc);
+
+   return (0);
+}
+
+int main()
+{
+   RC rc;
+   int hotHits[NUM_POLICIES];
+   int i;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF replacement policy test.\n";
+#ifndef PF_STATS
+   cout << " ** The PF layer was not compiled with the -DPF_STATS flag **\n";
+   cout << " **    The hot set part of this test will be skipped      **\n";
+#endif
+   cout << "----------------------\n";
+
+   for (i = 0; i < NUM_POLICIES; i++) {
+      cout << "Testing policy " << policyNames[i] << ": ";
+      if ((rc = TestPolicy(policies[i], hotHits[i]))) {
+         PF_PrintError(rc);
+         return (1);
+      }
+      cout << "hot set hits " << hotHits[i] << "/" << HOT_PAGES << "\n";
+   }
+
+   for (i = 0; i < NUM_POLICIES; i++) {
+      cout << "Testing scan hints with policy " << policyNames[i] << "\n";
+      if ((rc = TestHints(policies[i]))) {
+         PF_PrintError(rc);
+         return (1);
+      }
+   }
+
+#ifdef PF_STATS
+   // LRU keeps nothing across a scan larger than the buffer; the scan
+   // resistant policies must keep the whole hot set
+   if (hotHits[0] != 0) {
+      cout << "LRU kept hot pages across a scan!\n";
+      return (1);
+   }
+   for (i = 2; i < NUM_POLICIES; i++)
+      if (hotHits[i] != HOT_PAGES) {
+         cout << policyNames[i] << " did not keep the hot set!\n";
+         return (1);
+      }
+#endif
+
+   cout << "Ending PF replacement policy test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
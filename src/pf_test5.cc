@@ -0,0 +1,336 @@
+//
+// File:        pf_test5.cc
+// Description: Test the I/O modes of the PF component
+//
+// A file is written in one I/O mode and read back in the other.  Every
+// byte of every page is checked, so that a direct write of a page that
+// clobbers its neighbours (pages do not start on block boundaries) is
+// caught.  If the file system cannot do direct I/O, only the buffered
+// mode is tested.
+//
+// A file written in either mode is also read mapped (PF_IO_MMAP): the
+// pages must come straight from the mapping, without any read (checked
+// with PF_STATS), and the file must not be changed.
+//
+// Then, in each mode, dirty pages are forced in scattered order: they
+// must be written back sorted, with one write per run of consecutive
+// pages (checked with PF_STATS).
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <unistd.h>
+#include "pf.h"
+#include "pf_internal.h"
+#include "pf_testutil.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define FILE1        "file1"
+#define NUM_PAGES    (3 * PF_BUFFER_SIZE)   // pages in the test file
+
+static const char *modeNames[] = { "buffered", "direct", "mapped" };
+
+//
+// WriteFile
+//
+// Desc: Create FILE1 in writeMode and fill NUM_PAGES pages.  Then
+//       rewrite every other page with another seed.
+//
+RC WriteFile(PF_Manager &pfm, PF_IOMode writeMode)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+   int i;
+
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1)) ||
+         (rc = pfm.OpenFile(FILE1, fh, writeMode)))
+      return (rc);
+
+   for (i = 0; i < NUM_PAGES; i++) {
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+      FillPage(pData, pageNum, 0);
+      if ((rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+
+   // Rewrite odd pages after they were replaced once
+   for (pageNum = 1; pageNum < NUM_PAGES; pageNum += 2) {
+      if ((rc = fh.GetThisPage(pageNum, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      FillPage(pData, pageNum, 1);
+      if ((rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+
+   return (pfm.CloseFile(fh));
+}
+
+//
+// ReadFile
+//
+// Desc: Open FILE1 in readMode and check every page
+//
+RC ReadFile(PF_Manager &pfm, PF_IOMode readMode)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+   int numPages = 0;
+
+   if ((rc = pfm.OpenFile(FILE1, fh, readMode)))
+      return (rc);
+
+   for (rc = fh.GetFirstPage(ph); rc == 0; rc = fh.GetNextPage(pageNum, ph)) {
+      if ((rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+      CheckPage(pData, pageNum, pageNum % 2);
+      if ((rc = fh.UnpinPage(pageNum)))
+         return (rc);
+      numPages++;
+   }
+   if (rc != PF_EOF)
+      return (rc);
+
+   if (numPages != NUM_PAGES) {
+      cout << "Found " << numPages << " pages instead of " << NUM_PAGES
+         << "\n";
+      exit(1);
+   }
+
+   return (pfm.CloseFile(fh));
+}
+
+//
+// ForceAndCount
+//
+// Desc: ForcePages(ALL_PAGES) with fdatasync, checking (with PF_STATS)
+//       the # of pages and of write calls
+//
+RC ForceAndCount(PF_FileHandle &fh, int numPages, int numRuns)
+{
+   RC rc;
+   int pages = -Counter(PF_WRITEPAGE);
+   int runs = -Counter(PF_WRITERUN);
+
+   if ((rc = fh.ForcePages(ALL_PAGES, TRUE)))
+      return (rc);
+   pages += Counter(PF_WRITEPAGE);
+   runs += Counter(PF_WRITERUN);
+
+   ExpectStat("pages written", pages, numPages);
+   ExpectStat("writes", runs, numRuns);
+   return (0);
+}
+
+//
+// TestMapped
+//
+// Desc: Read FILE1 mapped and try to change it
+//
+RC TestMapped(PF_Manager &pfm)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph, ph2;
+   char *pData, *pData2;
+   RC rc;
+   int reads = -Counter(PF_READPAGE);
+
+   // Every page is checked, none is read
+   if ((rc = ReadFile(pfm, PF_IO_MMAP)))
+      return (rc);
+   reads += Counter(PF_READPAGE);
+   ExpectStat("pages read", reads, 0);
+
+   if ((rc = pfm.OpenFile(FILE1, fh, PF_IO_MMAP)))
+      return (rc);
+
+   // A page pinned twice is the same page of the mapping
+   if ((rc = fh.GetThisPage(1, ph)) ||
+         (rc = ph.GetData(pData)) ||
+         (rc = fh.GetThisPage(1, ph2)) ||
+         (rc = ph2.GetData(pData2)))
+      return (rc);
+   if (pData != pData2) {
+      cout << "Page 1 is in two places!\n";
+      exit(1);
+   }
+
+   // The file cannot be changed
+   Expect("MarkDirty", fh.MarkDirty(1), PF_READONLY);
+   Expect("AllocatePage", fh.AllocatePage(ph2), PF_READONLY);
+   Expect("DisposePage", fh.DisposePage(2), PF_READONLY);
+
+   // Nor closed while a page is pinned
+   Expect("CloseFile", pfm.CloseFile(fh), PF_PAGEPINNED);
+   if ((rc = fh.UnpinPage(1)) ||
+         (rc = fh.UnpinPage(1)))
+      return (rc);
+   Expect("UnpinPage", fh.UnpinPage(1), PF_PAGEUNPINNED);
+
+   return (pfm.CloseFile(fh));
+}
+
+//
+// TestWriteBack
+//
+// Desc: Dirty pages in scattered order and force them in mode
+//
+RC TestWriteBack(PF_Manager &pfm, PF_IOMode mode)
+{
+   // Pages dirtied: runs 3-5, 9-10 and 14, given out of order
+   static const PageNum dirty[] = { 10, 4, 14, 3, 9, 5 };
+   const int numDirty = sizeof(dirty) / sizeof(dirty[0]);
+   const int numPages = PF_BUFFER_SIZE - 1;
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+   int i;
+
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1)) ||
+         (rc = pfm.OpenFile(FILE1, fh, mode)))
+      return (rc);
+
+   // New pages are consecutive (the file fits in the buffer): one write
+   // per PF_WRITEBACK_RUN pages
+   for (i = 0; i < numPages; i++) {
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+      FillPage(pData, pageNum, 0);
+      if ((rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+   if ((rc = ForceAndCount(fh, numPages,
+         (numPages + PF_WRITEBACK_RUN - 1) / PF_WRITEBACK_RUN)))
+      return (rc);
+
+   // Scattered pages: one write per run; pinned pages are forced too
+   for (i = 0; i < numDirty; i++) {
+      if ((rc = fh.GetThisPage(dirty[i], ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      FillPage(pData, dirty[i], 1);
+      if ((rc = fh.MarkDirty(dirty[i])) ||
+            (i % 2 == 0 && (rc = fh.UnpinPage(dirty[i]))))
+         return (rc);
+   }
+   if ((rc = ForceAndCount(fh, numDirty, 3)))
+      return (rc);
+   for (i = 1; i < numDirty; i += 2)
+      if ((rc = fh.UnpinPage(dirty[i])))
+         return (rc);
+
+   // Nothing is left to write
+   if ((rc = ForceAndCount(fh, 0, 0)) ||
+         (rc = pfm.CloseFile(fh)))
+      return (rc);
+
+   // Read it all back
+   if ((rc = pfm.OpenFile(FILE1, fh, mode)))
+      return (rc);
+   for (pageNum = 0; pageNum < numPages; pageNum++) {
+      int seed = 0;
+      for (i = 0; i < numDirty; i++)
+         if (dirty[i] == pageNum)
+            seed = 1;
+      if ((rc = fh.GetThisPage(pageNum, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      CheckPage(pData, pageNum, seed);
+      if ((rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+
+   return (pfm.CloseFile(fh));
+}
+
+int main()
+{
+   PF_Manager pfm;
+   PF_FileHandle fh;
+   PF_IOMode modes[2] = { PF_IO_BUFFERED, PF_IO_DIRECT };
+   int numModes = 2;
+   RC rc;
+   int w, r;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF I/O mode test.\n";
+   cout << "----------------------\n";
+
+   // See whether this file system does direct I/O at all
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1))) {
+      PF_PrintError(rc);
+      return (1);
+   }
+   if ((rc = pfm.OpenFile(FILE1, fh, PF_IO_DIRECT)) == PF_NODIRECTIO) {
+      cout << "No direct I/O here, testing buffered I/O only\n";
+      numModes = 1;
+   }
+   else if (rc || (rc = pfm.CloseFile(fh))) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   for (w = 0; w < numModes; w++)
+      for (r = 0; r < numModes; r++) {
+         cout << "Writing " << modeNames[w] << ", reading "
+            << modeNames[r] << "\n";
+         if ((rc = WriteFile(pfm, modes[w])) ||
+               (rc = ReadFile(pfm, modes[r]))) {
+            PF_PrintError(rc);
+            return (1);
+         }
+      }
+
+   for (w = 0; w < numModes; w++) {
+      cout << "Writing " << modeNames[w] << ", reading mapped\n";
+      if ((rc = WriteFile(pfm, modes[w])) ||
+            (rc = TestMapped(pfm))) {
+         PF_PrintError(rc);
+         return (1);
+      }
+   }
+
+   for (w = 0; w < numModes; w++) {
+      cout << "Write-back, " << modeNames[w] << "\n";
+      if ((rc = TestWriteBack(pfm, modes[w]))) {
+         PF_PrintError(rc);
+         return (1);
+      }
+   }
+
+   if ((rc = pfm.DestroyFile(FILE1))) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF I/O mode test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
@@ -0,0 +1,270 @@
+//
+// File:        pf_test6.cc
+// Description: Test the read-ahead of the PF component
+//
+// A file larger than the buffer pool is scanned forwards and backwards,
+// without a hint and with the SEQUENTIAL hint, and pages are prefetched
+// explicitly.  Every byte of every page is checked, so that a page handed
+// out before its read-ahead finished is caught.  With PF_STATS the scans
+// must find all but their first few pages in the buffer, and random
+// accesses must not cause any read-ahead.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <unistd.h>
+#include "pf.h"
+#include "pf_internal.h"
+#include "pf_testutil.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define FILE1        "file1"
+#define NUM_PAGES    (3 * PF_BUFFER_SIZE)   // pages in the test file
+
+//
+// Scan
+//
+// Desc: Go through all pages of the file with GetNextPage (or, if
+//       bBackwards, GetPrevPage) and check them
+// Out:  misses - # of pages that had to be read by the scan itself
+//
+RC Scan(PF_FileHandle &fh, int bBackwards, ClientHint hint, int &misses)
+{
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+   int numPages = 0;
+
+   misses = -Counter(PF_PAGENOTFOUND);
+   for (rc = bBackwards ? fh.GetLastPage(ph, hint) : fh.GetFirstPage(ph, hint);
+         rc == 0;
+         rc = bBackwards ? fh.GetPrevPage(pageNum, ph, hint) :
+                           fh.GetNextPage(pageNum, ph, hint)) {
+      if ((rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+      CheckPage(pData, pageNum);
+      if ((rc = fh.UnpinPage(pageNum)))
+         return (rc);
+      numPages++;
+   }
+   if (rc != PF_EOF)
+      return (rc);
+   misses += Counter(PF_PAGENOTFOUND);
+
+   if (numPages != NUM_PAGES) {
+      cout << "Found " << numPages << " pages instead of " << NUM_PAGES
+         << "\n";
+      exit(1);
+   }
+   return (0);
+}
+
+//
+// ReadPages
+//
+// Desc: Get pages [first, last) with GetThisPage and check them
+//
+RC ReadPages(PF_FileHandle &fh, PageNum first, PageNum last,
+      ClientHint hint)
+{
+   PF_PageHandle ph;
+   char *pData;
+   RC rc;
+
+   for (PageNum i = first; i < last; i++) {
+      if ((rc = fh.GetThisPage(i, ph, hint)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      CheckPage(pData, i);
+      if ((rc = fh.UnpinPage(i)))
+         return (rc);
+   }
+   return (0);
+}
+
+//
+// WriteFile
+//
+// Desc: Create FILE1 with NUM_PAGES pages
+//
+RC WriteFile(PF_Manager &pfm)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1)) ||
+         (rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+
+   for (int i = 0; i < NUM_PAGES; i++) {
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+      FillPage(pData, pageNum);
+      if ((rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+
+   return (pfm.CloseFile(fh));
+}
+
+//
+// TestScans
+//
+// Desc: Scan the file in every direction, with and without a hint.  The
+//       file is reopened (and so out of the buffer) before each scan.
+//
+RC TestScans(PF_Manager &pfm)
+{
+   PF_FileHandle fh;
+   RC rc;
+   int misses;
+
+   cout << "Forward scan, no hint\n";
+   if ((rc = pfm.OpenFile(FILE1, fh)) ||
+         (rc = Scan(fh, FALSE, NO_HINT, misses)) ||
+         (rc = pfm.CloseFile(fh)))
+      return (rc);
+   ExpectStat("pages not read ahead", misses, PF_READAHEAD_TRIGGER);
+
+   cout << "Backward scan, no hint\n";
+   if ((rc = pfm.OpenFile(FILE1, fh)) ||
+         (rc = Scan(fh, TRUE, NO_HINT, misses)) ||
+         (rc = pfm.CloseFile(fh)))
+      return (rc);
+   ExpectStat("pages not read ahead", misses, PF_READAHEAD_TRIGGER + 1);
+
+   cout << "Forward scan, SEQUENTIAL\n";
+   if ((rc = pfm.OpenFile(FILE1, fh)) ||
+         (rc = Scan(fh, FALSE, SEQUENTIAL, misses)) ||
+         (rc = pfm.CloseFile(fh)))
+      return (rc);
+   ExpectStat("pages not read ahead", misses, 1);
+
+   cout << "Backward scan, ONE_SHOT\n";
+   if ((rc = pfm.OpenFile(FILE1, fh)) ||
+         (rc = Scan(fh, TRUE, ONE_SHOT, misses)) ||
+         (rc = pfm.CloseFile(fh)))
+      return (rc);
+   ExpectStat("pages not read ahead", misses, 2);
+
+   return (0);
+}
+
+//
+// TestNoReadAhead
+//
+// Desc: Neither GetThisPage without a hint nor the RANDOM hint read ahead
+//
+RC TestNoReadAhead(PF_Manager &pfm)
+{
+   PF_FileHandle fh;
+   RC rc;
+   int prefetched;
+
+   cout << "GetThisPage, no hint and RANDOM\n";
+   prefetched = -Counter(PF_PREFETCHPAGE);
+   if ((rc = pfm.OpenFile(FILE1, fh)) ||
+         (rc = ReadPages(fh, 0, NUM_PAGES, NO_HINT)) ||
+         (rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.OpenFile(FILE1, fh)) ||
+         (rc = ReadPages(fh, 0, NUM_PAGES, RANDOM)) ||
+         (rc = pfm.CloseFile(fh)))
+      return (rc);
+   prefetched += Counter(PF_PREFETCHPAGE);
+   ExpectStat("pages read ahead", prefetched, 0);
+
+   return (0);
+}
+
+//
+// TestPrefetchPages
+//
+// Desc: Prefetch pages explicitly, also when the buffer is all pinned
+//
+RC TestPrefetchPages(PF_Manager &pfm)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   RC rc;
+   int misses;
+   int i;
+
+   cout << "PrefetchPages\n";
+   if ((rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+
+   if ((rc = fh.PrefetchPages(10, PF_READAHEAD_PAGES)))
+      return (rc);
+   misses = -Counter(PF_PAGENOTFOUND);
+   if ((rc = ReadPages(fh, 10, 10 + PF_READAHEAD_PAGES, NO_HINT)))
+      return (rc);
+   misses += Counter(PF_PAGENOTFOUND);
+   ExpectStat("prefetched pages not found", misses, 0);
+
+   // Prefetching resident pages does nothing; pages past the end of the
+   // file cannot be prefetched
+   if ((rc = fh.PrefetchPages(10, PF_READAHEAD_PAGES)))
+      return (rc);
+   if ((rc = fh.PrefetchPages(NUM_PAGES, 1)) != PF_INVALIDPAGE) {
+      cout << "PrefetchPages past the end of file returned " << rc << "\n";
+      exit(1);
+   }
+
+   // Pin a buffer full of pages: there is no room for read-ahead
+   for (i = 0; i < PF_BUFFER_SIZE; i++)
+      if ((rc = fh.GetThisPage(PF_BUFFER_SIZE + i, ph)))
+         return (rc);
+   if ((rc = fh.PrefetchPages(0, 1)) != PF_NOBUF) {
+      cout << "PrefetchPages with all pages pinned returned " << rc << "\n";
+      exit(1);
+   }
+   for (i = 0; i < PF_BUFFER_SIZE; i++)
+      if ((rc = fh.UnpinPage(PF_BUFFER_SIZE + i)))
+         return (rc);
+
+   // Read-ahead picks up again once pages are unpinned
+   if ((rc = ReadPages(fh, 0, NUM_PAGES, SEQUENTIAL)))
+      return (rc);
+
+   return (pfm.CloseFile(fh));
+}
+
+int main()
+{
+   PF_Manager pfm;
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF read-ahead test.\n";
+   cout << "----------------------\n";
+
+   if ((rc = WriteFile(pfm)) ||
+         (rc = TestScans(pfm)) ||
+         (rc = TestNoReadAhead(pfm)) ||
+         (rc = TestPrefetchPages(pfm)) ||
+         (rc = pfm.DestroyFile(FILE1))) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF read-ahead test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
@@ -0,0 +1,220 @@
+//
+// File:        pf_test7.cc
+// Description: Test the page cleaner of the PF component
+//
+// A file larger than the buffer pool is written page by page.  With the
+// page cleaner on, the pages are written in the background before they
+// are replaced: only the very first victim has to be written by the page
+// fault itself, and no page is written twice.  With the cleaner off,
+// every victim is.  (The counts are only checked with PF_STATS.)
+//
+// Then the pages are updated over and over with every replacement policy
+// and a large clean target, so that pages are asked for while the cleaner
+// writes them.  Every byte of every page is checked afterwards.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <unistd.h>
+#include "pf.h"
+#include "pf_internal.h"
+#include "pf_testutil.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define FILE1        "file1"
+#define NUM_PAGES    (3 * PF_BUFFER_SIZE)   // pages in the test file
+
+//
+// WriteFile
+//
+// Desc: Create FILE1 with NUM_PAGES pages of seed 0 and check how many
+//       pages the cleaner wrote
+// In:   numCleaned - # of pages the cleaner must write
+//
+RC WriteFile(PF_Manager &pfm, int numCleaned)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+   int writes = 0, cleaned = 0, dirtyVictims = 0;
+
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1)) ||
+         (rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+
+   writes = -Counter(PF_WRITEPAGE);
+   cleaned = -Counter(PF_CLEANPAGE);
+   dirtyVictims = -Counter(PF_DIRTYVICTIM);
+
+   for (int i = 0; i < NUM_PAGES; i++) {
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+      FillPage(pData, pageNum, 0);
+      if ((rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+
+   if ((rc = pfm.CloseFile(fh)))
+      return (rc);
+
+   writes += Counter(PF_WRITEPAGE);
+   cleaned += Counter(PF_CLEANPAGE);
+   dirtyVictims += Counter(PF_DIRTYVICTIM);
+
+   // Only the first page replaced finds nothing cleaned yet
+   ExpectStat("pages written", writes, NUM_PAGES);
+   ExpectStat("pages written by the cleaner", cleaned, numCleaned);
+   ExpectStat("dirty pages replaced", dirtyVictims,
+         numCleaned ? 1 : NUM_PAGES - PF_BUFFER_SIZE);
+
+   return (0);
+}
+
+//
+// UpdateFile
+//
+// Desc: Go through the pages of FILE1 from first to last, numPasses times,
+//       giving each page the next seed
+// In:   seed - seed of the pages now
+//
+RC UpdateFile(PF_Manager &pfm, int seed, int numPasses)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   RC rc;
+
+   if ((rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+
+   for (int pass = 0; pass < numPasses; pass++, seed++)
+      for (PageNum i = 0; i < NUM_PAGES; i++) {
+         if ((rc = fh.GetThisPage(i, ph)) ||
+               (rc = ph.GetData(pData)))
+            return (rc);
+         CheckPage(pData, i, seed);
+         FillPage(pData, i, seed + 1);
+         if ((rc = fh.MarkDirty(i)) ||
+               (rc = fh.UnpinPage(i)))
+            return (rc);
+      }
+
+   return (pfm.CloseFile(fh));
+}
+
+//
+// ReadFile
+//
+// Desc: Check that every page of FILE1 has the given seed
+//
+RC ReadFile(PF_Manager &pfm, int seed)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   RC rc;
+
+   if ((rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+
+   for (PageNum i = 0; i < NUM_PAGES; i++) {
+      if ((rc = fh.GetThisPage(i, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      CheckPage(pData, i, seed);
+      if ((rc = fh.UnpinPage(i)))
+         return (rc);
+   }
+
+   return (pfm.CloseFile(fh));
+}
+
+//
+// TestCleaner
+//
+// Desc: Write the file with the cleaner on and off
+//
+RC TestCleaner(PF_Manager &pfm)
+{
+   int numClean = PF_BUFFER_SIZE * PF_CLEAN_TARGET / 100;
+   RC rc;
+
+   // Every time a page is replaced the cleaner gets ahead again: it ends
+   // up writing all pages up to numClean after the last victim
+   cout << "Cleaner on\n";
+   if ((rc = pfm.SetCleanTarget(PF_CLEAN_TARGET)) ||
+         (rc = WriteFile(pfm, NUM_PAGES - PF_BUFFER_SIZE - 1 + numClean)) ||
+         (rc = ReadFile(pfm, 0)))
+      return (rc);
+
+   cout << "Cleaner off\n";
+   if ((rc = pfm.SetCleanTarget(0)) ||
+         (rc = WriteFile(pfm, 0)) ||
+         (rc = ReadFile(pfm, 0)))
+      return (rc);
+
+   return (0);
+}
+
+//
+// TestPolicies
+//
+// Desc: Update the file with every replacement policy while the cleaner
+//       keeps half of the buffer clean
+//
+RC TestPolicies(PF_Manager &pfm)
+{
+   PF_ReplacePolicy policies[] = { PF_REPLACE_LRU, PF_REPLACE_CLOCK,
+      PF_REPLACE_2Q, PF_REPLACE_LRUK, PF_REPLACE_ARC };
+   const char *names[] = { "LRU", "CLOCK", "2Q", "LRU-K", "ARC" };
+   int seed = 0;
+   RC rc;
+
+   if ((rc = pfm.SetCleanTarget(50)))
+      return (rc);
+
+   for (int i = 0; i < 5; i++, seed += 3) {
+      cout << "Updates with cleaner, " << names[i] << "\n";
+      if ((rc = pfm.SetReplacePolicy(policies[i])) ||
+            (rc = UpdateFile(pfm, seed, 3)) ||
+            (rc = ReadFile(pfm, seed + 3)))
+         return (rc);
+   }
+
+   return (pfm.SetReplacePolicy(PF_REPLACE_LRU));
+}
+
+int main()
+{
+   PF_Manager pfm;
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF page cleaner test.\n";
+   cout << "----------------------\n";
+
+   if ((rc = TestCleaner(pfm)) ||
+         (rc = TestPolicies(pfm)) ||
+         (rc = pfm.DestroyFile(FILE1))) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF page cleaner test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
@@ -0,0 +1,361 @@
+//
+// File:        pf_test8.cc
+// Description: Test the PF component with several threads
+//
+// The buffer is made large enough to be split into shards.  A file twice
+// the size of the buffer is shared by 1, 2, 4 and 8 threads.  Each of them
+// picks pages at random: mostly it reads a page (latched shared) and
+// checks it, sometimes it updates a page (latched exclusive), and now and
+// then it scans a few pages.  Every page carries a version, bumped by each
+// update, and a pattern derived from its number and version.
+//
+// Meanwhile, the main thread resizes the buffer back and forth; a resize
+// is refused while a page is latched, and then tried again.
+//
+// Afterwards the file is reopened and read: every page must hold the
+// pattern of its version, and the versions must add up to the number of
+// updates.  With PF_STATS, every request for a page must have been found
+// in the buffer or read.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/time.h>
+#include "pf.h"
+#include "pf_internal.h"
+#include "pf_testutil.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define FILE1        "file1"
+#define BUFFER_PAGES (PF_MAX_SHARDS * PF_SHARD_PAGES)  // pages in the buffer
+#define NUM_PAGES    (2 * BUFFER_PAGES)   // pages in the test file
+#define NUM_OPS      20000                // operations of each thread
+#define SCAN_PAGES   8                    // pages of a scan
+#define MAX_THREADS  8
+#define NUM_RESIZES  20                   // resizes while threads work
+
+//
+// Fill, Check
+//
+// Desc: Fill a page with its version and a pattern derived from its
+//       number and version, or check that it holds them
+//
+static void Fill(char *pData, PageNum pageNum, int version)
+{
+   memcpy(pData, &version, sizeof(int));
+   for (int i = sizeof(int); i < PF_PAGE_SIZE; i++)
+      pData[i] = (char)(pageNum * 7 + version * 31 + i);
+}
+
+static int Check(const char *pData, PageNum pageNum)
+{
+   int version;
+
+   memcpy(&version, pData, sizeof(int));
+   for (int i = sizeof(int); i < PF_PAGE_SIZE; i++)
+      if (pData[i] != (char)(pageNum * 7 + version * 31 + i)) {
+         cout << "Page " << pageNum << " has the wrong contents!\n";
+         exit(1);
+      }
+   return (version);
+}
+
+//
+// Worker - what each thread gets
+//
+struct Worker {
+   PF_FileHandle *pFileHandle;
+   unsigned int  seed;
+   int           numUpdates;       // updates done
+   RC            rc;               // first error
+};
+
+//
+// ReadPage
+//
+// Desc: Get a page, check it under a shared latch and unpin it
+//
+static RC ReadPage(PF_FileHandle &fh, PageNum pageNum, ClientHint hint)
+{
+   PF_PageHandle ph;
+   char *pData;
+   RC rc;
+
+   if ((rc = fh.GetThisPage(pageNum, ph, hint)) ||
+         (rc = ph.GetData(pData)) ||
+         (rc = fh.LatchPage(pageNum)))
+      return (rc);
+   Check(pData, pageNum);
+   if ((rc = fh.UnlatchPage(pageNum)))
+      return (rc);
+   return (fh.UnpinPage(pageNum));
+}
+
+//
+// UpdatePage
+//
+// Desc: Get a page and give it the next version under an exclusive latch
+//
+static RC UpdatePage(PF_FileHandle &fh, PageNum pageNum)
+{
+   PF_PageHandle ph;
+   char *pData;
+   RC rc;
+
+   if ((rc = fh.GetThisPage(pageNum, ph)) ||
+         (rc = ph.GetData(pData)) ||
+         (rc = fh.LatchPage(pageNum, TRUE)))
+      return (rc);
+   Fill(pData, pageNum, Check(pData, pageNum) + 1);
+   if ((rc = fh.MarkDirty(pageNum)) ||
+         (rc = fh.UnlatchPage(pageNum)))
+      return (rc);
+   return (fh.UnpinPage(pageNum));
+}
+
+//
+// ScanPages
+//
+// Desc: Check SCAN_PAGES pages from pageNum on with GetNextPage
+//
+static RC ScanPages(PF_FileHandle &fh, PageNum pageNum)
+{
+   PF_PageHandle ph;
+   char *pData;
+   RC rc;
+
+   for (int i = 0; i < SCAN_PAGES; i++) {
+      if ((rc = fh.GetNextPage(pageNum, ph, SEQUENTIAL))) {
+         if (rc == PF_EOF)
+            break;
+         return (rc);
+      }
+      if ((rc = ph.GetPageNum(pageNum)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = fh.LatchPage(pageNum)))
+         return (rc);
+      Check(pData, pageNum);
+      if ((rc = fh.UnlatchPage(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+   return (0);
+}
+
+//
+// Work
+//
+// Desc: Thread body: NUM_OPS random operations on the file
+//
+static void *Work(void *pArg)
+{
+   Worker &w = *(Worker *)pArg;
+   PF_FileHandle &fh = *w.pFileHandle;
+   RC rc = 0;
+
+   for (int op = 0; op < NUM_OPS && !rc; op++) {
+      PageNum pageNum = rand_r(&w.seed) % NUM_PAGES;
+      int choice = rand_r(&w.seed) % 64;
+
+      if (choice == 0)
+         rc = ScanPages(fh, pageNum);
+      else if (choice < 9) {
+         if (!(rc = UpdatePage(fh, pageNum)))
+            w.numUpdates++;
+      }
+      else
+         rc = ReadPage(fh, pageNum, RANDOM);
+   }
+
+   w.rc = rc;
+   return (NULL);
+}
+
+//
+// CreateFile
+//
+// Desc: Create FILE1 with NUM_PAGES pages of version 0
+//
+RC CreateFile(PF_Manager &pfm)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1)) ||
+         (rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+
+   for (int i = 0; i < NUM_PAGES; i++) {
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+      Fill(pData, pageNum, 0);
+      if ((rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+
+   return (pfm.CloseFile(fh));
+}
+
+//
+// RunThreads
+//
+// Desc: Let numThreads threads work on FILE1 at once and print how many
+//       operations they did per second
+// Out:  numUpdates - add the number of updates they did
+//
+RC RunThreads(PF_Manager &pfm, int numThreads, int &numUpdates)
+{
+   PF_FileHandle fh;
+   pthread_t threads[MAX_THREADS];
+   Worker workers[MAX_THREADS];
+   struct timeval start, end;
+   RC rc;
+   int i;
+
+   if ((rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+
+#ifdef PF_STATS
+   int gets = -Counter(PF_GETPAGE);
+   int found = -Counter(PF_PAGEFOUND);
+   int notFound = -Counter(PF_PAGENOTFOUND);
+#endif
+
+   gettimeofday(&start, NULL);
+   for (i = 0; i < numThreads; i++) {
+      workers[i].pFileHandle = &fh;
+      workers[i].seed = 17 * numThreads + i;
+      workers[i].numUpdates = 0;
+      workers[i].rc = 0;
+      if (pthread_create(&threads[i], NULL, Work, &workers[i])) {
+         cout << "Cannot start a thread!\n";
+         exit(1);
+      }
+   }
+
+   // Shrink the buffer to half its size and grow it back, every
+   // millisecond
+   for (i = 0; i < NUM_RESIZES; i++) {
+      int size = (i % 2 == 0) ? BUFFER_PAGES / 2 : BUFFER_PAGES;
+      usleep(1000);
+      while ((rc = pfm.ResizeBuffer(size)) == PF_PAGELATCHED)
+         sched_yield();
+      if (rc)
+         return (rc);
+   }
+
+   for (i = 0; i < numThreads; i++)
+      pthread_join(threads[i], NULL);
+   gettimeofday(&end, NULL);
+
+   for (i = 0; i < numThreads; i++) {
+      if (workers[i].rc)
+         return (workers[i].rc);
+      numUpdates += workers[i].numUpdates;
+   }
+
+   double seconds = (end.tv_sec - start.tv_sec) +
+      (end.tv_usec - start.tv_usec) / 1e6;
+   printf("  %d thread(s): %.0f operations/s\n", numThreads,
+         numThreads * NUM_OPS / (seconds > 0 ? seconds : 1e-6));
+
+#ifdef PF_STATS
+   gets += Counter(PF_GETPAGE);
+   found += Counter(PF_PAGEFOUND);
+   notFound += Counter(PF_PAGENOTFOUND);
+   if (gets != found + notFound) {
+      cout << "Pages asked for: " << gets << ", found: " << found
+         << ", not found: " << notFound << "!\n";
+      exit(1);
+   }
+#endif
+
+   return (pfm.CloseFile(fh));
+}
+
+//
+// CheckFile
+//
+// Desc: Check every page of FILE1 and that the versions add up to
+//       numUpdates
+//
+RC CheckFile(PF_Manager &pfm, int numUpdates)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   char *pData;
+   int sum = 0;
+   RC rc;
+
+   if ((rc = pfm.OpenFile(FILE1, fh)))
+      return (rc);
+
+   for (PageNum i = 0; i < NUM_PAGES; i++) {
+      if ((rc = fh.GetThisPage(i, ph)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      sum += Check(pData, i);
+      if ((rc = fh.UnpinPage(i)))
+         return (rc);
+   }
+
+   if (sum != numUpdates) {
+      cout << "Versions add up to " << sum << " instead of " << numUpdates
+         << "!\n";
+      exit(1);
+   }
+
+   return (pfm.CloseFile(fh));
+}
+
+int main()
+{
+   PF_Manager pfm;
+   int numUpdates = 0;
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF multithreaded test.\n";
+   cout << "----------------------\n";
+
+   if ((rc = pfm.ResizeBuffer(BUFFER_PAGES)) ||
+         (rc = CreateFile(pfm))) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   for (int numThreads = 1; numThreads <= MAX_THREADS; numThreads *= 2)
+      if ((rc = RunThreads(pfm, numThreads, numUpdates)) ||
+            (rc = CheckFile(pfm, numUpdates))) {
+         PF_PrintError(rc);
+         return (1);
+      }
+
+   if ((rc = pfm.DestroyFile(FILE1))) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF multithreaded test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
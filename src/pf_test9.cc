@@ -0,0 +1,228 @@
+//
+// File:        pf_test9.cc
+// Description: Test the used-page map of the PF component
+//
+// A file larger than the buffer pool is written, and all but every
+// STRIDE-th page are disposed of.  After the file is reopened, scans
+// forwards and backwards must return just the pages left, and with
+// PF_STATS they must not ask the buffer manager for any free page.  New
+// pages must then be allocated lowest first, filling the holes before
+// the file grows.  A file without the map (as written before it existed)
+// must still reuse its pages from the free list.
+//
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include "pf.h"
+#include "pf_internal.h"
+#include "pf_testutil.h"
+
+using namespace std;
+
+//
+// Defines
+//
+#define FILE1        "file1"
+#define NUM_PAGES    (2 * PF_BUFFER_SIZE)   // pages in the test file
+#define STRIDE       16                     // every STRIDE-th page is kept
+
+//
+// AllocatePages
+//
+// Desc: Allocate numPages pages, fill them and check that they get the
+//       numbers expected
+// In:   numPages - # of pages to allocate
+//       pExpected - the page numbers they should get (NULL: any)
+//
+RC AllocatePages(PF_FileHandle &fh, int numPages, const PageNum *pExpected)
+{
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum;
+   RC rc;
+
+   for (int i = 0; i < numPages; i++) {
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetData(pData)) ||
+            (rc = ph.GetPageNum(pageNum)))
+         return (rc);
+      if (pExpected && pageNum != pExpected[i]) {
+         cout << "Allocated page " << pageNum << " instead of "
+            << pExpected[i] << "!\n";
+         exit(1);
+      }
+      FillPage(pData, pageNum);
+      if ((rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   }
+   return (0);
+}
+
+//
+// Scan
+//
+// Desc: Go through the pages of the file with GetNextPage (or, if
+//       bBackwards, GetPrevPage), check them, and check that they are
+//       every STRIDE-th page
+//
+RC Scan(PF_FileHandle &fh, int bBackwards)
+{
+   PF_PageHandle ph;
+   char *pData;
+   PageNum pageNum, expected;
+   int numFound = 0;
+   int gets = -Counter(PF_GETPAGE);
+   RC rc;
+
+   expected = bBackwards ? (NUM_PAGES - 1) / STRIDE * STRIDE : 0;
+   rc = bBackwards ? fh.GetLastPage(ph) : fh.GetFirstPage(ph);
+   while (!rc) {
+      if ((rc = ph.GetPageNum(pageNum)) ||
+            (rc = ph.GetData(pData)))
+         return (rc);
+      if (pageNum != expected) {
+         cout << "Scan got page " << pageNum << " instead of " << expected
+            << "!\n";
+         exit(1);
+      }
+      CheckPage(pData, pageNum);
+      numFound++;
+      expected += bBackwards ? -STRIDE : STRIDE;
+
+      if ((rc = fh.UnpinPage(pageNum)))
+         return (rc);
+      rc = bBackwards ? fh.GetPrevPage(pageNum, ph) :
+         fh.GetNextPage(pageNum, ph);
+   }
+   if (rc != PF_EOF)
+      return (rc);
+
+   Expect(bBackwards ? "Pages scanned backwards" : "Pages scanned",
+         numFound, (NUM_PAGES + STRIDE - 1) / STRIDE);
+
+   gets += Counter(PF_GETPAGE);
+   ExpectStat("Pages asked for", gets, numFound);
+
+   return (0);
+}
+
+//
+// TestMap
+//
+// Desc: Thin out a file, scan it and fill it up again
+//
+RC TestMap(PF_Manager &pfm)
+{
+   PF_FileHandle fh;
+   PageNum *pHoles;
+   int numHoles = 0;
+   RC rc;
+
+   cout << "Thinning out " << NUM_PAGES << " pages\n";
+
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1)) ||
+         (rc = pfm.OpenFile(FILE1, fh)) ||
+         (rc = AllocatePages(fh, NUM_PAGES, NULL)))
+      return (rc);
+
+   pHoles = new PageNum[NUM_PAGES];
+   for (PageNum i = 0; i < NUM_PAGES; i++)
+      if (i % STRIDE) {
+         if ((rc = fh.DisposePage(i)))
+            return (rc);
+         pHoles[numHoles++] = i;
+      }
+
+   // The map must come back from the file; the buffer holds none of its
+   // pages then
+   if ((rc = pfm.CloseFile(fh)) ||
+         (rc = pfm.OpenFile(FILE1, fh)) ||
+         (rc = Scan(fh, FALSE)) ||
+         (rc = Scan(fh, TRUE)))
+      return (rc);
+
+   // The holes are filled from the lowest page on, then the file grows
+   cout << "Filling the holes\n";
+   pHoles[numHoles] = NUM_PAGES;
+   if ((rc = AllocatePages(fh, numHoles + 1, pHoles)))
+      return (rc);
+   delete [] pHoles;
+
+   // A page disposed of is the next one allocated
+   PageNum again = STRIDE + 1;
+   if ((rc = fh.DisposePage(again)) ||
+         (rc = AllocatePages(fh, 1, &again)) ||
+         (rc = pfm.CloseFile(fh)))
+      return (rc);
+
+   return (pfm.DestroyFile(FILE1));
+}
+
+//
+// TestNoMap
+//
+// Desc: A file whose header has no map keeps its free pages on the free
+//       list: the page disposed of last is allocated first
+//
+RC TestNoMap(PF_Manager &pfm)
+{
+   PF_FileHandle fh;
+   PF_FileHdr hdr;
+   PageNum pages[] = { 2, 1 };
+   int fd;
+   RC rc;
+
+   cout << "File without a map\n";
+
+   unlink(FILE1);
+   if ((rc = pfm.CreateFile(FILE1)))
+      return (rc);
+
+   // Write the header of a file created before the map
+   memset(&hdr, 0, sizeof(hdr));
+   hdr.firstFree = PF_PAGE_LIST_END;
+   hdr.numPages = 0;
+   if ((fd = open(FILE1, O_WRONLY)) < 0 ||
+         pwrite(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+         close(fd))
+      return (PF_UNIX);
+
+   if ((rc = pfm.OpenFile(FILE1, fh)) ||
+         (rc = AllocatePages(fh, 4, NULL)) ||
+         (rc = fh.DisposePage(1)) ||
+         (rc = fh.DisposePage(2)) ||
+         (rc = AllocatePages(fh, 2, pages)) ||
+         (rc = pfm.CloseFile(fh)))
+      return (rc);
+
+   return (pfm.DestroyFile(FILE1));
+}
+
+int main()
+{
+   PF_Manager pfm;
+   RC rc;
+
+   cerr.flush();
+   cout.flush();
+   cout << "********************\n";
+   cout << "Starting PF used-page map test.\n";
+   cout << "----------------------\n";
+
+   if ((rc = TestMap(pfm)) ||
+         (rc = TestNoMap(pfm))) {
+      PF_PrintError(rc);
+      return (1);
+   }
+
+   cout << "Ending PF used-page map test.\n";
+   cout << "********************\n\n";
+
+   return (0);
+}
@@ -0,0 +1,125 @@
+//
+// File:        pf_testutil.h
+// Description: Helpers shared by the PF testers
+//
+
+#ifndef PF_TESTUTIL_H
+#define PF_TESTUTIL_H
+
+#include <iostream>
+#include <cstdlib>
+#include <unistd.h>
+#include "pf.h"
+#include "statistics.h"
+
+#ifdef PF_STATS
+// This is defined within pf_buffermgr.cc
+extern StatisticsMgr *pStatisticsMgr;
+#endif
+
+//
+// Expect
+//
+// Desc: Check a value
+//
+inline void Expect(const char *psWhat, long long value, long long expected)
+{
+   std::cout << "  " << psWhat << ": " << value << "\n";
+   if (value != expected) {
+      std::cout << "Expected " << expected << "!\n";
+      exit(1);
+   }
+}
+
+//
+// ExpectStat
+//
+// Desc: Check a value counted with statistics (only with PF_STATS)
+//
+inline void ExpectStat(const char *psWhat, long long value, long long expected)
+{
+#ifdef PF_STATS
+   Expect(psWhat, value, expected);
+#endif
+}
+
+//
+// Counter
+//
+// Desc: Current value of a statistic (0 without PF_STATS)
+//
+inline int Counter(const char *psKey)
+{
+   int value = 0;
+#ifdef PF_STATS
+   int *piValue = pStatisticsMgr->Get(psKey);
+   value = piValue ? *piValue : 0;
+   delete piValue;
+#endif
+   return (value);
+}
+
+//
+// FillPage, CheckPage
+//
+// Desc: Fill a page with a pattern derived from its number and a seed,
+//       or check that it holds that pattern
+//
+inline void FillPage(char *pData, PageNum pageNum, int seed = 0)
+{
+   for (int i = 0; i < PF_PAGE_SIZE; i++)
+      pData[i] = (char)(pageNum * 31 + seed * 7 + i);
+}
+
+inline void CheckPage(const char *pData, PageNum pageNum, int seed = 0)
+{
+   for (int i = 0; i < PF_PAGE_SIZE; i++)
+      if (pData[i] != (char)(pageNum * 31 + seed * 7 + i)) {
+         std::cout << "Page " << pageNum << " has the wrong contents!\n";
+         exit(1);
+      }
+}
+
+//
+// WriteFile
+//
+// Desc: Create a file of numPages pages
+//
+inline RC WriteFile(PF_Manager &pfm, const char *fileName, int numPages)
+{
+   PF_FileHandle fh;
+   PF_PageHandle ph;
+   PageNum pageNum;
+   RC rc;
+
+   unlink(fileName);
+   if ((rc = pfm.CreateFile(fileName)) ||
+         (rc = pfm.OpenFile(fileName, fh)))
+      return (rc);
+   for (int i = 0; i < numPages; i++)
+      if ((rc = fh.AllocatePage(ph)) ||
+            (rc = ph.GetPageNum(pageNum)) ||
+            (rc = fh.MarkDirty(pageNum)) ||
+            (rc = fh.UnpinPage(pageNum)))
+         return (rc);
+   return (pfm.CloseFile(fh));
+}
+
+//
+// ReadPages
+//
+// Desc: Get and unpin pages 0 to numPages - 1 of a file
+//
+inline RC ReadPages(PF_FileHandle &fh, int numPages)
+{
+   PF_PageHandle ph;
+   RC rc;
+
+   for (PageNum i = 0; i < numPages; i++)
+      if ((rc = fh.GetThisPage(i, ph)) ||
+            (rc = fh.UnpinPage(i)))
+         return (rc);
+   return (0);
+}
+
+#endif
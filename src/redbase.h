@@ -74,7 +74,11 @@ enum CompOp {
 // Pin Strategy Hint
 //
 enum ClientHint {
-    NO_HINT                                     // default value
+    NO_HINT,                                    // default value
+    SEQUENTIAL,                                 // part of a scan
+    RANDOM,                                     // point access
+    ONE_SHOT,                                   // will not be used again
+    KEEP_HOT                                    // keep in the buffer pool
 };
 
 //
@@ -50,6 +50,94 @@ private:
     RID  rid;
 };
 
+//
+// RM_RecordView: a record read in place.  Its data points into the page
+// in the buffer, which stays pinned until the view is released, reads
+// another record or is destroyed.  Reading the next record of the same
+// page keeps the pin.  The data is only to be read (it is not aligned:
+// attributes are copied out of it), and views must be released before
+// their file is closed.
+//
+class RM_RecordView {
+    friend class RM_FileHandle;
+    friend class RM_FileScan;
+public:
+    RM_RecordView ();
+    ~RM_RecordView();                  // Releases the record
+
+    // Return the data of the record (valid until the view is released)
+    RC GetData(char *&pData) const;
+
+    // Return the RID associated with the record
+    RC GetRid (RID &rid) const;
+
+    // Unpin the page of the record; the view no longer refers to one
+    RC Release();
+
+private:
+    // Copy constructor
+    RM_RecordView  (const RM_RecordView &view);
+    // Overloaded =
+    RM_RecordView& operator=(const RM_RecordView &view);
+
+    // TRUE if the view has page pageNum of pfFileHandle pinned
+    int IsOn       (const PF_FileHandle &pfFileHandle, PageNum pageNum) const;
+    // Refer to a record of a pinned page, taking over the pin
+    void Set       (const PF_FileHandle &pfFileHandle, char *pPage,
+                    const RID &rid, int offset);
+
+    const PF_FileHandle *pPfFileHandle;  // file of the page pinned, NULL
+                                         //   if none
+    char *pPage;                         // the page
+    char *pData;                         // the record in it
+    RID  rid;
+};
+
+//
+// RM_RecordBatch: records of a file scan read a page or more at a time
+// (RM_FileScan::GetNextBatch), in place as with RM_RecordView.  The
+// pages of the records stay pinned, once each, until the batch is
+// released or reads the next records.
+//
+class RM_RecordBatch {
+    friend class RM_FileScan;
+public:
+    RM_RecordBatch ();
+    ~RM_RecordBatch();                 // Releases the records
+
+    // # of records in the batch
+    int GetNumRecs() const;
+
+    // Return the data (not aligned) and the RID of record i of the batch,
+    // 0 <= i < GetNumRecs()
+    RC GetData(int i, char *&pData) const;
+    RC GetRid (int i, RID &rid) const;
+
+    // Unpin the pages of the records; the batch is then empty
+    RC Release();
+
+private:
+    // Copy constructor
+    RM_RecordBatch  (const RM_RecordBatch &batch);
+    // Overloaded =
+    RM_RecordBatch& operator=(const RM_RecordBatch &batch);
+
+    // Add a record of the last page added, or a page, making room
+    void AddRec    (char *pData, const RID &rid);
+    void AddPage   (const PF_FileHandle &pfFileHandle, PageNum pageNum,
+                    char *pPage);
+
+    const PF_FileHandle *pPfFileHandle;  // file of the pages, NULL if none
+    PageNum *pPages;                     // pages pinned
+    int     numPages;
+    int     maxPages;
+    char    *pLastPage;                  // the last one
+    char    **ppData;                    // the records in them
+    RID     *pRids;
+    int     numRecs;
+    int     maxRecs;
+};
+
 //
 // RM_FileHdr: Header structure for files
 //
@@ -71,8 +159,9 @@ public:
     RM_FileHandle ();
     ~RM_FileHandle();
 
-    // Given a RID, return the record
+    // Given a RID, return the record: a copy, or a view of it in place
     RC GetRec     (const RID &rid, RM_Record &rec) const;
+    RC GetRec     (const RID &rid, RM_RecordView &view) const;
 
     RC InsertRec  (const char *pData, RID &rid);       // Insert a new record
 
@@ -94,11 +183,40 @@ private:
     void SetBitmap (char *map, int idx) const;
     void ClrBitmap (char *map, int idx) const;
 
+    // Copy the file header to the header page
+    RC WriteHdr    ();
+
+    // Pin page pageNum, or take over the pin of view if it is on it
+    RC PinPage     (PageNum pageNum, RM_RecordView &view, char *&pData,
+                    ClientHint hint = NO_HINT) const;
+
     PF_FileHandle pfFileHandle;
     RM_FileHdr fileHdr;                                   // file header
     int bHdrChanged;                                      // dirty flag for file hdr
 };
 
+//
+// RM_ScanKernel: instruction set used to evaluate the condition of a
+// scan, many slots at a time (see rm_kernels.cc)
+//
+enum RM_ScanKernel {
+    RM_KERNEL_SCALAR,
+    RM_KERNEL_SSE42,
+    RM_KERNEL_AVX2,
+    RM_KERNEL_BEST                               // best one the CPU has
+};
+
+// Set it for the scans opened from now on; one the CPU does not have is
+// replaced by the best one it has.  Returns the one set.
+RM_ScanKernel RM_SetScanKernel(RM_ScanKernel kernel);
+
+// Evaluate a condition over numSlots slots whose attribute is at pAttr,
+// pAttr+recordSize, ...; bit i of the result is set if slot i matches
+typedef unsigned long long (*RM_MatchKernel)(const char *pAttr,
+                                             int recordSize, int numSlots,
+                                             int attrLength, CompOp compOp,
+                                             const void *value);
+
 //
 // RM_FileScan: condition-based scan of records in the file
 //
@@ -115,6 +233,11 @@ public:
                   void       *value,
                   ClientHint pinHint = NO_HINT); // Initialize a file scan
     RC GetNextRec(RM_Record &rec);               // Get next matching record
+    RC GetNextRec(RM_RecordView &view);          //   in place
+    // Get the next matching records, up to maxRows, in place: those of
+    // the current page, and of the next pages as long as there is room
+    // (at most RM_BATCH_PAGES pages are pinned by a batch)
+    RC GetNextBatch(RM_RecordBatch &batch, int maxRows);
     RC CloseScan ();                             // Close the scan
 
 private:
@@ -124,6 +247,11 @@ private:
     RM_FileScan&  operator=(const RM_FileScan &fileScan);
 
     void FindNextRecInCurPage(char *pData);
+    // Slots from first on (at most RM_KERNEL_SLOTS of them) that are in
+    // use and match, as bits from bit 0
+    unsigned long long MatchSlots(char *pData, int first, int numSlots) const;
+    // Pin the page after curPageNum and make it current
+    RC FetchNextPage(char *&pData);
 
     int bScanOpen;
     PageNum curPageNum;
@@ -136,6 +264,7 @@ private:
     CompOp compOp;
     void *value;
     ClientHint pinHint;
+    RM_MatchKernel pKernel;                      // NULL if compOp is NO_OP
 };
 
 //
@@ -146,7 +275,8 @@ public:
     RM_Manager    (PF_Manager &pfm);
     ~RM_Manager   ();
 
-    RC CreateFile (const char *fileName, int recordSize);
+    RC CreateFile (const char *fileName, int recordSize,
+                   int pageSize = PF_PAGE_SIZE, int bCompress = FALSE);
     RC DestroyFile(const char *fileName);
     RC OpenFile   (const char *fileName, RM_FileHandle &fileHandle);
 
@@ -177,7 +307,8 @@ void RM_PrintError(RC rc);
 #define RM_SCANOPEN        (START_RM_WARN + 8) // scan is open
 #define RM_CLOSEDSCAN      (START_RM_WARN + 9) // scan is closed
 #define RM_CLOSEDFILE      (START_RM_WARN + 10)// file handle is closed
-#define RM_LASTWARN        RM_CLOSEDFILE
+#define RM_INVALIDBATCH    (START_RM_WARN + 11)// invalid batch size or index
+#define RM_LASTWARN        RM_INVALIDBATCH
 
 #define RM_EOF             PF_EOF              // work-around for rm_test
 
@@ -25,7 +25,8 @@ static char *RM_WarnMsg[] = {
   (char*)"null pointer",
   (char*)"scan open",
   (char*)"scan closed",
-  (char*)"file closed"
+  (char*)"file closed",
+  (char*)"invalid batch size or record number"
 };
 
 // 
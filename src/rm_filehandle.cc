@@ -104,6 +104,90 @@ err_return:
    return (rc);
 }
 
+//
+// GetRec
+//
+// Desc: Given a RID, return a view of the record in place.  Its page
+//       stays pinned until the view is released (or reads another
+//       record, of another page).
+// In:   rid -
+// Out:  view - refers to the record, or to none on error
+// Ret:  RM return code
+//
+RC RM_FileHandle::GetRec(const RID &rid, RM_RecordView &view) const
+{
+   RC rc;
+   PageNum pageNum;
+   SlotNum slotNum;
+   char *pData;
+
+   // Extract page and slot number from rid
+   if ((rc = rid.GetPageNum(pageNum)) ||
+       (rc = rid.GetSlotNum(slotNum)))
+      return (rc);
+
+   // Sanity Check: slotNum bound check
+   if (slotNum >= fileHdr.numRecordsPerPage || slotNum < 0) {
+      view.Release();
+      return (RM_INVALIDSLOTNUM);
+   }
+
+   // Get the page where rid points (the view may have it already)
+   if ((rc = PinPage(pageNum, view, pData)))
+      return (rc);
+
+   // Sanity Check: a record corresponding to rid should exist
+   if (!GetBitmap(pData + sizeof(RM_PageHdr), slotNum)) {
+      pfFileHandle.UnpinPage(pageNum);
+      return (RM_RECORDNOTFOUND);
+   }
+
+   // The view keeps the page pinned
+   view.Set(pfFileHandle, pData, rid,
+            fileHdr.pageHeaderSize + slotNum * fileHdr.recordSize);
+
+   // Return ok
+   return (0);
+}
+
+//
+// PinPage
+//
+// Desc: Internal.  Pin a page for a view.  If the view has it pinned
+//       already, its pin is taken over; otherwise the view is released.
+//       Either way, the view refers to no record afterwards and the
+//       caller has to unpin the page (or hand it to a view).
+// In:   pageNum - the page
+//       view - view that may have it
+//       hint - how the page is used
+// Out:  pData - the data of the page
+// Ret:  PF return code
+//
+RC RM_FileHandle::PinPage(PageNum pageNum, RM_RecordView &view,
+                          char *&pData, ClientHint hint) const
+{
+   PF_PageHandle pageHandle;
+   RC rc;
+
+   if (view.IsOn(pfFileHandle, pageNum)) {
+      pData = view.pPage;
+      view.pPfFileHandle = NULL;
+      view.pPage = view.pData = NULL;
+      return (0);
+   }
+
+   if ((rc = view.Release()) ||
+       (rc = pfFileHandle.GetThisPage(pageNum, pageHandle, hint)))
+      return (rc);
+   if ((rc = pageHandle.GetData(pData))) {
+      pfFileHandle.UnpinPage(pageNum);
+      return (rc);
+   }
+
+   // Return ok
+   return (0);
+}
+
 //
 // InsertRec
 //
@@ -120,6 +204,8 @@ RC RM_FileHandle::InsertRec(const char *pRecordData, RID &rid)
    PF_PageHandle pageHandle;
    char *pData;
    RID *pRid;
+   PageNum oldFirstFree = fileHdr.firstFree;
+   int recOffset;
 
    // Sanity Check: pRecordData must not be NULL
    if (pRecordData == NULL)
@@ -148,7 +234,7 @@ RC RM_FileHandle::InsertRec(const char *pRecordData, RID &rid)
       ((RM_PageHdr *)pData)->nextFree = RM_PAGE_LIST_END;
 
       // Mark the page dirty since we changed the next pointer
-      if (rc = pfFileHandle.MarkDirty(pageNum))
+      if (rc = pfFileHandle.LogPage(pageNum, 0, sizeof(RM_PageHdr)))
          // Should not happen
          goto err_unpin;
 
@@ -188,8 +274,8 @@ RC RM_FileHandle::InsertRec(const char *pRecordData, RID &rid)
    delete pRid;
 
    // Copy the given record data to the buffer pool
-   memcpy(pData + fileHdr.pageHeaderSize + slotNum * fileHdr.recordSize, 
-          pRecordData, fileHdr.recordSize);
+   recOffset = fileHdr.pageHeaderSize + slotNum * fileHdr.recordSize;
+   memcpy(pData + recOffset, pRecordData, fileHdr.recordSize);
 
    // Set bit
    SetBitmap(pData + sizeof(RM_PageHdr), slotNum);
@@ -207,7 +293,8 @@ RC RM_FileHandle::InsertRec(const char *pRecordData, RID &rid)
    }
 
    // Mark the header page as dirty because we changed bitmap at least
-   if (rc = pfFileHandle.MarkDirty(pageNum))
+   if ((rc = pfFileHandle.LogPage(pageNum, 0, fileHdr.pageHeaderSize)) ||
+       (rc = pfFileHandle.LogPage(pageNum, recOffset, fileHdr.recordSize)))
       // Should not happen
       goto err_unpin;
 
@@ -216,6 +303,10 @@ RC RM_FileHandle::InsertRec(const char *pRecordData, RID &rid)
       // Should not happen
       goto err_return;
 
+   // Keep the header page up to date if the free page list changed
+   if (fileHdr.firstFree != oldFirstFree && (rc = WriteHdr()))
+      goto err_return;
+
    // Return ok
    return (0);
 
@@ -241,6 +332,8 @@ RC RM_FileHandle::DeleteRec(const RID &rid)
    SlotNum slotNum;
    PF_PageHandle pageHandle;
    char *pData;
+   PageNum oldFirstFree = fileHdr.firstFree;
+   int recOffset;
 
    // Extract page number from rid
    if (rc = rid.GetPageNum(pageNum))
@@ -279,8 +372,8 @@ RC RM_FileHandle::DeleteRec(const RID &rid)
    ClrBitmap(pData + sizeof(RM_PageHdr), slotNum);
    
    // Not necessary
-   memset(pData + fileHdr.pageHeaderSize + slotNum * fileHdr.recordSize, 
-          '\0', fileHdr.recordSize);
+   recOffset = fileHdr.pageHeaderSize + slotNum * fileHdr.recordSize;
+   memset(pData + recOffset, '\0', fileHdr.recordSize);
 
    // Find an empty slot
    for (slotNum = 0; slotNum < fileHdr.numRecordsPerPage; slotNum++)
@@ -295,7 +388,7 @@ RC RM_FileHandle::DeleteRec(const RID &rid)
       bHdrChanged = TRUE;
       
       // Mark the header page as dirty
-      if (rc = pfFileHandle.MarkDirty(pageNum))
+      if (rc = pfFileHandle.LogPage(pageNum, 0, fileHdr.pageHeaderSize))
          // Should not happen
          goto err_return;
       
@@ -304,6 +397,10 @@ RC RM_FileHandle::DeleteRec(const RID &rid)
          // Should not happen
          goto err_return;
 
+      // Keep the header page up to date
+      if (fileHdr.firstFree != oldFirstFree && (rc = WriteHdr()))
+         goto err_return;
+
       // Call PF_FileHandle.DisposePage()
       return pfFileHandle.DisposePage(pageNum);
    }
@@ -316,7 +413,8 @@ RC RM_FileHandle::DeleteRec(const RID &rid)
    }
 
    // Mark the header page as dirty because we changed bitmap at least
-   if (rc = pfFileHandle.MarkDirty(pageNum))
+   if ((rc = pfFileHandle.LogPage(pageNum, 0, fileHdr.pageHeaderSize)) ||
+       (rc = pfFileHandle.LogPage(pageNum, recOffset, fileHdr.recordSize)))
       // Should not happen
       goto err_unpin;
 
@@ -324,6 +422,10 @@ RC RM_FileHandle::DeleteRec(const RID &rid)
    if (rc = pfFileHandle.UnpinPage(pageNum))
       // Should not happen
       goto err_return;
+
+   // Keep the header page up to date if the free page list changed
+   if (fileHdr.firstFree != oldFirstFree && (rc = WriteHdr()))
+      goto err_return;
  
    // Return ok
    return (0);
@@ -408,7 +510,9 @@ RC RM_FileHandle::UpdateRec(const RM_Record &rec)
           fileHdr.recordSize);
 
    // Mark the header page as dirty
-   if (rc = pfFileHandle.MarkDirty(pageNum))
+   if (rc = pfFileHandle.LogPage(pageNum, fileHdr.pageHeaderSize
+                                 + slotNum * fileHdr.recordSize,
+                                 fileHdr.recordSize))
       // Should not happen
       goto err_unpin;
 
@@ -428,6 +532,46 @@ err_return:
    return (rc);
 }
 
+//
+// WriteHdr
+//
+// Desc: Internal.  Copy the file header to the header page (logging the
+//       change), so that the free page list on disk goes with the pages
+//       it links.  It stays changed for ForcePages and CloseFile.
+// Ret:  PF return code
+//
+RC RM_FileHandle::WriteHdr()
+{
+   RC rc;
+   PF_PageHandle pageHandle;
+   char *pData;
+
+   // Get the header page
+   if (rc = pfFileHandle.GetThisPage(RM_HEADER_PAGE_NUM, pageHandle))
+      goto err_return;
+
+   // Get a pointer where header information will be written
+   if (rc = pageHandle.GetData(pData))
+      // Should not happen
+      goto err_unpin;
+
+   // Write the file header (to the buffer pool)
+   memcpy(pData, &fileHdr, sizeof(fileHdr));
+   if (rc = pfFileHandle.LogPage(RM_HEADER_PAGE_NUM, 0, sizeof(fileHdr)))
+      // Should not happen
+      goto err_unpin;
+
+   // Unpin the header page
+   return (pfFileHandle.UnpinPage(RM_HEADER_PAGE_NUM));
+
+   // Recover from inconsistent state due to unexpected error
+err_unpin:
+   pfFileHandle.UnpinPage(RM_HEADER_PAGE_NUM);
+err_return:
+   // Return error
+   return (rc);
+}
+
 //
 // ForcePages
 //
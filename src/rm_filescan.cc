@@ -25,6 +25,7 @@ RM_FileScan::RM_FileScan()
    compOp = NO_OP;
    value = NULL;
    pinHint = NO_HINT;
+   pKernel = NULL;
 }
 
 // 
@@ -48,7 +49,9 @@ RM_FileScan::~RM_FileScan()
 //       _compOp     - EQ_OP|LT_OP|GT_OP|LE_OP|GE_OP|NE_OP|NO_OP
 //       _value      - points to the value which will be compared with
 //                     the given attribute
-//       _pinHint    - not implemented yet
+//       _pinHint    - buffer pool hint for the pages of the file; a file
+//                     scan reads every page once, so NO_HINT is taken
+//                     as SEQUENTIAL
 // Ret:  RM_SCANOPEN, RM_VALUENULL, RM_INVALIDATTR, RM_CLOSEDFILE
 //
 RC RM_FileScan::OpenScan(const RM_FileHandle &fileHandle, 
@@ -124,7 +127,9 @@ RC RM_FileScan::OpenScan(const RM_FileHandle &fileHandle,
    attrOffset  = _attrOffset;
    compOp      = _compOp;
    value       =  _value;
-   pinHint     = _pinHint;
+   pinHint     = (_pinHint == NO_HINT) ? SEQUENTIAL : _pinHint;
+   pKernel     = (_compOp == NO_OP) ? NULL :
+      RM_ChooseKernel(_attrType, _attrLength);
 
    // Set local state variables
    bScanOpen = TRUE;
@@ -162,7 +167,8 @@ RC RM_FileScan::GetNextRec(RM_Record &rec)
    if (curSlotNum == pFileHandle->fileHdr.numRecordsPerPage) {
 repeat:
       // Get next page
-      if (rc = pFileHandle->pfFileHandle.GetNextPage(curPageNum, pageHandle))
+      if (rc = pFileHandle->pfFileHandle.GetNextPage(curPageNum, pageHandle,
+            pinHint))
          // Test: EOF
          goto err_return;
 
@@ -177,7 +183,8 @@ repeat:
    }
    // We didn't process the whole page in the previous GetNextRec() call
    else {
-      if (rc = pFileHandle->pfFileHandle.GetThisPage(curPageNum, pageHandle))
+      if (rc = pFileHandle->pfFileHandle.GetThisPage(curPageNum, pageHandle,
+            pinHint))
          if (rc == PF_INVALIDPAGE)
             // We can get PF_INVALIDPAGE if curPageNum was disposed
             goto repeat;
@@ -242,64 +249,292 @@ err_return:
 }
 
 //
-// FineNextRecInCurPage
+// GetNextRec
+//
+// Desc: Retrieve a view of the next record that satisfies the scan
+//       condition, in place.  Its page stays pinned in the view; when the
+//       view was on the current page, its pin is kept for the next
+//       record, so that a page is pinned once for all of its records.
+// Out:  view - refers to the next matching record, or to none at the end
+//       or on error
+// Ret:  RM or PF return code
 //
-// Desc: Iterates slots in the current page (until hit or end)
+RC RM_FileScan::GetNextRec(RM_RecordView &view)
+{
+   RC rc;
+   char *pData;
+   int bPinned = FALSE;
+
+   // Sanity Check: 'this' must be open
+   if (!bScanOpen) {
+      view.Release();
+      return (RM_CLOSEDSCAN);
+   }
+
+   // Sanity Check: fileHandle must be open
+   const RM_FileHdr &fileHdr = pFileHandle->fileHdr;
+   if (fileHdr.recordSize == 0) { // a little tricky here
+      view.Release();
+      return (RM_CLOSEDFILE);
+   }
+
+   // Go on in the current page if there is more in it
+   if (curSlotNum < fileHdr.numRecordsPerPage) {
+      rc = pFileHandle->PinPage(curPageNum, view, pData, pinHint);
+      if (rc == PF_INVALIDPAGE)
+         // curPageNum was disposed
+         curSlotNum = fileHdr.numRecordsPerPage;
+      else if (rc)
+         return (rc);
+      else
+         bPinned = TRUE;
+   }
+   else if ((rc = view.Release()))
+      return (rc);
+
+   for (;;) {
+      if (bPinned) {
+         // Find the next record based on scan condition
+         FindNextRecInCurPage(pData);
+         if (curSlotNum < fileHdr.numRecordsPerPage)
+            break;
+
+         // No HIT in this page, go to next page
+         if ((rc = pFileHandle->pfFileHandle.UnpinPage(curPageNum)))
+            return (rc);
+         bPinned = FALSE;
+      }
+
+      if ((rc = FetchNextPage(pData)))
+         // Test: EOF
+         return (rc);
+      bPinned = TRUE;
+   }
+
+   // HIT: the view keeps the page pinned
+   view.Set(pFileHandle->pfFileHandle, pData, RID(curPageNum, curSlotNum),
+            fileHdr.pageHeaderSize + curSlotNum * fileHdr.recordSize);
+   curSlotNum++;
+
+   // Return ok
+   return (0);
+}
+
+//
+// GetNextBatch
+//
+// Desc: Retrieve the next records that satisfy the scan condition, up to
+//       maxRows, in place.  The rest of the current page is read first,
+//       then the next pages, each pinned once, until there are maxRows
+//       records or RM_BATCH_PAGES pages in the batch (pages without a
+//       match are not kept).  When the batch has the current page pinned
+//       still, its pin is taken over.
+// In:   maxRows - most records to retrieve
+// Out:  batch - the records, or none at the end or on error
+// Ret:  RM_EOF if there is no more record, RM_INVALIDBATCH if maxRows is
+//       less than 1, or other RM or PF return code
+//
+RC RM_FileScan::GetNextBatch(RM_RecordBatch &batch, int maxRows)
+{
+   RC rc;
+   char *pData;
+   int bPinned = FALSE;
+
+   // Sanity Check: 'this' must be open
+   if (!bScanOpen) {
+      batch.Release();
+      return (RM_CLOSEDSCAN);
+   }
+
+   // Sanity Check: fileHandle must be open
+   const RM_FileHdr &fileHdr = pFileHandle->fileHdr;
+   const PF_FileHandle &pfFileHandle = pFileHandle->pfFileHandle;
+   if (fileHdr.recordSize == 0) { // a little tricky here
+      batch.Release();
+      return (RM_CLOSEDFILE);
+   }
+
+   if (maxRows < 1) {
+      batch.Release();
+      return (RM_INVALIDBATCH);
+   }
+
+   // Go on in the current page if there is more in it
+   if (curSlotNum < fileHdr.numRecordsPerPage &&
+       batch.pPfFileHandle == &pfFileHandle && batch.numPages > 0 &&
+       batch.pPages[batch.numPages - 1] == curPageNum) {
+      pData = batch.pLastPage;
+      batch.numPages--;
+      bPinned = TRUE;
+   }
+   if ((rc = batch.Release())) {
+      if (bPinned)
+         pfFileHandle.UnpinPage(curPageNum);
+      return (rc);
+   }
+   if (!bPinned && curSlotNum < fileHdr.numRecordsPerPage) {
+      PF_PageHandle pageHandle;
+
+      rc = pfFileHandle.GetThisPage(curPageNum, pageHandle, pinHint);
+      if (rc == PF_INVALIDPAGE)
+         // curPageNum was disposed
+         curSlotNum = fileHdr.numRecordsPerPage;
+      else if (rc)
+         return (rc);
+      else if ((rc = pageHandle.GetData(pData))) {
+         pfFileHandle.UnpinPage(curPageNum);
+         return (rc);
+      }
+      else
+         bPinned = TRUE;
+   }
+
+   for (;;) {
+      if (bPinned) {
+         int numBefore = batch.numRecs;
+
+         // Take the matching records of the page while there is room,
+         // RM_KERNEL_SLOTS slots at a time
+         while (curSlotNum < fileHdr.numRecordsPerPage &&
+                batch.numRecs < maxRows) {
+            int numSlots = fileHdr.numRecordsPerPage - curSlotNum;
+            if (numSlots > RM_KERNEL_SLOTS)
+               numSlots = RM_KERNEL_SLOTS;
+            unsigned long long bits = MatchSlots(pData, curSlotNum,
+                                                 numSlots);
+
+            for ( ; bits && batch.numRecs < maxRows; bits &= bits - 1) {
+               SlotNum slotNum = curSlotNum + __builtin_ctzll(bits);
+               if (batch.numRecs == numBefore)
+                  batch.AddPage(pfFileHandle, curPageNum, pData);
+               batch.AddRec(pData + fileHdr.pageHeaderSize
+                            + slotNum * fileHdr.recordSize,
+                            RID(curPageNum, slotNum));
+            }
+
+            // Out of room: go on from the next match next time
+            curSlotNum = bits ? curSlotNum + __builtin_ctzll(bits) :
+               curSlotNum + numSlots;
+         }
+
+         // No HIT in this page: the batch does not keep it
+         if (batch.numRecs == numBefore &&
+             (rc = pfFileHandle.UnpinPage(curPageNum)))
+            goto err_release;
+         bPinned = FALSE;
+
+         if (batch.numRecs == maxRows || batch.numPages == RM_BATCH_PAGES)
+            break;
+      }
+
+      // At the end, the records so far are returned, and RM_EOF next time
+      if ((rc = FetchNextPage(pData))) {
+         if (rc == RM_EOF && batch.numRecs > 0)
+            break;
+         goto err_release;
+      }
+      bPinned = TRUE;
+   }
+
+   // Return ok
+   return (0);
+
+err_release:
+   batch.Release();
+   return (rc);
+}
+
+//
+// FetchNextPage
+//
+// Desc: Pin the page that follows the current page, and make it the
+//       current page, from its first slot
+// Out:  pData - the data of the page
+// Ret:  PF_EOF if there is none, or other PF return code
+//
+RC RM_FileScan::FetchNextPage(char *&pData)
+{
+   RC rc;
+   PF_PageHandle pageHandle;
+
+   if ((rc = pFileHandle->pfFileHandle.GetNextPage(curPageNum, pageHandle,
+         pinHint)))
+      return (rc);
+
+   // Update curPageNum
+   if ((rc = pageHandle.GetPageNum(curPageNum)) ||
+       (rc = pageHandle.GetData(pData)))
+      // Should not happen
+      return (rc);
+
+   // Reset curSlotNum
+   curSlotNum = 0;
+
+   // Return ok
+   return (0);
+}
+
+//
+// FindNextRecInCurPage
+//
+// Desc: Iterates slots in the current page (until hit or end), evaluating
+//       the scan condition over RM_KERNEL_SLOTS slots at a time
 // In:   pData - points a data page buffer
 //
 void RM_FileScan::FindNextRecInCurPage(char *pData)
 {
-   for ( ; curSlotNum < pFileHandle->fileHdr.numRecordsPerPage; curSlotNum++) {
-      float cmp;
-      int i;
-      float f;
-
-      // Skip empty slots
-      if (!pFileHandle->GetBitmap(pData + sizeof(RM_PageHdr), curSlotNum))
-         continue;
-      
-      // Hit if NO_OP
-      if (compOp == NO_OP)
-         break;
-
-      // Do comparison according to the attribute type
-      switch (attrType) {
-      case INT:
-         memcpy(&i,
-                pData + pFileHandle->fileHdr.pageHeaderSize
-                + curSlotNum * pFileHandle->fileHdr.recordSize 
-                + attrOffset,
-                sizeof(int));
-         cmp = i - *((int *)value);
-         break;
+   const int numRecordsPerPage = pFileHandle->fileHdr.numRecordsPerPage;
 
-      case FLOAT:
-         memcpy(&f,
-                pData + pFileHandle->fileHdr.pageHeaderSize
-                + curSlotNum * pFileHandle->fileHdr.recordSize 
-                + attrOffset,
-                sizeof(float));
-         cmp = f - *((float *)value);
-         break;
+   while (curSlotNum < numRecordsPerPage) {
+      int numSlots = numRecordsPerPage - curSlotNum;
+      if (numSlots > RM_KERNEL_SLOTS)
+         numSlots = RM_KERNEL_SLOTS;
 
-      case STRING:
-         cmp = memcmp(pData + pFileHandle->fileHdr.pageHeaderSize
-                      + curSlotNum * pFileHandle->fileHdr.recordSize 
-                      + attrOffset,
-                      value,
-                      attrLength);
-         break;
+      unsigned long long bits = MatchSlots(pData, curSlotNum, numSlots);
+      if (bits) {
+         curSlotNum += __builtin_ctzll(bits);
+         return;
       }
+      curSlotNum += numSlots;
+   }
+}
 
-      // Make decision according to comparison operator
-      if ((compOp == EQ_OP && cmp == 0)
-          || (compOp == LT_OP && cmp < 0)
-          || (compOp == GT_OP && cmp > 0)
-          || (compOp == LE_OP && cmp <= 0)
-          || (compOp == GE_OP && cmp >= 0)
-          || (compOp == NE_OP && cmp != 0))
-         break;
+//
+// MatchSlots
+//
+// Desc: Find the slots in use that satisfy the scan condition among
+//       numSlots slots of the current page from first on
+// In:   pData - points a data page buffer
+//       first - first slot
+//       numSlots - # of slots, at most RM_KERNEL_SLOTS
+// Ret:  bit i set if slot first+i is a hit
+//
+unsigned long long RM_FileScan::MatchSlots(char *pData, int first,
+                                           int numSlots) const
+{
+   const unsigned char *map =
+      (const unsigned char *)pData + sizeof(RM_PageHdr);
+   unsigned long long bits = 0;
+
+   // Slots in use, from the bitmap a byte at a time
+   for (int i = 0; i < numSlots; ) {
+      int idx = first + i;
+      int numBits = 8 - idx % 8;
+      if (numBits > numSlots - i)
+         numBits = numSlots - i;
+      bits |= (unsigned long long)((map[idx / 8] >> (idx % 8))
+                                   & ((1 << numBits) - 1)) << i;
+      i += numBits;
    }
+
+   // Those that match, unless any slot in use does (NO_OP)
+   if (bits && pKernel != NULL)
+      bits &= pKernel(pData + pFileHandle->fileHdr.pageHeaderSize
+                      + first * pFileHandle->fileHdr.recordSize + attrOffset,
+                      pFileHandle->fileHdr.recordSize, numSlots, attrLength,
+                      compOp, value);
+
+   return (bits);
 }
 
 //
@@ -326,6 +561,7 @@ RC RM_FileScan::CloseScan()
    compOp = NO_OP;
    value = NULL;
    pinHint = NO_HINT;
+   pKernel = NULL;
 
    // Return ok
    return (0);
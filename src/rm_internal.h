@@ -16,6 +16,8 @@
 // Constants and defines
 //
 const int RM_HEADER_PAGE_NUM = 0;
+const int RM_BATCH_PAGES = 8;      // Most pages pinned by an RM_RecordBatch
+const int RM_KERNEL_SLOTS = 64;    // Most slots evaluated by a kernel at once
 
 #define RM_PAGE_LIST_END  -1       // end of list of free pages
 #define RM_PAGE_FULL      -2       // all slots in the page are full
@@ -27,4 +29,9 @@ struct RM_PageHdr {
    PageNum nextFree;
 };
 
+//
+// Kernel of the chosen instruction set for a condition (rm_kernels.cc)
+//
+RM_MatchKernel RM_ChooseKernel(AttrType attrType, int attrLength);
+
 #endif
@@ -0,0 +1,472 @@
+//
+// File:        rm_kernels.cc
+// Description: Kernels evaluating the condition of a file scan
+//
+// A kernel evaluates the condition of a scan over up to RM_KERNEL_SLOTS
+// consecutive slots of a page at once, whether they are in use or not,
+// and returns a bit for each: the scan ANDs it with the bitmap of the
+// slots in use.  There is a kernel for each attribute type and each
+// instruction set: plain C++, SSE4.2 (four slots at a time) and AVX2
+// (eight, gathered with one instruction).  The SIMD ones are compiled
+// for their instruction set whatever the build flags are, and only used
+// if the CPU has it.
+//
+// INT and FLOAT attributes are compared as such.  STRING attributes are
+// compared on their first 4 bytes, as big-endian unsigned ints; only the
+// slots whose prefix is that of the value are compared further (with
+// memcmp).  Shorter strings are left to the plain kernel.
+//
+
+#include "rm_internal.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RM_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+typedef unsigned long long RM_Bits;
+
+//
+// Kernel used by the scans opened from now on
+//
+static RM_ScanKernel rmScanKernel = RM_KERNEL_BEST;
+
+//
+// RM_AllBits - the bits of numSlots slots
+//
+static inline RM_Bits RM_AllBits(int numSlots)
+{
+   return (numSlots >= 64) ? ~(RM_Bits)0 : (((RM_Bits)1 << numSlots) - 1);
+}
+
+//
+// RM_Decide
+//
+// Desc: Make decision according to comparison operator, for all of the
+//       slots at once
+// In:   lt, eq, gt - slots whose attribute is less than, equal to and
+//       greater than the value (none of them: unordered)
+//       numSlots - # of slots
+//       compOp - comparison operator
+// Ret:  slots that satisfy the condition
+//
+static inline RM_Bits RM_Decide(RM_Bits lt, RM_Bits eq, RM_Bits gt,
+                                int numSlots, CompOp compOp)
+{
+   switch (compOp) {
+   case EQ_OP: return (eq);
+   case LT_OP: return (lt);
+   case GT_OP: return (gt);
+   case LE_OP: return (lt | eq);
+   case GE_OP: return (gt | eq);
+   case NE_OP: return (~eq & RM_AllBits(numSlots));
+   default:    return (RM_AllBits(numSlots));
+   }
+}
+
+//
+// RM_Prefix - first 4 bytes of a string as a big-endian unsigned int
+//
+static inline unsigned int RM_Prefix(const char *pString)
+{
+   const unsigned char *p = (const unsigned char *)pString;
+   return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) |
+      ((unsigned int)p[2] << 8) | (unsigned int)p[3];
+}
+
+//
+// RM_RefineStrings
+//
+// Desc: Compare further the strings whose prefix is that of the value
+// In:   pAttr - attribute of the first slot
+//       recordSize - bytes from one slot to the next
+//       attrLength - length of the strings
+//       value - the value
+//       lt, eq - slots whose prefix is less than and equal to that of
+//       the value
+// Out:  lt, eq - slots whose string is less than and equal to the value
+//
+static void RM_RefineStrings(const char *pAttr, int recordSize,
+                             int attrLength, const char *value,
+                             RM_Bits &lt, RM_Bits &eq)
+{
+   RM_Bits ties = eq;
+
+   if (attrLength <= 4)
+      return;
+   while (ties) {
+      int i = __builtin_ctzll(ties);
+      int cmp = memcmp(pAttr + i * recordSize + 4, value + 4,
+                       attrLength - 4);
+
+      ties &= ties - 1;
+      if (cmp < 0)
+         lt |= (RM_Bits)1 << i;
+      if (cmp != 0)
+         eq &= ~((RM_Bits)1 << i);
+   }
+}
+
+//------------------------------------------------------------------------------
+// Plain kernels
+//------------------------------------------------------------------------------
+
+static RM_Bits RM_MatchInt(const char *pAttr, int recordSize, int numSlots,
+                           int attrLength, CompOp compOp, const void *value)
+{
+   RM_Bits lt = 0, eq = 0, gt = 0;
+   int v, a;
+
+   memcpy(&v, value, sizeof(int));
+   for (int i = 0; i < numSlots; i++, pAttr += recordSize) {
+      memcpy(&a, pAttr, sizeof(int));
+      lt |= (RM_Bits)(a < v) << i;
+      eq |= (RM_Bits)(a == v) << i;
+      gt |= (RM_Bits)(a > v) << i;
+   }
+   return (RM_Decide(lt, eq, gt, numSlots, compOp));
+}
+
+static RM_Bits RM_MatchFloat(const char *pAttr, int recordSize, int numSlots,
+                             int attrLength, CompOp compOp, const void *value)
+{
+   RM_Bits lt = 0, eq = 0, gt = 0;
+   float v, a;
+
+   memcpy(&v, value, sizeof(float));
+   for (int i = 0; i < numSlots; i++, pAttr += recordSize) {
+      memcpy(&a, pAttr, sizeof(float));
+      lt |= (RM_Bits)(a < v) << i;
+      eq |= (RM_Bits)(a == v) << i;
+      gt |= (RM_Bits)(a > v) << i;
+   }
+   return (RM_Decide(lt, eq, gt, numSlots, compOp));
+}
+
+static RM_Bits RM_MatchString(const char *pAttr, int recordSize,
+                              int numSlots, int attrLength, CompOp compOp,
+                              const void *value)
+{
+   RM_Bits lt = 0, eq = 0, gt = 0;
+
+   for (int i = 0; i < numSlots; i++, pAttr += recordSize) {
+      int cmp = memcmp(pAttr, value, attrLength);
+      lt |= (RM_Bits)(cmp < 0) << i;
+      eq |= (RM_Bits)(cmp == 0) << i;
+      gt |= (RM_Bits)(cmp > 0) << i;
+   }
+   return (RM_Decide(lt, eq, gt, numSlots, compOp));
+}
+
+#ifdef RM_KERNEL_X86
+
+//------------------------------------------------------------------------------
+// SSE4.2 kernels: four slots at a time, loaded one by one
+//------------------------------------------------------------------------------
+
+//
+// RM_CompareKeysSSE42
+//
+// Desc: Compare 4-byte keys of the slots with that of the value: ints,
+//       or (bString) string prefixes, as big-endian unsigned ints
+// Out:  lt, eq - slots whose key is less than and equal to the value's
+//
+__attribute__((target("sse4.2")))
+static void RM_CompareKeysSSE42(const char *pAttr, int recordSize,
+                                int numSlots, int v, int bString,
+                                RM_Bits &lt, RM_Bits &eq)
+{
+   const __m128i swap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                                      11, 10, 9, 8, 15, 14, 13, 12);
+   const __m128i bias = _mm_set1_epi32(bString ? (int)0x80000000 : 0);
+   const __m128i vv = _mm_xor_si128(_mm_set1_epi32(v), bias);
+   int k[4], i;
+
+   lt = eq = 0;
+   for (i = 0; i + 4 <= numSlots; i += 4, pAttr += 4 * recordSize) {
+      for (int j = 0; j < 4; j++)
+         memcpy(&k[j], pAttr + j * recordSize, sizeof(int));
+      __m128i a = _mm_loadu_si128((const __m128i *)k);
+      if (bString)
+         a = _mm_shuffle_epi8(a, swap);
+      a = _mm_xor_si128(a, bias);
+      lt |= (RM_Bits)_mm_movemask_ps(_mm_castsi128_ps(
+         _mm_cmpgt_epi32(vv, a))) << i;
+      eq |= (RM_Bits)_mm_movemask_ps(_mm_castsi128_ps(
+         _mm_cmpeq_epi32(vv, a))) << i;
+   }
+
+   // The last slots one by one
+   for ( ; i < numSlots; i++, pAttr += recordSize) {
+      int a;
+      memcpy(&a, pAttr, sizeof(int));
+      if (bString) {
+         unsigned int p = RM_Prefix(pAttr);
+         lt |= (RM_Bits)(p < (unsigned int)v) << i;
+         eq |= (RM_Bits)(p == (unsigned int)v) << i;
+      }
+      else {
+         lt |= (RM_Bits)(a < v) << i;
+         eq |= (RM_Bits)(a == v) << i;
+      }
+   }
+}
+
+__attribute__((target("sse4.2")))
+static RM_Bits RM_MatchIntSSE42(const char *pAttr, int recordSize,
+                                int numSlots, int attrLength, CompOp compOp,
+                                const void *value)
+{
+   RM_Bits lt, eq;
+   int v;
+
+   memcpy(&v, value, sizeof(int));
+   RM_CompareKeysSSE42(pAttr, recordSize, numSlots, v, FALSE, lt, eq);
+   return (RM_Decide(lt, eq, ~(lt | eq) & RM_AllBits(numSlots), numSlots,
+                     compOp));
+}
+
+__attribute__((target("sse4.2")))
+static RM_Bits RM_MatchFloatSSE42(const char *pAttr, int recordSize,
+                                  int numSlots, int attrLength,
+                                  CompOp compOp, const void *value)
+{
+   RM_Bits lt = 0, eq = 0, gt = 0;
+   float v, k[4];
+   int i;
+
+   memcpy(&v, value, sizeof(float));
+   const __m128 vv = _mm_set1_ps(v);
+   for (i = 0; i + 4 <= numSlots; i += 4, pAttr += 4 * recordSize) {
+      for (int j = 0; j < 4; j++)
+         memcpy(&k[j], pAttr + j * recordSize, sizeof(float));
+      __m128 a = _mm_loadu_ps(k);
+      lt |= (RM_Bits)_mm_movemask_ps(_mm_cmplt_ps(a, vv)) << i;
+      eq |= (RM_Bits)_mm_movemask_ps(_mm_cmpeq_ps(a, vv)) << i;
+      gt |= (RM_Bits)_mm_movemask_ps(_mm_cmpgt_ps(a, vv)) << i;
+   }
+   if (i < numSlots) {
+      RM_Bits rest = RM_MatchFloat(pAttr, recordSize, numSlots - i,
+                                   attrLength, compOp, value);
+      return (RM_Decide(lt, eq, gt, i, compOp) | (rest << i));
+   }
+   return (RM_Decide(lt, eq, gt, numSlots, compOp));
+}
+
+__attribute__((target("sse4.2")))
+static RM_Bits RM_MatchStringSSE42(const char *pAttr, int recordSize,
+                                   int numSlots, int attrLength,
+                                   CompOp compOp, const void *value)
+{
+   RM_Bits lt, eq;
+
+   RM_CompareKeysSSE42(pAttr, recordSize, numSlots,
+                       (int)RM_Prefix((const char *)value), TRUE, lt, eq);
+   RM_RefineStrings(pAttr, recordSize, attrLength, (const char *)value,
+                    lt, eq);
+   return (RM_Decide(lt, eq, ~(lt | eq) & RM_AllBits(numSlots), numSlots,
+                     compOp));
+}
+
+//------------------------------------------------------------------------------
+// AVX2 kernels: eight slots at a time, gathered
+//------------------------------------------------------------------------------
+
+//
+// RM_CompareKeysAVX2
+//
+// Desc: As RM_CompareKeysSSE42
+//
+__attribute__((target("avx2")))
+static void RM_CompareKeysAVX2(const char *pAttr, int recordSize,
+                               int numSlots, int v, int bString,
+                               RM_Bits &lt, RM_Bits &eq)
+{
+   const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                                         11, 10, 9, 8, 15, 14, 13, 12,
+                                         3, 2, 1, 0, 7, 6, 5, 4,
+                                         11, 10, 9, 8, 15, 14, 13, 12);
+   const __m256i bias = _mm256_set1_epi32(bString ? (int)0x80000000 : 0);
+   const __m256i vv = _mm256_xor_si256(_mm256_set1_epi32(v), bias);
+   const __m256i offsets = _mm256_mullo_epi32(
+      _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+      _mm256_set1_epi32(recordSize));
+   int i;
+
+   lt = eq = 0;
+   for (i = 0; i + 8 <= numSlots; i += 8, pAttr += 8 * recordSize) {
+      __m256i a = _mm256_i32gather_epi32((const int *)pAttr, offsets, 1);
+      if (bString)
+         a = _mm256_shuffle_epi8(a, swap);
+      a = _mm256_xor_si256(a, bias);
+      lt |= (RM_Bits)_mm256_movemask_ps(_mm256_castsi256_ps(
+         _mm256_cmpgt_epi32(vv, a))) << i;
+      eq |= (RM_Bits)_mm256_movemask_ps(_mm256_castsi256_ps(
+         _mm256_cmpeq_epi32(vv, a))) << i;
+   }
+
+   // The last slots, four at a time and one by one
+   if (i < numSlots) {
+      RM_Bits restLt, restEq;
+      RM_CompareKeysSSE42(pAttr, recordSize, numSlots - i, v, bString,
+                          restLt, restEq);
+      lt |= restLt << i;
+      eq |= restEq << i;
+   }
+}
+
+__attribute__((target("avx2")))
+static RM_Bits RM_MatchIntAVX2(const char *pAttr, int recordSize,
+                               int numSlots, int attrLength, CompOp compOp,
+                               const void *value)
+{
+   RM_Bits lt, eq;
+   int v;
+
+   memcpy(&v, value, sizeof(int));
+   RM_CompareKeysAVX2(pAttr, recordSize, numSlots, v, FALSE, lt, eq);
+   return (RM_Decide(lt, eq, ~(lt | eq) & RM_AllBits(numSlots), numSlots,
+                     compOp));
+}
+
+__attribute__((target("avx2")))
+static RM_Bits RM_MatchFloatAVX2(const char *pAttr, int recordSize,
+                                 int numSlots, int attrLength,
+                                 CompOp compOp, const void *value)
+{
+   RM_Bits lt = 0, eq = 0, gt = 0;
+   float v;
+   int i;
+
+   memcpy(&v, value, sizeof(float));
+   const __m256 vv = _mm256_set1_ps(v);
+   const __m256i offsets = _mm256_mullo_epi32(
+      _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+      _mm256_set1_epi32(recordSize));
+   for (i = 0; i + 8 <= numSlots; i += 8, pAttr += 8 * recordSize) {
+      __m256 a = _mm256_i32gather_ps((const float *)pAttr, offsets, 1);
+      lt |= (RM_Bits)_mm256_movemask_ps(_mm256_cmp_ps(a, vv, _CMP_LT_OQ))
+         << i;
+      eq |= (RM_Bits)_mm256_movemask_ps(_mm256_cmp_ps(a, vv, _CMP_EQ_OQ))
+         << i;
+      gt |= (RM_Bits)_mm256_movemask_ps(_mm256_cmp_ps(a, vv, _CMP_GT_OQ))
+         << i;
+   }
+   if (i < numSlots) {
+      RM_Bits rest = RM_MatchFloatSSE42(pAttr, recordSize, numSlots - i,
+                                        attrLength, compOp, value);
+      return (RM_Decide(lt, eq, gt, i, compOp) | (rest << i));
+   }
+   return (RM_Decide(lt, eq, gt, numSlots, compOp));
+}
+
+__attribute__((target("avx2")))
+static RM_Bits RM_MatchStringAVX2(const char *pAttr, int recordSize,
+                                  int numSlots, int attrLength,
+                                  CompOp compOp, const void *value)
+{
+   RM_Bits lt, eq;
+
+   RM_CompareKeysAVX2(pAttr, recordSize, numSlots,
+                      (int)RM_Prefix((const char *)value), TRUE, lt, eq);
+   RM_RefineStrings(pAttr, recordSize, attrLength, (const char *)value,
+                    lt, eq);
+   return (RM_Decide(lt, eq, ~(lt | eq) & RM_AllBits(numSlots), numSlots,
+                     compOp));
+}
+
+#endif // RM_KERNEL_X86
+
+//
+// RM_Supports
+//
+// Desc: Tell whether the CPU can run the kernels of an instruction set
+// In:   kernel - RM_KERNEL_SCALAR, RM_KERNEL_SSE42 or RM_KERNEL_AVX2
+// Ret:  TRUE or FALSE
+//
+static int RM_Supports(RM_ScanKernel kernel)
+{
+   switch (kernel) {
+   case RM_KERNEL_SCALAR:
+      return (TRUE);
+#ifdef RM_KERNEL_X86
+   case RM_KERNEL_SSE42:
+      return (__builtin_cpu_supports("sse4.2") != 0);
+   case RM_KERNEL_AVX2:
+      return (__builtin_cpu_supports("avx2") != 0);
+#endif
+   default:
+      return (FALSE);
+   }
+}
+
+//
+// RM_SetScanKernel
+//
+// Desc: Choose the instruction set the scans opened from now on use.
+//       One the CPU does not have is not used: the best one it has
+//       (RM_KERNEL_BEST) is used instead.
+// In:   kernel - instruction set, or RM_KERNEL_BEST
+// Ret:  the instruction set used
+//
+RM_ScanKernel RM_SetScanKernel(RM_ScanKernel kernel)
+{
+   if (kernel == RM_KERNEL_BEST || !RM_Supports(kernel)) {
+      kernel = RM_KERNEL_SCALAR;
+      if (RM_Supports(RM_KERNEL_SSE42))
+         kernel = RM_KERNEL_SSE42;
+      if (RM_Supports(RM_KERNEL_AVX2))
+         kernel = RM_KERNEL_AVX2;
+   }
+   rmScanKernel = kernel;
+   return (kernel);
+}
+
+//
+// RM_ChooseKernel
+//
+// Desc: The kernel of the chosen instruction set for the condition of a
+//       scan
+// In:   attrType - INT|FLOAT|STRING
+//       attrLength - length of the attribute
+// Ret:  the kernel
+//
+RM_MatchKernel RM_ChooseKernel(AttrType attrType, int attrLength)
+{
+   if (rmScanKernel == RM_KERNEL_BEST)
+      RM_SetScanKernel(RM_KERNEL_BEST);
+
+#ifdef RM_KERNEL_X86
+   if (rmScanKernel == RM_KERNEL_AVX2)
+      switch (attrType) {
+      case INT:
+         return (RM_MatchIntAVX2);
+      case FLOAT:
+         return (RM_MatchFloatAVX2);
+      case STRING:
+         if (attrLength >= 4)
+            return (RM_MatchStringAVX2);
+         break;
+      }
+   if (rmScanKernel == RM_KERNEL_SSE42)
+      switch (attrType) {
+      case INT:
+         return (RM_MatchIntSSE42);
+      case FLOAT:
+         return (RM_MatchFloatSSE42);
+      case STRING:
+         if (attrLength >= 4)
+            return (RM_MatchStringSSE42);
+         break;
+      }
+#endif
+
+   switch (attrType) {
+   case INT:
+      return (RM_MatchInt);
+   case FLOAT:
+      return (RM_MatchFloat);
+   default:
+      return (RM_MatchString);
+   }
+}
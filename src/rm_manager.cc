@@ -35,9 +35,13 @@ RM_Manager::~RM_Manager()
 //       Allocate a file header page and fill out some information
 // In:   fileName - name of file to create
 //       recordSize - fixed size of records
+//       pageSize - size of the pages of the file (see
+//       PF_Manager::CreateFile)
+//       bCompress - compress the pages on disk
 // Ret:  RM_INVALIDRECSIZE or PF return code
 //
-RC RM_Manager::CreateFile(const char *fileName, int recordSize)
+RC RM_Manager::CreateFile(const char *fileName, int recordSize,
+                          int pageSize, int bCompress)
 {
    RC rc;
    PF_FileHandle pfFileHandle;
@@ -47,12 +51,13 @@ RC RM_Manager::CreateFile(const char *fileName, int recordSize)
 
    // Sanity Check: recordSize should not be too large (or small)
    // Note that PF_Manager::CreateFile() will take care of fileName
-   if (recordSize >= PF_PAGE_SIZE - sizeof(RM_PageHdr) || recordSize < 1)
+   if (recordSize >= pageSize - (int)sizeof(RM_PageHdr) || recordSize < 1)
       // Test: invalid recordSize
       return (RM_INVALIDRECSIZE);
 
    // Call PF_Manager::CreateFile()
-   if (rc = pPfm->CreateFile(fileName))
+   if (rc = pPfm->CreateFile(fileName, pageSize, PF_EXTENT_PAGES,
+                             bCompress))
       // Test: existing fileName, wrong permission
       goto err_return;
 
@@ -75,11 +80,11 @@ RC RM_Manager::CreateFile(const char *fileName, int recordSize)
    fileHdr = (RM_FileHdr *)pData;
    fileHdr->firstFree = RM_PAGE_LIST_END;
    fileHdr->recordSize = recordSize;
-   fileHdr->numRecordsPerPage = (PF_PAGE_SIZE - sizeof(RM_PageHdr) - 1) 
+   fileHdr->numRecordsPerPage = (pageSize - sizeof(RM_PageHdr) - 1) 
                                 / (recordSize + 1.0/8);
    if (recordSize * (fileHdr->numRecordsPerPage + 1) 
        + fileHdr->numRecordsPerPage / 8 
-       <= PF_PAGE_SIZE - sizeof(RM_PageHdr) - 1)
+       <= pageSize - (int)sizeof(RM_PageHdr) - 1)
       fileHdr->numRecordsPerPage++;
    fileHdr->pageHeaderSize = sizeof(RM_PageHdr) 
                              + (fileHdr->numRecordsPerPage + 7) / 8;
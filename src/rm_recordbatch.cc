@@ -0,0 +1,157 @@
+//
+// File:        rm_recordbatch.cc
+// Description: RM_RecordBatch class implementation
+//
+
+#include "rm_internal.h"
+
+//
+// RM_RecordBatch
+//
+// Desc: Default Constructor
+//
+RM_RecordBatch::RM_RecordBatch()
+{
+   pPfFileHandle = NULL;
+   pPages = NULL;
+   numPages = maxPages = 0;
+   pLastPage = NULL;
+   ppData = NULL;
+   pRids = NULL;
+   numRecs = maxRecs = 0;
+}
+
+//
+// ~RM_RecordBatch
+//
+// Desc: Destructor - unpins the pages of the records
+//
+RM_RecordBatch::~RM_RecordBatch()
+{
+   Release();
+   delete [] pPages;
+   delete [] ppData;
+   delete [] pRids;
+}
+
+//
+// GetNumRecs
+//
+// Desc: Return the # of records in the batch
+//
+int RM_RecordBatch::GetNumRecs() const
+{
+   return (numRecs);
+}
+
+//
+// GetData
+//
+// Desc: Return the data of a record, in the buffer
+// In:   i - # of the record in the batch
+// Out:  pData - set to its data
+// Ret:  RM_INVALIDBATCH
+//
+RC RM_RecordBatch::GetData(int i, char *&pData) const
+{
+   if (i < 0 || i >= numRecs)
+      return (RM_INVALIDBATCH);
+
+   pData = ppData[i];
+
+   // Return ok
+   return (0);
+}
+
+//
+// GetRid
+//
+// Desc: Return the RID of a record
+// In:   i - # of the record in the batch
+// Out:  rid - set to its record identifier
+// Ret:  RM_INVALIDBATCH
+//
+RC RM_RecordBatch::GetRid(int i, RID &rid) const
+{
+   if (i < 0 || i >= numRecs)
+      return (RM_INVALIDBATCH);
+
+   rid = pRids[i];
+
+   // Return ok
+   return (0);
+}
+
+//
+// Release
+//
+// Desc: Unpin the pages of the records, and empty the batch
+// Ret:  PF return code (of the first page that could not be unpinned)
+//
+RC RM_RecordBatch::Release()
+{
+   RC rc = 0, rc2;
+
+   for (int i = 0; i < numPages; i++)
+      if ((rc2 = pPfFileHandle->UnpinPage(pPages[i])) && !rc)
+         rc = rc2;
+
+   pPfFileHandle = NULL;
+   numPages = 0;
+   pLastPage = NULL;
+   numRecs = 0;
+   return (rc);
+}
+
+//
+// AddPage
+//
+// Desc: Internal.  Add a pinned page: the batch unpins it when it is
+//       released
+// In:   pfFileHandle - file of the page (that of the other pages)
+//       pageNum - the page
+//       pPage - its data
+//
+void RM_RecordBatch::AddPage(const PF_FileHandle &pfFileHandle,
+      PageNum pageNum, char *pPage)
+{
+   if (numPages == maxPages) {
+      maxPages = (maxPages > 0) ? 2 * maxPages : RM_BATCH_PAGES;
+      PageNum *pNewPages = new PageNum[maxPages];
+      if (numPages > 0)
+         memcpy(pNewPages, pPages, numPages * sizeof(PageNum));
+      delete [] pPages;
+      pPages = pNewPages;
+   }
+
+   pPfFileHandle = &pfFileHandle;
+   pPages[numPages++] = pageNum;
+   pLastPage = pPage;
+}
+
+//
+// AddRec
+//
+// Desc: Internal.  Add a record of a page of the batch
+// In:   pData - the record
+//       rid - its RID
+//
+void RM_RecordBatch::AddRec(char *pData, const RID &rid)
+{
+   if (numRecs == maxRecs) {
+      maxRecs = (maxRecs > 0) ? 2 * maxRecs : 64;
+      char **ppNewData = new char *[maxRecs];
+      RID *pNewRids = new RID[maxRecs];
+      for (int i = 0; i < numRecs; i++) {
+         ppNewData[i] = ppData[i];
+         pNewRids[i] = pRids[i];
+      }
+      delete [] ppData;
+      delete [] pRids;
+      ppData = ppNewData;
+      pRids = pNewRids;
+   }
+
+   ppData[numRecs] = pData;
+   pRids[numRecs++] = rid;
+}
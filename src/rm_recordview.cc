@@ -0,0 +1,126 @@
+//
+// File:        rm_recordview.cc
+// Description: RM_RecordView class implementation
+//
+
+#include "rm_internal.h"
+
+//
+// RM_RecordView
+//
+// Desc: Default Constructor
+//
+RM_RecordView::RM_RecordView()
+{
+   pPfFileHandle = NULL;
+   pPage = NULL;
+   pData = NULL;
+}
+
+//
+// ~RM_RecordView
+//
+// Desc: Destructor - unpins the page of the record
+//
+RM_RecordView::~RM_RecordView()
+{
+   Release();
+}
+
+//
+// GetData
+//
+// Desc: Return data
+//       The view must refer to a record
+//       (by RM_FileHandle::GetRec() or RM_FileScan::GetNextRec())
+// Out:  _pData - set to this record's data, in the buffer
+// Ret:  RM_UNREADRECORD
+//
+RC RM_RecordView::GetData(char *&_pData) const
+{
+   // A record should have been read
+   if (pPfFileHandle == NULL)
+      return (RM_UNREADRECORD);
+
+   _pData = pData;
+
+   // Return ok
+   return (0);
+}
+
+//
+// GetRid
+//
+// Desc: Return RID
+// Out:  _rid - set to this record's record identifier
+// Ret:  RM_UNREADRECORD
+//
+RC RM_RecordView::GetRid(RID &_rid) const
+{
+   // A record should have been read
+   if (pPfFileHandle == NULL)
+      return (RM_UNREADRECORD);
+
+   _rid = rid;
+
+   // Return ok
+   return (0);
+}
+
+//
+// Release
+//
+// Desc: Unpin the page of the record, if the view refers to one
+// Ret:  PF return code
+//
+RC RM_RecordView::Release()
+{
+   const PF_FileHandle *pFileHandle = pPfFileHandle;
+   PageNum pageNum;
+   RC rc;
+
+   if (pFileHandle == NULL)
+      return (0);
+
+   pPfFileHandle = NULL;
+   pPage = pData = NULL;
+   if ((rc = rid.GetPageNum(pageNum)))
+      return (rc);
+   return (pFileHandle->UnpinPage(pageNum));
+}
+
+//
+// IsOn
+//
+// Desc: Internal.  Tell whether the view has a page pinned
+// In:   pfFileHandle - file of the page
+//       pageNum - the page
+// Ret:  TRUE or FALSE
+//
+int RM_RecordView::IsOn(const PF_FileHandle &pfFileHandle,
+      PageNum pageNum) const
+{
+   PageNum viewPageNum;
+
+   return (pPfFileHandle == &pfFileHandle &&
+         rid.GetPageNum(viewPageNum) == 0 && viewPageNum == pageNum);
+}
+
+//
+// Set
+//
+// Desc: Internal.  Refer to a record of a pinned page: the view unpins it
+//       when it is released.  It must not refer to a record already.
+// In:   pfFileHandle - file of the page
+//       _pPage - the page
+//       _rid - the record
+//       offset - offset of the record in the page
+//
+void RM_RecordView::Set(const PF_FileHandle &pfFileHandle, char *_pPage,
+      const RID &_rid, int offset)
+{
+   pPfFileHandle = &pfFileHandle;
+   pPage = _pPage;
+   pData = _pPage + offset;
+   rid = _rid;
+}
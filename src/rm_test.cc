@@ -21,6 +21,8 @@
 #include <unistd.h>
 #include <cstdlib>
 #include <cassert>
+#include <climits>
+#include <cmath>
 
 #include "redbase.h"
 #include "pf.h"
@@ -69,6 +71,9 @@ RC Test4(void);
 RC Test5(void);
 RC Test6(void);
 RC Test7(void);
+RC Test8(void);
+RC Test9(void);
+RC Test10(void);
 
 void PrintError(RC rc);
 void LsFile(char *fileName);
@@ -89,7 +94,7 @@ RC GetNextRecScan(RM_FileScan &fs, RM_Record &rec);
 //
 // Array of pointers to the test functions
 //
-#define NUM_TESTS       7               // number of tests
+#define NUM_TESTS       10              // number of tests
 int (*tests[])() =                      // RC doesn't work on some compilers
 {
    Test1,
@@ -98,7 +103,10 @@ int (*tests[])() =                      // RC doesn't work on some compilers
    Test4,
    Test5,
    Test6,
-   Test7
+   Test7,
+   Test8,
+   Test9,
+   Test10
 };
 
 //
@@ -972,3 +980,452 @@ RC Test7(void)
    return (0);
 }
 
+//
+// Test8 tests RM_RecordView
+//
+RC Test8(void)
+{
+   RC            rc;
+   RM_FileHandle fh;
+   RM_Record     rec;
+   RM_FileScan   fs;
+   int           val = 30;
+   int           numRecs = FEW_RECS*20;
+   int           n, numMatches;
+   TestRec       recBuf;
+   char          *pData;
+   char          stringBuf[STRLEN];
+   RID           rid;
+   RID           *rids = new RID[numRecs];
+
+   printf("test8 starting ****************\n");
+
+   rc = CreateFile(FILENAME, sizeof(TestRec));
+   assert(rc == 0);
+
+   rc = OpenFile(FILENAME, fh);
+   assert(rc == 0);
+
+   rc = AddRecs(fh, numRecs);
+   assert(rc == 0);
+
+   printf("\nTesting GetData() with unread view...\n");
+   {
+      RM_RecordView view;
+      rc = view.GetData(pData);
+      PrintError(rc);
+      assert(rc == RM_UNREADRECORD);
+      rc = view.Release();
+      assert(rc == 0);
+   }
+   printf("\nOK\n");
+
+   printf("\nscanning records in place\n");
+   {
+      RM_RecordView view;
+
+      rc = fs.OpenScan(fh, INT, sizeof(int), offsetof(TestRec, num),
+                       NO_OP, NULL, NO_HINT);
+      assert(rc == 0);
+      for (n = 0; (rc = fs.GetNextRec(view)) == 0; n++) {
+         rc = view.GetData(pData);
+         assert(rc == 0);
+         rc = view.GetRid(rids[n]);
+         assert(rc == 0);
+
+         // Records in the buffer are not aligned
+         memcpy(&recBuf, pData, sizeof(TestRec));
+         int i = (int)recBuf.r;
+         memset(stringBuf, ' ', STRLEN);
+         sprintf(stringBuf, "a%d", i);
+         if (i < 0 || i >= numRecs || strcmp(recBuf.str, stringBuf) ||
+               recBuf.num != (FEW_RECS/2-i)*(FEW_RECS/2-i)) {
+            printf("Test8: invalid record = [%s, %d, %f]\n",
+                  recBuf.str, recBuf.num, recBuf.r);
+            exit(1);
+         }
+      }
+      assert(rc == RM_EOF);
+      rc = fs.CloseScan();
+      assert(rc == 0);
+      printf("%d records\n", n);
+      assert(n == numRecs);
+
+      // Nothing stays pinned at the end of the scan
+      rc = view.GetData(pData);
+      assert(rc == RM_UNREADRECORD);
+   }
+
+   printf("\ncomparing a selective scan in place with a copying one\n");
+   {
+      RM_RecordView view;
+
+      rc = fs.OpenScan(fh, INT, sizeof(int), offsetof(TestRec, num),
+                       GT_OP, &val, NO_HINT);
+      assert(rc == 0);
+      for (numMatches = 0; (rc = GetNextRecScan(fs, rec)) == 0; numMatches++)
+         ;
+      assert(rc == RM_EOF);
+      rc = fs.CloseScan();
+      assert(rc == 0);
+
+      rc = fs.OpenScan(fh, INT, sizeof(int), offsetof(TestRec, num),
+                       GT_OP, &val, NO_HINT);
+      assert(rc == 0);
+      for (n = 0; (rc = fs.GetNextRec(view)) == 0; n++) {
+         rc = view.GetData(pData);
+         assert(rc == 0);
+         memcpy(&recBuf, pData, sizeof(TestRec));
+         assert(recBuf.num > val);
+      }
+      assert(rc == RM_EOF);
+      rc = fs.CloseScan();
+      assert(rc == 0);
+      printf("%d records (copying: %d)\n", n, numMatches);
+      assert(n == numMatches && n > 0);
+   }
+
+   printf("\nreading each record by rid in place\n");
+   {
+      RM_RecordView view;
+
+      for (n = 0; n < numRecs; n++) {
+         rc = fh.GetRec(rids[n], view);
+         assert(rc == 0);
+         rc = view.GetData(pData);
+         assert(rc == 0);
+         memcpy(&recBuf, pData, sizeof(TestRec));
+         rc = fh.GetRec(rids[n], rec);
+         assert(rc == 0);
+         rc = rec.GetData(pData);
+         assert(rc == 0);
+         assert(memcmp(pData, &recBuf, sizeof(TestRec)) == 0);
+      }
+
+      printf("\nTesting CloseFile() with a view of a record...\n");
+      rc = CloseFile(FILENAME, fh);
+      PrintError(rc);
+      assert(rc == PF_PAGEPINNED);
+      printf("\nOK\n");
+
+      printf("\nTesting GetRec() with non-existing rid...\n");
+      rc = DeleteRec(fh, rids[0]);
+      assert(rc == 0);
+      rc = fh.GetRec(rids[0], view);
+      PrintError(rc);
+      assert(rc == RM_RECORDNOTFOUND);
+      rc = view.GetRid(rid);
+      assert(rc == RM_UNREADRECORD);
+      printf("\nOK\n");
+   }
+
+   rc = CloseFile(FILENAME, fh);
+   assert(rc == 0);
+
+   rc = DestroyFile(FILENAME);
+   assert(rc == 0);
+
+   delete [] rids;
+
+   printf("\ntest8 done ********************\n");
+   return (0);
+}
+
+//
+// Test9 tests RM_FileScan::GetNextBatch
+//
+RC Test9(void)
+{
+   RC             rc;
+   RM_FileHandle  fh;
+   RM_FileScan    fs;
+   RM_RecordView  view;
+   RM_RecordBatch batch;
+   int            val = 30;
+   int            numRecs = FEW_RECS*20;
+   int            batchSizes[] = { 1, 7, 100, 1000 };
+   int            n, numMatches, numBatches;
+   char           *pData;
+   TestRec        recBuf;
+   RID            rid;
+   RID            *rids = new RID[numRecs];
+
+   printf("test9 starting ****************\n");
+
+   rc = CreateFile(FILENAME, sizeof(TestRec));
+   assert(rc == 0);
+
+   rc = OpenFile(FILENAME, fh);
+   assert(rc == 0);
+
+   rc = AddRecs(fh, numRecs);
+   assert(rc == 0);
+
+   // The matching records, as GetNextRec finds them
+   rc = fs.OpenScan(fh, INT, sizeof(int), offsetof(TestRec, num),
+                    GT_OP, &val, NO_HINT);
+   assert(rc == 0);
+   for (numMatches = 0; (rc = fs.GetNextRec(view)) == 0; numMatches++) {
+      rc = view.GetRid(rids[numMatches]);
+      assert(rc == 0);
+   }
+   assert(rc == RM_EOF);
+   rc = fs.CloseScan();
+   assert(rc == 0);
+
+   printf("\nTesting GetNextBatch() with invalid batch size...\n");
+   rc = fs.OpenScan(fh, INT, sizeof(int), offsetof(TestRec, num),
+                    GT_OP, &val, NO_HINT);
+   assert(rc == 0);
+   rc = fs.GetNextBatch(batch, 0);
+   PrintError(rc);
+   assert(rc == RM_INVALIDBATCH);
+   rc = fs.CloseScan();
+   assert(rc == 0);
+   printf("\nOK\n");
+
+   // The same records, in the same order, with any batch size
+   for (int b = 0; b < (int)(sizeof(batchSizes) / sizeof(int)); b++) {
+      printf("\nscanning in batches of %d\n", batchSizes[b]);
+      rc = fs.OpenScan(fh, INT, sizeof(int), offsetof(TestRec, num),
+                       GT_OP, &val, NO_HINT);
+      assert(rc == 0);
+      n = numBatches = 0;
+      while ((rc = fs.GetNextBatch(batch, batchSizes[b])) == 0) {
+         assert(batch.GetNumRecs() > 0 &&
+                batch.GetNumRecs() <= batchSizes[b]);
+         for (int i = 0; i < batch.GetNumRecs(); i++, n++) {
+            rc = batch.GetRid(i, rid);
+            assert(rc == 0);
+            assert(n < numMatches && rid == rids[n]);
+            rc = batch.GetData(i, pData);
+            assert(rc == 0);
+            memcpy(&recBuf, pData, sizeof(TestRec));
+            assert(recBuf.num > val);
+         }
+         numBatches++;
+      }
+      assert(rc == RM_EOF && batch.GetNumRecs() == 0);
+      rc = fs.CloseScan();
+      assert(rc == 0);
+      printf("%d records in %d batches\n", n, numBatches);
+      assert(n == numMatches);
+   }
+
+   printf("\nTesting GetData() past the batch...\n");
+   rc = fs.OpenScan(fh, INT, sizeof(int), offsetof(TestRec, num),
+                    NO_OP, NULL, NO_HINT);
+   assert(rc == 0);
+   rc = fs.GetNextBatch(batch, 5);
+   assert(rc == 0 && batch.GetNumRecs() == 5);
+   rc = batch.GetData(5, pData);
+   PrintError(rc);
+   assert(rc == RM_INVALIDBATCH);
+   printf("\nOK\n");
+
+   printf("\nTesting CloseFile() with a batch of records...\n");
+   rc = CloseFile(FILENAME, fh);
+   PrintError(rc);
+   assert(rc == PF_PAGEPINNED);
+   printf("\nOK\n");
+
+   rc = batch.Release();
+   assert(rc == 0 && batch.GetNumRecs() == 0);
+   rc = fs.CloseScan();
+   assert(rc == 0);
+
+   rc = CloseFile(FILENAME, fh);
+   assert(rc == 0);
+
+   rc = DestroyFile(FILENAME);
+   assert(rc == 0);
+
+   delete [] rids;
+
+   printf("\ntest9 done ********************\n");
+   return (0);
+}
+
+//
+// Matches
+//
+// Desc: Evaluate a scan condition on a record, as Test10 expects it
+//
+static int Matches(const TestRec &recBuf, AttrType attrType, int attrLength,
+                   CompOp compOp, const void *value)
+{
+   int lt, eq, gt;
+
+   switch (attrType) {
+   case INT:
+      lt = recBuf.num < *(const int *)value;
+      eq = recBuf.num == *(const int *)value;
+      gt = recBuf.num > *(const int *)value;
+      break;
+   case FLOAT:
+      lt = recBuf.r < *(const float *)value;
+      eq = recBuf.r == *(const float *)value;
+      gt = recBuf.r > *(const float *)value;
+      break;
+   default: {
+      int cmp = memcmp(recBuf.str, value, attrLength);
+      lt = cmp < 0;
+      eq = cmp == 0;
+      gt = cmp > 0;
+      }
+   }
+
+   switch (compOp) {
+   case EQ_OP: return (eq);
+   case LT_OP: return (lt);
+   case GT_OP: return (gt);
+   case LE_OP: return (lt || eq);
+   case GE_OP: return (gt || eq);
+   case NE_OP: return (!eq);
+   default:    return (TRUE);
+   }
+}
+
+//
+// Test10 tests the scan kernels: each of them must find the same records
+//
+RC Test10(void)
+{
+   RC             rc;
+   RM_FileHandle  fh;
+   RM_FileScan    fs;
+   RM_RecordBatch batch;
+   int            numRecs = FEW_RECS*20;
+   TestRec        recBuf;
+   RID            rid;
+   char           *pData;
+   int            i, k, c, op;
+
+   // The conditions
+   int   ints[] = { 0, 17, INT_MIN, INT_MAX };
+   float floats[] = { 0.5, -50, INFINITY };
+   char  longStr[STRLEN], shortStr[6], tinyStr[2];
+   struct {
+      AttrType   attrType;
+      int        attrLength;
+      int        attrOffset;
+      const void *value;
+   } conds[] = {
+      { INT, sizeof(int), offsetof(TestRec, num), &ints[0] },
+      { INT, sizeof(int), offsetof(TestRec, num), &ints[1] },
+      { INT, sizeof(int), offsetof(TestRec, num), &ints[2] },
+      { INT, sizeof(int), offsetof(TestRec, num), &ints[3] },
+      { FLOAT, sizeof(float), offsetof(TestRec, r), &floats[0] },
+      { FLOAT, sizeof(float), offsetof(TestRec, r), &floats[1] },
+      { FLOAT, sizeof(float), offsetof(TestRec, r), &floats[2] },
+      { STRING, STRLEN, offsetof(TestRec, str), longStr },
+      { STRING, sizeof(shortStr), offsetof(TestRec, str), shortStr },
+      { STRING, sizeof(tinyStr), offsetof(TestRec, str), tinyStr }
+   };
+   int numConds = sizeof(conds) / sizeof(conds[0]);
+   CompOp ops[] = { EQ_OP, LT_OP, GT_OP, LE_OP, GE_OP, NE_OP };
+   RM_ScanKernel kernels[] = { RM_KERNEL_SCALAR, RM_KERNEL_SSE42,
+                               RM_KERNEL_AVX2 };
+   const char *kernelNames[] = { "scalar", "SSE4.2", "AVX2" };
+
+   printf("test10 starting ****************\n");
+
+   rc = CreateFile(FILENAME, sizeof(TestRec));
+   assert(rc == 0);
+
+   rc = OpenFile(FILENAME, fh);
+   assert(rc == 0);
+
+   // Records with extreme ints, NaNs and infinities, strings that share
+   // prefixes of any length, with bytes past 0x7f; every 7th deleted
+   memset(longStr, 0, sizeof(longStr));
+   sprintf(longStr, "abcd%04d", 50);
+   memcpy(shortStr, longStr, sizeof(shortStr));
+   memcpy(tinyStr, longStr, sizeof(tinyStr));
+   for (i = 0; i < numRecs; i++) {
+      memset(&recBuf, 0, sizeof(recBuf));
+      recBuf.num = (i % 17 == 0) ? INT_MIN : (i % 19 == 0) ? INT_MAX :
+         i - numRecs / 2;
+      recBuf.r = (i % 11 == 0) ? NAN : (i % 13 == 0) ? INFINITY :
+         (i - numRecs / 2) * 0.25;
+      if (i % 3 == 0)
+         sprintf(recBuf.str, "abcd%04d", i % 100);
+      else if (i % 3 == 1)
+         sprintf(recBuf.str, "abce%d", i);
+      else
+         sprintf(recBuf.str, "ab%d", i);
+      if (i % 5 == 4)
+         recBuf.str[i % 4] = (char)0xe0;
+      rc = InsertRec(fh, (char *)&recBuf, rid);
+      assert(rc == 0);
+      if (i % 7 == 3) {
+         rc = DeleteRec(fh, rid);
+         assert(rc == 0);
+      }
+   }
+
+   for (k = 0; k < (int)(sizeof(kernels) / sizeof(kernels[0])); k++) {
+      if (RM_SetScanKernel(kernels[k]) != kernels[k]) {
+         printf("\nno %s kernel on this CPU, skipped\n", kernelNames[k]);
+         continue;
+      }
+      printf("\nscanning with the %s kernel\n", kernelNames[k]);
+
+      for (c = 0; c < numConds; c++)
+         for (op = 0; op < (int)(sizeof(ops) / sizeof(ops[0])); op++) {
+            int numExpected = 0, numFound = 0;
+
+            // The records that match, from a scan of all of them
+            rc = fs.OpenScan(fh, INT, sizeof(int), 0, NO_OP, NULL);
+            assert(rc == 0);
+            while ((rc = fs.GetNextBatch(batch, 1000)) == 0)
+               for (i = 0; i < batch.GetNumRecs(); i++) {
+                  rc = batch.GetData(i, pData);
+                  assert(rc == 0);
+                  memcpy(&recBuf, pData, sizeof(TestRec));
+                  numExpected += Matches(recBuf, conds[c].attrType,
+                                         conds[c].attrLength, ops[op],
+                                         conds[c].value);
+               }
+            assert(rc == RM_EOF);
+            rc = fs.CloseScan();
+            assert(rc == 0);
+
+            // Each of them, and no other, through the kernel
+            rc = fs.OpenScan(fh, conds[c].attrType, conds[c].attrLength,
+                             conds[c].attrOffset, ops[op],
+                             (void *)conds[c].value);
+            assert(rc == 0);
+            while ((rc = fs.GetNextBatch(batch, 37)) == 0)
+               for (i = 0; i < batch.GetNumRecs(); i++, numFound++) {
+                  rc = batch.GetData(i, pData);
+                  assert(rc == 0);
+                  memcpy(&recBuf, pData, sizeof(TestRec));
+                  assert(Matches(recBuf, conds[c].attrType,
+                                 conds[c].attrLength, ops[op],
+                                 conds[c].value));
+               }
+            assert(rc == RM_EOF);
+            rc = fs.CloseScan();
+            assert(rc == 0);
+
+            if (numFound != numExpected) {
+               printf("condition %d, operator %d: %d records, expected %d\n",
+                      c, op, numFound, numExpected);
+               assert(numFound == numExpected);
+            }
+         }
+      printf("%d conditions OK\n", numConds * 6);
+   }
+
+   RM_SetScanKernel(RM_KERNEL_BEST);
+
+   rc = CloseFile(FILENAME, fh);
+   assert(rc == 0);
+
+   rc = DestroyFile(FILENAME);
+   assert(rc == 0);
+
+   printf("\ntest10 done ********************\n");
+   return (0);
+}
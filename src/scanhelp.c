@@ -8,6 +8,7 @@
  * 
  * 1997 Changes: "print", "buffer", "reset" and "io" added.
  * 1998 Changes: "resize", "queryplans", "on" and "off" added.
+ * "curve" added.
  *
  *
  * This file is not compiled separately; it is #included into lex.yy.c .
@@ -136,6 +137,8 @@ static int get_id(char *s)
       return yylval.ival = RW_RESIZE;
    if(!strcmp(string, "buffer"))
       return yylval.ival = RW_BUFFER;
+   if(!strcmp(string, "curve"))
+      return yylval.ival = RW_CURVE;
 
    if(!strcmp(string, "queryplans"))
       return yylval.ival = RW_QUERY_PLAN;
@@ -21,7 +21,8 @@
 class SM_Manager {
     friend class QL_Manager;
 public:
-    SM_Manager    (IX_Manager &ixm, RM_Manager &rmm);
+    SM_Manager    (IX_Manager &ixm, RM_Manager &rmm,
+                   PF_Manager *pPfm = NULL);  // (pPfm: for the pools)
     ~SM_Manager   ();                             // Destructor
 
     RC OpenDb     (const char *dbName);           // Open the database
@@ -42,6 +43,8 @@ public:
     RC Help       (const char *relName);          // print schema of relName
 
     RC Print      (const char *relName);          // print relName contents
+    RC PrintIO    (PF_Manager &pfm);              // print the buffer use
+                                                  //   of relations, indexes
 
     RC Set        (const char *paramName,         // set parameter to
                    const char *value);            //   value
@@ -56,13 +59,19 @@ private:
     RC SetRelationIndexCount(const char *relName, int value);
     RC GetAttributeInfo(const char *relName, const char *attrName,
                         RM_Record &rec, char *&data);
+    RC GetIndexedAttr(const char *relName, int indexNo, char *attrName);
+    RC BindPool(const char *fileSpec, const char *poolName);
+    // Make the changes to a catalog durable
+    RC Commit(RM_FileHandle &fhCatalog);
 
     IX_Manager *pIxm;
     RM_Manager *pRmm;
+    PF_Manager *pPfm;
     RM_FileHandle fhRelcat;
     RM_FileHandle fhAttrcat;
 
     int useIndexNo;
+    int bCompress;                                // compress new relations
 };
 
 //
@@ -22,6 +22,8 @@
 #define MAXLINE (2048)
 #define RELCAT "relcat"
 #define ATTRCAT "attrcat"
+#define WARMUP ".warmup"         // pages in the buffer at CloseDb
+#define LOGFILE ".log"           // write-ahead log of the database
 
 #define OFFSET(type, member) ((int)&((type *) 0)->member)
 
@@ -70,4 +72,19 @@ do {                                                        \
    r.indexNo = _indexNo;                                    \
 } while (0)
 
+//
+// SM_BufferUseRec : what the buffer did for a relation or index, as
+// printed by SM_Manager::PrintIO
+//
+struct SM_BufferUseRec {
+   char relName[MAXNAME];
+   char attrName[MAXNAME];     // attribute indexed, "" for the relation
+   int hits;
+   int misses;
+   float hitRatio;
+   int evictions;
+   int writeBacks;
+   int residentPages;
+};
+
 #endif
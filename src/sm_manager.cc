@@ -12,15 +12,21 @@ using namespace std;
 // SM_Manager
 //
 // Desc: Constructor
+// In:   ixm, rmm - the IX and RM managers
+//       _pPfm - their PF_Manager, whose buffer pools Set works on and
+//       whose warm set and write-ahead log OpenDb and CloseDb open and
+//       close (NULL: none of these)
 //
-SM_Manager::SM_Manager(IX_Manager &ixm, RM_Manager &rmm)
+SM_Manager::SM_Manager(IX_Manager &ixm, RM_Manager &rmm, PF_Manager *_pPfm)
 {
-   // Set the associated {IX|RM}_Manager object
+   // Set the associated {IX|RM|PF}_Manager object
    pIxm = &ixm;
    pRmm = &rmm;
+   pPfm = _pPfm;
    
    //
    useIndexNo = -1;
+   bCompress = FALSE;
 }
 
 //
@@ -30,9 +36,10 @@ SM_Manager::SM_Manager(IX_Manager &ixm, RM_Manager &rmm)
 //
 SM_Manager::~SM_Manager()
 {
-   // Clear the associated {IX|RM}_Manager object
+   // Clear the associated {IX|RM|PF}_Manager object
    pIxm = NULL;
    pRmm = NULL;
+   pPfm = NULL;
 }
 
 //
@@ -40,7 +47,7 @@ SM_Manager::~SM_Manager()
 //
 // Desc: Open a DB
 // In:   dbName - name of DB to open
-// Ret:  SM_INVALIDDBNAME, SM_CHDIRFAILED, RM return code
+// Ret:  SM_INVALIDDBNAME, SM_CHDIRFAILED, RM or PF return code
 //
 RC SM_Manager::OpenDb(const char *dbName)
 {
@@ -60,9 +67,19 @@ RC SM_Manager::OpenDb(const char *dbName)
       goto err_return;
    }
 
+   // Bring the files up to date from the log (a session may have died
+   // with changes that were logged only), and log the changes from now on
+   if (pPfm != NULL && (rc = pPfm->OpenLog(LOGFILE)))
+      goto err_return;
+
+   // Bring back the pages that were in the buffer when the database was
+   // last closed.  Without the manifest the buffer just starts cold.
+   if (pPfm != NULL)
+      pPfm->LoadWarmSet(WARMUP);
+
    // Open a file scan for RELCAT
    if (rc = pRmm->OpenFile(RELCAT, fhRelcat))
-      goto err_return;
+      goto err_log;
 
    // Open a file scan for ATTRCAT
    if (rc = pRmm->OpenFile(ATTRCAT, fhAttrcat))
@@ -74,6 +91,9 @@ RC SM_Manager::OpenDb(const char *dbName)
    // Return error
 err_close:
    pRmm->CloseFile(fhRelcat);
+err_log:
+   if (pPfm != NULL)
+      pPfm->CloseLog();
 err_return:
    return (rc);
 }
@@ -82,7 +102,7 @@ err_return:
 // CloseDb
 //
 // Desc: Close a DB 
-// Ret:  RM return code
+// Ret:  RM or PF return code
 //
 RC SM_Manager::CloseDb()
 {
@@ -96,6 +116,14 @@ RC SM_Manager::CloseDb()
    if (rc = pRmm->CloseFile(fhRelcat))
       goto err_return;
 
+   // The files are written: sync them and close the log
+   if (pPfm != NULL && (rc = pPfm->CloseLog()))
+      goto err_return;
+
+   // Save which pages were in the buffer, for the next OpenDb
+   if (pPfm != NULL && (rc = pPfm->SaveWarmSet(WARMUP)))
+      goto err_return;
+
    // Return ok
    return (0);
 
@@ -155,7 +183,7 @@ RC SM_Manager::CreateTable(const char *relName,
    SM_SetRelcatRec(relcatRec, relName, tupleLength, attrCount, 0);
    if (rc = fhRelcat.InsertRec((char *)&relcatRec, rid))
       goto err_return;
-   if (rc = fhRelcat.ForcePages())
+   if (rc = Commit(fhRelcat))
       goto err_return;
 
    // Update ATTRCAT
@@ -167,11 +195,11 @@ RC SM_Manager::CreateTable(const char *relName,
       if (rc = fhAttrcat.InsertRec((char *)&attrcatRec, rid))
          goto err_return;
    }
-   if (rc = fhAttrcat.ForcePages())
+   if (rc = Commit(fhAttrcat))
       goto err_return;
 
    // Create file
-   if (rc = pRmm->CreateFile(relName, tupleLength))
+   if (rc = pRmm->CreateFile(relName, tupleLength, PF_PAGE_SIZE, bCompress))
       goto err_return;
 
    // Return ok
@@ -212,7 +240,7 @@ RC SM_Manager::DropTable(const char *relName)
       goto err_return;
    if (rc = fhRelcat.DeleteRec(rid))
       goto err_return;
-   if (rc = fhRelcat.ForcePages())
+   if (rc = Commit(fhRelcat))
       goto err_return;
 
    // Update ATTRCAT
@@ -246,7 +274,7 @@ RC SM_Manager::DropTable(const char *relName)
 
    if (rc = fs.CloseScan())
       goto err_return;
-   if (rc = fhAttrcat.ForcePages())
+   if (rc = Commit(fhAttrcat))
       goto err_return;
 
    // Destroy file
@@ -333,7 +361,7 @@ RC SM_Manager::CreateIndex(const char *relName, const char *attrName)
    ((SM_AttrcatRec *)attrcatData)->indexNo = indexNo;
    if (rc = fhAttrcat.UpdateRec(rec))
       goto err_return;
-   if (rc = fhAttrcat.ForcePages())
+   if (rc = Commit(fhAttrcat))
       goto err_return;
 
    // Update RELCAT
@@ -387,7 +415,7 @@ RC SM_Manager::DropIndex(const char *relName, const char *attrName)
    ((SM_AttrcatRec *)attrcatData)->indexNo = -1;
    if (rc = fhAttrcat.UpdateRec(rec))
       goto err_return;
-   if (rc = fhAttrcat.ForcePages())
+   if (rc = Commit(fhAttrcat))
       goto err_return;
 
    // Update RELCAT
@@ -650,6 +678,7 @@ RC SM_Manager::Print(const char *relName)
    RM_FileScan fs;
    RM_Record rec;
    RM_FileHandle fh;
+   RM_RecordView view;
    int i = 0;
 
    // Get the attribute count
@@ -719,13 +748,14 @@ RC SM_Manager::Print(const char *relName)
       if (rc = fs.OpenScan(fh, INT, sizeof(int), 0, NO_OP, NULL))
          goto err_closefile;
 
-      while ((rc = fs.GetNextRec(rec)) != RM_EOF) {
+      // The tuples are printed in place, from the buffer
+      while ((rc = fs.GetNextRec(view)) != RM_EOF) {
          char *data;
 
          if (rc != 0)
             goto err_closescan;
 
-         if (rc = rec.GetData(data))
+         if (rc = view.GetData(data))
             goto err_closescan;
 
          p.Print(cout, data);
@@ -757,13 +787,13 @@ RC SM_Manager::Print(const char *relName)
             goto err_closefile;
          }
           
-         if (rc = fh.GetRec(rid, rec)) {
+         if (rc = fh.GetRec(rid, view)) {
             is.CloseScan();
             pIxm->CloseIndex(ih);
             goto err_closefile;
          }
 
-         if (rc = rec.GetData(data))
+         if (rc = view.GetData(data))
             goto err_closescan;
 
          p.Print(cout, data);
@@ -779,8 +809,9 @@ RC SM_Manager::Print(const char *relName)
 
    // Print the footer information
    p.PrintFooter(cout);
-   // Close relation file
-   if (rc = pRmm->CloseFile(fh))
+   // Close relation file, once the last tuple is unpinned
+   if ((rc = view.Release()) ||
+       (rc = pRmm->CloseFile(fh)))
       goto err_delete;
 
    // Deallocate attributes
@@ -793,6 +824,7 @@ RC SM_Manager::Print(const char *relName)
 err_closescan:
    fs.CloseScan();
 err_closefile:
+   view.Release();
    pRmm->CloseFile(fh);
 err_delete:
    delete [] attributes;
@@ -800,25 +832,239 @@ err_delete:
    return (rc);
 }
 
+//
+// PrintIO
+//
+// Desc: Print what the buffer did for each relation and index opened so
+//       far (see PF_FileStats).  Their files are named after them: an
+//       index file is relName.indexNo, indexNo being the offset of the
+//       attribute indexed.  Other files are listed under their name.
+// In:   pfm - PF_Manager the files were opened with
+// Ret:  PF return code, RM return code
+//
+RC SM_Manager::PrintIO(PF_Manager &pfm)
+{
+   RC rc;
+   PF_FileStats *pStats;
+   int numFiles;
+   DataAttrInfo attributes[8];
+   SM_BufferUseRec use;
+
+   if (rc = pfm.GetFileStats(pStats, numFiles))
+      return (rc);
+
+   // Instantiate a Printer object
+   SM_SetAttrcatRec(attributes[0],
+                    "buffer", "relName", OFFSET(SM_BufferUseRec, relName),
+                    STRING, MAXNAME, -1);
+   SM_SetAttrcatRec(attributes[1],
+                    "buffer", "attrName", OFFSET(SM_BufferUseRec, attrName),
+                    STRING, MAXNAME, -1);
+   SM_SetAttrcatRec(attributes[2],
+                    "buffer", "hits", OFFSET(SM_BufferUseRec, hits),
+                    INT, sizeof(int), -1);
+   SM_SetAttrcatRec(attributes[3],
+                    "buffer", "misses", OFFSET(SM_BufferUseRec, misses),
+                    INT, sizeof(int), -1);
+   SM_SetAttrcatRec(attributes[4],
+                    "buffer", "hitRatio", OFFSET(SM_BufferUseRec, hitRatio),
+                    FLOAT, sizeof(float), -1);
+   SM_SetAttrcatRec(attributes[5],
+                    "buffer", "evictions",
+                    OFFSET(SM_BufferUseRec, evictions),
+                    INT, sizeof(int), -1);
+   SM_SetAttrcatRec(attributes[6],
+                    "buffer", "writeBacks",
+                    OFFSET(SM_BufferUseRec, writeBacks),
+                    INT, sizeof(int), -1);
+   SM_SetAttrcatRec(attributes[7],
+                    "buffer", "residentPages",
+                    OFFSET(SM_BufferUseRec, residentPages),
+                    INT, sizeof(int), -1);
+   Printer p(attributes, 8);
+
+   // Print the header information
+   p.PrintHeader(cout);
+
+   // Print each file
+   for (int i = 0; i < numFiles; i++) {
+      const char *fileName = pStats[i].fileName;
+      const char *dot = strrchr(fileName, '.');
+
+      memset(&use, 0, sizeof(use));
+      strncpy(use.relName, fileName, MAXNAME);
+
+      // An index: relName.indexNo, where relName has an attribute indexed
+      // with indexNo
+      if (dot != NULL && dot > fileName && dot - fileName < MAXNAME &&
+            dot[1] != '\0' &&
+            strspn(dot + 1, "0123456789") == strlen(dot + 1)) {
+         char relName[MAXNAME + 1];
+
+         memset(relName, '\0', sizeof(relName));
+         strncpy(relName, fileName, dot - fileName);
+         if (GetIndexedAttr(relName, atoi(dot + 1), use.attrName) == 0) {
+            memset(use.relName, '\0', sizeof(use.relName));
+            strncpy(use.relName, relName, MAXNAME);
+         }
+      }
+
+      use.hits = pStats[i].hits;
+      use.misses = pStats[i].misses;
+      if (use.hits + use.misses > 0)
+         use.hitRatio = (float)use.hits / (use.hits + use.misses);
+      use.evictions = pStats[i].evictions;
+      use.writeBacks = pStats[i].writeBacks;
+      use.residentPages = pStats[i].residentPages;
+
+      p.Print(cout, (char *)&use);
+   }
+
+   // Print the footer information
+   p.PrintFooter(cout);
+
+   delete [] pStats;
+
+   // Return ok
+   return (0);
+}
+
 //
 // Set
 //
-// Desc: 
+// Desc: Set a parameter.  Besides useindex, and compress (1: the pages
+//       of the relations created from now on, and of the tuples loaded
+//       into them, are compressed on disk), the buffer pools are set
+//       with these (their value holds two words):
+//       poolsize   "pool pages"   size of a pool, which is created if new
+//       poolpolicy "pool policy"  its policy: lru, clock, 2q, lruk or arc
+//       autotune   "pool pages"   size the pool by its miss-ratio curve,
+//                                 up to pages pages (0: stop)
+//       curve      "pool 1"       keep its miss-ratio curve (0: stop)
+//       pool       "file pool"    the pool the file of a relation (rel)
+//                                 or of one of its indexes (rel.attr)
+//                                 uses; "default" is the default pool
 // In:   paramName - 
 //       value - 
-// Ret:  
+// Ret:  SM_PARAMUNDEFINED, or SM, RM or PF return code
 //
 RC SM_Manager::Set(const char *paramName, const char *value)
 {
-   if (strcasecmp(paramName, "useindex") == 0)
+   static const char *policyNames[] = { "lru", "clock", "2q", "lruk", "arc" };
+   char *word1, *word2;
+   int i;
+   RC rc;
+
+   if (strcasecmp(paramName, "useindex") == 0) {
       useIndexNo = atoi(value);
-   else
+      return (0);
+   }
+   if (strcasecmp(paramName, "compress") == 0) {
+      bCompress = (atoi(value) != 0);
+      return (0);
+   }
+
+   if (pPfm == NULL || (strcasecmp(paramName, "poolsize") &&
+         strcasecmp(paramName, "poolpolicy") &&
+         strcasecmp(paramName, "autotune") &&
+         strcasecmp(paramName, "curve") &&
+         strcasecmp(paramName, "pool")))
       return (SM_PARAMUNDEFINED);
 
+   // Split the value in two
+   word1 = new char[strlen(value) + 1];
+   word2 = new char[strlen(value) + 1];
+   if (sscanf(value, "%s %s", word1, word2) != 2)
+      rc = SM_PARAMUNDEFINED;
+   else if (strcasecmp(paramName, "poolsize") == 0)
+      rc = pPfm->SetPoolSize(word1, atoi(word2));
+   else if (strcasecmp(paramName, "poolpolicy") == 0) {
+      for (i = 0; i < 5 && strcasecmp(word2, policyNames[i]); i++)
+         ;
+      rc = pPfm->SetPoolPolicy(word1, (PF_ReplacePolicy)i);
+   }
+   else if (strcasecmp(paramName, "autotune") == 0)
+      rc = pPfm->SetAutoTune(word1, atoi(word2));
+   else if (strcasecmp(paramName, "curve") == 0)
+      rc = pPfm->SetCurve(word1, atoi(word2) != 0);
+   else
+      rc = BindPool(word1, word2);
+   delete [] word1;
+   delete [] word2;
+
+   return (rc);
+}
+
+//
+// BindPool
+//
+// Desc: Have the file of a relation or index use a buffer pool.  A
+//       catalog is opened again so that it does now.
+// In:   fileSpec - relName or relName.attrName
+//       poolName - name of the pool
+// Ret:  SM_INDEXNOTFOUND, or SM, RM or PF return code
+//
+RC SM_Manager::BindPool(const char *fileSpec, const char *poolName)
+{
+   RC rc;
+   RM_Record rec;
+   char *data;
+   char relName[MAXNAME + 1];
+   char fileName[MAXNAME + 16];
+   const char *attrName = strchr(fileSpec, '.');
+   RM_FileHandle *pCatalog = NULL;
+
+   // Name of the file of the relation, or of the index
+   if (attrName == NULL ? strlen(fileSpec) > MAXNAME :
+         attrName - fileSpec > MAXNAME)
+      return (SM_INVALIDRELNAME);
+   memset(relName, '\0', sizeof(relName));
+   strncpy(relName, fileSpec, attrName ? attrName - fileSpec : MAXNAME);
+   if (attrName == NULL) {
+      if (strcmp(relName, RELCAT) == 0)
+         pCatalog = &fhRelcat;
+      else if (strcmp(relName, ATTRCAT) == 0)
+         pCatalog = &fhAttrcat;
+      else if ((rc = GetRelationInfo(relName, rec, data)))
+         return (rc);
+      strcpy(fileName, relName);
+   }
+   else {
+      if ((rc = GetAttributeInfo(relName, attrName + 1, rec, data)))
+         return (rc);
+      if (((SM_AttrcatRec *)data)->indexNo == -1)
+         return (SM_INDEXNOTFOUND);
+      sprintf(fileName, "%s.%d", relName, ((SM_AttrcatRec *)data)->indexNo);
+   }
+
+   if ((rc = pPfm->BindFile(fileName, poolName)))
+      return (rc);
+
+   // The catalogs are kept open
+   if (pCatalog != NULL && ((rc = pRmm->CloseFile(*pCatalog)) ||
+         (rc = pRmm->OpenFile(fileName, *pCatalog))))
+      return (rc);
+
    // Return ok
    return (0);
 }
 
+//
+// Commit
+//
+// Desc: Make the changes to a catalog durable: with a log, commit it
+//       (the changes to the other files too); otherwise force the pages
+//       of the catalog to disk
+// In:   fhCatalog - fhRelcat or fhAttrcat
+// Ret:  RM or PF return code
+//
+RC SM_Manager::Commit(RM_FileHandle &fhCatalog)
+{
+   if (pPfm != NULL)
+      return (pPfm->Commit());
+   return (fhCatalog.ForcePages());
+}
+
 //
 // Help
 //
@@ -1037,7 +1283,7 @@ RC SM_Manager::SetRelationIndexCount(const char *relName, int value)
    ((SM_RelcatRec *)relcatData)->indexCount += value;
    if (rc = fhRelcat.UpdateRec(rec))
       goto err_return;
-   if (rc = fhRelcat.ForcePages())
+   if (rc = Commit(fhRelcat))
       goto err_return;
 
    // Return ok
@@ -1096,3 +1342,59 @@ err_return:
    return (rc);
 }
 
+//
+// GetIndexedAttr
+//
+// Desc: Find the attribute of a relation that has index indexNo
+// In:   relName -
+//       indexNo -
+// Out:  attrName - set to the name of the attribute (MAXNAME chars)
+// Ret:  SM_INDEXNOTFOUND, RM return code
+//
+RC SM_Manager::GetIndexedAttr(const char *relName, int indexNo,
+                              char *attrName)
+{
+   RC rc;
+   char _relName[MAXNAME];
+   RM_FileScan fs;
+   RM_Record rec;
+   char *data;
+
+   // Open a file scan for ATTRCAT
+   memset(_relName, '\0', sizeof(_relName));
+   strncpy(_relName, relName, MAXNAME);
+   if (rc = fs.OpenScan(fhAttrcat, STRING, MAXNAME,
+                        OFFSET(SM_AttrcatRec, relName), EQ_OP, _relName))
+      goto err_return;
+
+   // Find the attribute with the index
+   while ((rc = fs.GetNextRec(rec)) != RM_EOF) {
+      if (rc != 0)
+         goto err_closescan;
+
+      if (rc = rec.GetData(data))
+         goto err_closescan;
+
+      if (((SM_AttrcatRec *)data)->indexNo == indexNo) {
+         memcpy(attrName, ((SM_AttrcatRec *)data)->attrName, MAXNAME);
+         break;
+      }
+   }
+   if (rc == RM_EOF) {
+      rc = SM_INDEXNOTFOUND;
+      goto err_closescan;
+   }
+
+   // Close a file scan for ATTRCAT
+   if (rc = fs.CloseScan())
+      goto err_return;
+
+   // Return ok
+   return (0);
+
+   // Return error
+err_closescan:
+   fs.CloseScan();
+err_return:
+   return (rc);
+}
@@ -13,7 +13,7 @@
 
 using namespace std;
 
-SM_Manager::SM_Manager(IX_Manager &ixm, RM_Manager &rmm)
+SM_Manager::SM_Manager(IX_Manager &ixm, RM_Manager &rmm, PF_Manager *pPfm)
 {
 }
 
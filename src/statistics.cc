@@ -13,6 +13,9 @@
 
 // This is essentially a (poor-man's) simplified version of gprof.
 
+// The statistics of the PF layer are kept apart, in the per-thread slots
+// (see statistics.h); only other keys are looked up in the list.
+
 // Andre Bergholz, who was the TA for the 2000 offering has written
 // some (or maybe all) of this code.
 
@@ -32,6 +35,32 @@ const char *PF_PAGENOTFOUND = "PAGENOTFOUND";
 const char *PF_READPAGE = "READPAGE";           // IO
 const char *PF_WRITEPAGE = "WRITEPAGE";         // IO
 const char *PF_FLUSHPAGES = "FLUSHPAGES";
+const char *PF_PREFETCHPAGE = "PREFETCHPAGE";   // IO
+const char *PF_WRITERUN = "WRITERUN";           // IO
+const char *PF_CLEANPAGE = "CLEANPAGE";         // IO
+const char *PF_DIRTYVICTIM = "DIRTYVICTIM";     // IO
+
+const char *const PF_StatKeys[PF_NUM_STATS] = {
+   "GETPAGE", "PAGEFOUND", "PAGENOTFOUND", "READPAGE", "WRITEPAGE",
+   "FLUSHPAGES", "PREFETCHPAGE", "WRITERUN", "CLEANPAGE", "DIRTYVICTIM"
+};
+
+const char *const PF_TimerNames[PF_NUM_TIMERS] = {
+   "READTIME", "WRITETIME", "EVICTTIME"
+};
+
+//
+// StatCounter
+//
+// Desc: The PF_StatCounter whose key is psKey, -1 if none is
+//
+static int StatCounter(const char *psKey)
+{
+   for (int i = 0; i < PF_NUM_STATS; i++)
+      if (psKey == PF_StatKeys[i] || strcmp(psKey, PF_StatKeys[i]) == 0)
+         return (i);
+   return (-1);
+}
 
 //
 // Statistic class
@@ -110,6 +139,51 @@ Boolean Statistic::operator==(const char *psKey_) const
 // This class will track a dynamic list of statistics.
 //
 
+int StatisticsMgr::numThreads = 0;
+
+StatisticsMgr::StatisticsMgr()
+{
+   memset(slots, 0, sizeof(slots));
+   pthread_mutex_init(&mutex, NULL);
+}
+
+StatisticsMgr::~StatisticsMgr()
+{
+   pthread_mutex_destroy(&mutex);
+}
+
+//
+// Sum
+//
+// Sum up a statistic counted by number over the slots.  Returns whether
+// it has been registered at all since it was last reset.
+//
+int StatisticsMgr::Sum(PF_StatCounter counter, int &value)
+{
+   int bUsed = FALSE;
+
+   value = 0;
+   for (int i = 0; i < STAT_MAX_THREADS; i++) {
+      value += slots[i].values[counter];
+      bUsed |= slots[i].bUsed[counter];
+   }
+   return (bUsed);
+}
+
+//
+// Clear
+//
+// Reset a statistic counted by number.  What other threads add to it
+// meanwhile may or may not be kept.
+//
+void StatisticsMgr::Clear(PF_StatCounter counter)
+{
+   for (int i = 0; i < STAT_MAX_THREADS; i++) {
+      slots[i].values[counter] = 0;
+      slots[i].bUsed[counter] = FALSE;
+   }
+}
+
 //
 // Register
 //
@@ -130,6 +204,42 @@ RC StatisticsMgr::Register (const char *psKey, const Stat_Operation op,
    if (psKey==NULL || (op != STAT_ADDONE && piValue == NULL))
       return STAT_INVALID_ARGS;
 
+   // The PF statistics are counted in the slots.  Those operations that
+   // are not additions fold the slots into one.
+   int counter = StatCounter(psKey);
+   if (counter >= 0) {
+      PF_StatCounter c = (PF_StatCounter)counter;
+      int iValue;
+
+      switch (op) {
+         case STAT_ADDONE:
+            Add(c);
+            return 0;
+         case STAT_ADDVALUE:
+            Add(c, *piValue);
+            return 0;
+         case STAT_SUBVALUE:
+            Add(c, -*piValue);
+            return 0;
+         default:
+            break;
+      }
+
+      pthread_mutex_lock(&mutex);
+      Sum(c, iValue);
+      if (op == STAT_SETVALUE)
+         iValue = *piValue;
+      else if (op == STAT_MULTVALUE)
+         iValue *= *piValue;
+      else
+         iValue = (int) (iValue/(*piValue));
+      Clear(c);
+      Add(c, iValue);
+      pthread_mutex_unlock(&mutex);
+      return 0;
+   }
+
+   pthread_mutex_lock(&mutex);
    iCount = llStats.GetLength();
 
    for (i=0; i < iCount; i++) {
@@ -174,6 +284,7 @@ RC StatisticsMgr::Register (const char *psKey, const Stat_Operation op,
       llStats.Append(*pStat);
       delete pStat;
    }
+   pthread_mutex_unlock(&mutex);
 
    return 0;
 }
@@ -212,7 +323,17 @@ int *StatisticsMgr::Get(const char *psKey)
 {
    int i, iCount;
    Statistic *pStat = NULL;
+   int *piValue = NULL;
+
+   int counter = StatCounter(psKey);
+   if (counter >= 0) {
+      int iValue;
+      if (Sum((PF_StatCounter)counter, iValue))
+         piValue = new int(iValue);
+      return piValue;
+   }
 
+   pthread_mutex_lock(&mutex);
    iCount = llStats.GetLength();
 
    for (i=0; i < iCount; i++) {
@@ -222,10 +343,11 @@ int *StatisticsMgr::Get(const char *psKey)
    }
 
    // Check to see if we found the Stat
-   if (i==iCount)
-      return NULL;
+   if (i!=iCount)
+      piValue = new int(pStat->iValue);
+   pthread_mutex_unlock(&mutex);
 
-   return new int(pStat->iValue);
+   return piValue;
 }
 
 //
@@ -237,13 +359,21 @@ void StatisticsMgr::Print()
 {
    int i, iCount;
    Statistic *pStat = NULL;
+   int iValue;
 
+   for (i=0; i < PF_NUM_STATS; i++)
+      if (Sum((PF_StatCounter)i, iValue))
+         cout << PF_StatKeys[i] << "::" << iValue << "\n";
+   PrintTimes();
+
+   pthread_mutex_lock(&mutex);
    iCount = llStats.GetLength();
 
    for (i=0; i < iCount; i++) {
       pStat = llStats[i];
       cout << pStat->psKey << "::" << pStat->iValue << "\n";
    }
+   pthread_mutex_unlock(&mutex);
 }
 
 //
@@ -260,6 +390,16 @@ RC StatisticsMgr::Reset(const char *psKey)
    if (psKey==NULL)
       return STAT_INVALID_ARGS;
 
+   int counter = StatCounter(psKey);
+   if (counter >= 0) {
+      int iValue;
+      if (!Sum((PF_StatCounter)counter, iValue))
+         return STAT_UNKNOWN_KEY;
+      Clear((PF_StatCounter)counter);
+      return 0;
+   }
+
+   pthread_mutex_lock(&mutex);
    iCount = llStats.GetLength();
 
    for (i=0; i < iCount; i++) {
@@ -271,7 +411,9 @@ RC StatisticsMgr::Reset(const char *psKey)
    // If we found the statistic then remove it from the list
    if (i!=iCount)
       llStats.Delete(i);
-   else
+   pthread_mutex_unlock(&mutex);
+
+   if (i==iCount)
       return STAT_UNKNOWN_KEY;
 
    return 0;
@@ -285,6 +427,62 @@ RC StatisticsMgr::Reset(const char *psKey)
 //
 void StatisticsMgr::Reset()
 {
+   for (int i = 0; i < PF_NUM_STATS; i++)
+      Clear((PF_StatCounter)i);
+   for (int i = 0; i < STAT_MAX_THREADS; i++)
+      memset(slots[i].times, 0, sizeof(slots[i].times));
+
+   pthread_mutex_lock(&mutex);
    llStats.Erase();
+   pthread_mutex_unlock(&mutex);
+}
+
+//
+// GetTimes
+//
+// Get the # of operations timed by timer in each bucket: counts[b] is
+// the # of those that took from 2^b to 2^(b+1) nanoseconds.
+//
+void StatisticsMgr::GetTimes(PF_StatTimer timer,
+      long long counts[STAT_TIME_BUCKETS])
+{
+   for (int b = 0; b < STAT_TIME_BUCKETS; b++) {
+      counts[b] = 0;
+      for (int i = 0; i < STAT_MAX_THREADS; i++)
+         counts[b] += slots[i].times[timer][b];
+   }
+}
+
+//
+// PrintTimes
+//
+// Print out the # of operations of each timer and their median, 90th
+// and 99th percentile times (each the upper bound of its bucket)
+//
+void StatisticsMgr::PrintTimes()
+{
+   static const int percents[] = { 50, 90, 99 };
+   long long counts[STAT_TIME_BUCKETS];
+
+   for (int t = 0; t < PF_NUM_TIMERS; t++) {
+      long long total = 0;
+
+      GetTimes((PF_StatTimer)t, counts);
+      for (int b = 0; b < STAT_TIME_BUCKETS; b++)
+         total += counts[b];
+      if (total == 0)
+         continue;
+
+      cout << PF_TimerNames[t] << "::" << total;
+      for (int p = 0; p < 3; p++) {
+         long long seen = 0;
+         int b;
+         for (b = 0; b < STAT_TIME_BUCKETS - 1; b++)
+            if ((seen += counts[b]) * 100 >= total * percents[p])
+               break;
+         cout << " p" << percents[p] << "<" << (2LL << b) << "ns";
+      }
+      cout << "\n";
+   }
 }
 
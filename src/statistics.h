@@ -17,6 +17,14 @@
 // Andre Bergholz, who was the TA for the 2000 offering, has written
 // some (or probably all) of this code.
 
+// The statistics of the PF layer are counted on every page access, so
+// they do not go through the list of statistics: each has a number
+// (PF_StatCounter) and is counted by Add in a slot of the thread doing
+// it, without a lock (see StatSlot).  Register, Get, Print and Reset
+// take them by their keys as before.  The time taken by reads, writes
+// and evictions is kept the same way in histograms of log2 buckets
+// (Time, GetTimes).
+
 #ifndef STATISTICS_H
 #define STATISTICS_H
 
@@ -46,8 +54,65 @@ const int STAT_BASE = 9000;
 #endif
 
 // This include must come after the common defines
+#include <pthread.h>
+#include <time.h>
 #include "linkedlist.h"    // Template class for the link list
 
+//
+// The statistics counted by number.  The order is that of PF_StatKeys.
+//
+enum PF_StatCounter {
+    PF_STAT_GETPAGE,
+    PF_STAT_PAGEFOUND,
+    PF_STAT_PAGENOTFOUND,
+    PF_STAT_READPAGE,
+    PF_STAT_WRITEPAGE,
+    PF_STAT_FLUSHPAGES,
+    PF_STAT_PREFETCHPAGE,
+    PF_STAT_WRITERUN,
+    PF_STAT_CLEANPAGE,
+    PF_STAT_DIRTYVICTIM,
+    PF_NUM_STATS
+};
+
+//
+// The operations that are timed
+//
+enum PF_StatTimer {
+    PF_TIME_READ,      // ReadPage
+    PF_TIME_WRITE,     // WritePage, WriteRun
+    PF_TIME_EVICT,     // throwing a page out of the buffer (and writing it)
+    PF_NUM_TIMERS
+};
+
+const int STAT_MAX_THREADS = 64;    // threads with a slot of their own
+const int STAT_TIME_BUCKETS = 40;   // bucket b: times of 2^b to 2^(b+1) ns
+const int STAT_CACHE_LINE = 64;
+
+//
+// StatSlot - the counts of one thread
+//
+// Only its thread changes a slot (threads beyond STAT_MAX_THREADS share
+// them, hence the atomic adds), and the slots are a cache line apart, so
+// counting costs an uncontended add.  Readers sum up the slots.
+//
+struct StatSlot {
+    int       values[PF_NUM_STATS];
+    char      bUsed[PF_NUM_STATS];          // registered since Reset
+    long long times[PF_NUM_TIMERS][STAT_TIME_BUCKETS];
+} __attribute__((aligned(STAT_CACHE_LINE)));
+
+//
+// StatNow - a clock for Time, in nanoseconds
+//
+inline long long StatNow()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000000LL + ts.tv_nsec);
+}
+
 // A single statistic will be tracked by a Statistic class
 class Statistic {
 public:
@@ -85,12 +150,38 @@ enum Stat_Operation {
     STAT_SUBVALUE
 };
 
-// The StatisticsMgr will track a group of statistics
+// The StatisticsMgr will track a group of statistics.  It may be used by
+// several threads at once.
 class StatisticsMgr {
 
 public:
-    StatisticsMgr() {};
-    ~StatisticsMgr() {};
+    StatisticsMgr();
+    ~StatisticsMgr();
+
+    // Add value to a statistic counted by number
+    void Add(PF_StatCounter counter, int value = 1)
+    {
+        StatSlot &slot = slots[ThreadSlot()];
+        __sync_fetch_and_add(&slot.values[counter], value);
+        if (!slot.bUsed[counter])
+            slot.bUsed[counter] = TRUE;
+    }
+
+    // Count an operation that took the time since start (a StatNow)
+    void Time(PF_StatTimer timer, long long start)
+    {
+        long long ns = StatNow() - start;
+        int bucket = ns > 1 ? 63 - __builtin_clzll(ns) : 0;
+        if (bucket >= STAT_TIME_BUCKETS)
+            bucket = STAT_TIME_BUCKETS - 1;
+        __sync_fetch_and_add(&slots[ThreadSlot()].times[timer][bucket], 1);
+    }
+
+    // Get the # of operations timed in each bucket
+    void GetTimes(PF_StatTimer timer, long long counts[STAT_TIME_BUCKETS]);
+
+    // Print out the percentiles of the times of each timer
+    void PrintTimes();
 
     // Add a new statistic or register a change to an existing statistic.
     // The piValue for can be NULL, except for those operations that require
@@ -116,7 +207,23 @@ public:
     void Reset();
 
 private:
-    LinkList<Statistic> llStats;
+    // The slot of the calling thread
+    static int ThreadSlot()
+    {
+        static __thread int slot = -1;
+        if (slot < 0)
+            slot = (int)((unsigned int)__sync_fetch_and_add(&numThreads, 1)
+                  % STAT_MAX_THREADS);
+        return (slot);
+    }
+
+    int  Sum    (PF_StatCounter counter, int &value);
+    void Clear  (PF_StatCounter counter);
+
+    StatSlot            slots[STAT_MAX_THREADS];   // PF_StatCounter counts
+    LinkList<Statistic> llStats;   // statistics counted by key
+    pthread_mutex_t     mutex;     // protects llStats
+    static int          numThreads;                // threads given a slot
 };
 
 //
@@ -136,6 +243,14 @@ extern const char *PF_PAGENOTFOUND;
 extern const char *PF_READPAGE;         // IO
 extern const char *PF_WRITEPAGE;        // IO
 extern const char *PF_FLUSHPAGES;
+extern const char *PF_PREFETCHPAGE;     // IO
+extern const char *PF_WRITERUN;         // IO
+extern const char *PF_CLEANPAGE;        // IO
+extern const char *PF_DIRTYVICTIM;      // IO
+
+// The keys of the PF_StatCounter statistics, and the names of the timers
+extern const char *const PF_StatKeys[PF_NUM_STATS];
+extern const char *const PF_TimerNames[PF_NUM_TIMERS];
 
 #endif
 
@@ -48,7 +48,7 @@ main(int argc, char *argv[])
     PF_Manager pfm;
     RM_Manager rmm(pfm);
     IX_Manager ixm(pfm);
-    SM_Manager smm(ixm, rmm);
+    SM_Manager smm(ixm, rmm, &pfm);
     QL_Manager qlm(smm, ixm, rmm);
 
     // open the database
@@ -1,21 +1,22 @@
-/* A Bison parser, made by GNU Bison 2.5.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison interface for Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989-1990, 2000-2011 Free Software Foundation, Inc.
-   
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -26,58 +27,80 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
 
-/* Tokens.  */
+#ifndef YY_YY_Y_TAB_H_INCLUDED
+# define YY_YY_Y_TAB_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     RW_CREATE = 258,
-     RW_DROP = 259,
-     RW_TABLE = 260,
-     RW_INDEX = 261,
-     RW_LOAD = 262,
-     RW_SET = 263,
-     RW_HELP = 264,
-     RW_PRINT = 265,
-     RW_EXIT = 266,
-     RW_SELECT = 267,
-     RW_FROM = 268,
-     RW_WHERE = 269,
-     RW_INSERT = 270,
-     RW_DELETE = 271,
-     RW_UPDATE = 272,
-     RW_AND = 273,
-     RW_INTO = 274,
-     RW_VALUES = 275,
-     T_EQ = 276,
-     T_LT = 277,
-     T_LE = 278,
-     T_GT = 279,
-     T_GE = 280,
-     T_NE = 281,
-     T_EOF = 282,
-     NOTOKEN = 283,
-     RW_RESET = 284,
-     RW_IO = 285,
-     RW_BUFFER = 286,
-     RW_RESIZE = 287,
-     RW_QUERY_PLAN = 288,
-     RW_ON = 289,
-     RW_OFF = 290,
-     T_INT = 291,
-     T_REAL = 292,
-     T_STRING = 293,
-     T_QSTRING = 294,
-     T_SHELL_CMD = 295
-   };
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    RW_CREATE = 258,               /* RW_CREATE  */
+    RW_DROP = 259,                 /* RW_DROP  */
+    RW_TABLE = 260,                /* RW_TABLE  */
+    RW_INDEX = 261,                /* RW_INDEX  */
+    RW_LOAD = 262,                 /* RW_LOAD  */
+    RW_SET = 263,                  /* RW_SET  */
+    RW_HELP = 264,                 /* RW_HELP  */
+    RW_PRINT = 265,                /* RW_PRINT  */
+    RW_EXIT = 266,                 /* RW_EXIT  */
+    RW_SELECT = 267,               /* RW_SELECT  */
+    RW_FROM = 268,                 /* RW_FROM  */
+    RW_WHERE = 269,                /* RW_WHERE  */
+    RW_INSERT = 270,               /* RW_INSERT  */
+    RW_DELETE = 271,               /* RW_DELETE  */
+    RW_UPDATE = 272,               /* RW_UPDATE  */
+    RW_AND = 273,                  /* RW_AND  */
+    RW_INTO = 274,                 /* RW_INTO  */
+    RW_VALUES = 275,               /* RW_VALUES  */
+    T_EQ = 276,                    /* T_EQ  */
+    T_LT = 277,                    /* T_LT  */
+    T_LE = 278,                    /* T_LE  */
+    T_GT = 279,                    /* T_GT  */
+    T_GE = 280,                    /* T_GE  */
+    T_NE = 281,                    /* T_NE  */
+    T_EOF = 282,                   /* T_EOF  */
+    NOTOKEN = 283,                 /* NOTOKEN  */
+    RW_RESET = 284,                /* RW_RESET  */
+    RW_IO = 285,                   /* RW_IO  */
+    RW_BUFFER = 286,               /* RW_BUFFER  */
+    RW_RESIZE = 287,               /* RW_RESIZE  */
+    RW_CURVE = 288,                /* RW_CURVE  */
+    RW_QUERY_PLAN = 289,           /* RW_QUERY_PLAN  */
+    RW_ON = 290,                   /* RW_ON  */
+    RW_OFF = 291,                  /* RW_OFF  */
+    T_INT = 292,                   /* T_INT  */
+    T_REAL = 293,                  /* T_REAL  */
+    T_STRING = 294,                /* T_STRING  */
+    T_QSTRING = 295,               /* T_QSTRING  */
+    T_SHELL_CMD = 296              /* T_SHELL_CMD  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
-/* Tokens.  */
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
 #define RW_CREATE 258
 #define RW_DROP 259
 #define RW_TABLE 260
@@ -108,24 +131,21 @@
 #define RW_IO 285
 #define RW_BUFFER 286
 #define RW_RESIZE 287
-#define RW_QUERY_PLAN 288
-#define RW_ON 289
-#define RW_OFF 290
-#define T_INT 291
-#define T_REAL 292
-#define T_STRING 293
-#define T_QSTRING 294
-#define T_SHELL_CMD 295
-
-
-
-
+#define RW_CURVE 288
+#define RW_QUERY_PLAN 289
+#define RW_ON 290
+#define RW_OFF 291
+#define T_INT 292
+#define T_REAL 293
+#define T_STRING 294
+#define T_QSTRING 295
+#define T_SHELL_CMD 296
+
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
+union YYSTYPE
 {
-
-/* Line 2068 of yacc.c  */
-#line 71 "parse.y"
+#line 73 "parse.y"
 
     int ival;
     CompOp cval;
@@ -133,16 +153,19 @@ typedef union YYSTYPE
     char *sval;
     NODE *n;
 
+#line 157 "y.tab.h"
 
-
-/* Line 2068 of yacc.c  */
-#line 140 "y.tab.h"
-} YYSTYPE;
+};
+typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
 # define YYSTYPE_IS_DECLARED 1
 #endif
 
+
 extern YYSTYPE yylval;
 
 
+int yyparse (void);
+
+
+#endif /* !YY_YY_Y_TAB_H_INCLUDED  */